@@ -74,6 +74,202 @@ struct self_dispatch<true>
 };
 ///////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////
+// An array's view() method returns a lightweight read-only view of a slice, instead of converting
+// every element up front as slicing does. The view holds a reference to the array object and
+// fetches elements through it as they're accessed, so viewing part of a huge array (or slicing a
+// view) costs nothing until the elements are used. list() on a view gives a modifiable copy.
+struct PyArraySliceObject
+{
+  PyObject_HEAD;
+  PyObject *array;
+  Py_ssize_t start;
+  Py_ssize_t step;
+  Py_ssize_t length;
+};
+
+inline PyObject *array_slice_new(PyObject *array, Py_ssize_t start, Py_ssize_t step,
+                                 Py_ssize_t length);
+
+inline void array_slice_dealloc(PyObject *self)
+{
+  PyArraySliceObject *slice = (PyArraySliceObject *)self;
+  Py_XDECREF(slice->array);
+  Py_TYPE(self)->tp_free(self);
+}
+
+inline Py_ssize_t array_slice_len(PyObject *self)
+{
+  return ((PyArraySliceObject *)self)->length;
+}
+
+inline PyObject *array_slice_item(PyObject *self, Py_ssize_t idx)
+{
+  PyArraySliceObject *slice = (PyArraySliceObject *)self;
+
+  if(idx < 0 || idx >= slice->length)
+  {
+    PyErr_SetString(PyExc_IndexError, "list index out of range");
+    return NULL;
+  }
+
+  return PySequence_GetItem(slice->array, slice->start + idx * slice->step);
+}
+
+inline PyObject *array_slice_subscript(PyObject *self, PyObject *idxobj)
+{
+  PyArraySliceObject *slice = (PyArraySliceObject *)self;
+
+  if(PyIndex_Check(idxobj))
+  {
+    Py_ssize_t idx = PyNumber_AsSsize_t(idxobj, PyExc_IndexError);
+    if(idx == -1 && PyErr_Occurred())
+      return NULL;
+
+    if(idx < 0)
+      idx += slice->length;
+
+    return array_slice_item(self, idx);
+  }
+
+  if(PySlice_Check(idxobj))
+  {
+    Py_ssize_t start, stop, step, slicelength;
+
+    if(PySlice_GetIndicesEx(idxobj, slice->length, &start, &stop, &step, &slicelength) < 0)
+      return NULL;
+
+    // compose with our own slice so the new view refers directly to the array
+    return array_slice_new(slice->array, slice->start + start * slice->step, slice->step * step,
+                           slicelength);
+  }
+
+  PyErr_SetString(PyExc_TypeError, "list index not index or slice");
+  return NULL;
+}
+
+inline PyObject *array_slice_repr(PyObject *self)
+{
+  PyObject *list = PySequence_List(self);
+  if(!list)
+    return NULL;
+
+  PyObject *ret = PyObject_Repr(list);
+  Py_DECREF(list);
+  return ret;
+}
+
+inline PyObject *array_slice_concat(PyObject *self, PyObject *other)
+{
+  PyObject *list = PySequence_List(self);
+  if(!list)
+    return NULL;
+
+  PyObject *ret = PySequence_InPlaceConcat(list, other);
+  Py_DECREF(list);
+  return ret;
+}
+
+inline PyObject *array_slice_richcompare(PyObject *self, PyObject *other, int op)
+{
+  // compare as lists, so a view compares equal to a list with the same elements
+  PyObject *list = PySequence_List(self);
+  if(!list)
+    return NULL;
+
+  PyObject *ret = NULL;
+
+  if(PyObject_TypeCheck(other, Py_TYPE(self)))
+  {
+    PyObject *otherList = PySequence_List(other);
+    if(otherList)
+    {
+      ret = PyObject_RichCompare(list, otherList, op);
+      Py_DECREF(otherList);
+    }
+  }
+  else
+  {
+    ret = PyObject_RichCompare(list, other, op);
+  }
+
+  Py_DECREF(list);
+  return ret;
+}
+
+inline PyTypeObject *array_slice_type()
+{
+  static PySequenceMethods sequenceMethods = {};
+  static PyMappingMethods mappingMethods = {};
+  static PyTypeObject type = {PyVarObject_HEAD_INIT(NULL, 0)};
+  static bool ready = false;
+
+  if(!ready)
+  {
+    sequenceMethods.sq_length = &array_slice_len;
+    sequenceMethods.sq_item = &array_slice_item;
+    sequenceMethods.sq_concat = &array_slice_concat;
+    mappingMethods.mp_length = &array_slice_len;
+    mappingMethods.mp_subscript = &array_slice_subscript;
+
+    type.tp_name = "renderdoc.ArraySlice";
+    type.tp_basicsize = sizeof(PyArraySliceObject);
+    type.tp_flags = Py_TPFLAGS_DEFAULT;
+    type.tp_doc = "A read-only view of a slice of an array, elements are fetched as they're accessed";
+    type.tp_dealloc = &array_slice_dealloc;
+    type.tp_repr = &array_slice_repr;
+    type.tp_str = &array_slice_repr;
+    type.tp_richcompare = &array_slice_richcompare;
+    type.tp_as_sequence = &sequenceMethods;
+    type.tp_as_mapping = &mappingMethods;
+
+    if(PyType_Ready(&type) < 0)
+      return NULL;
+
+    ready = true;
+  }
+
+  return &type;
+}
+
+inline PyObject *array_slice_new(PyObject *array, Py_ssize_t start, Py_ssize_t step,
+                                 Py_ssize_t length)
+{
+  PyTypeObject *type = array_slice_type();
+  if(!type)
+    return NULL;
+
+  PyArraySliceObject *slice = PyObject_New(PyArraySliceObject, type);
+  if(!slice)
+    return NULL;
+
+  Py_INCREF(array);
+  slice->array = array;
+  slice->start = start;
+  slice->step = step;
+  slice->length = length;
+
+  return (PyObject *)slice;
+}
+
+// returns a view of array[start:stop:step], any of which can be NULL or None as with a slice
+inline PyObject *array_view(PyObject *array, Py_ssize_t len, PyObject *start, PyObject *stop,
+                            PyObject *step)
+{
+  PyObject *sliceobj = PySlice_New(start, stop, step);
+  if(!sliceobj)
+    return NULL;
+
+  Py_ssize_t first, last, stride, slicelength;
+  int res = PySlice_GetIndicesEx(sliceobj, len, &first, &last, &stride, &slicelength);
+  Py_DECREF(sliceobj);
+
+  if(res < 0)
+    return NULL;
+
+  return array_slice_new(array, first, stride, slicelength);
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // templated implementations of array functions for both slots and named
 // functions in python sequences
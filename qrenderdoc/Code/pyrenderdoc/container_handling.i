@@ -87,6 +87,11 @@
 
 %enddef // %define LIST_MODIFY_IN_PLACE_TYPEMAP
 
+// passes the python object for 'self' to a method, for anything that needs to keep it alive
+%typemap(in, numinputs=0) PyObject *pyself {
+  $1 = self;
+}
+
 // this macro defines the list array class named methods, forwarding to templated implementations
 %define EXTEND_ARRAY_CLASS_METHODS(Container)
   %extend Container {
@@ -95,6 +100,7 @@
     %feature("kwargs") pop;
     %feature("kwargs") sort;
     %feature("kwargs") index;
+    %feature("kwargs") view;
 
     PyObject *append(PyObject *value)
     {
@@ -150,6 +156,14 @@
     {
       return array_removeOne($self, item);
     }
+
+    // unlike slicing, which copies the elements into a list, this returns a read-only view that
+    // fetches elements from the array as they're accessed.
+    PyObject *view(PyObject *pyself, PyObject *start = NULL, PyObject *stop = NULL,
+                   PyObject *step = NULL)
+    {
+      return array_view(pyself, (Py_ssize_t)array_len($self), start, stop, step);
+    }
   } // %extend Container
 %enddef // define EXTEND_ARRAY_CLASS_METHODS(Container)
 
@@ -485,6 +485,54 @@ struct TypeConversion<rdcpair<A, B>, false>
   static PyObject *ConvertToPy(const rdcpair<A, B> &in) { return ConvertToPy(in, NULL); }
 };
 
+// python object that takes ownership of a bytebuf and exposes it with the buffer protocol. The
+// zero-copy accessors like GetBufferDataView move their bytebuf into one of these and hand it to
+// python wrapped in a memoryview, so large readbacks can be passed straight on to e.g. numpy.
+struct PyByteBufObject
+{
+  PyObject_HEAD
+  bytebuf *buf;
+};
+
+inline int PyByteBuf_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+  bytebuf *buf = ((PyByteBufObject *)self)->buf;
+  return PyBuffer_FillInfo(view, self, buf->data(), (Py_ssize_t)buf->size(), 1, flags);
+}
+
+inline void PyByteBuf_dealloc(PyObject *self)
+{
+  PyByteBufObject *obj = (PyByteBufObject *)self;
+  delete obj->buf;
+  Py_TYPE(self)->tp_free(self);
+}
+
+inline PyTypeObject *PyByteBuf_Type()
+{
+  static PyBufferProcs bufferProcs = {};
+  static PyTypeObject type = {PyVarObject_HEAD_INIT(NULL, 0)};
+  static bool ready = false;
+
+  if(!ready)
+  {
+    bufferProcs.bf_getbuffer = &PyByteBuf_getbuffer;
+
+    type.tp_name = "renderdoc.bytebuf_storage";
+    type.tp_basicsize = sizeof(PyByteBufObject);
+    type.tp_flags = Py_TPFLAGS_DEFAULT;
+    type.tp_doc = "Storage for bytes returned from RenderDoc, accessed through a memoryview";
+    type.tp_dealloc = &PyByteBuf_dealloc;
+    type.tp_as_buffer = &bufferProcs;
+
+    if(PyType_Ready(&type) < 0)
+      return NULL;
+
+    ready = true;
+  }
+
+  return &type;
+}
+
 // specialisation for bytebuf
 template <>
 struct TypeConversion<bytebuf, false>
@@ -493,13 +541,29 @@ struct TypeConversion<bytebuf, false>
   // nicer failure error messages out with the index that failed
   static int ConvertFromPy(PyObject *in, bytebuf &out, int *failIdx)
   {
-    if(!PyBytes_Check(in))
+    // accept anything implementing the buffer protocol - bytes, bytearray, memoryview, numpy arrays
+    // etc. Strings don't implement it so they're still rejected.
+    if(!PyObject_CheckBuffer(in))
+      return SWIG_TypeError;
+
+    Py_buffer view = {};
+    if(PyObject_GetBuffer(in, &view, PyBUF_FULL_RO) != 0)
+    {
+      PyErr_Clear();
       return SWIG_TypeError;
+    }
 
-    Py_ssize_t len = PyBytes_Size(in);
+    // copies directly for contiguous buffers, and gathers strided ones
+    out.resize((size_t)view.len);
+    int ret = PyBuffer_ToContiguous(out.data(), &view, view.len, 'C');
 
-    out.resize((size_t)len);
-    memcpy(out.data(), PyBytes_AsString(in), out.size());
+    PyBuffer_Release(&view);
+
+    if(ret != 0)
+    {
+      PyErr_Clear();
+      return SWIG_TypeError;
+    }
 
     return SWIG_OK;
   }
@@ -517,6 +581,26 @@ struct TypeConversion<bytebuf, false>
   }
 
   static PyObject *ConvertToPy(const bytebuf &in) { return ConvertToPy(in, NULL); }
+  // when we can take ownership of the data, avoid the copy into a bytes object
+  static PyObject *ConvertToPy(bytebuf &&in)
+  {
+    PyTypeObject *type = PyByteBuf_Type();
+    if(!type)
+      return NULL;
+
+    PyByteBufObject *obj = PyObject_New(PyByteBufObject, type);
+    if(!obj)
+      return NULL;
+
+    obj->buf = new bytebuf;
+    obj->buf->swap(in);
+
+    // the memoryview holds the only reference to the storage, and frees it when released
+    PyObject *ret = PyMemoryView_FromObject((PyObject *)obj);
+    Py_DECREF(obj);
+
+    return ret;
+  }
 };
 
 // specialisation for array
@@ -540,22 +624,35 @@ struct TypeConversion<rdcarray<U>, false>
   // nicer failure error messages out with the index that failed
   static int ConvertFromPy(PyObject *in, rdcarray<U> &out, int *failIdx)
   {
-    if(!PyList_Check(in))
+    // accept any sequence such as tuples or array slices, but not strings which would otherwise be
+    // split into characters
+    if(PyUnicode_Check(in) || PyBytes_Check(in) || !PySequence_Check(in))
       return SWIG_TypeError;
 
-    out.resize((size_t)PyList_Size(in));
+    // for lists and tuples this just adds a reference
+    PyObject *seq = PySequence_Fast(in, "expected a sequence");
+    if(!seq)
+    {
+      PyErr_Clear();
+      return SWIG_TypeError;
+    }
+
+    out.resize((size_t)PySequence_Fast_GET_SIZE(seq));
 
     for(int i = 0; i < out.count(); i++)
     {
-      int ret = TypeConversion<U>::ConvertFromPy(PyList_GetItem(in, i), out[i]);
+      int ret = TypeConversion<U>::ConvertFromPy(PySequence_Fast_GET_ITEM(seq, i), out[i]);
       if(!SWIG_IsOK(ret))
       {
+        Py_DECREF(seq);
         if(failIdx)
           *failIdx = i;
         return ret;
       }
     }
 
+    Py_DECREF(seq);
+
     return SWIG_OK;
   }
 
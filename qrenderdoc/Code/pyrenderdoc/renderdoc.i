@@ -293,6 +293,41 @@ Invalid if the object is not actually a string.
   PyObject *AsString() { return ConvertToPy($self->data.str); }
 }
 
+// zero-copy variants of functions returning large bytebufs. The data is moved into storage owned by
+// python instead of being copied into a bytes object.
+%extend IReplayController {
+  %feature("docstring") R"(Retrieve the contents of a range of a buffer, without copying.
+
+This is the same as :meth:`GetBufferData` but the data is returned as a read-only ``memoryview``
+which can be passed directly to anything that accepts a bytes-like object, such as
+``struct.unpack_from`` or ``numpy.frombuffer``.
+
+:param ResourceId buff: The id of the buffer to retrieve data from.
+:param int offset: The byte offset to the start of the range.
+:param int len: The length of the range, or 0 to retrieve the rest of the bytes in the buffer.
+:return: The requested buffer contents.
+:rtype: ``memoryview``
+)";
+  PyObject *GetBufferDataView(ResourceId buff, uint64_t offset, uint64_t len)
+  {
+    return TypeConversion<bytebuf>::ConvertToPy($self->GetBufferData(buff, offset, len));
+  }
+
+  %feature("docstring") R"(Retrieve the contents of one subresource of a texture, without copying.
+
+This is the same as :meth:`GetTextureData` but the data is returned as a read-only ``memoryview``.
+
+:param ResourceId tex: The id of the texture to retrieve data from.
+:param Subresource sub: The subresource within this texture to use.
+:return: The requested texture contents.
+:rtype: ``memoryview``
+)";
+  PyObject *GetTextureDataView(ResourceId tex, const Subresource &sub)
+  {
+    return TypeConversion<bytebuf>::ConvertToPy($self->GetTextureData(tex, sub));
+  }
+}
+
 // add python array members that aren't in slots
 EXTEND_ARRAY_CLASS_METHODS(rdcarray)
 EXTEND_ARRAY_CLASS_METHODS(StructuredChunkList)
@@ -321,6 +356,8 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EnvironmentModification)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EventUsage)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PathEntry)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PixelModification)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, MeshFormat)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, MeshStatistics)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceId)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, LineColumnInfo)
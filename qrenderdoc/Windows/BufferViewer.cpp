@@ -1343,7 +1343,7 @@ struct CalcBoundingBoxData
 {
   uint32_t eventId;
 
-  BufferConfiguration input[3];
+  rdcarray<MeshFormat> input[3];
 
   BBoxData output;
 };
@@ -2759,30 +2759,101 @@ void BufferViewer::populateBBox(PopulateBufferData *bufdata)
 
     bbox->eventId = eventId;
 
-    bbox->input[0] = bufdata->vsinConfig;
-    bbox->input[1] = bufdata->vsoutConfig;
-    bbox->input[2] = bufdata->vsoutConfig;
+    // describe every column as a mesh element, so that the bounds can all be calculated natively
+    // in one go on the replay thread.
+    rdcarray<BoundVBuffer> vbs = m_Ctx.CurPipelineState().GetVBuffers();
+    BoundVBuffer ib = m_Ctx.CurPipelineState().GetIBuffer();
+
+    {
+      const BufferConfiguration &s = bufdata->vsinConfig;
+
+      for(int i = 0; i < s.columns.count(); i++)
+      {
+        const ShaderConstant &el = s.columns[i];
+        const BufferElementProperties &prop = s.props[i];
+
+        MeshFormat fmt;
+        fmt.format = prop.format;
+        fmt.numIndices = s.numRows;
+        fmt.instanced = prop.perinstance;
+        fmt.instStepRate = prop.instancerate;
+        fmt.allowRestart = s.primRestart != 0;
+        fmt.restartIndex = s.primRestart;
+
+        if(draw->flags & DrawFlags::Indexed)
+        {
+          fmt.indexResourceId = ib.resourceId;
+          fmt.indexByteStride = draw->indexByteWidth ? draw->indexByteWidth : 4U;
+          fmt.indexByteOffset = ib.byteOffset + draw->indexOffset * fmt.indexByteStride;
+          fmt.baseVertex = draw->baseVertex;
+        }
+
+        bool generic = i < s.genericsEnabled.count() && s.genericsEnabled[i];
+
+        if(prop.buffer < vbs.count() && !generic)
+        {
+          const BoundVBuffer &vb = vbs[prop.buffer];
+
+          // instanced elements only read the value for the current instance
+          uint64_t element = draw->vertexOffset;
+          if(prop.perinstance)
+            element = draw->instanceOffset +
+                      (prop.instancerate > 0 ? s.curInstance / prop.instancerate : 0);
+
+          fmt.vertexResourceId = vb.resourceId;
+          fmt.vertexByteStride = vb.byteStride;
+          fmt.vertexByteOffset = vb.byteOffset + el.byteOffset + element * vb.byteStride;
+        }
+
+        bbox->input[0].push_back(fmt);
+      }
+    }
+
+    const MeshFormat *postFormats[] = {&bufdata->postVS, &bufdata->postGS};
+    const BufferConfiguration *postConfigs[] = {&bufdata->vsoutConfig, &bufdata->gsoutConfig};
+
+    for(int stage = 0; stage < 2; stage++)
+    {
+      const BufferConfiguration &s = *postConfigs[stage];
+
+      for(int i = 0; i < s.columns.count(); i++)
+      {
+        MeshFormat fmt = *postFormats[stage];
+        fmt.format = s.props[i].format;
+        if(fmt.vertexResourceId != ResourceId())
+          fmt.vertexByteOffset += s.columns[i].byteOffset;
+
+        bbox->input[stage + 1].push_back(fmt);
+      }
+    }
 
     QPointer<BufferViewer> me(this);
 
-    // fire up a thread to calculate the bounding box
-    LambdaThread *thread = new LambdaThread([this, me, bbox] {
+    m_Ctx.Replay().AsyncInvoke([this, me, bbox](IReplayController *r) {
       if(!me)
         return;
 
-      calcBoundingData(*bbox);
+      rdcarray<MeshFormat> formats;
+      for(size_t stage = 0; stage < ARRAY_COUNT(bbox->input); stage++)
+        formats.append(bbox->input[stage]);
+
+      rdcarray<MeshStatistics> stats = r->GetMeshStatistics(formats);
+
+      size_t idx = 0;
+      for(size_t stage = 0; stage < ARRAY_COUNT(bbox->input); stage++)
+      {
+        for(int i = 0; i < bbox->input[stage].count() && idx < stats.size(); i++, idx++)
+        {
+          bbox->output.bounds[stage].Min.push_back(stats[idx].minimum);
+          bbox->output.bounds[stage].Max.push_back(stats[idx].maximum);
+        }
+      }
 
       if(!me)
         return;
 
       GUIInvoke::call(this, [this, bbox]() { UI_UpdateBoundingBox(*bbox); });
     });
-    thread->setName(lit("BBox calc"));
-    thread->selfDelete(true);
-    thread->start();
-
-    // give the thread a few ms to finish, so we don't get a tiny flicker on small/fast meshes
-    thread->wait(10);
   }
 }
 
@@ -2800,101 +2871,6 @@ void BufferViewer::setPersistData(const QVariant &persistData)
   ui->dockarea->restoreState(state);
 }
 
-void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
-{
-  for(size_t stage = 0; stage < ARRAY_COUNT(bbox.input); stage++)
-  {
-    const BufferConfiguration &s = bbox.input[stage];
-
-    QList<FloatVector> &minOutputList = bbox.output.bounds[stage].Min;
-    QList<FloatVector> &maxOutputList = bbox.output.bounds[stage].Max;
-
-    minOutputList.reserve(s.columns.count());
-    maxOutputList.reserve(s.columns.count());
-
-    for(int i = 0; i < s.columns.count(); i++)
-    {
-      FloatVector maxvec(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
-
-      if(s.columns[i].type.descriptor.columns == 1)
-        maxvec.y = maxvec.z = maxvec.w = 0.0;
-      else if(s.columns[i].type.descriptor.columns == 2)
-        maxvec.z = maxvec.w = 0.0;
-      else if(s.columns[i].type.descriptor.columns == 3)
-        maxvec.w = 0.0;
-
-      minOutputList.push_back(maxvec);
-      maxOutputList.push_back(FloatVector(-maxvec.x, -maxvec.y, -maxvec.z, -maxvec.w));
-    }
-
-    QVector<CachedElData> cache;
-
-    CacheDataForIteration(cache, s.columns, s.props, s.buffers, bbox.input[0].curInstance);
-
-    // possible optimisation here if this shows up as a hot spot - sort and unique the indices and
-    // iterate in ascending order, to be more cache friendly
-
-    for(uint32_t row = 0; row < s.numRows; row++)
-    {
-      uint32_t idx = row;
-
-      if(s.indices && s.indices->hasData())
-      {
-        idx = CalcIndex(s.indices, row, s.baseVertex, s.primRestart);
-
-        if(idx == ~0U || (s.primRestart && idx == s.primRestart))
-          continue;
-      }
-
-      for(int col = 0; col < s.columns.count(); col++)
-      {
-        const CachedElData &d = cache[col];
-        const ShaderConstant *el = d.el;
-        const BufferElementProperties *prop = d.prop;
-
-        float *minOut = (float *)&minOutputList[col];
-        float *maxOut = (float *)&maxOutputList[col];
-
-        if(d.data)
-        {
-          const byte *bytes = d.data;
-
-          if(!prop->perinstance)
-            bytes += d.stride * idx;
-
-          QVariantList list = GetVariants(prop->format, el->type.descriptor, bytes, d.end);
-
-          for(int comp = 0; comp < 4 && comp < list.count(); comp++)
-          {
-            const QVariant &v = list[comp];
-
-            QMetaType::Type vt = GetVariantMetatype(v);
-
-            float fval = 0.0f;
-
-            if(vt == QMetaType::Double)
-              fval = (float)v.toDouble();
-            else if(vt == QMetaType::Float)
-              fval = v.toFloat();
-            else if(vt == QMetaType::UInt || vt == QMetaType::UShort || vt == QMetaType::UChar)
-              fval = (float)v.toUInt();
-            else if(vt == QMetaType::Int || vt == QMetaType::Short || vt == QMetaType::SChar)
-              fval = (float)v.toInt();
-            else
-              continue;
-
-            if(qIsFinite(fval))
-            {
-              minOut[comp] = qMin(minOut[comp], fval);
-              maxOut[comp] = qMax(maxOut[comp], fval);
-            }
-          }
-        }
-      }
-    }
-  }
-}
-
 void BufferViewer::UI_UpdateBoundingBox(const CalcBoundingBoxData &bbox)
 {
   {
@@ -168,7 +168,6 @@ private:
   QMap<uint32_t, BBoxData> m_BBoxes;
 
   void populateBBox(PopulateBufferData *data);
-  void calcBoundingData(CalcBoundingBoxData &bbox);
   void UI_UpdateBoundingBox(const CalcBoundingBoxData &bbox);
   void UI_UpdateBoundingBoxLabels(int compCount = 0);
 
@@ -0,0 +1,1232 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include <map>
+#include "api/replay/data_types.h"
+#include "common/common.h"
+#include "common/formatting.h"
+#include "common/threading.h"
+#include "strings/string_utils.h"
+#include "android_utils.h"
+
+// Client for the adb server's 'smart socket' protocol. Requests are sent as a 4-digit hex length
+// followed by the request string, and the server replies OKAY or FAIL (followed by a hex length
+// prefixed message). A host:transport request switches the connection to talk to a device, after
+// which a single service such as shell: or sync: can be opened on it.
+//
+// Most services close the connection once they're done, but sync: sessions can carry any number of
+// transfers so we keep those open for reuse.
+//
+// Shell commands use the shell v2 protocol where the device supports it, which keeps stdout and
+// stderr separate and returns the command's exit code like adb does. On older devices the plain
+// shell: service merges stderr into stdout and has no exit code, so the command always appears to
+// succeed - the same as running an old adb against those devices.
+
+namespace Android
+{
+// timeout between pieces of data from a shell command, which can be slow to produce its output.
+static const uint32_t shellTimeoutMS = 60000;
+
+// the largest data packet allowed in the sync protocol.
+static const uint32_t syncMaxData = 64 * 1024;
+
+// regular file, rw-r--r--
+static const uint32_t syncDefaultMode = 0100644;
+
+enum class ServerReply
+{
+  Okay,
+  Fail,
+  Disconnected,
+};
+
+static bool SendRequest(Network::Socket *sock, const rdcstr &request)
+{
+  rdcstr msg = StringFormat::Fmt("%04x", (uint32_t)request.length()) + request;
+  return sock->SendDataBlocking(msg.c_str(), (uint32_t)msg.length());
+}
+
+static bool RecvHexLength(Network::Socket *sock, uint32_t &length)
+{
+  char hex[4];
+  if(!sock->RecvDataBlocking(hex, 4))
+    return false;
+
+  length = 0;
+  for(char c : hex)
+  {
+    length <<= 4;
+    if(c >= '0' && c <= '9')
+      length |= uint32_t(c - '0');
+    else if(c >= 'a' && c <= 'f')
+      length |= uint32_t(c - 'a' + 10);
+    else if(c >= 'A' && c <= 'F')
+      length |= uint32_t(c - 'A' + 10);
+    else
+      return false;
+  }
+
+  return true;
+}
+
+static bool RecvString(Network::Socket *sock, uint32_t length, rdcstr &str)
+{
+  str.resize(length);
+  return sock->RecvDataBlocking(str.data(), length);
+}
+
+static ServerReply RecvReply(Network::Socket *sock, rdcstr &error)
+{
+  char status[4];
+  if(!sock->RecvDataBlocking(status, 4))
+    return ServerReply::Disconnected;
+
+  if(!memcmp(status, "OKAY", 4))
+    return ServerReply::Okay;
+
+  uint32_t length = 0;
+  if(!memcmp(status, "FAIL", 4) && RecvHexLength(sock, length) && RecvString(sock, length, error))
+    return ServerReply::Fail;
+
+  return ServerReply::Disconnected;
+}
+
+// reads everything the server sends until it closes the connection
+static void RecvUntilClosed(Network::Socket *sock, rdcstr &output)
+{
+  char buf[4096];
+
+  while(sock->Connected())
+  {
+    uint32_t length = sizeof(buf);
+    if(!sock->RecvDataNonBlocking(buf, length))
+      break;
+
+    if(length > 0)
+    {
+      output.append(buf, length);
+      continue;
+    }
+
+    // nothing was ready. If the connection is still open, block until the next byte arrives
+    if(!sock->IsRecvDataWaiting())
+    {
+      if(!sock->Connected() || !sock->RecvDataBlocking(buf, 1))
+        break;
+
+      output.push_back(buf[0]);
+    }
+  }
+}
+
+uint16_t adbServerPort()
+{
+  // adb itself allows the server port to be overridden this way
+  const char *env = Process::GetEnvVariable("ANDROID_ADB_SERVER_PORT");
+  if(env)
+  {
+    uint32_t port = atoi(env);
+    if(port > 0 && port <= 0xffff)
+      return uint16_t(port);
+  }
+
+  return 5037;
+}
+
+Network::Socket *adbOpenService(uint16_t port, const rdcstr &deviceID, const rdcstr &service,
+                                rdcstr &error)
+{
+  error.clear();
+
+  Network::Socket *sock = Network::CreateClientSocket("127.0.0.1", port, 1000);
+  if(!sock)
+    return NULL;
+
+  rdcstr transport = deviceID.empty() ? "host:transport-any" : "host:transport:" + deviceID;
+
+  ServerReply reply = ServerReply::Disconnected;
+  if(SendRequest(sock, transport))
+    reply = RecvReply(sock, error);
+
+  if(reply == ServerReply::Okay && SendRequest(sock, service))
+    reply = RecvReply(sock, error);
+
+  if(reply == ServerReply::Okay)
+    return sock;
+
+  if(reply == ServerReply::Disconnected)
+    error.clear();
+  else if(error.empty())
+    error = "adb server refused '" + service + "'";
+
+  delete sock;
+  return NULL;
+}
+
+static void SetFailure(Process::ProcessResult &result, const rdcstr &error)
+{
+  result.strStderror = "adb: error: " + error + "\n";
+  result.retCode = 1;
+}
+
+static bool HostQuery(uint16_t port, const rdcstr &request, rdcstr &response,
+                      Process::ProcessResult &result)
+{
+  Network::Socket *sock = Network::CreateClientSocket("127.0.0.1", port, 1000);
+  if(!sock)
+    return false;
+
+  rdcstr error;
+  uint32_t length = 0;
+  ServerReply reply = ServerReply::Disconnected;
+  if(SendRequest(sock, request))
+    reply = RecvReply(sock, error);
+
+  if(reply == ServerReply::Okay &&
+     !(RecvHexLength(sock, length) && RecvString(sock, length, response)))
+    reply = ServerReply::Disconnected;
+
+  delete sock;
+
+  if(reply == ServerReply::Fail)
+    SetFailure(result, error);
+
+  return reply != ServerReply::Disconnected;
+}
+
+static Threading::CriticalSection featuresLock;
+static std::map<rdcstr, bool> shellV2Support;
+
+// checks whether the device supports the shell v2 protocol. Returns false if the server couldn't be
+// reached, and sets a failure in result if it refused the query, e.g. for an unknown device.
+static bool SupportsShellV2(uint16_t port, const rdcstr &deviceID, bool &shellV2,
+                            Process::ProcessResult &result)
+{
+  rdcstr key = StringFormat::Fmt("%u:%s", port, deviceID.c_str());
+
+  {
+    SCOPED_LOCK(featuresLock);
+    auto it = shellV2Support.find(key);
+    if(it != shellV2Support.end())
+    {
+      shellV2 = it->second;
+      return true;
+    }
+  }
+
+  rdcstr prefix = deviceID.empty() ? "host:" : "host-serial:" + deviceID + ":";
+
+  rdcstr features;
+  if(!HostQuery(port, prefix + "features", features, result))
+    return false;
+
+  if(result.retCode != 0)
+    return true;
+
+  rdcarray<rdcstr> list;
+  split(features.trimmed(), list, ',');
+  shellV2 = list.contains("shell_v2");
+
+  SCOPED_LOCK(featuresLock);
+  shellV2Support[key] = shellV2;
+
+  return true;
+}
+
+// shell v2 packets are a 1 byte ID and a little-endian length, followed by that much data
+enum class ShellPacket : byte
+{
+  Stdin = 0,
+  Stdout = 1,
+  Stderr = 2,
+  Exit = 3,
+};
+
+static const uint32_t shellMaxPacket = 1024 * 1024;
+
+static void RecvShellV2(Network::Socket *sock, Process::ProcessResult &result)
+{
+  bytebuf data;
+
+  for(;;)
+  {
+    ShellPacket id;
+    uint32_t length = 0;
+    if(!sock->RecvDataBlocking(&id, 1) || !sock->RecvDataBlocking(&length, 4) ||
+       length > shellMaxPacket)
+      break;
+
+    data.resize(length);
+    if(length > 0 && !sock->RecvDataBlocking(data.data(), length))
+      break;
+
+    if(id == ShellPacket::Stdout)
+    {
+      result.strStdout.append((const char *)data.data(), length);
+    }
+    else if(id == ShellPacket::Stderr)
+    {
+      result.strStderror.append((const char *)data.data(), length);
+    }
+    else if(id == ShellPacket::Exit)
+    {
+      result.retCode = length > 0 ? data[0] : 0;
+      return;
+    }
+  }
+
+  // the connection was lost before the command exited
+  result.retCode = 1;
+}
+
+static bool RunShell(uint16_t port, const rdcstr &deviceID, const rdcstr &command,
+                     Process::ProcessResult &result)
+{
+  bool shellV2 = false;
+  if(!SupportsShellV2(port, deviceID, shellV2, result))
+    return false;
+
+  if(result.retCode != 0)
+    return true;
+
+  // without a terminal, as adb does when it's given a command to run
+  rdcstr service = (shellV2 ? "shell,v2,raw:" : "shell:") + command;
+
+  rdcstr error;
+  Network::Socket *sock = adbOpenService(port, deviceID, service, error);
+  if(!sock)
+  {
+    if(error.empty())
+      return false;
+
+    SetFailure(result, error);
+    return true;
+  }
+
+  sock->SetTimeout(shellTimeoutMS);
+  if(shellV2)
+    RecvShellV2(sock, result);
+  else
+    RecvUntilClosed(sock, result.strStdout);
+  delete sock;
+
+  return true;
+}
+
+static bool Forward(uint16_t port, const rdcstr &deviceID, const rdcstr &request,
+                    Process::ProcessResult &result)
+{
+  Network::Socket *sock = Network::CreateClientSocket("127.0.0.1", port, 1000);
+  if(!sock)
+    return false;
+
+  rdcstr prefix = deviceID.empty() ? "host:" : "host-serial:" + deviceID + ":";
+
+  rdcstr error;
+  ServerReply reply = ServerReply::Disconnected;
+  if(SendRequest(sock, prefix + request))
+    reply = RecvReply(sock, error);
+
+  // the first OKAY says the device was found, the second that the forward was (un)installed.
+  // Older servers close the connection instead of sending the second.
+  if(reply == ServerReply::Okay && RecvReply(sock, error) == ServerReply::Fail)
+    reply = ServerReply::Fail;
+
+  delete sock;
+
+  if(reply == ServerReply::Fail)
+    SetFailure(result, error);
+
+  return reply != ServerReply::Disconnected;
+}
+
+enum class SyncResult
+{
+  Success,
+  Failed,
+  Disconnected,
+};
+
+struct SyncConnection
+{
+  uint16_t port;
+  rdcstr deviceID;
+  Network::Socket *sock;
+};
+
+static Threading::CriticalSection syncLock;
+static rdcarray<SyncConnection> syncConnections;
+
+static const size_t maxIdleSyncConnections = 4;
+
+static Network::Socket *TakeSyncConnection(uint16_t port, const rdcstr &deviceID, bool &reused,
+                                           rdcstr &error)
+{
+  {
+    SCOPED_LOCK(syncLock);
+    for(size_t i = 0; i < syncConnections.size(); i++)
+    {
+      if(syncConnections[i].port == port && syncConnections[i].deviceID == deviceID)
+      {
+        Network::Socket *sock = syncConnections[i].sock;
+        syncConnections.erase(i);
+        reused = true;
+        return sock;
+      }
+    }
+  }
+
+  reused = false;
+  return adbOpenService(port, deviceID, "sync:", error);
+}
+
+static void ReturnSyncConnection(uint16_t port, const rdcstr &deviceID, Network::Socket *sock)
+{
+  {
+    SCOPED_LOCK(syncLock);
+    if(syncConnections.size() < maxIdleSyncConnections)
+    {
+      syncConnections.push_back({port, deviceID, sock});
+      return;
+    }
+  }
+
+  delete sock;
+}
+
+// sync requests are a 4 character ID and a little-endian length, followed by that much data. Each
+// request is sent in one go so that a connection the server has closed is noticed on the following
+// read rather than partway through a request.
+static bool SyncRequest(Network::Socket *sock, const char *id, const void *data, uint32_t length)
+{
+  bytebuf packet;
+  packet.resize(8 + length);
+  memcpy(packet.data(), id, 4);
+  memcpy(packet.data() + 4, &length, 4);
+  if(length > 0)
+    memcpy(packet.data() + 8, data, length);
+  return sock->SendDataBlocking(packet.data(), (uint32_t)packet.size());
+}
+
+static bool SyncHeader(Network::Socket *sock, const char *id, uint32_t value)
+{
+  byte header[8];
+  memcpy(header, id, 4);
+  memcpy(header + 4, &value, 4);
+  return sock->SendDataBlocking(header, sizeof(header));
+}
+
+static bool SyncRecvHeader(Network::Socket *sock, char *id, uint32_t &length)
+{
+  return sock->RecvDataBlocking(id, 4) && sock->RecvDataBlocking(&length, 4);
+}
+
+static SyncResult SyncFailure(Network::Socket *sock, uint32_t length, rdcstr &error)
+{
+  if(!RecvString(sock, length, error))
+    return SyncResult::Disconnected;
+  return SyncResult::Failed;
+}
+
+static SyncResult SyncStat(Network::Socket *sock, const rdcstr &path, uint32_t &mode)
+{
+  if(!SyncRequest(sock, "STAT", path.c_str(), (uint32_t)path.length()))
+    return SyncResult::Disconnected;
+
+  char id[4];
+  uint32_t stat[3];
+  if(!sock->RecvDataBlocking(id, 4) || !sock->RecvDataBlocking(stat, sizeof(stat)) ||
+     memcmp(id, "STAT", 4))
+    return SyncResult::Disconnected;
+
+  mode = stat[0];
+  return SyncResult::Success;
+}
+
+static SyncResult SyncPush(Network::Socket *sock, const rdcstr &localPath, rdcstr remotePath,
+                           rdcstr &error)
+{
+  // like adb, pushing onto a directory puts the file inside it
+  uint32_t mode = 0;
+  SyncResult res = SyncStat(sock, remotePath, mode);
+  if(res != SyncResult::Success)
+    return res;
+
+  if((mode & 0170000) == 0040000)
+  {
+    if(remotePath.back() != '/')
+      remotePath += "/";
+    remotePath += get_basename(localPath);
+  }
+
+  FILE *f = FileIO::fopen(localPath.c_str(), "rb");
+  if(!f)
+  {
+    error = "cannot stat '" + localPath + "': No such file or directory";
+    return SyncResult::Failed;
+  }
+
+  rdcstr dest = StringFormat::Fmt("%s,%u", remotePath.c_str(), syncDefaultMode);
+  bool ok = SyncRequest(sock, "SEND", dest.c_str(), (uint32_t)dest.length());
+
+  bytebuf chunk;
+  chunk.resize(syncMaxData);
+  while(ok)
+  {
+    size_t read = FileIO::fread(chunk.data(), 1, chunk.size(), f);
+    if(read == 0)
+      break;
+    ok = SyncRequest(sock, "DATA", chunk.data(), (uint32_t)read);
+  }
+
+  FileIO::fclose(f);
+
+  // DONE carries the modification time in place of a length
+  uint32_t mtime = (uint32_t)FileIO::GetModifiedTimestamp(localPath);
+  if(!ok || !SyncHeader(sock, "DONE", mtime))
+    return SyncResult::Disconnected;
+
+  char id[4];
+  uint32_t length = 0;
+  if(!SyncRecvHeader(sock, id, length))
+    return SyncResult::Disconnected;
+
+  if(!memcmp(id, "OKAY", 4))
+    return SyncResult::Success;
+  if(!memcmp(id, "FAIL", 4))
+    return SyncFailure(sock, length, error);
+
+  return SyncResult::Disconnected;
+}
+
+static bool IsLocalDirectory(const rdcstr &path)
+{
+  rdcarray<PathEntry> entries;
+  FileIO::GetFilesInDirectory(path.c_str(), entries);
+
+  const PathProperty errors =
+      PathProperty::ErrorUnknown | PathProperty::ErrorAccessDenied | PathProperty::ErrorInvalidPath;
+
+  return entries.empty() || !(entries[0].flags & errors);
+}
+
+static SyncResult SyncPull(Network::Socket *sock, const rdcstr &remotePath, rdcstr localPath,
+                           rdcstr &error)
+{
+  // like adb, pulling into a directory puts the file inside it
+  if(IsLocalDirectory(localPath))
+  {
+    if(localPath.back() != '/' && localPath.back() != '\\')
+      localPath += "/";
+    localPath += get_basename(remotePath);
+  }
+
+  if(!SyncRequest(sock, "RECV", remotePath.c_str(), (uint32_t)remotePath.length()))
+    return SyncResult::Disconnected;
+
+  FILE *f = NULL;
+  SyncResult res = SyncResult::Disconnected;
+
+  bytebuf chunk;
+  char id[4];
+  uint32_t length = 0;
+  while(SyncRecvHeader(sock, id, length))
+  {
+    if(!memcmp(id, "FAIL", 4))
+    {
+      res = SyncFailure(sock, length, error);
+      break;
+    }
+
+    // only create the local file once we know the remote one could be opened
+    if(!f)
+    {
+      f = FileIO::fopen(localPath.c_str(), "wb");
+      if(!f)
+      {
+        error = "cannot create '" + localPath + "'";
+        res = SyncResult::Failed;
+        break;
+      }
+    }
+
+    if(!memcmp(id, "DONE", 4))
+    {
+      res = SyncResult::Success;
+      break;
+    }
+
+    if(memcmp(id, "DATA", 4) || length > syncMaxData)
+      break;
+
+    chunk.resize(length);
+    if(!sock->RecvDataBlocking(chunk.data(), length))
+      break;
+
+    if(FileIO::fwrite(chunk.data(), 1, length, f) != length)
+    {
+      error = "cannot write '" + localPath + "'";
+      res = SyncResult::Failed;
+      break;
+    }
+  }
+
+  if(f)
+  {
+    FileIO::fclose(f);
+    if(res != SyncResult::Success)
+      FileIO::Delete(localPath.c_str());
+  }
+
+  return res;
+}
+
+template <typename Transfer>
+static bool RunSync(uint16_t port, const rdcstr &deviceID, Process::ProcessResult &result,
+                    Transfer transfer)
+{
+  // a reused connection may have been closed since it was last used, if the device or server was
+  // restarted. If so we try again once on a new connection.
+  for(int attempt = 0; attempt < 2; attempt++)
+  {
+    bool reused = false;
+    rdcstr error;
+    Network::Socket *sock = TakeSyncConnection(port, deviceID, reused, error);
+    if(!sock)
+    {
+      if(error.empty())
+        return false;
+
+      SetFailure(result, error);
+      return true;
+    }
+
+    SyncResult res = transfer(sock, error);
+
+    if(res == SyncResult::Success)
+    {
+      ReturnSyncConnection(port, deviceID, sock);
+      return true;
+    }
+
+    // the server ends the sync session after any failure, so the connection can't be reused
+    delete sock;
+
+    if(res == SyncResult::Failed)
+    {
+      SetFailure(result, error);
+      return true;
+    }
+
+    if(!reused)
+      return false;
+  }
+
+  return false;
+}
+
+// splits a command line into arguments, removing double quotes. Returns false for anything that
+// would need more careful handling to match how adb sees its command line.
+static bool SplitArgs(const rdcstr &args, rdcarray<rdcstr> &tokens)
+{
+  tokens.clear();
+
+  rdcstr cur;
+  bool quoted = false, inToken = false;
+  for(char c : args)
+  {
+    if(c == '\'' || c == '\\')
+      return false;
+
+    if(c == '"')
+    {
+      quoted = !quoted;
+      inToken = true;
+    }
+    else if(c == ' ' && !quoted)
+    {
+      if(inToken)
+        tokens.push_back(cur);
+      cur.clear();
+      inToken = false;
+    }
+    else
+    {
+      cur.push_back(c);
+      inToken = true;
+    }
+  }
+
+  if(quoted)
+    return false;
+
+  if(inToken)
+    tokens.push_back(cur);
+
+  return true;
+}
+
+bool adbServerCommand(uint16_t port, const rdcstr &deviceID, const rdcstr &args,
+                      const rdcstr &workDir, Process::ProcessResult &result)
+{
+  result = Process::ProcessResult();
+  result.retCode = 0;
+
+  rdcarray<rdcstr> tokens;
+  if(!SplitArgs(args, tokens) || tokens.empty())
+    return false;
+
+  const rdcstr &cmd = tokens[0];
+
+  if(cmd == "shell" && tokens.size() > 1)
+  {
+    // the command is passed through to the device's shell as-is, the same as adb does when it has
+    // been run with each word as a separate argument. Quoting would have been removed by our own
+    // command line parsing first, so anything with quotes goes through adb.
+    if(args.contains('"'))
+      return false;
+
+    rdcstr command = args.trimmed().substr(cmd.length()).trimmed();
+    return RunShell(port, deviceID, command, result);
+  }
+  else if(cmd == "logcat")
+  {
+    // adb runs logcat through the shell with each argument quoted
+    rdcstr command = "export ANDROID_LOG_TAGS=\"\"; exec logcat";
+    for(size_t i = 1; i < tokens.size(); i++)
+      command += " '" + tokens[i] + "'";
+    return RunShell(port, deviceID, command, result);
+  }
+  else if(cmd == "devices" && tokens.size() == 1)
+  {
+    rdcstr devices;
+    if(!HostQuery(port, "host:devices", devices, result))
+      return false;
+
+    if(result.retCode == 0)
+      result.strStdout = "List of devices attached\n" + devices + "\n";
+    return true;
+  }
+  else if(cmd == "forward" && tokens.size() == 3)
+  {
+    if(tokens[1] == "--remove")
+      return Forward(port, deviceID, "killforward:" + tokens[2], result);
+    else if(tokens[1][0] != '-')
+      return Forward(port, deviceID, "forward:" + tokens[1] + ";" + tokens[2], result);
+  }
+  else if((cmd == "push" || cmd == "pull") && tokens.size() == 3)
+  {
+    rdcstr local = cmd == "push" ? tokens[1] : tokens[2];
+    rdcstr remote = cmd == "push" ? tokens[2] : tokens[1];
+
+    if(local.empty() || remote.empty() || local[0] == '-')
+      return false;
+
+    // local paths are relative to the directory adb would have been run in
+    if(FileIO::IsRelativePath(local) && !workDir.empty() && workDir != ".")
+      local = workDir + "/" + local;
+
+    if(cmd == "push")
+    {
+      return RunSync(port, deviceID, result, [&local, &remote](Network::Socket *sock, rdcstr &err) {
+        return SyncPush(sock, local, remote, err);
+      });
+    }
+    else
+    {
+      return RunSync(port, deviceID, result, [&local, &remote](Network::Socket *sock, rdcstr &err) {
+        return SyncPull(sock, remote, local, err);
+      });
+    }
+  }
+
+  return false;
+}
+
+void adbCloseConnections()
+{
+  rdcarray<SyncConnection> conns;
+  {
+    SCOPED_LOCK(syncLock);
+    conns.swap(syncConnections);
+  }
+
+  for(SyncConnection &c : conns)
+  {
+    SyncRequest(c.sock, "QUIT", NULL, 0);
+    delete c.sock;
+  }
+
+  // the device or server may be different next time
+  SCOPED_LOCK(featuresLock);
+  shellV2Support.clear();
+}
+};
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#undef None
+
+#include "catch/catch.hpp"
+
+// a stand-in for the adb server, with one device that has a handful of canned shell commands and
+// an in-memory filesystem
+struct FakeADBServer
+{
+  FakeADBServer()
+  {
+    for(port = 9735; port < 9755; port++)
+    {
+      server = Network::CreateServerSocket("localhost", port, 4);
+      if(server)
+        break;
+    }
+
+    if(server)
+      acceptThread = Threading::CreateThread([this]() { AcceptLoop(); });
+  }
+
+  ~FakeADBServer()
+  {
+    Android::adbCloseConnections();
+
+    Atomic::Inc32(&shutdown);
+    if(acceptThread)
+    {
+      Threading::JoinThread(acceptThread);
+      Threading::CloseThread(acceptThread);
+    }
+    delete server;
+
+    for(Threading::ThreadHandle t : clientThreads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+  }
+
+  uint16_t port = 0;
+  Network::Socket *server = NULL;
+
+  const rdcstr serial = "FAKE0123";
+
+  Threading::CriticalSection lock;
+  rdcarray<rdcstr> requests;
+  std::map<rdcstr, bytebuf> files;
+  int32_t syncConnections = 0;
+  // simulate the device going away between transfers
+  bool closeSyncAfterTransfer = false;
+  // simulate an older device without the shell v2 protocol
+  bool shellV2 = true;
+
+private:
+  Threading::ThreadHandle acceptThread = 0;
+  rdcarray<Threading::ThreadHandle> clientThreads;
+  int32_t shutdown = 0;
+
+  void AcceptLoop()
+  {
+    while(Atomic::CmpExch32(&shutdown, 0, 0) == 0)
+    {
+      Network::Socket *client = server->AcceptClient(10);
+      if(client)
+        clientThreads.push_back(Threading::CreateThread([this, client]() {
+          Serve(client);
+          delete client;
+        }));
+    }
+  }
+
+  void Reply(Network::Socket *sock, const rdcstr &status, const rdcstr &msg)
+  {
+    rdcstr data = status + StringFormat::Fmt("%04x", (uint32_t)msg.length()) + msg;
+    sock->SendDataBlocking(data.c_str(), (uint32_t)data.length());
+  }
+
+  void Okay(Network::Socket *sock) { sock->SendDataBlocking("OKAY", 4); }
+  void Serve(Network::Socket *sock)
+  {
+    bool device = false;
+
+    while(true)
+    {
+      uint32_t length = 0;
+      rdcstr request;
+      if(!Android::RecvHexLength(sock, length) || !Android::RecvString(sock, length, request))
+        return;
+
+      {
+        SCOPED_LOCK(lock);
+        requests.push_back(request);
+      }
+
+      if(request == "host:devices")
+      {
+        Okay(sock);
+        Reply(sock, "", serial + "\tdevice\n");
+        return;
+      }
+      else if(request == "host:transport:" + serial || request == "host:transport-any")
+      {
+        Okay(sock);
+        device = true;
+      }
+      else if(request.beginsWith("host:transport:"))
+      {
+        Reply(sock, "FAIL", "device '" + request.substr(15) + "' not found");
+        return;
+      }
+      else if(request == "host:features" || request == "host-serial:" + serial + ":features")
+      {
+        SCOPED_LOCK(lock);
+        Okay(sock);
+        Reply(sock, "", shellV2 ? "cmd,shell_v2,stat_v2" : "cmd");
+        return;
+      }
+      else if(request.beginsWith("host-serial:") && request.endsWith(":features"))
+      {
+        Reply(sock, "FAIL", "device '" + request.substr(12, request.length() - 21) + "' not found");
+        return;
+      }
+      else if(request.beginsWith("host-serial:" + serial + ":"))
+      {
+        Okay(sock);
+        Okay(sock);
+        return;
+      }
+      else if(device && (request.beginsWith("shell:") || request.beginsWith("shell,v2,raw:")))
+      {
+        Okay(sock);
+
+        bool v2 = request.beginsWith("shell,v2,raw:");
+        rdcstr command = request.substr(request.find(':') + 1);
+
+        rdcstr output, errors;
+        byte exitCode = 0;
+        if(command == "getprop ro.product.model")
+        {
+          output = "Pixel\n";
+        }
+        else if(command == "pm list packages")
+        {
+          // large enough to arrive in several pieces
+          for(int i = 0; i < 5000; i++)
+            output += StringFormat::Fmt("package:com.example.app%d\n", i);
+        }
+        else
+        {
+          errors = "/system/bin/sh: " + command + ": not found\n";
+          exitCode = 127;
+        }
+
+        if(v2)
+        {
+          ShellPacket(sock, Android::ShellPacket::Stdout, output.c_str(), output.length());
+          ShellPacket(sock, Android::ShellPacket::Stderr, errors.c_str(), errors.length());
+          ShellPacket(sock, Android::ShellPacket::Exit, &exitCode, 1);
+        }
+        else
+        {
+          output += errors;
+          sock->SendDataBlocking(output.c_str(), (uint32_t)output.length());
+        }
+        return;
+      }
+      else if(device && request == "sync:")
+      {
+        Okay(sock);
+        {
+          SCOPED_LOCK(lock);
+          syncConnections++;
+        }
+        ServeSync(sock);
+        return;
+      }
+      else
+      {
+        Reply(sock, "FAIL", "unknown request");
+        return;
+      }
+    }
+  }
+
+  void ShellPacket(Network::Socket *sock, Android::ShellPacket id, const void *data, size_t length)
+  {
+    // split into pieces like adbd does for long output
+    const byte *bytes = (const byte *)data;
+    for(size_t offs = 0; offs < length; offs += 4096)
+    {
+      uint32_t chunk = (uint32_t)RDCMIN(length - offs, (size_t)4096);
+      sock->SendDataBlocking(&id, 1);
+      sock->SendDataBlocking(&chunk, 4);
+      sock->SendDataBlocking(bytes + offs, chunk);
+    }
+  }
+
+  void SyncReply(Network::Socket *sock, const char *id, uint32_t value)
+  {
+    Android::SyncHeader(sock, id, value);
+  }
+
+  void ServeSync(Network::Socket *sock)
+  {
+    char id[4];
+    uint32_t length;
+    while(Android::SyncRecvHeader(sock, id, length))
+    {
+      rdcstr path;
+      if(!Android::RecvString(sock, length, path))
+        return;
+
+      if(!memcmp(id, "QUIT", 4))
+        return;
+
+      SCOPED_LOCK(lock);
+
+      if(!memcmp(id, "STAT", 4))
+      {
+        uint32_t stat[3] = {};
+        if(path == "/sdcard/")
+          stat[0] = 0040755;
+        else if(files.find(path) != files.end())
+          stat[0] = 0100644;
+        sock->SendDataBlocking("STAT", 4);
+        sock->SendDataBlocking(stat, sizeof(stat));
+        continue;
+      }
+      else if(!memcmp(id, "SEND", 4))
+      {
+        path = path.substr(0, path.find(','));
+        bytebuf &contents = files[path];
+        contents.clear();
+        while(Android::SyncRecvHeader(sock, id, length) && !memcmp(id, "DATA", 4))
+        {
+          size_t offs = contents.size();
+          contents.resize(offs + length);
+          sock->RecvDataBlocking(contents.data() + offs, length);
+        }
+        SyncReply(sock, "OKAY", 0);
+      }
+      else if(!memcmp(id, "RECV", 4))
+      {
+        auto it = files.find(path);
+        if(it == files.end())
+        {
+          rdcstr msg = "remote object '" + path + "' does not exist";
+          SyncReply(sock, "FAIL", (uint32_t)msg.length());
+          sock->SendDataBlocking(msg.c_str(), (uint32_t)msg.length());
+          return;
+        }
+
+        const bytebuf &contents = it->second;
+        for(size_t offs = 0; offs < contents.size(); offs += Android::syncMaxData)
+        {
+          uint32_t chunk = (uint32_t)RDCMIN(contents.size() - offs, size_t(Android::syncMaxData));
+          SyncReply(sock, "DATA", chunk);
+          sock->SendDataBlocking(contents.data() + offs, chunk);
+        }
+        SyncReply(sock, "DONE", 0);
+      }
+
+      if(closeSyncAfterTransfer)
+        return;
+    }
+  }
+};
+
+TEST_CASE("Test adb server protocol client", "[android]")
+{
+  FakeADBServer adb;
+  REQUIRE(adb.server);
+
+  Process::ProcessResult result;
+
+  SECTION("Host queries")
+  {
+    REQUIRE(Android::adbServerCommand(adb.port, "", "devices", ".", result));
+    CHECK(result.retCode == 0);
+    CHECK(result.strStdout == "List of devices attached\nFAKE0123\tdevice\n\n");
+  };
+
+  SECTION("Shell commands")
+  {
+    REQUIRE(Android::adbServerCommand(adb.port, adb.serial, "shell getprop ro.product.model", ".",
+                                      result));
+    CHECK(result.strStdout == "Pixel\n");
+
+    REQUIRE(Android::adbServerCommand(adb.port, adb.serial, "shell pm list packages", ".", result));
+    rdcarray<rdcstr> lines;
+    split(result.strStdout.trimmed(), lines, '\n');
+    REQUIRE(lines.size() == 5000);
+    CHECK(lines[4999] == "package:com.example.app4999");
+
+    REQUIRE(Android::adbServerCommand(adb.port, "", "logcat -t 10 -s renderdoc:*", ".", result));
+
+    // errors and the exit code are returned separately
+    REQUIRE(Android::adbServerCommand(adb.port, adb.serial, "shell whoami", ".", result));
+    CHECK(result.retCode == 127);
+    CHECK(result.strStdout.empty());
+    CHECK(result.strStderror == "/system/bin/sh: whoami: not found\n");
+
+    // unknown devices are reported the same way adb does
+    REQUIRE(Android::adbServerCommand(adb.port, "OTHER", "shell whoami", ".", result));
+    CHECK(result.retCode != 0);
+    CHECK(result.strStderror.contains("device 'OTHER' not found"));
+
+    SCOPED_LOCK(adb.lock);
+    CHECK(adb.requests.contains("host:transport-any"));
+    CHECK(adb.requests.contains(
+        "shell,v2,raw:export ANDROID_LOG_TAGS=\"\"; exec logcat '-t' '10' '-s' 'renderdoc:*'"));
+  };
+
+  SECTION("Shell commands without shell v2")
+  {
+    {
+      SCOPED_LOCK(adb.lock);
+      adb.shellV2 = false;
+    }
+
+    REQUIRE(Android::adbServerCommand(adb.port, adb.serial, "shell getprop ro.product.model", ".",
+                                      result));
+    CHECK(result.strStdout == "Pixel\n");
+
+    // stderr is merged and there's no exit code
+    REQUIRE(Android::adbServerCommand(adb.port, adb.serial, "shell whoami", ".", result));
+    CHECK(result.retCode == 0);
+    CHECK(result.strStdout == "/system/bin/sh: whoami: not found\n");
+
+    SCOPED_LOCK(adb.lock);
+    CHECK(adb.requests.contains("shell:whoami"));
+  };
+
+  SECTION("Port forwarding")
+  {
+    REQUIRE(Android::adbServerCommand(adb.port, adb.serial, "forward tcp:38920 localabstract:foo",
+                                      ".", result));
+    CHECK(result.retCode == 0);
+    REQUIRE(
+        Android::adbServerCommand(adb.port, adb.serial, "forward --remove tcp:38920", ".", result));
+    CHECK(result.retCode == 0);
+
+    SCOPED_LOCK(adb.lock);
+    CHECK(adb.requests.contains("host-serial:FAKE0123:forward:tcp:38920;localabstract:foo"));
+    CHECK(adb.requests.contains("host-serial:FAKE0123:killforward:tcp:38920"));
+  };
+
+  SECTION("Commands left to adb")
+  {
+    CHECK_FALSE(
+        Android::adbServerCommand(adb.port, adb.serial, "install -r \"a.apk\"", ".", result));
+    CHECK_FALSE(Android::adbServerCommand(adb.port, adb.serial, "root", ".", result));
+    CHECK_FALSE(
+        Android::adbServerCommand(adb.port, adb.serial, "shell echo \"a b\"", ".", result));
+  };
+
+  SECTION("File transfers")
+  {
+    bytebuf contents;
+    contents.resize(200 * 1024 + 17);
+    for(size_t i = 0; i < contents.size(); i++)
+      contents[i] = byte((i * 7919) >> 3);
+
+    rdcstr local = FileIO::GetTempFolderFilename() + "/renderdoc_adb_test";
+    FileIO::WriteAll(local, contents);
+
+    REQUIRE(Android::adbServerCommand(adb.port, adb.serial, "push \"" + local + "\" /sdcard/",
+                                      ".", result));
+    CHECK(result.retCode == 0);
+
+    {
+      SCOPED_LOCK(adb.lock);
+      CHECK(adb.files["/sdcard/renderdoc_adb_test"] == contents);
+    }
+
+    SECTION("Pull on the same connection")
+    {
+      FileIO::Delete(local.c_str());
+      REQUIRE(Android::adbServerCommand(adb.port, adb.serial,
+                                        "pull /sdcard/renderdoc_adb_test \"" + local + "\"", ".",
+                                        result));
+      CHECK(result.retCode == 0);
+
+      SCOPED_LOCK(adb.lock);
+      CHECK(adb.syncConnections == 1);
+    };
+
+    SECTION("Pull after the connection was closed")
+    {
+      {
+        SCOPED_LOCK(adb.lock);
+        adb.closeSyncAfterTransfer = true;
+      }
+      // let the server close the idle connection
+      Android::adbServerCommand(adb.port, adb.serial, "push \"" + local + "\" /sdcard/", ".",
+                                result);
+      Threading::Sleep(50);
+
+      FileIO::Delete(local.c_str());
+      REQUIRE(Android::adbServerCommand(adb.port, adb.serial,
+                                        "pull /sdcard/renderdoc_adb_test \"" + local + "\"", ".",
+                                        result));
+      CHECK(result.retCode == 0);
+
+      SCOPED_LOCK(adb.lock);
+      CHECK(adb.syncConnections == 2);
+    };
+
+    bytebuf pulled;
+    FileIO::ReadAll(local, pulled);
+    CHECK(pulled == contents);
+
+    // pulling into a directory keeps the remote file name
+    rdcstr dir = FileIO::GetTempFolderFilename();
+    rdcstr pulledInto = dir + "/renderdoc_adb_test";
+    FileIO::Delete(pulledInto.c_str());
+    REQUIRE(Android::adbServerCommand(adb.port, adb.serial,
+                                      "pull /sdcard/renderdoc_adb_test \"" + dir + "\"", ".",
+                                      result));
+    CHECK(result.retCode == 0);
+    pulled.clear();
+    FileIO::ReadAll(pulledInto, pulled);
+    CHECK(pulled == contents);
+
+    // a failed pull doesn't leave an empty file behind
+    FileIO::Delete(local.c_str());
+    REQUIRE(Android::adbServerCommand(adb.port, adb.serial,
+                                      "pull /sdcard/missing \"" + local + "\"", ".", result));
+    CHECK(result.retCode != 0);
+    CHECK(result.strStderror.contains("does not exist"));
+    CHECK_FALSE(FileIO::exists(local.c_str()));
+  };
+}
+
+TEST_CASE("Test adb server protocol client without a server", "[android]")
+{
+  Process::ProcessResult result;
+  CHECK_FALSE(Android::adbServerCommand(1, "", "devices", ".", result));
+  CHECK_FALSE(Android::adbServerCommand(1, "FAKE0123", "shell whoami", ".", result));
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -36,6 +36,10 @@ RDOC_CONFIG(rdcstr, Android_JDKDirPath, "",
             "The location of the root of the Java JDK. This path "
             "should contain folders such as bin and lib.");
 
+RDOC_CONFIG(bool, Android_DirectADBProtocol, true,
+            "Talk to the adb server over its socket protocol for common commands such as shell "
+            "queries, port forwarding and file transfers, instead of running adb for each one.");
+
 namespace Android
 {
 static bool adbKillServer = false;
@@ -341,6 +345,16 @@ Process::ProcessResult adbExecCommand(const rdcstr &device, const rdcstr &args,
     deviceArgs = args;
   else
     deviceArgs = StringFormat::Fmt("-s %s %s", device.c_str(), args.c_str());
+
+  // talking to the server directly avoids the cost of launching adb, which adds up quickly
+  if(Android_DirectADBProtocol() &&
+     adbServerCommand(adbServerPort(), device, args, workDir, result))
+  {
+    if(!silent)
+      RDCLOG("ADB SERVER: '%s'", deviceArgs.c_str());
+    return result;
+  }
+
   return execCommand(adb, deviceArgs, workDir, silent);
 }
 void initAdb()
@@ -371,6 +385,7 @@ void initAdb()
 }
 void shutdownAdb()
 {
+  adbCloseConnections();
   if(adbKillServer)
     adbExecCommand("", "kill-server", ".", false);
 }
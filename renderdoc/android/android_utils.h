@@ -37,6 +37,18 @@ Process::ProcessResult execScript(const rdcstr &script, const rdcstr &args,
 Process::ProcessResult execCommand(const rdcstr &exe, const rdcstr &args,
                                    const rdcstr &workDir = ".", bool silent = false);
 
+// direct client for the adb server, used to avoid running adb for each command. Handles a subset of
+// adb commands - returns false if the command isn't handled or the server couldn't be reached, in
+// which case adb should be run instead.
+uint16_t adbServerPort();
+bool adbServerCommand(uint16_t port, const rdcstr &deviceID, const rdcstr &args,
+                      const rdcstr &workDir, Process::ProcessResult &result);
+// opens a service on the device (e.g. shell:, sync:, tcp:<port>). Returns NULL if the server
+// couldn't be reached, or if it refused the request in which case error is filled out.
+Network::Socket *adbOpenService(uint16_t port, const rdcstr &deviceID, const rdcstr &service,
+                                rdcstr &error);
+void adbCloseConnections();
+
 enum class ToolDir
 {
   None,
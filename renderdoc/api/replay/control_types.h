@@ -99,6 +99,35 @@ struct MeshFormat
 
 DECLARE_REFLECTION_STRUCT(MeshFormat);
 
+DOCUMENT(R"(Contains the bounds and some basic statistics of a single mesh element, as calculated by
+:meth:`ReplayController.GetMeshStatistics`.
+
+Only finite values are considered when calculating the bounds and average. Components that don't
+exist in the element's format are left as 0.
+)");
+struct MeshStatistics
+{
+  DOCUMENT("");
+  MeshStatistics() = default;
+  MeshStatistics(const MeshStatistics &) = default;
+  MeshStatistics &operator=(const MeshStatistics &) = default;
+
+  DOCUMENT(R"(The minimum value in each component, as a :class:`FloatVector`. If no values were read
+this will be larger than :data:`maximum`.
+)");
+  FloatVector minimum;
+  DOCUMENT("The maximum value in each component, as a :class:`FloatVector`.");
+  FloatVector maximum;
+  DOCUMENT("The average value in each component, as a :class:`FloatVector`.");
+  FloatVector average;
+  DOCUMENT("The number of vertices that were read, after skipping any primitive restart indices.");
+  uint32_t vertexCount = 0;
+  DOCUMENT("The number of component values that were skipped for being NaN or infinite.");
+  uint32_t nonFiniteCount = 0;
+};
+
+DECLARE_REFLECTION_STRUCT(MeshStatistics);
+
 struct ICamera;
 
 DOCUMENT(R"(
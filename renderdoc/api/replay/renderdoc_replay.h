@@ -888,6 +888,31 @@ completed, further calls will return an empty list.
 )");
   virtual rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger) = 0;
 
+  DOCUMENT(R"(Run a shader's debugging with a given shader debugger instance until it either finishes
+or reaches one of a set of instructions, without recording any of the intermediate states. This is
+much faster than repeatedly calling :meth:`ContinueDebug` when only the final values are needed, such
+as when comparing a shader's simulated outputs against the real results.
+
+The returned state is a snapshot rather than a delta like the states returned from
+:meth:`ContinueDebug`. Its list of changes contains every live variable with its current value in
+:data:`ShaderVariableChange.after`, and :data:`ShaderVariableChange.before` left empty. While running
+in this mode source variable mappings for function-local variables are not tracked.
+
+Debugging can be resumed afterwards with either this function or :meth:`ContinueDebug`. This will
+always perform at least one step, so calling it again while stopped at a breakpoint will continue on
+to the next breakpoint.
+
+:param ShaderDebugger debugger: The shader debugger to run.
+:param list breakpoints: A list of ``int`` instruction indices to stop before executing. If this is
+  empty the shader will run to completion. Source lines can be mapped to instructions using
+  :data:`ShaderDebugTrace.lineInfo`.
+:return: The state when execution stopped. If debugging had already completed, this state has no
+  changes.
+:rtype: ShaderDebugState
+)");
+  virtual ShaderDebugState RunDebug(ShaderDebugger *debugger,
+                                    const rdcarray<uint32_t> &breakpoints) = 0;
+
   DOCUMENT(R"(Free a debugging trace from running a shader invocation debug.
 
 :param ShaderDebugTrace trace: The shader debugging trace to free.
@@ -942,8 +967,28 @@ texture to something compatible with the target file format.
 )");
   virtual MeshFormat GetPostVSData(uint32_t instance, uint32_t view, MeshDataStage stage) = 0;
 
+  DOCUMENT(R"(Calculate the bounds and basic statistics for one or more mesh elements. These can be
+vertex inputs, or the outputs from :meth:`GetPostVSData` - for outputs other than the position
+:data:`MeshFormat.vertexByteOffset` and :data:`MeshFormat.format` should be adjusted to select the
+element.
+
+If the element is :data:`instanced <MeshFormat.instanced>` then only the single element at
+:data:`MeshFormat.vertexByteOffset` is read, otherwise :data:`MeshFormat.numIndices` vertices are
+read, using the index buffer if one is specified.
+
+Elements are processed in parallel, so it's more efficient to pass all elements of interest in one
+call than to make several calls.
+
+:param list streams: The list of :class:`MeshFormat` describing the elements to process.
+:return: The statistics for each element, in the same order as the input.
+:rtype: ``list`` of :class:`MeshStatistics`
+)");
+  virtual rdcarray<MeshStatistics> GetMeshStatistics(const rdcarray<MeshFormat> &streams) = 0;
+
   DOCUMENT(R"(Retrieve the contents of a range of a buffer as a ``bytes``.
 
+In python, :meth:`GetBufferDataView` returns the same data without copying it.
+
 :param ResourceId buff: The id of the buffer to retrieve data from.
 :param int offset: The byte offset to the start of the range.
 :param int len: The length of the range, or 0 to retrieve the rest of the bytes in the buffer.
@@ -954,6 +999,8 @@ texture to something compatible with the target file format.
 
   DOCUMENT(R"(Retrieve the contents of one subresource of a texture as a ``bytes``.
 
+In python, :meth:`GetTextureDataView` returns the same data without copying it.
+
 :param ResourceId tex: The id of the texture to retrieve data from.
 :param Subresource sub: The subresource within this texture to use.
 :return: The requested texture contents.
@@ -1907,6 +1954,23 @@ temporary name. This function wraps up the use of the in-application API to end
 )");
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_EndSelfHostCapture(const char *dllname);
 
+DOCUMENT(R"(Begin recording RenderDoc's internal profiling regions, to find where time is spent while
+replaying without an external profiler. Regions are recorded until :func:`EndProfiling` is called.
+
+Profiling regions are not available in stable release builds.
+)");
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_StartProfiling();
+
+DOCUMENT(R"(Stop recording profiling regions that were started with :func:`StartProfiling` and write
+them to a JSON file in the Chrome trace event format, which can be loaded into ``chrome://tracing``
+or Perfetto.
+
+:param str filename: The path to write the trace to.
+:return: ``True`` if the trace was written successfully, ``False`` if there was an error.
+:rtype: ``bool``
+)");
+extern "C" RENDERDOC_API bool RENDERDOC_CC RENDERDOC_EndProfiling(const rdcstr &filename);
+
 //////////////////////////////////////////////////////////////////////////
 // Vulkan layer handling
 //////////////////////////////////////////////////////////////////////////
@@ -1015,6 +1015,7 @@ rdcstr DoStringise(const SectionType &el)
     STRINGISE_ENUM_CLASS_NAMED(ExtendedThumbnail, "renderdoc/internal/exthumb");
     STRINGISE_ENUM_CLASS_NAMED(EmbeddedLogfile, "renderdoc/internal/logfile");
     STRINGISE_ENUM_CLASS_NAMED(EditedShaders, "renderdoc/ui/edits");
+    STRINGISE_ENUM_CLASS_NAMED(BufferStore, "renderdoc/internal/bufferstore");
   }
   END_ENUM_STRINGISE();
 }
@@ -98,6 +98,13 @@ version of RenderDoc that addes a new section type. They should be considered eq
   This section contains any edited shaders.
 
   The name for this section will be "renderdoc/ui/edits".
+
+.. data:: BufferStore
+
+  This section contains large buffers from the frame capture, such as resource initial contents,
+  stored once for each unique set of contents and referenced from the frame capture section.
+
+  The name for this section will be "renderdoc/internal/bufferstore".
 )");
 enum class SectionType : uint32_t
 {
@@ -112,6 +119,7 @@ enum class SectionType : uint32_t
   ExtendedThumbnail,
   EmbeddedLogfile,
   EditedShaders,
+  BufferStore,
   Count,
 };
 
@@ -0,0 +1,386 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "common/threading.h"
+#include "core/settings.h"
+
+RDOC_CONFIG(uint32_t, Threading_TaskPoolThreads, 0,
+            "The number of worker threads used for parallel work such as loading captures. If "
+            "set to 0, one less than the number of logical processors is used.");
+
+namespace Threading
+{
+struct Task
+{
+  TaskGroup *group = NULL;
+  std::function<void()> func;
+};
+
+// a simple locked deque. The owning worker pushes and pops at the back so it works on the most
+// recently added (and likely cache-hot) task first, while other threads take from the front so they
+// pick up the oldest and typically largest pieces of work.
+struct TaskQueue
+{
+  CriticalSection lock;
+  rdcarray<Task> tasks;
+  size_t head = 0;
+
+  void Push(Task &&task)
+  {
+    SCOPED_LOCK(lock);
+    tasks.push_back(std::move(task));
+  }
+
+  bool PopBack(Task &task)
+  {
+    SCOPED_LOCK(lock);
+    if(head == tasks.size())
+      return false;
+    task = std::move(tasks.back());
+    tasks.pop_back();
+    Compact();
+    return true;
+  }
+
+  bool PopFront(Task &task)
+  {
+    SCOPED_LOCK(lock);
+    if(head == tasks.size())
+      return false;
+    task = std::move(tasks[head]);
+    head++;
+    Compact();
+    return true;
+  }
+
+private:
+  void Compact()
+  {
+    if(head == tasks.size())
+    {
+      tasks.clear();
+      head = 0;
+    }
+    else if(head >= 64 && head * 2 >= tasks.size())
+    {
+      tasks.erase(0, head);
+      head = 0;
+    }
+  }
+};
+
+// thread-local worker index, stored +1 so that 0 identifies threads outside the pool
+static uint64_t workerTLSSlot = 0;
+
+class TaskPool
+{
+public:
+  TaskPool(uint32_t numThreads)
+  {
+    m_Queues.resize(numThreads);
+    for(uint32_t i = 0; i < numThreads; i++)
+      m_Queues[i] = new TaskQueue;
+
+    m_Threads.resize(numThreads);
+    for(uint32_t i = 0; i < numThreads; i++)
+      m_Threads[i] = CreateThread([this, i]() { WorkerMain(i); });
+  }
+
+  ~TaskPool()
+  {
+    Atomic::Inc32(&m_Shutdown);
+    m_Wake.Wake((uint32_t)m_Threads.size());
+
+    for(ThreadHandle t : m_Threads)
+    {
+      JoinThread(t);
+      CloseThread(t);
+    }
+
+    for(TaskQueue *q : m_Queues)
+      delete q;
+  }
+
+  uint32_t NumThreads() const { return (uint32_t)m_Threads.size(); }
+  void Submit(TaskGroup *group, std::function<void()> &&func)
+  {
+    Atomic::Inc32(&group->m_Pending);
+
+    Task task;
+    task.group = group;
+    task.func = std::move(func);
+
+    uint32_t idx = CurrentWorker();
+    if(idx < m_Queues.size())
+      m_Queues[idx]->Push(std::move(task));
+    else
+      m_Global.Push(std::move(task));
+
+    // the atomic is a full barrier so either a sleeping worker is counted here and gets woken, or
+    // it hasn't yet re-checked the queues and will see the task we just pushed.
+    if(Atomic::CmpExch32(&m_Sleeping, 0, 0) > 0)
+    {
+      m_Wake.Wake(1);
+    }
+    else if(Atomic::CmpExch32(&m_NumBlocked, 0, 0) > 0)
+    {
+      // every worker is busy, possibly blocked waiting on a group. Wake one blocked waiter so the
+      // task can't be stranded behind them.
+      SCOPED_LOCK(m_BlockedLock);
+      if(!m_Blocked.empty())
+        m_Blocked[0]->m_Wake.Wake(1);
+    }
+  }
+
+  // block the calling thread until the group finishes or new work is submitted. Returns
+  // immediately if either has already happened.
+  void Block(TaskGroup *group)
+  {
+    {
+      SCOPED_LOCK(m_BlockedLock);
+
+      // count ourselves before checking the group, so either the last task sees the count and
+      // takes the lock to wake us, or we see that it has already finished
+      Atomic::Inc32(&m_NumBlocked);
+      if(group->IsFinished())
+      {
+        Atomic::Dec32(&m_NumBlocked);
+        return;
+      }
+      m_Blocked.push_back(group);
+    }
+
+    // anything submitted before we were registered won't have woken us, so look once more
+    if(!RunOne())
+      group->m_Wake.WaitForWake();
+
+    {
+      SCOPED_LOCK(m_BlockedLock);
+      m_Blocked.removeOne(group);
+      Atomic::Dec32(&m_NumBlocked);
+    }
+  }
+
+  bool RunOne()
+  {
+    Task task;
+    if(!FindTask(CurrentWorker(), task))
+      return false;
+
+    Execute(task);
+    return true;
+  }
+
+private:
+  rdcarray<ThreadHandle> m_Threads;
+  rdcarray<TaskQueue *> m_Queues;
+  TaskQueue m_Global;
+  Semaphore m_Wake;
+  int32_t m_Sleeping = 0;
+  int32_t m_Shutdown = 0;
+
+  // groups with a thread blocked in Wait(). Only compared by pointer outside the lock, since a
+  // group can be destroyed as soon as its last task finishes.
+  CriticalSection m_BlockedLock;
+  rdcarray<TaskGroup *> m_Blocked;
+  int32_t m_NumBlocked = 0;
+
+  uint32_t CurrentWorker()
+  {
+    uintptr_t idx = (uintptr_t)GetTLSValue(workerTLSSlot);
+    // this must be a worker in this pool, since workers never outlive the pool that created them
+    return idx == 0 ? ~0U : uint32_t(idx - 1);
+  }
+
+  bool FindTask(uint32_t idx, Task &task)
+  {
+    const uint32_t numQueues = (uint32_t)m_Queues.size();
+
+    if(idx < numQueues && m_Queues[idx]->PopBack(task))
+      return true;
+
+    if(m_Global.PopFront(task))
+      return true;
+
+    // steal, starting from the next worker along so that thieves spread out
+    uint32_t start = idx < numQueues ? idx + 1 : 0;
+    for(uint32_t i = 0; i < numQueues; i++)
+    {
+      uint32_t victim = (start + i) % numQueues;
+      if(victim != idx && m_Queues[victim]->PopFront(task))
+        return true;
+    }
+
+    return false;
+  }
+
+  void Execute(Task &task)
+  {
+    TaskGroup *group = task.group;
+
+    if(!group->IsCancelled())
+      task.func();
+    task.func = std::function<void()>();
+
+    if(Atomic::Dec32(&group->m_Pending) == 0 && Atomic::CmpExch32(&m_NumBlocked, 0, 0) > 0)
+    {
+      // a waiter registers under the lock only if the group hasn't finished, so if it's in the list
+      // it's still alive. Wake every thread blocked on it
+      SCOPED_LOCK(m_BlockedLock);
+      for(TaskGroup *g : m_Blocked)
+        if(g == group)
+          group->m_Wake.Wake(1);
+    }
+  }
+
+  void WorkerMain(uint32_t idx)
+  {
+    SetTLSValue(workerTLSSlot, (void *)(uintptr_t)(idx + 1));
+    SetCurrentThreadName("RenderDoc task worker");
+
+    Task task;
+    for(;;)
+    {
+      if(FindTask(idx, task))
+      {
+        Execute(task);
+        continue;
+      }
+
+      Atomic::Inc32(&m_Sleeping);
+
+      // check again now that we're counted as sleeping, so a task submitted since the search above
+      // isn't missed
+      bool shutdown = Atomic::CmpExch32(&m_Shutdown, 0, 0) != 0;
+      bool found = !shutdown && FindTask(idx, task);
+
+      if(!shutdown && !found)
+        m_Wake.WaitForWake();
+
+      Atomic::Dec32(&m_Sleeping);
+
+      if(shutdown)
+        break;
+
+      if(found)
+        Execute(task);
+    }
+
+    SetTLSValue(workerTLSSlot, NULL);
+  }
+};
+
+static CriticalSection poolLock;
+static TaskPool *pool = NULL;
+
+static TaskPool *GetTaskPool()
+{
+  SCOPED_LOCK(poolLock);
+
+  if(!pool)
+  {
+    if(workerTLSSlot == 0)
+      workerTLSSlot = AllocateTLSSlot();
+
+    uint32_t numThreads = Threading_TaskPoolThreads();
+    if(numThreads == 0)
+      numThreads = RDCMAX(1U, NumberOfCores() - 1);
+
+    pool = new TaskPool(numThreads);
+  }
+
+  return pool;
+}
+
+void TaskGroup::Run(std::function<void()> task)
+{
+  GetTaskPool()->Submit(this, std::move(task));
+}
+
+void TaskGroup::Wait()
+{
+  if(IsFinished())
+    return;
+
+  TaskPool *p = GetTaskPool();
+
+  // help out while we wait. The tasks we run may belong to other groups, but either way it makes
+  // progress and means a task can wait on its own children without deadlocking the pool.
+  while(!IsFinished())
+  {
+    if(p->RunOne())
+      continue;
+
+    // the remaining tasks are running on other threads, so block until they finish or more work
+    // turns up that we can help with
+    p->Block(this);
+  }
+}
+
+void ParallelFor(TaskGroup &group, uint32_t begin, uint32_t end,
+                 std::function<void(uint32_t)> func, uint32_t batchSize)
+{
+  if(end <= begin)
+    return;
+
+  const uint32_t count = end - begin;
+
+  if(batchSize == 0)
+  {
+    // aim for a few batches per thread so that stealing can balance uneven work
+    uint32_t numBatches = (GetTaskPool()->NumThreads() + 1) * 4;
+    batchSize = RDCMAX(1U, (count + numBatches - 1) / numBatches);
+  }
+
+  for(uint32_t batch = begin; batch < end; batch += RDCMIN(batchSize, end - batch))
+  {
+    uint32_t batchEnd = batch + RDCMIN(batchSize, end - batch);
+    group.Run([&group, &func, batch, batchEnd]() {
+      for(uint32_t i = batch; i < batchEnd && !group.IsCancelled(); i++)
+        func(i);
+    });
+  }
+
+  group.Wait();
+}
+
+uint32_t TaskPoolThreadCount()
+{
+  return GetTaskPool()->NumThreads();
+}
+
+void ShutdownTaskPool()
+{
+  TaskPool *p = NULL;
+
+  {
+    SCOPED_LOCK(poolLock);
+    p = pool;
+    pool = NULL;
+  }
+
+  delete p;
+}
+};
@@ -110,6 +110,113 @@ public:
 private:
   SpinLock *m_Spin = NULL;
 };
+
+// A group of tasks run on the shared work-stealing task pool. Tasks can be added from any thread,
+// including from inside other tasks, and Wait() runs pending tasks on the calling thread instead of
+// just blocking, so it's safe to wait on a group from within a task.
+class TaskGroup
+{
+public:
+  TaskGroup() = default;
+  ~TaskGroup() { Wait(); }
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  void Run(std::function<void()> task);
+  void Wait();
+  bool IsFinished() { return Atomic::CmpExch32(&m_Pending, 0, 0) == 0; }
+  // tasks in the group that haven't started yet will be skipped. Running tasks aren't interrupted
+  // but can check IsCancelled() to finish early.
+  void Cancel() { Atomic::CmpExch32(&m_Cancelled, 0, 1); }
+  bool IsCancelled() { return Atomic::CmpExch32(&m_Cancelled, 0, 0) != 0; }
+private:
+  friend class TaskPool;
+
+  int32_t m_Pending = 0;
+  int32_t m_Cancelled = 0;
+  // woken when the group finishes or new work is submitted while a waiter is blocked on it
+  Semaphore m_Wake;
+};
+
+// The result of a single task run on the pool. Get() waits for the result, running other tasks in
+// the meantime. If the task is cancelled before it starts, the result is default-constructed.
+// Destroying the future waits for the task, since it writes to storage owned by the future.
+template <typename T>
+class Future
+{
+public:
+  Future() = default;
+  explicit Future(std::function<T()> func) : m_State(new State)
+  {
+    State *state = m_State;
+    state->group.Run([state, func]() { state->result = func(); });
+  }
+  Future(Future &&o) : m_State(o.m_State) { o.m_State = NULL; }
+  Future &operator=(Future &&o)
+  {
+    Reset();
+    m_State = o.m_State;
+    o.m_State = NULL;
+    return *this;
+  }
+  Future(const Future &) = delete;
+  Future &operator=(const Future &) = delete;
+  ~Future() { Reset(); }
+  bool IsValid() const { return m_State != NULL; }
+  bool IsReady() { return m_State && m_State->group.IsFinished(); }
+  void Cancel()
+  {
+    if(m_State)
+      m_State->group.Cancel();
+  }
+  T &Get()
+  {
+    m_State->group.Wait();
+    return m_State->result;
+  }
+
+private:
+  struct State
+  {
+    TaskGroup group;
+    T result = T();
+  };
+
+  State *m_State = NULL;
+
+  void Reset()
+  {
+    // the task writes into the state, so it must finish before the state is freed
+    if(m_State)
+      m_State->group.Wait();
+    delete m_State;
+    m_State = NULL;
+  }
+};
+
+template <typename Func>
+Future<decltype(std::declval<Func>()())> Async(Func func)
+{
+  return Future<decltype(std::declval<Func>()())>(func);
+}
+
+// calls func(i) for every i in [begin, end), in batches spread across the task pool, and returns
+// once every call has finished. If batchSize is 0 a size is picked to give each thread several
+// batches. Cancelling the group skips any batches that haven't started.
+void ParallelFor(TaskGroup &group, uint32_t begin, uint32_t end,
+                 std::function<void(uint32_t)> func, uint32_t batchSize = 0);
+inline void ParallelFor(uint32_t begin, uint32_t end, std::function<void(uint32_t)> func,
+                        uint32_t batchSize = 0)
+{
+  TaskGroup group;
+  ParallelFor(group, begin, end, func, batchSize);
+}
+
+// the number of worker threads in the task pool, starting it if necessary
+uint32_t TaskPoolThreadCount();
+// stop the task pool's worker threads. It will start again on next use, picking up any change to
+// the configured thread count.
+void ShutdownTaskPool();
 };
 
 #define SCOPED_LOCK(cs) Threading::ScopedLock CONCAT(scopedlock, __LINE__)(&cs);
@@ -71,4 +71,132 @@ TEST_CASE("Test spin lock", "[threading]")
   CHECK(finalValue == value);
 }
 
+TEST_CASE("Test task pool", "[threading]")
+{
+  REQUIRE(Threading::TaskPoolThreadCount() >= 1);
+
+  SECTION("Task group runs every task")
+  {
+    int32_t count = 0;
+
+    {
+      Threading::TaskGroup group;
+      for(int i = 0; i < 1000; i++)
+        group.Run([&count]() { Atomic::Inc32(&count); });
+      group.Wait();
+
+      CHECK(group.IsFinished());
+    }
+
+    CHECK(count == 1000);
+  };
+
+  SECTION("Parallel for visits each index once")
+  {
+    rdcarray<int32_t> visited;
+    visited.resize(10000);
+
+    Threading::ParallelFor(0, (uint32_t)visited.size(),
+                           [&visited](uint32_t i) { Atomic::Inc32(&visited[i]); });
+
+    bool allOnce = true;
+    for(int32_t v : visited)
+      allOnce &= (v == 1);
+    CHECK(allOnce);
+
+    // empty and single-element ranges, and explicit batch sizes
+    int32_t count = 0;
+    Threading::ParallelFor(5, 5, [&count](uint32_t) { Atomic::Inc32(&count); });
+    CHECK(count == 0);
+    Threading::ParallelFor(5, 6, [&count](uint32_t) { Atomic::Inc32(&count); });
+    CHECK(count == 1);
+    Threading::ParallelFor(0, 1001, [&count](uint32_t) { Atomic::Inc32(&count); }, 7);
+    CHECK(count == 1002);
+  };
+
+  SECTION("Nested parallel for")
+  {
+    int64_t sum = 0;
+
+    Threading::ParallelFor(0, 64, [&sum](uint32_t outer) {
+      Threading::ParallelFor(0, 256, [&sum, outer](uint32_t inner) {
+        Atomic::ExchAdd64(&sum, int64_t(outer * 256 + inner));
+      });
+    });
+
+    const int64_t n = 64 * 256;
+    CHECK(sum == n * (n - 1) / 2);
+  };
+
+  SECTION("Futures")
+  {
+    Threading::Future<int> a = Threading::Async([]() { return 6; });
+    Threading::Future<int> b = Threading::Async([]() { return 7; });
+    Threading::Future<rdcstr> c = Threading::Async([]() { return rdcstr("hello"); });
+
+    CHECK(a.Get() * b.Get() == 42);
+    CHECK(c.Get() == "hello");
+    CHECK(a.IsReady());
+
+    Threading::Future<int> moved = std::move(a);
+    CHECK_FALSE(a.IsValid());
+    CHECK(moved.Get() == 6);
+
+    // dropping a future without getting its result must wait for the task to finish writing it
+    int32_t finished = 0;
+    {
+      Threading::Future<rdcstr> dropped = Threading::Async([&finished]() {
+        Threading::Sleep(20);
+        Atomic::Inc32(&finished);
+        return rdcstr("a string long enough to need its own allocation");
+      });
+    }
+    CHECK(finished == 1);
+  };
+
+  SECTION("Cancellation")
+  {
+    int32_t started = 0;
+    int32_t release = 0;
+
+    Threading::TaskGroup group;
+
+    // hold every worker so nothing else gets picked up until we've cancelled
+    const uint32_t numThreads = Threading::TaskPoolThreadCount();
+    for(uint32_t i = 0; i < numThreads; i++)
+    {
+      group.Run([&started, &release]() {
+        Atomic::Inc32(&started);
+        while(Atomic::CmpExch32(&release, 0, 0) == 0)
+          Threading::Sleep(0);
+      });
+    }
+
+    while(Atomic::CmpExch32(&started, 0, 0) < (int32_t)numThreads)
+      Threading::Sleep(0);
+
+    int32_t skipped = 0;
+    for(int i = 0; i < 100; i++)
+      group.Run([&skipped]() { Atomic::Inc32(&skipped); });
+
+    group.Cancel();
+    CHECK(group.IsCancelled());
+    Atomic::Inc32(&release);
+
+    group.Wait();
+
+    CHECK(started == (int32_t)numThreads);
+    CHECK(skipped == 0);
+  };
+
+  SECTION("Pool can be restarted")
+  {
+    Threading::ShutdownTaskPool();
+
+    int32_t count = 0;
+    Threading::ParallelFor(0, 100, [&count](uint32_t) { Atomic::Inc32(&count); });
+    CHECK(count == 100);
+  };
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
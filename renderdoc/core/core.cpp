@@ -29,6 +29,7 @@
 #include "api/replay/version.h"
 #include "common/common.h"
 #include "common/threading.h"
+#include "core/profiler.h"
 #include "core/settings.h"
 #include "hooks/hooks.h"
 #include "maths/formatpacking.h"
@@ -49,6 +50,16 @@
 RDOC_DEBUG_CONFIG(bool, Capture_Debug_SnapshotDiagnosticLog, false,
                   "Snapshot the diagnostic log at capture time and embed in the capture.");
 
+RDOC_CONFIG(bool, Capture_BackgroundFileWriting, false,
+            "Buffer each capture in memory and compress and write it to disk on a background "
+            "thread, so the application can continue as soon as the frame has been serialised.");
+
+RDOC_CONFIG(uint32_t, Capture_BackgroundFileWritingMemoryLimitMB, 1024,
+            "The amount of memory in MB that captures waiting to be written in the background can "
+            "use. When more than this is outstanding, new captures will wait for earlier writes "
+            "to finish before starting, and a capture that needs more than is left is written "
+            "directly instead of being buffered.");
+
 void LogReplayOptions(const ReplayOptions &opts)
 {
   RDCLOG("%s API validation during replay", (opts.apiValidation ? "Enabling" : "Not enabling"));
@@ -358,6 +369,8 @@ void RenderDoc::Initialise()
   Superluminal::Init();
 #endif
 
+  Profiler::Init();
+
   m_RemoteIdent = 0;
   m_RemoteThread = 0;
 
@@ -488,6 +501,31 @@ RenderDoc::~RenderDoc()
     (*it)();
   m_ShutdownFunctions.clear();
 
+  // stop the writer thread once it's finished the capture it's writing, then write anything left
+  // over here so no capture is left incomplete.
+  {
+    SCOPED_LOCK(m_CaptureWriteLock);
+    m_CaptureWriterShutdown = true;
+  }
+
+  if(m_CaptureWriterThread)
+  {
+    Threading::JoinThread(m_CaptureWriterThread);
+    Threading::CloseThread(m_CaptureWriterThread);
+    m_CaptureWriterThread = 0;
+  }
+
+  if(!m_PendingCaptureWrites.empty())
+    RDCLOG("Finishing writing %u captures at shutdown", (uint32_t)m_PendingCaptureWrites.size());
+
+  for(PendingCaptureWrite &write : m_PendingCaptureWrites)
+  {
+    write.rdc->FlushDeferredSections(RENDERDOC_ProgressCallback());
+    CompleteCaptureFile(write.rdc, write.frameNumber);
+  }
+  m_PendingCaptureWrites.clear();
+  m_PendingCaptureWriteBytes = 0;
+
   for(size_t i = 0; i < m_Captures.size(); i++)
   {
     if(m_Captures[i].retrieved)
@@ -521,6 +559,10 @@ RenderDoc::~RenderDoc()
 
   Network::Shutdown();
 
+  Threading::ShutdownTaskPool();
+
+  Profiler::Shutdown();
+
   Threading::Shutdown();
 
   StringFormat::Shutdown();
@@ -679,6 +721,8 @@ void RenderDoc::ShutdownReplay()
   for(auto it = m_ShutdownFunctions.begin(); it != m_ShutdownFunctions.end(); ++it)
     (*it)();
   m_ShutdownFunctions.clear();
+
+  Threading::ShutdownTaskPool();
 }
 
 void RenderDoc::RegisterShutdownFunction(ShutdownFunction func)
@@ -1187,13 +1231,27 @@ RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePi
 
   m_CurrentLogFile = StringFormat::Fmt("%s%s.rdc", m_CaptureFileTemplate.c_str(), suffix.c_str());
 
+  const bool backgroundWrite = Capture_BackgroundFileWriting();
+  const uint64_t backgroundWriteLimit =
+      uint64_t(Capture_BackgroundFileWritingMemoryLimitMB()) * 1024 * 1024;
+
+  // if previous captures are still being written and using too much memory, wait for them to catch
+  // up before serialising another one.
+  if(backgroundWrite)
+    WaitForCaptureWriting(backgroundWriteLimit);
+
   // make sure we don't stomp another capture if we make multiple captures in the same frame.
   {
     SCOPED_LOCK(m_CaptureLock);
+    SCOPED_LOCK(m_CaptureWriteLock);
     int altnum = 2;
-    while(std::find_if(m_Captures.begin(), m_Captures.end(), [this](const CaptureData &o) {
-            return o.path == m_CurrentLogFile;
-          }) != m_Captures.end())
+    while(std::find_if(m_Captures.begin(), m_Captures.end(),
+                       [this](const CaptureData &o) { return o.path == m_CurrentLogFile; }) !=
+              m_Captures.end() ||
+          std::find_if(m_PendingCaptureWrites.begin(), m_PendingCaptureWrites.end(),
+                       [this](const PendingCaptureWrite &o) {
+                         return o.rdc->GetFilename() == m_CurrentLogFile;
+                       }) != m_PendingCaptureWrites.end())
     {
       m_CurrentLogFile =
           StringFormat::Fmt("%s%s_%d.rdc", m_CaptureFileTemplate.c_str(), suffix.c_str(), altnum);
@@ -1221,6 +1279,19 @@ RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePi
     RDCERR("Error creating RDC at '%s'", m_CurrentLogFile.c_str());
     SAFE_DELETE(ret);
   }
+  else if(backgroundWrite)
+  {
+    // this capture can buffer whatever the limit leaves after those still queued. If it needs more
+    // than that, the RDC writes out what it has and the rest of the capture is written directly.
+    uint64_t pending = 0;
+    {
+      SCOPED_LOCK(m_CaptureWriteLock);
+      pending = m_PendingCaptureWriteBytes;
+    }
+
+    ret->SetDeferredWriting(true,
+                            pending < backgroundWriteLimit ? backgroundWriteLimit - pending : 0);
+  }
 
   return ret;
 }
@@ -1651,29 +1722,137 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
 {
   RenderDoc::Inst().SetProgress(CaptureProgress::FileWriting, 0.0f);
 
+  // the frame capture section is complete, so any buffers it referenced can be written
   if(rdc)
+    rdc->WriteBufferStore();
+
+  // add the resolve database if we were capturing callstacks. The modules are listed now rather
+  // than when the file is written, since they could be unloaded by then.
+  if(rdc && m_Options.captureCallstacks)
+  {
+    SectionProperties props = {};
+    props.type = SectionType::ResolveDatabase;
+    props.version = 1;
+    StreamWriter *w = rdc->WriteSection(props);
+
+    size_t sz = 0;
+    Callstack::GetLoadedModules(NULL, sz);
+
+    byte *buf = new byte[sz];
+    Callstack::GetLoadedModules(buf, sz);
+
+    w->Write(buf, sz);
+
+    w->Finish();
+
+    delete w;
+    delete[] buf;
+  }
+
+  uint64_t deferredSize = rdc ? rdc->GetDeferredSize() : 0;
+
+  if(deferredSize > 0)
   {
-    // add the resolve database if we were capturing callstacks.
-    if(m_Options.captureCallstacks)
+    RDCLOG("Queueing %.2f MB capture to be written in the background: %s",
+           double(deferredSize) / (1024.0 * 1024.0), rdc->GetFilename().c_str());
+
+    SCOPED_LOCK(m_CaptureWriteLock);
+
+    // the writer thread takes ownership of the RDC and its buffered sections from here on
+    m_PendingCaptureWrites.push_back({rdc, frameNumber, deferredSize});
+    m_PendingCaptureWriteBytes += deferredSize;
+
+    if(!m_CaptureWriterRunning)
     {
-      SectionProperties props = {};
-      props.type = SectionType::ResolveDatabase;
-      props.version = 1;
-      StreamWriter *w = rdc->WriteSection(props);
+      if(m_CaptureWriterThread)
+      {
+        Threading::JoinThread(m_CaptureWriterThread);
+        Threading::CloseThread(m_CaptureWriterThread);
+      }
 
-      size_t sz = 0;
-      Callstack::GetLoadedModules(NULL, sz);
+      m_CaptureWriterRunning = true;
+      m_CaptureWriterThread = Threading::CreateThread([this]() { CaptureWriterThread(); });
+    }
 
-      byte *buf = new byte[sz];
-      Callstack::GetLoadedModules(buf, sz);
+    return;
+  }
 
-      w->Write(buf, sz);
+  // nothing was buffered, so write any remaining sections directly
+  if(rdc)
+    rdc->FlushDeferredSections(RENDERDOC_ProgressCallback());
 
-      w->Finish();
+  CompleteCaptureFile(rdc, frameNumber);
 
-      delete w;
+  RenderDoc::Inst().SetProgress(CaptureProgress::FileWriting, 1.0f);
+}
+
+void RenderDoc::CaptureWriterThread()
+{
+  Threading::SetCurrentThreadName("Capture file writer");
+
+  for(;;)
+  {
+    PendingCaptureWrite write;
+
+    {
+      SCOPED_LOCK(m_CaptureWriteLock);
+      if(m_PendingCaptureWrites.empty() || m_CaptureWriterShutdown)
+      {
+        m_CaptureWriterRunning = false;
+        return;
+      }
+
+      write = m_PendingCaptureWrites[0];
+    }
+
+    write.rdc->FlushDeferredSections([](float progress) {
+      // leave a little room at the end for the extra sections and finalising
+      RenderDoc::Inst().SetProgress(CaptureProgress::FileWriting, progress * 0.99f);
+    });
+
+    CompleteCaptureFile(write.rdc, write.frameNumber);
+
+    {
+      SCOPED_LOCK(m_CaptureWriteLock);
+      m_PendingCaptureWrites.erase(0);
+      m_PendingCaptureWriteBytes -= write.size;
     }
 
+    RenderDoc::Inst().SetProgress(CaptureProgress::FileWriting, 1.0f);
+  }
+}
+
+void RenderDoc::WaitForCaptureWriting()
+{
+  WaitForCaptureWriting(0);
+}
+
+void RenderDoc::WaitForCaptureWriting(uint64_t maxPendingBytes)
+{
+  bool logged = false;
+
+  for(;;)
+  {
+    {
+      SCOPED_LOCK(m_CaptureWriteLock);
+      if(m_PendingCaptureWrites.empty() || m_PendingCaptureWriteBytes < maxPendingBytes)
+        return;
+
+      if(!logged)
+        RDCLOG("Waiting for %u captures (%.2f MB) to finish writing",
+               (uint32_t)m_PendingCaptureWrites.size(),
+               double(m_PendingCaptureWriteBytes) / (1024.0 * 1024.0));
+      logged = true;
+    }
+
+    Threading::Sleep(5);
+  }
+}
+
+void RenderDoc::CompleteCaptureFile(RDCFile *rdc, uint32_t frameNumber)
+{
+  if(rdc)
+  {
     const RDCThumb &thumb = rdc->GetThumbnail();
     if(thumb.format != FileType::JPG && thumb.width > 0 && thumb.height > 0)
     {
@@ -1715,9 +1894,9 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
       delete w;
     }
 
-    RDCLOG("Written to disk: %s", m_CurrentLogFile.c_str());
+    RDCLOG("Written to disk: %s", rdc->GetFilename().c_str());
 
-    CaptureData cap(m_CurrentLogFile, Timing::GetUnixTimestamp(), rdc->GetDriver(), frameNumber);
+    CaptureData cap(rdc->GetFilename(), Timing::GetUnixTimestamp(), rdc->GetDriver(), frameNumber);
     {
       SCOPED_LOCK(m_CaptureLock);
       m_Captures.push_back(cap);
@@ -1729,8 +1908,6 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
   {
     RDCLOG("Discarded capture, Frame %u", frameNumber);
   }
-
-  RenderDoc::Inst().SetProgress(CaptureProgress::FileWriting, 1.0f);
 }
 
 void RenderDoc::AddChildProcess(uint32_t pid, uint32_t ident)
@@ -1814,6 +1991,9 @@ void RenderDoc::RemoveDeviceFrameCapturer(void *dev)
   RDCLOG("Removing device frame capturer for %#p", dev);
 
   m_DeviceFrameCapturers.erase(dev);
+
+  // don't let the application tear down with captures still in flight
+  WaitForCaptureWriting();
 }
 
 void RenderDoc::AddFrameCapturer(void *dev, void *wnd, IFrameCapturer *cap)
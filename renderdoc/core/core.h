@@ -443,6 +443,7 @@ public:
   void EncodePixelsPNG(const RDCThumb &in, RDCThumb &out);
   RDCFile *CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePixels &fp);
   void FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber);
+  void WaitForCaptureWriting();
 
   void AddChildProcess(uint32_t pid, uint32_t ident);
   rdcarray<rdcpair<uint32_t, uint32_t>> GetChildProcesses();
@@ -625,6 +626,25 @@ private:
   Threading::CriticalSection m_CaptureLock;
   rdcarray<CaptureData> m_Captures;
 
+  struct PendingCaptureWrite
+  {
+    RDCFile *rdc;
+    uint32_t frameNumber;
+    uint64_t size;
+  };
+
+  // captures that have been serialised into memory and are waiting to be written to disk
+  Threading::CriticalSection m_CaptureWriteLock;
+  rdcarray<PendingCaptureWrite> m_PendingCaptureWrites;
+  uint64_t m_PendingCaptureWriteBytes = 0;
+  bool m_CaptureWriterRunning = false;
+  bool m_CaptureWriterShutdown = false;
+  Threading::ThreadHandle m_CaptureWriterThread = 0;
+
+  void CompleteCaptureFile(RDCFile *rdc, uint32_t frameNumber);
+  void CaptureWriterThread();
+  void WaitForCaptureWriting(uint64_t maxPendingBytes);
+
   Threading::CriticalSection m_ChildLock;
   rdcarray<rdcpair<uint32_t, uint32_t>> m_Children;
   rdcarray<rdcpair<uint32_t, Threading::ThreadHandle>> m_ChildThreads;
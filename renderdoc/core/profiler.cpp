@@ -0,0 +1,423 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "profiler.h"
+#include <map>
+#include "common/common.h"
+#include "common/formatting.h"
+#include "common/threading.h"
+#include "core/settings.h"
+#include "strings/string_utils.h"
+
+RDOC_CONFIG(uint32_t, Profiler_EventsPerThread, 256 * 1024,
+            "The number of profile region events kept for each thread while profiling. Once this "
+            "many are recorded the oldest are overwritten. Rounded up to a power of two.");
+
+namespace Profiler
+{
+static const uint32_t EndEventFlag = 0x80000000U;
+
+struct Event
+{
+  uint64_t tick;
+  // index into the thread's name table, with EndEventFlag set for end events
+  uint32_t name;
+  uint32_t padding;
+};
+
+// only the owning thread writes events or names, and only while it has the buffer marked busy.
+// Start() and Stop() clear the active flag and wait for each buffer to be idle before reading or
+// releasing it, so the events and names never need a lock.
+struct ThreadBuffer
+{
+  uint64_t threadID = 0;
+
+  int32_t busy = 0;
+
+  rdcarray<Event> events;
+  uint64_t mask = 0;
+  uint64_t writeIdx = 0;
+
+  // names are de-duplicated per thread so events stay small
+  rdcarray<rdcstr> names;
+  std::map<uint32_t, rdcarray<uint32_t>> nameLookup;
+
+  uint32_t GetName(const rdcstr &name)
+  {
+    rdcarray<uint32_t> &candidates = nameLookup[strhash(name.c_str())];
+
+    for(uint32_t idx : candidates)
+      if(names[idx] == name)
+        return idx;
+
+    candidates.push_back((uint32_t)names.size());
+    names.push_back(name);
+    return candidates.back();
+  }
+
+  void Record(uint32_t name)
+  {
+    Event &ev = events[size_t(writeIdx & mask)];
+    ev.tick = Timing::GetTick();
+    ev.name = name;
+    writeIdx++;
+  }
+
+  void WaitIdle()
+  {
+    while(Atomic::CmpExch32(&busy, 0, 0) != 0)
+      Threading::Sleep(0);
+  }
+
+  // the ring is only allocated while profiling, so threads that have since exited only keep this
+  // header around.
+  void Release()
+  {
+    events = rdcarray<Event>();
+    names.clear();
+    nameLookup.clear();
+    writeIdx = 0;
+  }
+};
+
+static uint64_t bufferTLSSlot = 0;
+static Threading::CriticalSection bufferLock;
+static rdcarray<ThreadBuffer *> buffers;
+
+static int32_t active = 0;
+static uint64_t startTick = 0;
+
+static ThreadBuffer *GetThreadBuffer()
+{
+  ThreadBuffer *buf = (ThreadBuffer *)Threading::GetTLSValue(bufferTLSSlot);
+
+  if(buf)
+    return buf;
+
+  buf = new ThreadBuffer;
+  buf->threadID = Threading::GetCurrentID();
+
+  Threading::SetTLSValue(bufferTLSSlot, buf);
+
+  SCOPED_LOCK(bufferLock);
+  buffers.push_back(buf);
+
+  return buf;
+}
+
+// marks this thread's buffer as busy, returns NULL if profiling isn't active. The flag is set
+// before checking active, so Stop() either sees the buffer busy or this thread sees it inactive.
+static ThreadBuffer *BeginWrite()
+{
+  if(!IsActive())
+    return NULL;
+
+  ThreadBuffer *buf = GetThreadBuffer();
+
+  Atomic::CmpExch32(&buf->busy, 0, 1);
+
+  if(!IsActive())
+  {
+    Atomic::CmpExch32(&buf->busy, 1, 0);
+    return NULL;
+  }
+
+  if(buf->events.empty())
+  {
+    uint64_t size = 1;
+    while(size < RDCMAX(1024U, Profiler_EventsPerThread()))
+      size <<= 1;
+
+    buf->events.resize((size_t)size);
+    buf->mask = size - 1;
+  }
+
+  return buf;
+}
+
+static void EndWrite(ThreadBuffer *buf)
+{
+  Atomic::CmpExch32(&buf->busy, 1, 0);
+}
+
+void Init()
+{
+  bufferTLSSlot = Threading::AllocateTLSSlot();
+}
+
+void Shutdown()
+{
+  Atomic::CmpExch32(&active, 1, 0);
+
+  SCOPED_LOCK(bufferLock);
+  for(ThreadBuffer *buf : buffers)
+  {
+    buf->WaitIdle();
+    delete buf;
+  }
+  buffers.clear();
+}
+
+void Start()
+{
+  Atomic::CmpExch32(&active, 1, 0);
+
+  {
+    SCOPED_LOCK(bufferLock);
+    for(ThreadBuffer *buf : buffers)
+    {
+      buf->WaitIdle();
+      buf->Release();
+    }
+  }
+
+  startTick = Timing::GetTick();
+  Atomic::CmpExch32(&active, 0, 1);
+}
+
+bool IsActive()
+{
+  return Atomic::CmpExch32(&active, 0, 0) != 0;
+}
+
+void BeginRegion(const rdcstr &name)
+{
+  ThreadBuffer *buf = BeginWrite();
+  if(!buf)
+    return;
+
+  buf->Record(buf->GetName(name));
+  EndWrite(buf);
+}
+
+void EndRegion()
+{
+  ThreadBuffer *buf = BeginWrite();
+  if(!buf)
+    return;
+
+  buf->Record(EndEventFlag);
+  EndWrite(buf);
+}
+
+static void AppendEscaped(rdcstr &json, const rdcstr &str)
+{
+  for(char c : str)
+  {
+    if(c == '"' || c == '\\')
+    {
+      json.push_back('\\');
+      json.push_back(c);
+    }
+    else if((unsigned char)c < 0x20)
+    {
+      json += StringFormat::Fmt("\\u%04x", (uint32_t)c);
+    }
+    else
+    {
+      json.push_back(c);
+    }
+  }
+}
+
+rdcstr Stop()
+{
+  Atomic::CmpExch32(&active, 1, 0);
+
+  const uint64_t stopTick = Timing::GetTick();
+  // ticks are in units of 1/frequency milliseconds, trace timestamps are in microseconds
+  const double usPerTick = 1000.0 / Timing::GetTickFrequency();
+
+  rdcstr json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+
+  const uint32_t pid = Process::GetCurrentPID();
+
+  SCOPED_LOCK(bufferLock);
+
+  for(ThreadBuffer *buf : buffers)
+  {
+    buf->WaitIdle();
+
+    const uint64_t capacity = buf->mask + 1;
+
+    uint64_t end = buf->writeIdx;
+    uint64_t begin = end > capacity ? end - capacity : 0;
+
+    rdcarray<Event> events;
+    events.reserve(size_t(end - begin));
+    for(uint64_t i = begin; i < end; i++)
+      events.push_back(buf->events[size_t(i & buf->mask)]);
+
+    const rdcarray<rdcstr> &names = buf->names;
+
+    // match begins with ends to produce complete events. Ends without a begin started before the
+    // ring buffer's window or before profiling started, so are skipped. Regions still open are
+    // closed at the stop time.
+    rdcarray<const Event *> stack;
+
+    auto emit = [&](const Event *ev, uint64_t endTick) {
+      if(ev->tick < startTick || ev->name >= names.size())
+        return;
+
+      if(!first)
+        json += ",\n";
+      first = false;
+
+      json += "{\"name\":\"";
+      AppendEscaped(json, names[ev->name]);
+      json += StringFormat::Fmt("\",\"ph\":\"X\",\"pid\":%u,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f}",
+                                pid, buf->threadID, double(ev->tick - startTick) * usPerTick,
+                                double(endTick - ev->tick) * usPerTick);
+    };
+
+    for(const Event &ev : events)
+    {
+      if(ev.name & EndEventFlag)
+      {
+        if(!stack.empty())
+        {
+          emit(stack.back(), ev.tick);
+          stack.pop_back();
+        }
+      }
+      else
+      {
+        stack.push_back(&ev);
+      }
+    }
+
+    for(const Event *ev : stack)
+      emit(ev, stopTick);
+
+    buf->Release();
+  }
+
+  json += "\n]}\n";
+
+  return json;
+}
+};
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Check profiler region recording", "[profiler]")
+{
+  SECTION("Nested regions")
+  {
+    Profiler::Start();
+    CHECK(Profiler::IsActive());
+
+    Profiler::BeginRegion("outer");
+    Profiler::BeginRegion("inner \"quoted\"");
+    Profiler::EndRegion();
+    Profiler::BeginRegion("inner");
+    Profiler::EndRegion();
+    Profiler::EndRegion();
+    Profiler::BeginRegion("unclosed");
+
+    rdcstr json = Profiler::Stop();
+    CHECK_FALSE(Profiler::IsActive());
+
+    CHECK(json.beginsWith("{"));
+    CHECK(json.contains("\"name\":\"outer\""));
+    CHECK(json.contains("\"name\":\"inner\""));
+    CHECK(json.contains("\"name\":\"inner \\\"quoted\\\"\""));
+    CHECK(json.contains("\"name\":\"unclosed\""));
+
+    // nothing is recorded while inactive
+    Profiler::BeginRegion("inactive");
+    Profiler::EndRegion();
+
+    Profiler::Start();
+    json = Profiler::Stop();
+    CHECK_FALSE(json.contains("inactive"));
+    CHECK_FALSE(json.contains("outer"));
+  };
+
+  SECTION("Restarting discards previous events")
+  {
+    Profiler::Start();
+    Profiler::BeginRegion("before restart");
+    Profiler::EndRegion();
+
+    Profiler::Start();
+    Profiler::BeginRegion("after restart");
+    Profiler::EndRegion();
+
+    rdcstr json = Profiler::Stop();
+    CHECK(json.contains("after restart"));
+    CHECK_FALSE(json.contains("before restart"));
+  };
+
+  SECTION("Ring buffer wrapping")
+  {
+    Profiler::Start();
+
+    // an end whose begin has been overwritten should be skipped, not mismatched
+    Profiler::BeginRegion("oldest");
+    for(uint32_t i = 0; i < Profiler_EventsPerThread() + 10; i++)
+    {
+      Profiler::BeginRegion("repeated");
+      Profiler::EndRegion();
+    }
+    Profiler::EndRegion();
+
+    rdcstr json = Profiler::Stop();
+    CHECK(json.contains("repeated"));
+    CHECK_FALSE(json.contains("oldest"));
+  };
+
+  SECTION("Multiple threads")
+  {
+    Profiler::Start();
+
+    rdcarray<Threading::ThreadHandle> threads;
+    for(int i = 0; i < 4; i++)
+    {
+      threads.push_back(Threading::CreateThread([i]() {
+        for(int r = 0; r < 100; r++)
+        {
+          Profiler::BeginRegion(StringFormat::Fmt("thread%d", i));
+          Profiler::EndRegion();
+        }
+      }));
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    rdcstr json = Profiler::Stop();
+    for(int i = 0; i < 4; i++)
+      CHECK(json.contains(StringFormat::Fmt("thread%d", i)));
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,47 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+#include "api/replay/rdcstr.h"
+
+// A minimal built-in profiler for RENDERDOC_PROFILEREGION. Each thread records its regions into its
+// own fixed-size ring buffer without locking, so when the buffer wraps the oldest regions are lost.
+// The recorded regions can be written out as JSON in the Chrome trace event format, which can be
+// loaded in chrome://tracing or Perfetto.
+namespace Profiler
+{
+void Init();
+void Shutdown();
+
+// begin recording. Only regions that begin after this point are included in the trace.
+void Start();
+// stop recording, returns the regions recorded since Start() as a chrome trace JSON string
+rdcstr Stop();
+bool IsActive();
+
+void BeginRegion(const rdcstr &name);
+void EndRegion();
+};
@@ -41,6 +41,11 @@
 RDOC_CONFIG(uint32_t, RemoteServer_TimeoutMS, 5000,
             "Timeout in milliseconds for remote server operations.");
 
+RDOC_CONFIG(bool, RemoteServer_CompressCaptureCopies, true,
+            "Compress captures while copying them to and from a remote server or a remotely "
+            "running application. This is much faster over slow links such as USB to Android "
+            "devices.");
+
 RDOC_CONFIG(bool, RemoteServer_DebugLogging, false,
             "Output a verbose logging file in the system's temporary folder containing the "
             "traffic to and from the remote server.");
@@ -374,10 +379,12 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
     else if(type == eRemoteServer_CopyCaptureFromRemote)
     {
       rdcstr path;
+      bool compress = false;
 
       {
         READ_DATA_SCOPE();
         SERIALISE_ELEMENT(path);
+        SERIALISE_ELEMENT(compress);
       }
 
       reader.EndChunk();
@@ -387,7 +394,10 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
         SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureFromRemote);
 
         StreamReader fileStream(FileIO::fopen(path.c_str(), "rb"));
-        ser.SerialiseStream(path, fileStream);
+        if(compress)
+          ser.SerialiseCompressedStream(path, fileStream, NULL);
+        else
+          ser.SerialiseStream(path, fileStream);
       }
     }
     else if(type == eRemoteServer_CopyCaptureToRemote)
@@ -400,12 +410,22 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
 
       FileIO::CreateParentDirectory(path);
 
+      bool fileErrored = false;
+
       {
         READ_DATA_SCOPE();
 
+        bool compress = false;
+        SERIALISE_ELEMENT(compress);
+
         StreamWriter streamWriter(FileIO::fopen(path.c_str(), "wb"), Ownership::Stream);
 
-        ser.SerialiseStream(path.c_str(), streamWriter, NULL);
+        if(compress)
+          ser.SerialiseCompressedStream(path.c_str(), streamWriter, NULL);
+        else
+          ser.SerialiseStream(path.c_str(), streamWriter, NULL);
+
+        fileErrored = streamWriter.IsErrored();
       }
 
       reader.EndChunk();
@@ -418,9 +438,20 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
         break;
       }
 
-      RDCLOG("File received.");
+      if(fileErrored)
+      {
+        // the connection is still fine, reply with no path to indicate the copy failed
+        FileIO::Delete(path.c_str());
+        path.clear();
 
-      tempFiles.push_back(path);
+        RDCERR("File was corrupted or couldn't be written");
+      }
+      else
+      {
+        RDCLOG("File received.");
+
+        tempFiles.push_back(path);
+      }
 
       {
         WRITE_DATA_SCOPE();
@@ -1476,11 +1507,13 @@ void RemoteServer::CopyCaptureFromRemote(const char *remotepath, const char *loc
                                          RENDERDOC_ProgressCallback progress)
 {
   rdcstr path = remotepath;
+  bool compress = RemoteServer_CompressCaptureCopies();
 
   {
     WRITE_DATA_SCOPE();
     SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureFromRemote);
     SERIALISE_ELEMENT(path);
+    SERIALISE_ELEMENT(compress);
   }
 
   {
@@ -1491,13 +1524,19 @@ void RemoteServer::CopyCaptureFromRemote(const char *remotepath, const char *loc
     {
       StreamWriter streamWriter(FileIO::fopen(localpath, "wb"), Ownership::Stream);
 
-      ser.SerialiseStream(localpath, streamWriter, progress);
+      if(compress)
+        ser.SerialiseCompressedStream(localpath, streamWriter, progress);
+      else
+        ser.SerialiseStream(localpath, streamWriter, progress);
 
       if(ser.IsErrored())
       {
         RDCERR("Network error receiving file");
         return;
       }
+
+      if(streamWriter.IsErrored())
+        RDCERR("Error writing received file to '%s'", localpath);
     }
     else
     {
@@ -1522,9 +1561,15 @@ rdcstr RemoteServer::CopyCaptureToRemote(const char *filename, RENDERDOC_Progres
     WRITE_DATA_SCOPE();
     SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureToRemote);
 
+    bool compress = RemoteServer_CompressCaptureCopies();
+    SERIALISE_ELEMENT(compress);
+
     // this will take ownership of and close the file
     StreamReader fileStream(fileHandle);
-    ser.SerialiseStream(filename, fileStream, progress);
+    if(compress)
+      ser.SerialiseCompressedStream(filename, fileStream, progress);
+    else
+      ser.SerialiseStream(filename, fileStream, progress);
   }
 
   rdcstr path;
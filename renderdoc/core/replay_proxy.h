@@ -103,6 +103,7 @@ enum ReplayProxyPacket
 
   eReplayProxy_ContinueDebug,
   eReplayProxy_FreeDebugger,
+  eReplayProxy_RunDebug,
 };
 
 DECLARE_REFLECTION_ENUM(ReplayProxyPacket);
@@ -531,6 +532,8 @@ public:
                              const uint32_t groupid[3], const uint32_t threadid[3]);
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<ShaderDebugState>, ContinueDebug, ShaderDebugger *debugger);
   IMPLEMENT_FUNCTION_PROXIED(void, FreeDebugger, ShaderDebugger *debugger);
+  IMPLEMENT_FUNCTION_PROXIED(ShaderDebugState, RunDebug, ShaderDebugger *debugger,
+                             const rdcarray<uint32_t> &breakpoints);
 
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<ShaderEncoding>, GetTargetShaderEncodings);
   IMPLEMENT_FUNCTION_PROXIED(void, BuildTargetShader, ShaderEncoding sourceEncoding,
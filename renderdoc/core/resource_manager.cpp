@@ -175,12 +175,31 @@ bool IsCompleteWriteFrameRef(FrameRefType refType)
   return refType == eFrameRef_CompleteWrite;
 }
 
+void FrameRefSet::clear()
+{
+  if(m_Count == 0)
+    return;
+
+  for(Entry &e : m_Entries)
+    e = Entry();
+  m_Count = 0;
+}
+
+void FrameRefSet::Grow()
+{
+  rdcarray<Entry> old;
+  old.swap(m_Entries);
+
+  m_Entries.resize(RDCMAX((size_t)16, old.size() * 2));
+
+  for(const Entry &e : old)
+    if(e.id != ResourceId())
+      m_Entries[Probe(e.id)] = e;
+}
+
 void ResourceRecord::AddResourceReferences(ResourceRecordHandler *mgr)
 {
-  for(auto it = m_FrameRefs.begin(); it != m_FrameRefs.end(); ++it)
-  {
-    mgr->MarkResourceFrameReferenced(it->first, it->second);
-  }
+  mgr->MarkResourceFrameReferenced(m_FrameRefs);
 }
 
 void ResourceRecord::Delete(ResourceRecordHandler *mgr)
@@ -204,3 +223,172 @@ void ResourceRecord::Delete(ResourceRecordHandler *mgr)
     mgr->DestroyResourceRecord(this);
   }
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Check frame reference set", "[resource_manager]")
+{
+  SECTION("matches map-based tracking")
+  {
+    FrameRefSet refs;
+    std::map<ResourceId, FrameRefType> expected;
+
+    rdcarray<ResourceId> ids;
+    for(int i = 0; i < 300; i++)
+      ids.push_back(ResourceIDGen::GetNewUniqueID());
+
+    const FrameRefType types[] = {eFrameRef_None, eFrameRef_PartialWrite, eFrameRef_CompleteWrite,
+                                  eFrameRef_Read};
+
+    uint32_t seed = 1234;
+    for(int i = 0; i < 5000; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      ResourceId id = ids[(seed >> 8) % ids.size()];
+      FrameRefType refType = types[(seed >> 20) % ARRAY_COUNT(types)];
+
+      bool expectedNew = MarkReferenced(expected, id, refType);
+      CHECK(refs.Mark(id, refType, ComposeFrameRefs) == expectedNew);
+    }
+
+    CHECK(refs.size() == expected.size());
+
+    size_t visited = 0;
+    refs.ForEach([&](ResourceId id, FrameRefType refType) {
+      visited++;
+      auto it = expected.find(id);
+      bool found = (it != expected.end());
+      REQUIRE(found);
+      CHECK(it->second == refType);
+    });
+    CHECK(visited == expected.size());
+
+    for(auto it = expected.begin(); it != expected.end(); ++it)
+      CHECK(refs.Find(it->first) == it->second);
+  };
+
+  SECTION("clear and swap")
+  {
+    FrameRefSet a, b;
+
+    ResourceId id = ResourceIDGen::GetNewUniqueID();
+
+    CHECK(a.Find(id) == eFrameRef_None);
+    CHECK(a.Mark(id, eFrameRef_Read, ComposeFrameRefs));
+    CHECK_FALSE(a.Mark(id, eFrameRef_PartialWrite, ComposeFrameRefs));
+    CHECK(a.Find(id) == eFrameRef_ReadBeforeWrite);
+
+    a.swap(b);
+    CHECK(a.empty());
+    CHECK(b.size() == 1);
+    CHECK(b.Find(id) == eFrameRef_ReadBeforeWrite);
+
+    b.clear();
+    CHECK(b.empty());
+    CHECK(b.Find(id) == eFrameRef_None);
+    CHECK(b.Mark(id, eFrameRef_CompleteWrite, ComposeFrameRefs));
+    CHECK(b.Find(id) == eFrameRef_CompleteWrite);
+  };
+}
+
+TEST_CASE("Check resource ID map", "[resource_manager]")
+{
+  // build IDs from raw values so we can place them anywhere relative to each other
+  auto makeId = [](uint64_t raw) {
+    ResourceId id;
+    memcpy(&id, &raw, sizeof(raw));
+    return id;
+  };
+
+  SECTION("matches std::map")
+  {
+    ResourceIdMap<uint32_t> map;
+    std::map<ResourceId, uint32_t> expected;
+
+    uint32_t seed = 4321;
+    for(uint32_t i = 0; i < 20000; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+
+      // mostly a dense range of IDs, with the odd outlier below and far above it
+      uint64_t raw = 1000000 + ((seed >> 8) % 3000);
+      if((seed >> 24) % 50 == 0)
+        raw = (seed >> 4) % 1000;
+      else if((seed >> 24) % 50 == 1)
+        raw = 1000000000000000000ULL + (seed >> 8);
+
+      ResourceId id = makeId(raw);
+
+      if((seed >> 20) % 4 == 0)
+      {
+        CHECK(map.Erase(id) == (expected.erase(id) > 0));
+      }
+      else
+      {
+        map[id] = i;
+        expected[id] = i;
+      }
+    }
+
+    CHECK(map.size() == expected.size());
+
+    for(auto it = expected.begin(); it != expected.end(); ++it)
+    {
+      const uint32_t *val = map.Find(it->first);
+      REQUIRE(val);
+      CHECK(*val == it->second);
+    }
+
+    size_t visited = 0;
+    map.ForEach([&](ResourceId id, uint32_t val) {
+      visited++;
+      auto it = expected.find(id);
+      bool found = (it != expected.end());
+      REQUIRE(found);
+      CHECK(it->second == val);
+    });
+    CHECK(visited == expected.size());
+  };
+
+  SECTION("outliers move into the array when it grows over them")
+  {
+    ResourceIdMap<uint32_t> map;
+
+    // the first ID sets the base, so this one lands too far ahead and goes in the hash map
+    map[makeId(100)] = 1;
+    map[makeId(5000)] = 2;
+    CHECK(map.size() == 2);
+
+    for(uint64_t raw = 101; raw < 5000; raw++)
+      map[makeId(raw)] = 3;
+
+    CHECK(map.size() == 5000 - 100 + 1);
+    CHECK(*map.Find(makeId(100)) == 1);
+    CHECK(*map.Find(makeId(5000)) == 2);
+    CHECK(map.Erase(makeId(5000)));
+    CHECK_FALSE(map.Contains(makeId(5000)));
+  };
+
+  SECTION("null and missing IDs")
+  {
+    ResourceIdMap<ResourceId> map;
+
+    CHECK(map.empty());
+    CHECK(map.Find(ResourceId()) == NULL);
+    CHECK_FALSE(map.Erase(makeId(5)));
+
+    map[makeId(5)] = makeId(6);
+    CHECK(map.Find(ResourceId()) == NULL);
+    CHECK(map.Find(makeId(4)) == NULL);
+    CHECK(map.Find(makeId(7)) == NULL);
+    CHECK(*map.Find(makeId(5)) == makeId(6));
+
+    map.clear();
+    CHECK(map.empty());
+    CHECK(map.Find(makeId(5)) == NULL);
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
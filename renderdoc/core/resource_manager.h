@@ -34,6 +34,7 @@
 #include "api/replay/resourceid.h"
 #include "common/threading.h"
 #include "core/core.h"
+#include "core/sharded_map.h"
 #include "os/os_specific.h"
 #include "serialise/serialiser.h"
 
@@ -282,6 +283,260 @@ inline bool MarkReferenced(std::map<ResourceId, FrameRefType> &refs, ResourceId
   return MarkReferenced(refs, id, refType, ComposeFrameRefs);
 }
 
+template <typename Compose>
+bool MarkReferenced(ShardedMap<ResourceId, FrameRefType> &refs, ResourceId id,
+                    FrameRefType refType, Compose comp)
+{
+  return refs.Update(id, [refType, &comp](FrameRefType &ref, bool inserted) {
+    ref = inserted ? refType : comp(ref, refType);
+  });
+}
+
+// compact set of frame references, recorded by a single thread (e.g. into a command buffer's
+// record) and then merged into the resource manager in one go. This is an open-addressed hash table
+// with linear probing so marking a reference is a couple of cache lines touched with no allocation,
+// and clearing keeps the storage around for when the record is reused.
+class FrameRefSet
+{
+public:
+  template <typename Compose>
+  bool Mark(ResourceId id, FrameRefType refType, Compose comp)
+  {
+    if(m_Count + 1 > (m_Entries.size() >> 1) + (m_Entries.size() >> 2))
+      Grow();
+
+    Entry &e = m_Entries[Probe(id)];
+    if(e.id == id)
+    {
+      e.refType = comp(e.refType, refType);
+      return false;
+    }
+
+    e.id = id;
+    e.refType = refType;
+    m_Count++;
+    return true;
+  }
+
+  // returns eFrameRef_None if id isn't referenced
+  FrameRefType Find(ResourceId id) const
+  {
+    if(m_Count == 0)
+      return eFrameRef_None;
+    const Entry &e = m_Entries[Probe(id)];
+    return e.id == id ? e.refType : eFrameRef_None;
+  }
+
+  size_t size() const { return m_Count; }
+  bool empty() const { return m_Count == 0; }
+  void clear();
+  void swap(FrameRefSet &other)
+  {
+    m_Entries.swap(other.m_Entries);
+    std::swap(m_Count, other.m_Count);
+  }
+
+  // calls func(ResourceId, FrameRefType) for each reference, in no particular order
+  template <typename Func>
+  void ForEach(Func func) const
+  {
+    for(const Entry &e : m_Entries)
+      if(e.id != ResourceId())
+        func(e.id, e.refType);
+  }
+
+private:
+  struct Entry
+  {
+    ResourceId id;
+    FrameRefType refType = eFrameRef_None;
+  };
+
+  // returns the index of id's entry, or of the empty entry where it would go
+  size_t Probe(ResourceId id) const
+  {
+    uint64_t h = std::hash<ResourceId>()(id);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+
+    size_t mask = m_Entries.size() - 1;
+    size_t idx = size_t(h) & mask;
+    while(m_Entries[idx].id != id && m_Entries[idx].id != ResourceId())
+      idx = (idx + 1) & mask;
+    return idx;
+  }
+
+  void Grow();
+
+  rdcarray<Entry> m_Entries;
+  size_t m_Count = 0;
+};
+
+template <typename Compose>
+bool MarkReferenced(FrameRefSet &refs, ResourceId id, FrameRefType refType, Compose comp)
+{
+  return refs.Mark(id, refType, comp);
+}
+
+// map keyed by ResourceId for the replay-side ID tables, which are looked up for almost every
+// parameter of every chunk. IDs are allocated sequentially, so the original IDs in a capture and
+// the live IDs created on replay each fall in a dense range. Those are stored in a flat array
+// indexed by the offset from the first ID inserted, and IDs too far outside that range fall back
+// to a hash map.
+template <typename Value>
+class ResourceIdMap
+{
+public:
+  // returns NULL if id isn't present
+  const Value *Find(ResourceId id) const
+  {
+    uint64_t idx = ToIndex(id);
+    if(idx < m_Dense.size())
+      return m_Dense[(size_t)idx].present ? &m_Dense[(size_t)idx].value : NULL;
+
+    if(m_Sparse.empty())
+      return NULL;
+
+    auto it = m_Sparse.find(id);
+    return it == m_Sparse.end() ? NULL : &it->second;
+  }
+
+  Value *Find(ResourceId id)
+  {
+    return const_cast<Value *>(const_cast<const ResourceIdMap *>(this)->Find(id));
+  }
+
+  bool Contains(ResourceId id) const { return Find(id) != NULL; }
+  // returns the value for id, inserting a default-constructed value if it's not present
+  Value &operator[](ResourceId id)
+  {
+    Slot *slot = GetDenseSlot(id);
+    if(slot == NULL)
+      return m_Sparse[id];
+
+    if(!slot->present)
+    {
+      slot->present = true;
+      m_DenseCount++;
+    }
+    return slot->value;
+  }
+
+  bool Erase(ResourceId id)
+  {
+    uint64_t idx = ToIndex(id);
+    if(idx < m_Dense.size())
+    {
+      Slot &slot = m_Dense[(size_t)idx];
+      if(!slot.present)
+        return false;
+
+      slot = Slot();
+      m_DenseCount--;
+      return true;
+    }
+
+    return m_Sparse.erase(id) > 0;
+  }
+
+  size_t size() const { return m_DenseCount + m_Sparse.size(); }
+  bool empty() const { return size() == 0; }
+  void clear()
+  {
+    m_Dense.clear();
+    m_DenseCount = 0;
+    m_Sparse.clear();
+  }
+
+  // calls func(ResourceId, const Value &) for each element, in no particular order
+  template <typename Func>
+  void ForEach(Func func) const
+  {
+    for(size_t i = 0; i < m_Dense.size(); i++)
+      if(m_Dense[i].present)
+        func(FromRaw(m_Base + i), m_Dense[i].value);
+
+    for(auto it = m_Sparse.begin(); it != m_Sparse.end(); ++it)
+      func(it->first, it->second);
+  }
+
+private:
+  struct Slot
+  {
+    Value value = Value();
+    bool present = false;
+  };
+
+  // don't bother falling back to the hash map until the array would be at least this big
+  static const uint64_t MinDenseSize = 1024;
+
+  static uint64_t ToRaw(ResourceId id)
+  {
+    RDCCOMPILE_ASSERT(sizeof(id) == sizeof(uint64_t), "ResourceId is no longer 1:1 with uint64_t");
+    uint64_t raw = 0;
+    memcpy(&raw, &id, sizeof(uint64_t));
+    return raw;
+  }
+
+  static ResourceId FromRaw(uint64_t raw)
+  {
+    ResourceId id;
+    memcpy(&id, &raw, sizeof(uint64_t));
+    return id;
+  }
+
+  // IDs below the base wrap around to huge indices, so a single bounds check covers both sides
+  uint64_t ToIndex(ResourceId id) const { return ToRaw(id) - m_Base; }
+  // returns the slot for id in the array, growing it if that keeps it dense enough, or NULL if id
+  // should go in the hash map instead.
+  Slot *GetDenseSlot(ResourceId id)
+  {
+    if(id == ResourceId())
+      return NULL;
+
+    // with nothing in the array we can start it afresh from this ID
+    if(m_DenseCount == 0 && (m_Dense.empty() || ToIndex(id) >= m_Dense.size()))
+    {
+      m_Dense.clear();
+      m_Base = ToRaw(id);
+    }
+
+    uint64_t idx = ToIndex(id);
+    if(idx >= m_Dense.size())
+    {
+      if(idx >= RDCMAX(uint64_t(MinDenseSize), uint64_t(m_DenseCount) * 4))
+        return NULL;
+
+      m_Dense.resize(RDCMAX(size_t(idx) + 1, m_Dense.size() * 2));
+
+      // anything in the hash map that is now in range must move into the array
+      for(auto it = m_Sparse.begin(); it != m_Sparse.end();)
+      {
+        uint64_t sparseIdx = ToIndex(it->first);
+        if(sparseIdx < m_Dense.size())
+        {
+          m_Dense[(size_t)sparseIdx].value = it->second;
+          m_Dense[(size_t)sparseIdx].present = true;
+          m_DenseCount++;
+          it = m_Sparse.erase(it);
+        }
+        else
+        {
+          ++it;
+        }
+      }
+    }
+
+    return &m_Dense[(size_t)idx];
+  }
+
+  uint64_t m_Base = 0;
+  rdcarray<Slot> m_Dense;
+  size_t m_DenseCount = 0;
+  std::unordered_map<ResourceId, Value> m_Sparse;
+};
+
 // verbose prints with IDs of each dirty resource and whether it was prepared,
 // and whether it was serialised.
 #define VERBOSE_DIRTY_RESOURCES OPTION_OFF
@@ -300,6 +555,7 @@ public:
   virtual void MarkDirtyResource(ResourceId id) = 0;
   virtual void RemoveResourceRecord(ResourceId id) = 0;
   virtual void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType) = 0;
+  virtual void MarkResourceFrameReferenced(const FrameRefSet &refs) = 0;
   virtual void DestroyResourceRecord(ResourceRecord *record) = 0;
 };
 
@@ -472,8 +728,7 @@ struct ResourceRecord
   void AddResourceReferences(ResourceRecordHandler *mgr);
   void AddReferencedIDs(std::set<ResourceId> &ids)
   {
-    for(auto it = m_FrameRefs.begin(); it != m_FrameRefs.end(); ++it)
-      ids.insert(it->first);
+    m_FrameRefs.ForEach([&ids](ResourceId id, FrameRefType) { ids.insert(id); });
   }
 
   uint64_t Length;
@@ -527,7 +782,7 @@ protected:
   rdcarray<StoredChunk> m_Chunks;
   Threading::CriticalSection *m_ChunkLock;
 
-  std::map<ResourceId, FrameRefType> m_FrameRefs;
+  FrameRefSet m_FrameRefs;
 };
 
 template <typename Compose>
@@ -622,6 +877,9 @@ public:
   void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType, Compose comp);
 
   inline void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType);
+
+  // merge a set of references recorded elsewhere, e.g. by a command buffer at submission time
+  void MarkResourceFrameReferenced(const FrameRefSet &refs);
   void MarkBackgroundFrameReferenced(const rdcflatmap<ResourceId, FrameRefType> &refs);
   void CleanBackgroundFrameReferences();
 
@@ -696,13 +954,17 @@ protected:
 
   void UpdateLastWriteAndPartialUseTime(ResourceId id, FrameRefType refType);
 
+  // adds the frame reference, and a reference on the resource's record if it's newly referenced
+  template <typename Compose>
+  void MarkFrameReferenced(ResourceId id, FrameRefType refType, Compose comp);
+
   void Prepare_InitialStateIfPostponed(ResourceId id, bool midframe);
   void SkipOrPostponeOrPrepare_InitialState(ResourceId id, FrameRefType refType);
 
-  // very coarse lock, protects EVERYTHING. This could certainly be improved and it may be a
-  // bottleneck for performance. Given that the main use cases are write-rarely read-often the lock
-  // should be optimised for that as we only want to make sure we're not modifying the objects
-  // together, by far the most common operation is looking up data.
+  // coarse lock, protects everything except the sharded containers below which have their own
+  // per-shard locks. Those are the tables hit from every thread while capturing, so the operations
+  // that only touch them don't take this lock. The operations that walk the initial contents still
+  // take it, so that they see a consistent view of the postponed and skipped resources.
   Threading::CriticalSection m_Lock;
 
   // we only need to lock during capturing, on replay we have single threaded access.
@@ -713,13 +975,13 @@ protected:
 
   // used during capture - map from real resource to its wrapper (other way can be done just with an
   // Unwrap)
-  std::map<RealResourceType, WrappedResourceType> m_WrapperMap;
+  ShardedMap<RealResourceType, WrappedResourceType> m_WrapperMap;
 
   // used during capture - holds resources referenced in current frame (and how they're referenced)
-  std::map<ResourceId, FrameRefType> m_FrameReferencedResources;
+  ShardedMap<ResourceId, FrameRefType> m_FrameReferencedResources;
 
   // used during capture - holds resources marked as dirty, needing initial contents
-  std::set<ResourceId> m_DirtyResources;
+  ShardedSet<ResourceId> m_DirtyResources;
 
   struct InitialContentDataOrChunk
   {
@@ -739,17 +1001,17 @@ protected:
   };
 
   // used during capture or replay - holds initial contents
-  std::map<ResourceId, InitialContentDataOrChunk> m_InitialContents;
+  ShardedMap<ResourceId, InitialContentDataOrChunk> m_InitialContents;
 
   // used during capture or replay - map of resources currently alive with their real IDs, used in
   // capture and replay.
   std::unordered_map<ResourceId, WrappedResourceType> m_CurrentResourceMap;
 
   // used during replay - maps back and forth from original id to live id and vice-versa
-  std::unordered_map<ResourceId, ResourceId> m_OriginalIDs, m_LiveIDs;
+  ResourceIdMap<ResourceId> m_OriginalIDs, m_LiveIDs;
 
   // used during replay - holds resources allocated and the original id that they represent
-  std::unordered_map<ResourceId, WrappedResourceType> m_LiveResourceMap;
+  ResourceIdMap<WrappedResourceType> m_LiveResourceMap;
 
   // used during capture - holds resource records by id.
   std::unordered_map<ResourceId, RecordType *> m_ResourceRecords;
@@ -757,9 +1019,9 @@ protected:
 
   // used during replay - holds current resource replacements
   // replaced -> replacement
-  std::unordered_map<ResourceId, ResourceId> m_Replacements;
+  ResourceIdMap<ResourceId> m_Replacements;
   // replacement -> replaced (for looking up original IDs)
-  std::unordered_map<ResourceId, ResourceId> m_Replaced;
+  ResourceIdMap<ResourceId> m_Replaced;
 
   // During initial resources preparation, persistent resources are
   // postponed until serializing to RDC file.
@@ -816,13 +1078,19 @@ void ResourceManager<Configuration>::Shutdown()
 
   while(!m_LiveResourceMap.empty())
   {
-    auto it = m_LiveResourceMap.begin();
-    ResourceId id = it->first;
-    ResourceTypeRelease(it->second);
+    rdcarray<ResourceId> ids;
+    m_LiveResourceMap.ForEach([&ids](ResourceId id, WrappedResourceType) { ids.push_back(id); });
+
+    for(ResourceId id : ids)
+    {
+      // releasing one resource may have released others along with it
+      WrappedResourceType *res = m_LiveResourceMap.Find(id);
+      if(res == NULL)
+        continue;
 
-    auto removeit = m_LiveResourceMap.find(id);
-    if(removeit != m_LiveResourceMap.end())
-      m_LiveResourceMap.erase(removeit);
+      ResourceTypeRelease(*res);
+      m_LiveResourceMap.Erase(id);
+    }
   }
 
   RDCASSERT(m_ResourceRecords.empty());
@@ -910,109 +1178,168 @@ template <typename Compose>
 void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id,
                                                                  FrameRefType refType, Compose comp)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   if(id == ResourceId())
     return;
 
-  if(IsActiveCapturing(m_State))
+  bool backgroundCapturing;
+
   {
-    SkipOrPostponeOrPrepare_InitialState(id, refType);
+    SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
+    // the state is only read under the lock, it can change on another thread starting or ending a
+    // capture
+    backgroundCapturing = IsBackgroundCapturing(m_State);
 
-    if(IsDirtyFrameRef(refType))
+    if(IsActiveCapturing(m_State))
     {
-      Prepare_InitialStateIfPostponed(id, true);
+      SkipOrPostponeOrPrepare_InitialState(id, refType);
+
+      if(IsDirtyFrameRef(refType))
+      {
+        Prepare_InitialStateIfPostponed(id, true);
+      }
     }
+
+    UpdateLastWriteAndPartialUseTime(id, refType);
   }
 
-  UpdateLastWriteAndPartialUseTime(id, refType);
+  if(backgroundCapturing)
+    return;
 
-  if(IsBackgroundCapturing(m_State))
+  // the frame references are sharded so this doesn't need the global lock
+  MarkFrameReferenced(id, refType, comp);
+}
+
+template <typename Configuration>
+void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id, FrameRefType refType)
+{
+  return MarkResourceFrameReferenced(id, refType, ComposeFrameRefs);
+}
+
+template <typename Configuration>
+void ResourceManager<Configuration>::MarkResourceFrameReferenced(const FrameRefSet &refs)
+{
+  if(refs.empty())
     return;
 
-  bool newRef = MarkReferenced(m_FrameReferencedResources, id, refType, comp);
+  // same as marking each reference individually, but the global lock is only taken once for the
+  // whole set instead of per reference.
+  bool backgroundCapturing;
 
-  if(newRef)
   {
-    RecordType *record = GetResourceRecord(id);
+    SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
 
-    if(record)
-      record->AddRef();
+    backgroundCapturing = IsBackgroundCapturing(m_State);
+    const bool activeCapturing = IsActiveCapturing(m_State);
+
+    refs.ForEach([this, activeCapturing](ResourceId id, FrameRefType refType) {
+      if(activeCapturing)
+      {
+        SkipOrPostponeOrPrepare_InitialState(id, refType);
+
+        if(IsDirtyFrameRef(refType))
+          Prepare_InitialStateIfPostponed(id, true);
+      }
+
+      UpdateLastWriteAndPartialUseTime(id, refType);
+    });
   }
+
+  if(backgroundCapturing)
+    return;
+
+  refs.ForEach([this](ResourceId id, FrameRefType refType) {
+    MarkFrameReferenced(id, refType, ComposeFrameRefs);
+  });
 }
 
 template <typename Configuration>
-void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id, FrameRefType refType)
-{
-  return MarkResourceFrameReferenced(id, refType, ComposeFrameRefs);
+template <typename Compose>
+void ResourceManager<Configuration>::MarkFrameReferenced(ResourceId id, FrameRefType refType,
+                                                         Compose comp)
+{
+  // the record is referenced while the shard is still locked. ClearReferencedResources drains each
+  // shard under the same lock before releasing the references, so a new reference is either drained
+  // and released along with its AddRef, or stays in the map with its AddRef for the next clear.
+  m_FrameReferencedResources.Update(
+      id, [this, id, refType, &comp](FrameRefType &ref, bool inserted) {
+        if(!inserted)
+        {
+          ref = comp(ref, refType);
+          return;
+        }
+
+        ref = refType;
+
+        RecordType *record = GetResourceRecord(id);
+
+        if(record)
+          record->AddRef();
+      });
 }
 
 template <typename Configuration>
 void ResourceManager<Configuration>::MarkDirtyResource(ResourceId res)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   if(res == ResourceId())
     return;
 
-  m_DirtyResources.insert(res);
+  m_DirtyResources.Insert(res);
 }
 
 template <typename Configuration>
 bool ResourceManager<Configuration>::IsResourceDirty(ResourceId res)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   if(res == ResourceId())
     return false;
 
-  return m_DirtyResources.find(res) != m_DirtyResources.end();
+  return m_DirtyResources.Contains(res);
 }
 
 template <typename Configuration>
 void ResourceManager<Configuration>::SetInitialContents(ResourceId id, InitialContentData contents)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   RDCASSERT(id != ResourceId());
 
-  auto it = m_InitialContents.find(id);
+  InitialContentDataOrChunk prev;
 
-  if(it != m_InitialContents.end())
-    it->second.Free(this);
+  bool inserted =
+      m_InitialContents.Update(id, [&prev, &contents](InitialContentDataOrChunk &data, bool) {
+        prev = data;
+        data = InitialContentDataOrChunk();
+        data.data = contents;
+      });
 
-  m_InitialContents[id].data = contents;
+  // free the old contents after the shard is unlocked, as that calls into the driver
+  if(!inserted)
+    prev.Free(this);
 }
 
 template <typename Configuration>
 void ResourceManager<Configuration>::SetInitialChunk(ResourceId id, Chunk *chunk)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   RDCASSERT(id != ResourceId());
   RDCASSERT(chunk->GetChunkType<SystemChunk>() == SystemChunk::InitialContents);
 
-  InitialContentDataOrChunk &data = m_InitialContents[id];
+  Chunk *prev = NULL;
 
-  if(data.chunk)
-    data.chunk->Delete();
+  m_InitialContents.Update(id, [&prev, chunk](InitialContentDataOrChunk &data, bool) {
+    prev = data.chunk;
+    data.chunk = chunk;
+  });
 
-  data.chunk = chunk;
+  if(prev)
+    prev->Delete();
 }
 
 template <typename Configuration>
 typename Configuration::InitialContentData ResourceManager<Configuration>::GetInitialContents(
     ResourceId id)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   if(id == ResourceId())
     return InitialContentData();
 
-  if(m_InitialContents.find(id) != m_InitialContents.end())
-    return m_InitialContents[id].data;
-
-  return InitialContentData();
+  return m_InitialContents.Find(id).data;
 }
 
 // use a namespace so this doesn't pollute the global namesapce
@@ -1051,12 +1378,12 @@ void ResourceManager<Configuration>::Serialise_InitialContentsNeeded(WriteSerial
 
   // all resources that were recorded as being modified should be included in the list of those
   // needing initial contents
-  for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
+  for(const rdcpair<ResourceId, FrameRefType> &ref : m_FrameReferencedResources.Snapshot())
   {
-    RecordType *record = GetResourceRecord(it->first);
-    if(IsDirtyFrameRef(it->second))
+    RecordType *record = GetResourceRecord(ref.first);
+    if(IsDirtyFrameRef(ref.second))
     {
-      WrittenRecord wr = {it->first, record ? record->DataInSerialiser : true};
+      WrittenRecord wr = {ref.first, record ? record->DataInSerialiser : true};
 
       NeededInitials.push_back(wr);
     }
@@ -1066,12 +1393,12 @@ void ResourceManager<Configuration>::Serialise_InitialContentsNeeded(WriteSerial
   // referenced read-only, as anything not in this list will have its initial contents freed on
   // replay (see CreateInitialContents). However we only need to keep resources that are referenced
   // (unless we have ref all resources on)
-  for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
+  for(const rdcpair<ResourceId, InitialContentDataOrChunk> &initial : m_InitialContents.Snapshot())
   {
     bool include = RenderDoc::Inst().GetCaptureOptions().refAllResources;
 
-    ResourceId id = it->first;
-    if(m_FrameReferencedResources.find(id) != m_FrameReferencedResources.end())
+    ResourceId id = initial.first;
+    if(m_FrameReferencedResources.Contains(id))
       include = true;
 
     if(include)
@@ -1091,13 +1418,10 @@ void ResourceManager<Configuration>::Serialise_InitialContentsNeeded(WriteSerial
 template <typename Configuration>
 void ResourceManager<Configuration>::FreeInitialContents()
 {
-  while(!m_InitialContents.empty())
-  {
-    auto it = m_InitialContents.begin();
-    it->second.Free(this);
-    if(!m_InitialContents.empty())
-      m_InitialContents.erase(m_InitialContents.begin());
-  }
+  m_InitialContents.Drain(
+      [this](std::pair<const ResourceId, InitialContentDataOrChunk> &initial) {
+        initial.second.Free(this);
+      });
   m_PostponedResourceIDs.clear();
   m_SkippedResourceIDs.clear();
 }
@@ -1307,24 +1631,17 @@ void ResourceManager<Configuration>::CreateInitialContents(ReadSerialiser &ser)
 
     // if this resource exists and we don't have initial contents for it serialised, create some for
     // reset purposes.
-    if(HasLiveResource(id) && m_InitialContents.find(id) == m_InitialContents.end())
+    if(HasLiveResource(id) && !m_InitialContents.Contains(id))
       Create_InitialState(id, GetLiveResource(id), wr.written);
   }
 
   // any initial contents that we ended up with which we don't need can be freed now
-  for(auto it = m_InitialContents.begin(); it != m_InitialContents.end();)
+  for(rdcpair<ResourceId, InitialContentDataOrChunk> &initial : m_InitialContents.Snapshot())
   {
-    ResourceId id = it->first;
-
-    if(ids.find(id) == ids.end())
-    {
-      it->second.Free(this);
-      ++it;
-      m_InitialContents.erase(id);
-    }
-    else
+    if(ids.find(initial.first) == ids.end())
     {
-      ++it;
+      m_InitialContents.Erase(initial.first);
+      initial.second.Free(this);
     }
   }
 }
@@ -1337,7 +1654,7 @@ void ResourceManager<Configuration>::ApplyInitialContents()
   for(auto it = resources.begin(); it != resources.end(); ++it)
   {
     ResourceId id = *it;
-    const InitialContentDataOrChunk &data = m_InitialContents[id];
+    const InitialContentDataOrChunk data = m_InitialContents.Find(id);
     WrappedResourceType live = GetLiveResource(id);
     Apply_InitialState(live, data.data);
   }
@@ -1348,9 +1665,9 @@ template <typename Configuration>
 rdcarray<ResourceId> ResourceManager<Configuration>::InitialContentResources()
 {
   rdcarray<ResourceId> resources;
-  for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
+  for(const rdcpair<ResourceId, InitialContentDataOrChunk> &initial : m_InitialContents.Snapshot())
   {
-    ResourceId id = it->first;
+    ResourceId id = initial.first;
 
     if(HasLiveResource(id))
     {
@@ -1390,8 +1707,7 @@ void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser
       RenderDoc::Inst().SetProgress(CaptureProgress::AddReferencedResources, idx / num);
       idx += 1.0f;
 
-      if(m_FrameReferencedResources.find(it->first) == m_FrameReferencedResources.end() &&
-         it->second->InternalResource)
+      if(!m_FrameReferencedResources.Contains(it->first) && it->second->InternalResource)
         continue;
 
       it->second->Insert(sortedChunks);
@@ -1399,15 +1715,17 @@ void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser
   }
   else
   {
-    float num = float(m_FrameReferencedResources.size());
+    rdcarray<rdcpair<ResourceId, FrameRefType>> refs = m_FrameReferencedResources.Snapshot();
+
+    float num = float(refs.size());
     float idx = 0.0f;
 
-    for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
+    for(const rdcpair<ResourceId, FrameRefType> &ref : refs)
     {
       RenderDoc::Inst().SetProgress(CaptureProgress::AddReferencedResources, idx / num);
       idx += 1.0f;
 
-      RecordType *record = GetResourceRecord(it->first);
+      RecordType *record = GetResourceRecord(ref.first);
       if(record)
         record->Insert(sortedChunks);
     }
@@ -1426,18 +1744,18 @@ void ResourceManager<Configuration>::PrepareInitialContents()
 {
   SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
 
-  RDCDEBUG("Preparing up to %u potentially dirty resources", (uint32_t)m_DirtyResources.size());
+  rdcarray<ResourceId> dirtyResources = m_DirtyResources.Snapshot();
+
+  RDCDEBUG("Preparing up to %u potentially dirty resources", (uint32_t)dirtyResources.size());
   uint32_t prepared = 0;
   uint32_t postponed = 0;
   uint32_t skipped = 0;
 
-  float num = float(m_DirtyResources.size());
+  float num = float(dirtyResources.size());
   float idx = 0.0f;
 
-  for(auto it = m_DirtyResources.begin(); it != m_DirtyResources.end(); ++it)
+  for(ResourceId id : dirtyResources)
   {
-    ResourceId id = *it;
-
     RenderDoc::Inst().SetProgress(CaptureProgress::PrepareInitialStates, idx / num);
     idx += 1.0f;
 
@@ -1490,19 +1808,36 @@ void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser
   uint32_t dirty = 0;
   uint32_t skipped = 0;
 
-  RDCDEBUG("Checking %u resources with initial contents", (uint32_t)m_InitialContents.size());
+  // walk a sorted snapshot, so the chunks are written in ID order and the shards aren't held locked
+  // while the driver serialises each resource
+  rdcarray<rdcpair<ResourceId, InitialContentDataOrChunk>> initials = m_InitialContents.Snapshot();
 
-  float num = float(m_InitialContents.size());
+  RDCDEBUG("Checking %u resources with initial contents", (uint32_t)initials.size());
+
+  float num = float(initials.size());
   float idx = 0.0f;
 
-  for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
+  // with a buffer store the contents are moved out of the chunk, so the up-front size estimate
+  // would only be filled with padding. Instead serialise each chunk to memory first so its length
+  // can be fixed up, then copy it out.
+  WriteSerialiser *scratchSer = NULL;
+  if(ser.GetBufferStore())
+  {
+    scratchSer = new WriteSerialiser(new StreamWriter(StreamWriter::DefaultScratchSize),
+                                     Ownership::Stream);
+    scratchSer->SetChunkMetadataRecording(ser.GetChunkMetadataRecording());
+    scratchSer->SetUserData(ser.GetUserData());
+    scratchSer->SetBufferStore(ser.GetBufferStore(), Ownership::Nothing);
+  }
+
+  for(const rdcpair<ResourceId, InitialContentDataOrChunk> &initial : initials)
   {
-    ResourceId id = it->first;
+    ResourceId id = initial.first;
 
     RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseInitialStates, idx / num);
     idx += 1.0f;
 
-    if(m_FrameReferencedResources.find(id) == m_FrameReferencedResources.end() &&
+    if(!m_FrameReferencedResources.Contains(id) &&
        !RenderDoc::Inst().GetCaptureOptions().refAllResources)
     {
 #if ENABLED(VERBOSE_DIRTY_RESOURCES)
@@ -1537,32 +1872,52 @@ void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser
     // Load postponed resource if needed.
     Prepare_InitialStateIfPostponed(id, false);
 
+    // preparing a postponed resource replaces its contents, so fetch them after
+    InitialContentDataOrChunk contents = m_InitialContents.Find(id);
+
     dirty++;
 
-    if(!Need_InitialStateChunk(id, it->second.data))
+    if(!Need_InitialStateChunk(id, contents.data))
     {
       // this was handled in ApplyInitialContentsNonChunks(), do nothing as there's no point copying
       // the data again (it's already been serialised).
       continue;
     }
 
-    if(it->second.chunk)
+    if(contents.chunk)
     {
-      it->second.chunk->Write(ser);
+      contents.chunk->Write(ser);
+    }
+    else if(scratchSer)
+    {
+      Chunk *chunk = NULL;
+
+      {
+        ScopedChunk scope(*scratchSer, SystemChunk::InitialContents);
+
+        Serialise_InitialState(*scratchSer, id, record, &contents.data);
+
+        chunk = scope.Get();
+      }
+
+      chunk->Write(ser);
+      chunk->Delete();
     }
     else
     {
-      uint64_t size = GetSize_InitialState(id, it->second.data);
+      uint64_t size = GetSize_InitialState(id, contents.data);
 
       SCOPED_SERIALISE_CHUNK(SystemChunk::InitialContents, size);
 
-      Serialise_InitialState(ser, id, record, &it->second.data);
+      Serialise_InitialState(ser, id, record, &contents.data);
     }
 
     // Reset back to empty contents, unloading the actual resource.
     SetInitialContents(id, InitialContentData());
   }
 
+  SAFE_DELETE(scratchSer);
+
   RDCDEBUG("Serialised %u resources, skipped %u unreferenced", dirty, skipped);
 }
 
@@ -1571,11 +1926,11 @@ void ResourceManager<Configuration>::ApplyInitialContentsNonChunks(WriteSerialis
 {
   SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
 
-  for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
+  for(const rdcpair<ResourceId, InitialContentDataOrChunk> &initial : m_InitialContents.Snapshot())
   {
-    ResourceId id = it->first;
+    ResourceId id = initial.first;
 
-    if(m_FrameReferencedResources.find(id) == m_FrameReferencedResources.end() &&
+    if(!m_FrameReferencedResources.Contains(id) &&
        !RenderDoc::Inst().GetCaptureOptions().refAllResources)
     {
       continue;
@@ -1586,8 +1941,8 @@ void ResourceManager<Configuration>::ApplyInitialContentsNonChunks(WriteSerialis
     if(!record || record->InternalResource)
       continue;
 
-    if(!Need_InitialStateChunk(id, it->second.data))
-      Serialise_InitialState(ser, id, record, &it->second.data);
+    if(!Need_InitialStateChunk(id, initial.second.data))
+      Serialise_InitialState(ser, id, record, &initial.second.data);
   }
 }
 
@@ -1596,19 +1951,16 @@ void ResourceManager<Configuration>::ClearReferencedResources()
 {
   SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
 
-  for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
-  {
-    RecordType *record = GetResourceRecord(it->first);
+  m_FrameReferencedResources.Drain([this](const std::pair<const ResourceId, FrameRefType> &ref) {
+    RecordType *record = GetResourceRecord(ref.first);
 
     if(record)
     {
-      if(IncludesWrite(it->second))
-        MarkDirtyResource(it->first);
+      if(IncludesWrite(ref.second))
+        MarkDirtyResource(ref.first);
       record->Delete(this);
     }
-  }
-
-  m_FrameReferencedResources.clear();
+  });
 }
 
 template <typename Configuration>
@@ -1628,7 +1980,7 @@ bool ResourceManager<Configuration>::HasReplacement(ResourceId from)
 {
   SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
 
-  return m_Replacements.find(from) != m_Replacements.end();
+  return m_Replacements.Contains(from);
 }
 
 template <typename Configuration>
@@ -1636,13 +1988,13 @@ void ResourceManager<Configuration>::RemoveReplacement(ResourceId id)
 {
   SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
 
-  auto it = m_Replacements.find(id);
+  ResourceId *replacement = m_Replacements.Find(id);
 
-  if(it == m_Replacements.end())
+  if(replacement == NULL)
     return;
 
-  m_Replaced.erase(it->second);
-  m_Replacements.erase(it);
+  m_Replaced.Erase(*replacement);
+  m_Replacements.Erase(id);
 }
 
 template <typename Configuration>
@@ -1700,8 +2052,6 @@ void ResourceManager<Configuration>::DestroyResourceRecord(ResourceRecord *recor
 template <typename Configuration>
 bool ResourceManager<Configuration>::AddWrapper(WrappedResourceType wrap, RealResourceType real)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   bool ret = true;
 
   if(wrap == (WrappedResourceType)RecordType::NullResource ||
@@ -1711,60 +2061,52 @@ bool ResourceManager<Configuration>::AddWrapper(WrappedResourceType wrap, RealRe
     ret = false;
   }
 
-  if(m_WrapperMap[real] != (WrappedResourceType)RecordType::NullResource)
+  if(m_WrapperMap.Set(real, wrap) != (WrappedResourceType)RecordType::NullResource)
   {
     RDCERR("Overriding wrapper for resource");
     ret = false;
   }
 
-  m_WrapperMap[real] = wrap;
-
   return ret;
 }
 
 template <typename Configuration>
 void ResourceManager<Configuration>::RemoveWrapper(RealResourceType real)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
-  if(real == (RealResourceType)RecordType::NullResource || !HasWrapper(real))
+  if(real == (RealResourceType)RecordType::NullResource || !m_WrapperMap.Erase(real))
   {
     RDCERR(
         "Invalid state removing resource wrapper - real resource is NULL or doesn't have wrapper");
     return;
   }
-
-  m_WrapperMap.erase(m_WrapperMap.find(real));
 }
 
 template <typename Configuration>
 bool ResourceManager<Configuration>::HasWrapper(RealResourceType real)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   if(real == (RealResourceType)RecordType::NullResource)
     return false;
 
-  return (m_WrapperMap.find(real) != m_WrapperMap.end());
+  return m_WrapperMap.Contains(real);
 }
 
 template <typename Configuration>
 typename Configuration::WrappedResourceType ResourceManager<Configuration>::GetWrapper(
     RealResourceType real)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   if(real == (RealResourceType)RecordType::NullResource)
     return (WrappedResourceType)RecordType::NullResource;
 
-  if(real != (RealResourceType)RecordType::NullResource && !HasWrapper(real))
+  WrappedResourceType ret = m_WrapperMap.Find(real);
+
+  if(ret == (WrappedResourceType)RecordType::NullResource)
   {
     RDCERR(
         "Invalid state removing resource wrapper - real resource isn't NULL and doesn't have "
         "wrapper");
   }
 
-  return m_WrapperMap[real];
+  return ret;
 }
 
 template <typename Configuration>
@@ -1780,11 +2122,11 @@ void ResourceManager<Configuration>::AddLiveResource(ResourceId origid, WrappedR
   m_OriginalIDs[GetID(livePtr)] = origid;
   m_LiveIDs[origid] = GetID(livePtr);
 
-  if(m_LiveResourceMap.find(origid) != m_LiveResourceMap.end())
+  if(WrappedResourceType *existing = m_LiveResourceMap.Find(origid))
   {
     RDCERR("Releasing live resource for duplicate creation: %s", ToStr(origid).c_str());
-    ResourceTypeRelease(m_LiveResourceMap[origid]);
-    m_LiveResourceMap.erase(origid);
+    ResourceTypeRelease(*existing);
+    m_LiveResourceMap.Erase(origid);
   }
 
   m_LiveResourceMap[origid] = livePtr;
@@ -1798,8 +2140,7 @@ bool ResourceManager<Configuration>::HasLiveResource(ResourceId origid)
   if(origid == ResourceId())
     return false;
 
-  return (m_Replacements.find(origid) != m_Replacements.end() ||
-          m_LiveResourceMap.find(origid) != m_LiveResourceMap.end());
+  return m_Replacements.Contains(origid) || m_LiveResourceMap.Contains(origid);
 }
 
 template <typename Configuration>
@@ -1813,11 +2154,11 @@ typename Configuration::WrappedResourceType ResourceManager<Configuration>::GetL
 
   RDCASSERT(HasLiveResource(origid), origid);
 
-  if(m_Replacements.find(origid) != m_Replacements.end())
-    return GetLiveResource(m_Replacements[origid]);
+  if(const ResourceId *replacement = m_Replacements.Find(origid))
+    return GetLiveResource(*replacement);
 
-  if(m_LiveResourceMap.find(origid) != m_LiveResourceMap.end())
-    return m_LiveResourceMap[origid];
+  if(const WrappedResourceType *res = m_LiveResourceMap.Find(origid))
+    return *res;
 
   return (WrappedResourceType)RecordType::NullResource;
 }
@@ -1829,7 +2170,7 @@ void ResourceManager<Configuration>::EraseLiveResource(ResourceId origid)
 
   RDCASSERT(HasLiveResource(origid), origid);
 
-  m_LiveResourceMap.erase(origid);
+  m_LiveResourceMap.Erase(origid);
 }
 
 template <typename Configuration>
@@ -1857,8 +2198,8 @@ typename Configuration::WrappedResourceType ResourceManager<Configuration>::GetC
   if(id == ResourceId())
     return (WrappedResourceType)RecordType::NullResource;
 
-  if(m_Replacements.find(id) != m_Replacements.end())
-    return GetCurrentResource(m_Replacements[id]);
+  if(const ResourceId *replacement = m_Replacements.Find(id))
+    return GetCurrentResource(*replacement);
 
   return m_CurrentResourceMap[id];
 }
@@ -1876,7 +2217,7 @@ void ResourceManager<Configuration>::ReleaseCurrentResource(ResourceId id)
   }
 
   m_CurrentResourceMap.erase(id);
-  m_DirtyResources.erase(id);
+  m_DirtyResources.Erase(id);
 
   auto it = std::lower_bound(m_ResourceRefTimes.begin(), m_ResourceRefTimes.end(), id);
   if(it != m_ResourceRefTimes.end())
@@ -1889,8 +2230,9 @@ ResourceId ResourceManager<Configuration>::GetOriginalID(ResourceId id)
   if(id == ResourceId())
     return id;
 
-  RDCASSERT(m_OriginalIDs.find(id) != m_OriginalIDs.end(), id);
-  return m_OriginalIDs[id];
+  const ResourceId *orig = m_OriginalIDs.Find(id);
+  RDCASSERT(orig, id);
+  return orig ? *orig : ResourceId();
 }
 
 template <typename Configuration>
@@ -1899,11 +2241,12 @@ ResourceId ResourceManager<Configuration>::GetUnreplacedOriginalID(ResourceId id
   if(id == ResourceId())
     return id;
 
-  if(m_Replaced.find(id) != m_Replaced.end())
-    return m_Replaced[id];
+  if(const ResourceId *replaced = m_Replaced.Find(id))
+    return *replaced;
 
-  RDCASSERT(m_OriginalIDs.find(id) != m_OriginalIDs.end(), id);
-  return m_OriginalIDs[id];
+  const ResourceId *orig = m_OriginalIDs.Find(id);
+  RDCASSERT(orig, id);
+  return orig ? *orig : ResourceId();
 }
 
 template <typename Configuration>
@@ -1912,6 +2255,7 @@ ResourceId ResourceManager<Configuration>::GetLiveID(ResourceId id)
   if(id == ResourceId())
     return id;
 
-  RDCASSERT(m_LiveIDs.find(id) != m_LiveIDs.end(), id);
-  return m_LiveIDs[id];
+  const ResourceId *live = m_LiveIDs.Find(id);
+  RDCASSERT(live, id);
+  return live ? *live : ResourceId();
 }
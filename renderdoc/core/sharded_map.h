@@ -0,0 +1,243 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+#include "api/replay/rdcpair.h"
+#include "common/threading.h"
+
+// the hash used to pick a shard. Key types without a std::hash specialisation can provide an
+// overload of this function alongside their declaration.
+template <typename Key>
+inline uint64_t ShardHash(const Key &key)
+{
+  return (uint64_t)std::hash<Key>()(key);
+}
+
+// Containers split into a fixed number of shards, each an ordered container with its own lock.
+// Threads operating on different keys will rarely contend, unlike with one lock around the whole
+// container. Single-key operations are atomic, and iterating takes a sorted snapshot of the
+// elements one shard at a time.
+template <typename Container, uint32_t NumShards>
+class ShardedContainer
+{
+public:
+  size_t size() const
+  {
+    size_t ret = 0;
+    for(const Shard &s : m_Shards)
+    {
+      SCOPED_LOCK(s.lock);
+      ret += s.data.size();
+    }
+    return ret;
+  }
+
+  bool empty() const { return size() == 0; }
+  void clear()
+  {
+    for(Shard &s : m_Shards)
+    {
+      SCOPED_LOCK(s.lock);
+      s.data.clear();
+    }
+  }
+
+  // removes all elements, calling func with each. Each shard is emptied under its lock and then the
+  // callback is called without any lock held, so it's free to access this container.
+  template <typename Func>
+  void Drain(Func func)
+  {
+    for(Shard &s : m_Shards)
+    {
+      Container data;
+      {
+        SCOPED_LOCK(s.lock);
+        data.swap(s.data);
+      }
+      for(auto it = data.begin(); it != data.end(); ++it)
+        func(*it);
+    }
+  }
+
+protected:
+  struct Shard
+  {
+    mutable Threading::CriticalSection lock;
+    Container data;
+
+    // keep neighbouring shards' locks off the same cache line. We can't rely on alignas here as
+    // the containing objects are heap allocated without over-aligned new.
+    byte padding[64];
+  };
+
+  template <typename Key>
+  Shard &GetShard(const Key &key)
+  {
+    return m_Shards[ShardIndex(key)];
+  }
+
+  template <typename Key>
+  const Shard &GetShard(const Key &key) const
+  {
+    return m_Shards[ShardIndex(key)];
+  }
+
+  Shard m_Shards[NumShards];
+
+private:
+  template <typename Key>
+  static uint32_t ShardIndex(const Key &key)
+  {
+    // mix the bits, as identity hashes of sequential IDs or aligned pointers share their low bits
+    uint64_t h = ShardHash(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return uint32_t(h % NumShards);
+  }
+};
+
+template <typename Key, typename Value, uint32_t NumShards = 16>
+class ShardedMap : public ShardedContainer<std::map<Key, Value>, NumShards>
+{
+  typedef ShardedContainer<std::map<Key, Value>, NumShards> Base;
+
+public:
+  bool Contains(const Key &key) const
+  {
+    const typename Base::Shard &s = Base::GetShard(key);
+    SCOPED_LOCK(s.lock);
+    return s.data.find(key) != s.data.end();
+  }
+
+  // returns the value for key, or a default-constructed value if it's not present
+  Value Find(const Key &key) const
+  {
+    const typename Base::Shard &s = Base::GetShard(key);
+    SCOPED_LOCK(s.lock);
+    auto it = s.data.find(key);
+    if(it == s.data.end())
+      return Value();
+    return it->second;
+  }
+
+  // sets the value for key, returns the previous value or a default-constructed value
+  Value Set(const Key &key, const Value &value)
+  {
+    typename Base::Shard &s = Base::GetShard(key);
+    SCOPED_LOCK(s.lock);
+    Value &el = s.data[key];
+    Value ret = el;
+    el = value;
+    return ret;
+  }
+
+  bool Erase(const Key &key)
+  {
+    typename Base::Shard &s = Base::GetShard(key);
+    SCOPED_LOCK(s.lock);
+    return s.data.erase(key) > 0;
+  }
+
+  // calls func(Value &value, bool inserted) with the key's shard locked, inserting a
+  // default-constructed value first if it's not present. Returns whether the key was inserted.
+  template <typename Func>
+  bool Update(const Key &key, Func func)
+  {
+    typename Base::Shard &s = Base::GetShard(key);
+    SCOPED_LOCK(s.lock);
+    auto it = s.data.find(key);
+    bool inserted = false;
+    if(it == s.data.end())
+    {
+      it = s.data.insert(std::make_pair(key, Value())).first;
+      inserted = true;
+    }
+    func(it->second, inserted);
+    return inserted;
+  }
+
+  rdcarray<rdcpair<Key, Value>> Snapshot() const
+  {
+    rdcarray<rdcpair<Key, Value>> ret;
+    for(const typename Base::Shard &s : Base::m_Shards)
+    {
+      SCOPED_LOCK(s.lock);
+      for(auto it = s.data.begin(); it != s.data.end(); ++it)
+        ret.push_back(make_rdcpair(it->first, it->second));
+    }
+    std::sort(ret.begin(), ret.end(),
+              [](const rdcpair<Key, Value> &a, const rdcpair<Key, Value> &b) {
+                return a.first < b.first;
+              });
+    return ret;
+  }
+};
+
+template <typename Key, uint32_t NumShards = 16>
+class ShardedSet : public ShardedContainer<std::set<Key>, NumShards>
+{
+  typedef ShardedContainer<std::set<Key>, NumShards> Base;
+
+public:
+  bool Contains(const Key &key) const
+  {
+    const typename Base::Shard &s = Base::GetShard(key);
+    SCOPED_LOCK(s.lock);
+    return s.data.find(key) != s.data.end();
+  }
+
+  // returns true if the key was newly inserted
+  bool Insert(const Key &key)
+  {
+    typename Base::Shard &s = Base::GetShard(key);
+    SCOPED_LOCK(s.lock);
+    return s.data.insert(key).second;
+  }
+
+  bool Erase(const Key &key)
+  {
+    typename Base::Shard &s = Base::GetShard(key);
+    SCOPED_LOCK(s.lock);
+    return s.data.erase(key) > 0;
+  }
+
+  rdcarray<Key> Snapshot() const
+  {
+    rdcarray<Key> ret;
+    for(const typename Base::Shard &s : Base::m_Shards)
+    {
+      SCOPED_LOCK(s.lock);
+      for(auto it = s.data.begin(); it != s.data.end(); ++it)
+        ret.push_back(*it);
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+  }
+};
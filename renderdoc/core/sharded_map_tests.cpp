@@ -0,0 +1,225 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/globalconfig.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "sharded_map.h"
+#include "api/replay/resourceid.h"
+#include "common/formatting.h"
+#include "common/timing.h"
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Test sharded map and set", "[sharded_map]")
+{
+  SECTION("map operations")
+  {
+    ShardedMap<uint64_t, int> map;
+
+    CHECK(map.empty());
+    CHECK(map.Find(5) == 0);
+
+    CHECK(map.Set(5, 10) == 0);
+    CHECK(map.Set(5, 20) == 10);
+    CHECK(map.Contains(5));
+    CHECK_FALSE(map.Contains(6));
+    CHECK(map.Find(5) == 20);
+    CHECK(map.size() == 1);
+
+    bool inserted = map.Update(6, [](int &val, bool ins) {
+      CHECK(ins);
+      val += 3;
+    });
+    CHECK(inserted);
+
+    inserted = map.Update(6, [](int &val, bool ins) {
+      CHECK_FALSE(ins);
+      val += 3;
+    });
+    CHECK_FALSE(inserted);
+    CHECK(map.Find(6) == 6);
+
+    CHECK(map.Erase(5));
+    CHECK_FALSE(map.Erase(5));
+    CHECK(map.size() == 1);
+
+    map.clear();
+    CHECK(map.empty());
+  };
+
+  SECTION("snapshots are sorted")
+  {
+    ShardedMap<uint64_t, uint64_t> map;
+    ShardedSet<uint64_t> set;
+
+    for(uint64_t i = 0; i < 500; i++)
+    {
+      uint64_t key = (i * 7919) % 1000;
+      map.Set(key, key * 2);
+      CHECK(set.Insert(key));
+      CHECK_FALSE(set.Insert(key));
+    }
+
+    rdcarray<rdcpair<uint64_t, uint64_t>> mapSnap = map.Snapshot();
+    rdcarray<uint64_t> setSnap = set.Snapshot();
+
+    REQUIRE(mapSnap.size() == 500);
+    REQUIRE(setSnap.size() == 500);
+
+    for(size_t i = 0; i < 500; i++)
+    {
+      CHECK(mapSnap[i].second == mapSnap[i].first * 2);
+      CHECK(mapSnap[i].first == setSnap[i]);
+      if(i > 0)
+      {
+        CHECK(mapSnap[i - 1].first < mapSnap[i].first);
+      }
+    }
+  };
+
+  SECTION("drain")
+  {
+    ShardedMap<ResourceId, int> map;
+
+    rdcarray<ResourceId> ids;
+    for(int i = 0; i < 100; i++)
+    {
+      ids.push_back(ResourceIDGen::GetNewUniqueID());
+      map.Set(ids.back(), i);
+    }
+
+    int sum = 0, count = 0;
+    map.Drain([&](const std::pair<const ResourceId, int> &el) {
+      // the callback can safely re-enter the map
+      map.Contains(el.first);
+      sum += el.second;
+      count++;
+    });
+
+    CHECK(count == 100);
+    CHECK(sum == 99 * 100 / 2);
+    CHECK(map.empty());
+  };
+
+  SECTION("concurrent updates")
+  {
+    ShardedMap<uint64_t, uint32_t> map;
+    ShardedSet<uint64_t> set;
+
+    const uint64_t numThreads = 8;
+    const uint64_t numKeys = 4096;
+
+    rdcarray<Threading::ThreadHandle> threads;
+
+    // every thread touches every key, so each value should end up incremented once per thread
+    for(uint64_t t = 0; t < numThreads; t++)
+    {
+      threads.push_back(Threading::CreateThread([&map, &set, t, numKeys]() {
+        for(uint64_t i = 0; i < numKeys; i++)
+        {
+          uint64_t key = (i + t * 97) % numKeys;
+          map.Update(key, [](uint32_t &val, bool) { val++; });
+          set.Insert(key);
+        }
+      }));
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    CHECK(map.size() == numKeys);
+    CHECK(set.size() == numKeys);
+
+    uint64_t mismatches = 0;
+    for(const rdcpair<uint64_t, uint32_t> &el : map.Snapshot())
+      if(el.second != numThreads)
+        mismatches++;
+
+    CHECK(mismatches == 0);
+  };
+}
+
+TEST_CASE("Benchmark resource table contention", "[.][benchmark]")
+{
+  const int numThreads = 8;
+  const uint64_t numKeys = 8192;
+  const uint64_t numOps = 200000;
+
+  rdcarray<ResourceId> ids;
+  for(uint64_t i = 0; i < numKeys; i++)
+    ids.push_back(ResourceIDGen::GetNewUniqueID());
+
+  // mimics the capture-time pattern of marking references and checking dirty state from many
+  // threads at once
+  auto run = [&](const char *name, std::function<void(ResourceId)> op) {
+    PerformanceTimer timer;
+
+    rdcarray<Threading::ThreadHandle> threads;
+    for(int t = 0; t < numThreads; t++)
+    {
+      threads.push_back(Threading::CreateThread([&ids, &op, t, numKeys, numOps]() {
+        uint64_t idx = uint64_t(t) * 1013;
+        for(uint64_t i = 0; i < numOps; i++)
+        {
+          idx = (idx * 6364136223846793005ULL + 1442695040888963407ULL);
+          op(ids[(idx >> 33) % numKeys]);
+        }
+      }));
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    double ms = timer.GetMilliseconds();
+
+    WARN(StringFormat::Fmt("%s: %.2f ms, %.1f Mops/s", name, ms,
+                           double(numThreads * numOps) / (ms * 1000.0)));
+  };
+
+  {
+    Threading::CriticalSection lock;
+    std::map<ResourceId, uint32_t> refs;
+
+    run("Single lock", [&lock, &refs](ResourceId id) {
+      SCOPED_LOCK(lock);
+      refs[id]++;
+    });
+  }
+
+  {
+    ShardedMap<ResourceId, uint32_t> refs;
+
+    run("Sharded", [&refs](ResourceId id) { refs.Update(id, [](uint32_t &val, bool) { val++; }); });
+  }
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -23,6 +23,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <set>
 #include "android/android.h"
 #include "api/replay/renderdoc_replay.h"
 #include "common/threading.h"
@@ -30,9 +31,12 @@
 #include "jpeg-compressor/jpgd.h"
 #include "os/os_specific.h"
 #include "replay/replay_driver.h"
+#include "core/settings.h"
 #include "serialise/serialiser.h"
 
-static const uint32_t TargetControlProtocolVersion = 6;
+RDOC_EXTERN_CONFIG(bool, RemoteServer_CompressCaptureCopies);
+
+static const uint32_t TargetControlProtocolVersion = 7;
 
 static bool IsProtocolVersionSupported(const uint32_t protocolVersion)
 {
@@ -52,6 +56,10 @@ static bool IsProtocolVersionSupported(const uint32_t protocolVersion)
   if(protocolVersion == 5)
     return true;
 
+  // 6 -> 7 optionally compress capture copies
+  if(protocolVersion == 6)
+    return true;
+
   if(protocolVersion == TargetControlProtocolVersion)
     return true;
 
@@ -342,10 +350,15 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
         caps = RenderDoc::Inst().GetCaptures();
 
         uint32_t id;
+        bool compress = false;
 
         {
           READ_DATA_SCOPE();
           SERIALISE_ELEMENT(id);
+          if(version >= 7)
+          {
+            SERIALISE_ELEMENT(compress);
+          }
         }
 
         if(id < caps.size())
@@ -357,7 +370,10 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
           rdcstr filename = caps[id].path;
 
           StreamReader fileStream(FileIO::fopen(filename.c_str(), "rb"));
-          ser.SerialiseStream(filename, fileStream);
+          if(compress)
+            ser.SerialiseCompressedStream(filename, fileStream, NULL);
+          else
+            ser.SerialiseStream(filename, fileStream);
 
           if(fileStream.IsErrored() || ser.IsErrored())
             SAFE_DELETE(client);
@@ -632,6 +648,16 @@ public:
 
     SERIALISE_ELEMENT(remoteID);
 
+    bool compress = RemoteServer_CompressCaptureCopies();
+    if(m_Version >= 7)
+    {
+      SERIALISE_ELEMENT(compress);
+    }
+    else
+    {
+      compress = false;
+    }
+
     if(ser.IsErrored())
     {
       SAFE_DELETE(m_Socket);
@@ -639,6 +665,8 @@ public:
     }
 
     m_CaptureCopies[remoteID] = localpath;
+    if(compress)
+      m_CompressedCopies.insert(remoteID);
   }
 
   void DeleteCapture(uint32_t remoteID)
@@ -844,7 +872,10 @@ public:
 
       StreamWriter streamWriter(FileIO::fopen(msg.newCapture.path.c_str(), "wb"), Ownership::Stream);
 
-      ser.SerialiseStream(msg.newCapture.path.c_str(), streamWriter, progress);
+      if(m_CompressedCopies.erase(msg.newCapture.captureId))
+        ser.SerialiseCompressedStream(msg.newCapture.path.c_str(), streamWriter, progress);
+      else
+        ser.SerialiseStream(msg.newCapture.path.c_str(), streamWriter, progress);
 
       if(reader.IsErrored())
       {
@@ -854,6 +885,10 @@ public:
         return msg;
       }
 
+      if(streamWriter.IsErrored())
+        RDCERR("Capture copy to '%s' was corrupted or couldn't be written",
+               msg.newCapture.path.c_str());
+
       m_CaptureCopies.erase(msg.newCapture.captureId);
 
       reader.EndChunk();
@@ -887,6 +922,7 @@ private:
   uint32_t m_Version, m_PID;
 
   std::map<uint32_t, rdcstr> m_CaptureCopies;
+  std::set<uint32_t> m_CompressedCopies;
 };
 
 extern "C" RENDERDOC_API ITargetControl *RENDERDOC_CC RENDERDOC_CreateTargetControl(
@@ -524,6 +524,11 @@ bool D3D11InitParams::IsSupportedVersion(uint64_t ver)
   if(ver == 0x11)
     return true;
 
+  // 0x12 -> 0x13 - large buffers can be stored once in a separate buffer store section,
+  // referenced by their size with the top bit set
+  if(ver == 0x12)
+    return true;
+
   return false;
 }
 
@@ -1297,6 +1297,9 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
   if(sectionIdx < 0)
     return ReplayStatus::FileCorrupted;
 
+  // the buffer store is read before the frame capture, since section readers share the file
+  BufferStore *bufferStore = rdc->ReadBufferStore();
+
   StreamReader *reader = rdc->ReadSection(sectionIdx);
 
   if(IsStructuredExporting(m_State))
@@ -1314,6 +1317,7 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
   if(reader->IsErrored())
   {
     delete reader;
+    delete bufferStore;
     return ReplayStatus::FileIOFailed;
   }
 
@@ -1321,6 +1325,7 @@ ReplayStatus WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool store
 
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
+  ser.SetBufferStore(bufferStore, Ownership::Stream);
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
 
@@ -2088,6 +2093,10 @@ bool WrappedID3D11Device::EndFrameCapture(void *dev, void *wnd)
 
       ser.SetUserData(GetResourceManager());
 
+      // large buffers like initial contents are stored once per unique contents
+      if(rdc)
+        ser.SetBufferStore(rdc->GetBufferStore(), Ownership::Nothing);
+
       {
         // remember to update this estimated chunk length if you add more parameters
         SCOPED_SERIALISE_CHUNK(SystemChunk::DriverInit, sizeof(D3D11InitParams) + 16);
@@ -2955,6 +2955,21 @@ rdcarray<ShaderDebugState> D3D11Replay::ContinueDebug(ShaderDebugger *debugger)
   return interpreter->ContinueDebug(&apiWrapper);
 }
 
+ShaderDebugState D3D11Replay::RunDebug(ShaderDebugger *debugger,
+                                       const rdcarray<uint32_t> &breakpoints)
+{
+  DXBCDebug::InterpretDebugger *interpreter = (DXBCDebug::InterpretDebugger *)debugger;
+
+  if(!interpreter)
+    return {};
+
+  D3D11DebugAPIWrapper apiWrapper(m_pDevice, interpreter->dxbc, interpreter->global);
+
+  D3D11MarkerRegion region("RunDebug Simulation Loop");
+
+  return interpreter->RunDebug(&apiWrapper, breakpoints);
+}
+
 void D3D11Replay::FreeDebugger(ShaderDebugger *debugger)
 {
   delete debugger;
@@ -223,6 +223,11 @@ bool D3D12InitParams::IsSupportedVersion(uint64_t ver)
   if(ver == 0x9)
     return true;
 
+  // 0xA -> 0xB - Large buffers can be stored once in a separate buffer store section, referenced
+  //              by their size with the top bit set
+  if(ver == 0xA)
+    return true;
+
   return false;
 }
 
@@ -2434,6 +2434,10 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
 
     ser.SetUserData(GetResourceManager());
 
+    // large buffers like initial contents are stored once per unique contents
+    if(rdc)
+      ser.SetBufferStore(rdc->GetBufferStore(), Ownership::Nothing);
+
     m_InitParams.usedDXIL = m_UsedDXIL;
 
     if(m_UsedDXIL)
@@ -3696,6 +3700,9 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
   if(sectionIdx < 0)
     return ReplayStatus::FileCorrupted;
 
+  // the buffer store is read before the frame capture, since section readers share the file
+  BufferStore *bufferStore = rdc->ReadBufferStore();
+
   StreamReader *reader = rdc->ReadSection(sectionIdx);
 
   if(IsStructuredExporting(m_State))
@@ -3713,6 +3720,7 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
   if(reader->IsErrored())
   {
     delete reader;
+    delete bufferStore;
     return ReplayStatus::FileIOFailed;
   }
 
@@ -3722,6 +3730,7 @@ ReplayStatus WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool store
 
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
+  ser.SetBufferStore(bufferStore, Ownership::Stream);
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
 
@@ -52,7 +52,7 @@ struct D3D12InitParams
   uint32_t VendorUAVSpace = ~0U;
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0xA;
+  static const uint64_t CurrentVersion = 0xB;
 
   static bool IsSupportedVersion(uint64_t ver);
 };
@@ -3047,6 +3047,21 @@ rdcarray<ShaderDebugState> D3D12Replay::ContinueDebug(ShaderDebugger *debugger)
   return interpreter->ContinueDebug(&apiWrapper);
 }
 
+ShaderDebugState D3D12Replay::RunDebug(ShaderDebugger *debugger,
+                                       const rdcarray<uint32_t> &breakpoints)
+{
+  DXBCDebug::InterpretDebugger *interpreter = (DXBCDebug::InterpretDebugger *)debugger;
+
+  if(!interpreter)
+    return {};
+
+  D3D12DebugAPIWrapper apiWrapper(m_pDevice, interpreter->dxbc, interpreter->global);
+
+  D3D12MarkerRegion region(m_pDevice->GetQueue()->GetReal(), "RunDebug Simulation Loop");
+
+  return interpreter->RunDebug(&apiWrapper, breakpoints);
+}
+
 void D3D12Replay::FreeDebugger(ShaderDebugger *debugger)
 {
   delete debugger;
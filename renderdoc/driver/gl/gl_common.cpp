@@ -1198,6 +1198,11 @@ bool GLInitParams::IsSupportedVersion(uint64_t ver)
   if(ver == 0x22)
     return true;
 
+  // 0x23 -> 0x24 - Large buffers can be stored once in a separate buffer store section,
+  //                referenced by their size with the top bit set
+  if(ver == 0x23)
+    return true;
+
   return false;
 }
 
@@ -450,7 +450,9 @@ T CheckConstParam(T t);
   template bool WrappedOpenGL::CONCAT(Serialise_, func(ReadSerialiser &ser, ##__VA_ARGS__)); \
   template bool WrappedOpenGL::CONCAT(Serialise_, func(WriteSerialiser &ser, ##__VA_ARGS__));
 
-#define USE_SCRATCH_SERIALISER() WriteSerialiser &ser = m_ScratchSerialiser;
+#define USE_SCRATCH_SERIALISER()            \
+  WriteSerialiser &ser = m_ScratchSerialiser; \
+  PrepareScratchSerialiser();
 
 #define SERIALISE_TIME_CALL(...)                                          \
   m_ScratchSerialiser.ChunkMetadata().timestampMicro = Timing::GetTick(); \
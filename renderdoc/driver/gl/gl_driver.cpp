@@ -942,15 +942,10 @@ WrappedOpenGL::~WrappedOpenGL()
 
   GetResourceManager()->ReleaseCurrentResource(m_DeviceResourceID);
 
+  m_ScratchSerialiser.GetWriter()->ClearExternalBuffer();
+
   for(auto it = m_ContextData.begin(); it != m_ContextData.end(); ++it)
-  {
-    if(it->second.m_ContextDataRecord)
-    {
-      RDCASSERT(it->second.m_ContextDataRecord->GetRefCount() == 1);
-      it->second.m_ContextDataRecord->Delete(GetResourceManager());
-      GetResourceManager()->ReleaseCurrentResource(it->second.m_ContextDataResourceID);
-    }
-  }
+    it->second.DeleteResourceRecord(this);
 
   if(m_ContextRecord)
   {
@@ -1001,6 +996,30 @@ GLResourceRecord *WrappedOpenGL::GetContextRecord()
   }
 }
 
+ChunkAllocator *WrappedOpenGL::GetContextChunkAllocator()
+{
+  GLContextTLSData *ret = (GLContextTLSData *)Threading::GetTLSValue(m_CurCtxDataTLS);
+  if(ret && ret->ctxAlloc)
+  {
+    return ret->ctxAlloc;
+  }
+  else
+  {
+    ContextData &dat = GetCtxData();
+    dat.CreateResourceRecord(this, GetCtx().ctx);
+    return dat.m_ChunkAlloc;
+  }
+}
+
+void WrappedOpenGL::PrepareScratchSerialiser()
+{
+  // while capturing, most chunks end up in the context record so serialise them straight into the
+  // context's chunk pages. Anything that doesn't will just be copied out as normal. If a chunk is
+  // already in progress, leave it alone.
+  if(IsActiveCapturing(m_State) && m_ScratchSerialiser.GetWriter()->GetOffset() == 0)
+    GetContextChunkAllocator()->SerialiseInPlace(m_ScratchSerialiser);
+}
+
 void WrappedOpenGL::CheckImplicitThread()
 {
   if(IsActiveCapturing(m_State) && m_LastCtx != GetCtx().ctx)
@@ -1011,7 +1030,7 @@ void WrappedOpenGL::CheckImplicitThread()
     SCOPED_SERIALISE_CHUNK(GLChunk::ImplicitThreadSwitch);
     Serialise_ContextConfiguration(ser, m_LastCtx);
     Serialise_BeginCaptureFrame(ser);
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1071,13 +1090,9 @@ void WrappedOpenGL::DeleteContext(void *contextHandle)
   if(ctxdata.m_ClientMemoryIBO)
     glDeleteBuffers(1, &ctxdata.m_ClientMemoryIBO);
 
-  if(ctxdata.m_ContextDataRecord)
-  {
-    RDCASSERT(ctxdata.m_ContextDataRecord->GetRefCount() == 1);
-    ctxdata.m_ContextDataRecord->Delete(GetResourceManager());
-    GetResourceManager()->ReleaseCurrentResource(ctxdata.m_ContextDataResourceID);
-    ctxdata.m_ContextDataRecord = NULL;
-  }
+  m_ScratchSerialiser.GetWriter()->ClearExternalBuffer();
+
+  ctxdata.DeleteResourceRecord(this);
 
   m_LastContexts.removeOneIf(
       [contextHandle](const GLWindowingData &ctx) { return ctx.ctx == contextHandle; });
@@ -1133,9 +1148,30 @@ void WrappedOpenGL::ContextData::CreateResourceRecord(WrappedOpenGL *driver, voi
     m_ContextDataRecord->DataInSerialiser = false;
     m_ContextDataRecord->Length = 0;
     m_ContextDataRecord->InternalResource = true;
+
+    if(!m_ChunkAlloc)
+    {
+      m_ChunkPool = new ChunkPagePool(1024 * 1024);
+      m_ChunkAlloc = new ChunkAllocator(*m_ChunkPool);
+    }
   }
 }
 
+void WrappedOpenGL::ContextData::DeleteResourceRecord(WrappedOpenGL *driver)
+{
+  if(m_ContextDataRecord)
+  {
+    RDCASSERT(m_ContextDataRecord->GetRefCount() == 1);
+    m_ContextDataRecord->Delete(driver->GetResourceManager());
+    driver->GetResourceManager()->ReleaseCurrentResource(m_ContextDataResourceID);
+    m_ContextDataRecord = NULL;
+  }
+
+  // the record's chunks are gone, so the pages they were allocated from can go too
+  SAFE_DELETE(m_ChunkAlloc);
+  SAFE_DELETE(m_ChunkPool);
+}
+
 void WrappedOpenGL::CreateContext(GLWindowingData winData, void *shareContext,
                                   GLInitParams initParams, bool core, bool attribsCreate)
 {
@@ -1367,11 +1403,12 @@ void WrappedOpenGL::ActivateContext(GLWindowingData winData)
     {
       tlsData->ctxPair = {winData.ctx, GetShareGroup(winData.ctx)};
       tlsData->ctxRecord = ctxdata.m_ContextDataRecord;
+      tlsData->ctxAlloc = ctxdata.m_ChunkAlloc;
     }
     else
     {
       tlsData = new GLContextTLSData(ContextPair({winData.ctx, GetShareGroup(winData.ctx)}),
-                                     ctxdata.m_ContextDataRecord);
+                                     ctxdata.m_ContextDataRecord, ctxdata.m_ChunkAlloc);
       m_CtxDataVector.push_back(tlsData);
 
       Threading::SetTLSValue(m_CurCtxDataTLS, tlsData);
@@ -1544,7 +1581,7 @@ void WrappedOpenGL::ActivateContext(GLWindowingData winData)
       USE_SCRATCH_SERIALISER();
       SCOPED_SERIALISE_CHUNK(GLChunk::MakeContextCurrent);
       Serialise_BeginCaptureFrame(ser);
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     }
 
     // also serialise out this context's backbuffer params
@@ -1552,7 +1589,7 @@ void WrappedOpenGL::ActivateContext(GLWindowingData winData)
       USE_SCRATCH_SERIALISER();
       SCOPED_SERIALISE_CHUNK(GLChunk::ContextConfiguration);
       Serialise_ContextConfiguration(ser, winData.ctx);
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     }
 
     // update the last context so we don't record an implicit switch
@@ -2113,7 +2150,7 @@ void WrappedOpenGL::SwapBuffers(WindowingSystem winSystem, void *windowHandle)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_Present(ser);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 
   RenderDoc::Inst().AddActiveDriver(GetDriverType(), true);
@@ -2215,7 +2252,7 @@ void WrappedOpenGL::StartFrameCapture(void *dev, void *wnd)
     USE_SCRATCH_SERIALISER();
     SCOPED_SERIALISE_CHUNK(GLChunk::ContextConfiguration);
     Serialise_ContextConfiguration(ser, GetCtx().ctx);
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 
   // if we changed contexts above, pop back to where we were
@@ -2306,6 +2343,10 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
 
       ser.SetUserData(GetResourceManager());
 
+      // large buffers like initial contents are stored once per unique contents
+      if(rdc)
+        ser.SetBufferStore(rdc->GetBufferStore(), Ownership::Nothing);
+
       {
         // we no longer use this one, but for ease of compatibility we still serialise it here. This
         // will be immediately overridden by the actual parameters by a
@@ -2496,7 +2537,7 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
         USE_SCRATCH_SERIALISER();
         SCOPED_SERIALISE_CHUNK(GLChunk::ContextConfiguration);
         Serialise_ContextConfiguration(ser, GetCtx().ctx);
-        GetContextRecord()->AddChunk(scope.Get());
+        GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
       }
     }
 
@@ -2736,9 +2777,18 @@ void WrappedOpenGL::CleanupCapture()
 
   CleanupResourceRecord(m_ContextRecord, true);
 
+  m_ScratchSerialiser.GetWriter()->ClearExternalBuffer();
+
   for(auto it = m_ContextData.begin(); it != m_ContextData.end(); ++it)
   {
     CleanupResourceRecord(it->second.m_ContextDataRecord, true);
+
+    // all the chunks allocated from the context's pages are gone, release the memory
+    if(it->second.m_ChunkAlloc)
+    {
+      it->second.m_ChunkAlloc->Reset();
+      it->second.m_ChunkPool->Trim();
+    }
   }
 }
 
@@ -2957,9 +3007,14 @@ void WrappedOpenGL::AttemptCapture()
 
     CleanupResourceRecord(m_ContextRecord, false);
 
+    m_ScratchSerialiser.GetWriter()->ClearExternalBuffer();
+
     for(auto it = m_ContextData.begin(); it != m_ContextData.end(); ++it)
     {
       CleanupResourceRecord(it->second.m_ContextDataRecord, false);
+
+      if(it->second.m_ChunkAlloc)
+        it->second.m_ChunkAlloc->Reset();
     }
   }
 }
@@ -3255,6 +3310,9 @@ ReplayStatus WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   if(sectionIdx < 0)
     return ReplayStatus::FileCorrupted;
 
+  // the buffer store is read before the frame capture, since section readers share the file
+  BufferStore *bufferStore = rdc->ReadBufferStore();
+
   StreamReader *reader = rdc->ReadSection(sectionIdx);
 
   if(IsStructuredExporting(m_State))
@@ -3272,6 +3330,7 @@ ReplayStatus WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   if(reader->IsErrored())
   {
     delete reader;
+    delete bufferStore;
     return ReplayStatus::FileIOFailed;
   }
 
@@ -3279,6 +3338,7 @@ ReplayStatus WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
+  ser.SetBufferStore(bufferStore, Ownership::Stream);
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
 
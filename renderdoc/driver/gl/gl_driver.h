@@ -59,7 +59,7 @@ struct GLInitParams
   rdcstr renderer, version;
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x23;
+  static const uint64_t CurrentVersion = 0x24;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -391,6 +391,8 @@ private:
       RDCEraseEl(m_ClientMemoryVBOs);
       m_ClientMemoryIBO = 0;
       m_ContextDataResourceID = ResourceId();
+      m_ChunkPool = NULL;
+      m_ChunkAlloc = NULL;
     }
 
     void *ctx;
@@ -500,6 +502,13 @@ private:
     ResourceId m_ContextDataResourceID;
     GLResourceRecord *m_ContextDataRecord;
 
+    // chunks recorded into m_ContextDataRecord during a capture all live exactly as long as the
+    // capture, so they're allocated from pages owned by the context and released together
+    ChunkPagePool *m_ChunkPool;
+    ChunkAllocator *m_ChunkAlloc;
+
+    void DeleteResourceRecord(WrappedOpenGL *driver);
+
     ResourceId m_ContextFBOID;
 
   private:
@@ -606,6 +615,8 @@ public:
   RDCDriver GetDriverType() { return m_DriverType; }
   ContextPair &GetCtx();
   GLResourceRecord *GetContextRecord();
+  ChunkAllocator *GetContextChunkAllocator();
+  void PrepareScratchSerialiser();
 
   void CheckImplicitThread();
 
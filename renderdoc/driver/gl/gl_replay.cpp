@@ -3687,6 +3687,12 @@ rdcarray<ShaderDebugState> GLReplay::ContinueDebug(ShaderDebugger *debugger)
   return {};
 }
 
+ShaderDebugState GLReplay::RunDebug(ShaderDebugger *debugger, const rdcarray<uint32_t> &breakpoints)
+{
+  GLNOTIMP("RunDebug");
+  return {};
+}
+
 void GLReplay::FreeDebugger(ShaderDebugger *debugger)
 {
   delete debugger;
@@ -321,8 +321,12 @@ private:
 
 struct GLContextTLSData
 {
-  GLContextTLSData() : ctxPair({NULL, NULL}), ctxRecord(NULL) {}
-  GLContextTLSData(ContextPair p, GLResourceRecord *r) : ctxPair(p), ctxRecord(r) {}
+  GLContextTLSData() : ctxPair({NULL, NULL}), ctxRecord(NULL), ctxAlloc(NULL) {}
+  GLContextTLSData(ContextPair p, GLResourceRecord *r, ChunkAllocator *a)
+      : ctxPair(p), ctxRecord(r), ctxAlloc(a)
+  {
+  }
   ContextPair ctxPair;
   GLResourceRecord *ctxRecord;
+  ChunkAllocator *ctxAlloc;
 };
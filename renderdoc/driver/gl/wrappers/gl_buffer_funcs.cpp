@@ -1367,7 +1367,7 @@ void WrappedOpenGL::glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
       SCOPED_SERIALISE_CHUNK(gl_CurChunk);
       Serialise_glBindBufferBase(ser, target, index, buffer);
 
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     }
   }
 }
@@ -1501,7 +1501,7 @@ void WrappedOpenGL::glBindBufferRange(GLenum target, GLuint index, GLuint buffer
       SCOPED_SERIALISE_CHUNK(gl_CurChunk);
       Serialise_glBindBufferRange(ser, target, index, buffer, offset, size);
 
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     }
   }
 }
@@ -1670,7 +1670,7 @@ void WrappedOpenGL::glBindBuffersBase(GLenum target, GLuint first, GLsizei count
       SCOPED_SERIALISE_CHUNK(gl_CurChunk);
       Serialise_glBindBuffersBase(ser, target, first, count, buffers);
 
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     }
   }
 }
@@ -1884,7 +1884,7 @@ void WrappedOpenGL::glBindBuffersRange(GLenum target, GLuint first, GLsizei coun
       SCOPED_SERIALISE_CHUNK(gl_CurChunk);
       Serialise_glBindBuffersRange(ser, target, first, count, buffers, offsets, sizes);
 
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     }
   }
 }
@@ -1958,7 +1958,7 @@ void WrappedOpenGL::glInvalidateBufferData(GLuint buffer)
       SCOPED_SERIALISE_CHUNK(gl_CurChunk);
       Serialise_glInvalidateBufferData(ser, buffer);
 
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     }
     else
     {
@@ -2037,7 +2037,7 @@ void WrappedOpenGL::glInvalidateBufferSubData(GLuint buffer, GLintptr offset, GL
       SCOPED_SERIALISE_CHUNK(gl_CurChunk);
       Serialise_glInvalidateBufferSubData(ser, buffer, offset, length);
 
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     }
     else
     {
@@ -2674,7 +2674,7 @@ GLboolean WrappedOpenGL::glUnmapNamedBufferEXT(GLuint buffer)
           USE_SCRATCH_SERIALISER();
           SCOPED_SERIALISE_CHUNK(gl_CurChunk);
           Serialise_glUnmapNamedBufferEXT(ser, buffer);
-          GetContextRecord()->AddChunk(scope.Get());
+          GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
         }
 
         {
@@ -2860,7 +2860,7 @@ void WrappedOpenGL::glFlushMappedNamedBufferRangeEXT(GLuint buffer, GLintptr off
           USE_SCRATCH_SERIALISER();
           SCOPED_SERIALISE_CHUNK(gl_CurChunk);
           Serialise_glFlushMappedNamedBufferRangeEXT(ser, buffer, offset, length);
-          GetContextRecord()->AddChunk(scope.Get());
+          GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
         }
         else
         {
@@ -2895,7 +2895,7 @@ void WrappedOpenGL::glFlushMappedNamedBufferRangeEXT(GLuint buffer, GLintptr off
         USE_SCRATCH_SERIALISER();
         SCOPED_SERIALISE_CHUNK(gl_CurChunk);
         Serialise_glFlushMappedNamedBufferRangeEXT(ser, buffer, offset, length);
-        GetContextRecord()->AddChunk(scope.Get());
+        GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
 
         // update the comparison buffer
         if(IsActiveCapturing(m_State) && record->GetShadowPtr(1))
@@ -3153,7 +3153,7 @@ void WrappedOpenGL::glTransformFeedbackBufferBase(GLuint xfb, GLuint index, GLui
 
     if(IsActiveCapturing(m_State))
     {
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     }
     else if(xfb != 0)
     {
@@ -3217,7 +3217,7 @@ void WrappedOpenGL::glTransformFeedbackBufferRange(GLuint xfb, GLuint index, GLu
 
     if(IsActiveCapturing(m_State))
     {
-      GetContextRecord()->AddChunk(scope.Get());
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
       GetResourceManager()->MarkResourceFrameReferenced(BufferRes(GetCtx(), buffer),
                                                         eFrameRef_ReadBeforeWrite);
     }
@@ -3276,7 +3276,7 @@ void WrappedOpenGL::glBindTransformFeedback(GLenum target, GLuint id)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBindTransformFeedback(ser, target, id);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
 
     if(record)
       GetResourceManager()->MarkResourceFrameReferenced(record->GetResourceID(), eFrameRef_Read);
@@ -3310,7 +3310,7 @@ void WrappedOpenGL::glBeginTransformFeedback(GLenum primitiveMode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBeginTransformFeedback(ser, primitiveMode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -3335,7 +3335,7 @@ void WrappedOpenGL::glPauseTransformFeedback()
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPauseTransformFeedback(ser);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -3360,7 +3360,7 @@ void WrappedOpenGL::glResumeTransformFeedback()
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glResumeTransformFeedback(ser);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -3387,7 +3387,7 @@ void WrappedOpenGL::glEndTransformFeedback()
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glEndTransformFeedback(ser);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -4580,7 +4580,7 @@ void WrappedOpenGL::glBindVertexArray(GLuint array)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBindVertexArray(ser, array);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     if(record)
       GetResourceManager()->MarkVAOReferenced(record->Resource, eFrameRef_ReadBeforeWrite);
   }
@@ -5290,7 +5290,7 @@ bool WrappedOpenGL::Serialise_glVertexAttrib(SerialiserType &ser, GLuint index,
       Serialise_glVertexAttrib(ser, index, count, eGL_NONE, GL_FALSE, vals,      \
                                AttribType(TypeOr | CONCAT(Attrib_, paramtype))); \
                                                                                  \
-      GetContextRecord()->AddChunk(scope.Get());                                 \
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));       \
     }                                                                            \
   }
 
@@ -5349,7 +5349,7 @@ ATTRIB_FUNC(4, 4Nub, Attrib_N, GLubyte, GLubyte x, GLubyte y, GLubyte z, GLubyte
       Serialise_glVertexAttrib(ser, index, count, eGL_NONE, GL_FALSE, value,               \
                                AttribType(TypeOr | CONCAT(Attrib_, paramtype)));           \
                                                                                            \
-      GetContextRecord()->AddChunk(scope.Get());                                           \
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));                 \
     }                                                                                      \
   }
 
@@ -5412,7 +5412,7 @@ ATTRIB_FUNC(4, 4Nusv, Attrib_N, GLushort)
       SCOPED_SERIALISE_CHUNK(gl_CurChunk);                                                     \
       Serialise_glVertexAttrib(ser, index, count, type, normalized, passparam, Attrib_packed); \
                                                                                                \
-      GetContextRecord()->AddChunk(scope.Get());                                               \
+      GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));                     \
     }                                                                                          \
   }
 
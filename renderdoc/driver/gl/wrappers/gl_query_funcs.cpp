@@ -151,7 +151,7 @@ GLenum WrappedOpenGL::glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 t
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glClientWaitSync(ser, sync, flags, timeout);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 
   return ret;
@@ -186,7 +186,7 @@ void WrappedOpenGL::glWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glWaitSync(ser, sync, flags, timeout);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -352,7 +352,7 @@ void WrappedOpenGL::glBeginQuery(GLenum target, GLuint id)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBeginQuery(ser, target, id);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     GetResourceManager()->MarkResourceFrameReferenced(QueryRes(GetCtx(), id), eFrameRef_Read);
   }
 }
@@ -390,7 +390,7 @@ void WrappedOpenGL::glBeginQueryIndexed(GLenum target, GLuint index, GLuint id)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBeginQueryIndexed(ser, target, index, id);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     GetResourceManager()->MarkResourceFrameReferenced(QueryRes(GetCtx(), id), eFrameRef_Read);
   }
 }
@@ -426,7 +426,7 @@ void WrappedOpenGL::glEndQuery(GLenum target)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glEndQuery(ser, target);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -461,7 +461,7 @@ void WrappedOpenGL::glEndQueryIndexed(GLenum target, GLuint index)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glEndQueryIndexed(ser, target, index);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -494,7 +494,7 @@ void WrappedOpenGL::glBeginConditionalRender(GLuint id, GLenum mode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBeginConditionalRender(ser, id, mode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     GetResourceManager()->MarkResourceFrameReferenced(QueryRes(GetCtx(), id), eFrameRef_Read);
   }
 }
@@ -522,7 +522,7 @@ void WrappedOpenGL::glEndConditionalRender()
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glEndConditionalRender(ser);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -553,7 +553,7 @@ void WrappedOpenGL::glQueryCounter(GLuint query, GLenum target)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glQueryCounter(ser, query, target);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     GetResourceManager()->MarkResourceFrameReferenced(QueryRes(GetCtx(), query), eFrameRef_Read);
   }
 }
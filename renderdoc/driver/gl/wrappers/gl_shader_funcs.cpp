@@ -997,7 +997,7 @@ void WrappedOpenGL::glUniformBlockBinding(GLuint program, GLuint uniformBlockInd
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glUniformBlockBinding(ser, program, uniformBlockIndex, uniformBlockBinding);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1066,7 +1066,7 @@ void WrappedOpenGL::glShaderStorageBlockBinding(GLuint program, GLuint storageBl
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glShaderStorageBlockBinding(ser, program, storageBlockIndex, storageBlockBinding);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1180,7 +1180,7 @@ void WrappedOpenGL::glUniformSubroutinesuiv(GLenum shadertype, GLsizei count, co
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glUniformSubroutinesuiv(ser, shadertype, count, indices);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1353,7 +1353,7 @@ void WrappedOpenGL::glUseProgram(GLuint program)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glUseProgram(ser, program);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     GetResourceManager()->MarkResourceFrameReferenced(ProgramRes(GetCtx(), program), eFrameRef_Read);
   }
 }
@@ -1753,7 +1753,7 @@ void WrappedOpenGL::glBindProgramPipeline(GLuint pipeline)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBindProgramPipeline(ser, pipeline);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
     GetResourceManager()->MarkResourceFrameReferenced(ProgramPipeRes(GetCtx(), pipeline),
                                                       eFrameRef_Read);
     // mark all the sub programs referenced
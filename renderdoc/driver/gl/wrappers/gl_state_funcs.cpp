@@ -53,7 +53,7 @@ void WrappedOpenGL::glBlendFunc(GLenum sfactor, GLenum dfactor)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendFunc(ser, sfactor, dfactor);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -84,7 +84,7 @@ void WrappedOpenGL::glBlendFunci(GLuint buf, GLenum src, GLenum dst)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendFunci(ser, buf, src, dst);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -117,7 +117,7 @@ void WrappedOpenGL::glBlendColor(GLfloat red, GLfloat green, GLfloat blue, GLflo
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendColor(ser, red, green, blue, alpha);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -152,7 +152,7 @@ void WrappedOpenGL::glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GL
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendFuncSeparate(ser, sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -189,7 +189,7 @@ void WrappedOpenGL::glBlendFuncSeparatei(GLuint buf, GLenum sfactorRGB, GLenum d
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendFuncSeparatei(ser, buf, sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -218,7 +218,7 @@ void WrappedOpenGL::glBlendEquation(GLenum mode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendEquation(ser, mode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -248,7 +248,7 @@ void WrappedOpenGL::glBlendEquationi(GLuint buf, GLenum mode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendEquationi(ser, buf, mode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -279,7 +279,7 @@ void WrappedOpenGL::glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendEquationSeparate(ser, modeRGB, modeAlpha);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -311,7 +311,7 @@ void WrappedOpenGL::glBlendEquationSeparatei(GLuint buf, GLenum modeRGB, GLenum
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendEquationSeparatei(ser, buf, modeRGB, modeAlpha);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -341,7 +341,7 @@ void WrappedOpenGL::glBlendBarrierKHR()
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendBarrierKHR(ser);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -357,7 +357,7 @@ void WrappedOpenGL::glBlendBarrier()
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glBlendBarrierKHR(ser);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -386,7 +386,7 @@ void WrappedOpenGL::glLogicOp(GLenum opcode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glLogicOp(ser, opcode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -417,7 +417,7 @@ void WrappedOpenGL::glStencilFunc(GLenum func, GLint ref, GLuint mask)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glStencilFunc(ser, func, ref, mask);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -450,7 +450,7 @@ void WrappedOpenGL::glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, G
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glStencilFuncSeparate(ser, face, func, ref, mask);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -479,7 +479,7 @@ void WrappedOpenGL::glStencilMask(GLuint mask)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glStencilMask(ser, mask);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -509,7 +509,7 @@ void WrappedOpenGL::glStencilMaskSeparate(GLenum face, GLuint mask)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glStencilMaskSeparate(ser, face, mask);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -540,7 +540,7 @@ void WrappedOpenGL::glStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glStencilOp(ser, fail, zfail, zpass);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -573,7 +573,7 @@ void WrappedOpenGL::glStencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glStencilOpSeparate(ser, face, sfail, dpfail, dppass);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -606,7 +606,7 @@ void WrappedOpenGL::glClearColor(GLclampf red, GLclampf green, GLclampf blue, GL
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glClearColor(ser, red, green, blue, alpha);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -635,7 +635,7 @@ void WrappedOpenGL::glClearStencil(GLint stencil)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glClearStencil(ser, stencil);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -667,7 +667,7 @@ void WrappedOpenGL::glClearDepth(GLdouble depth)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glClearDepth(ser, depth);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -681,7 +681,7 @@ void WrappedOpenGL::glClearDepthf(GLfloat depth)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glClearDepth(ser, depth);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -710,7 +710,7 @@ void WrappedOpenGL::glDepthFunc(GLenum func)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDepthFunc(ser, func);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -739,7 +739,7 @@ void WrappedOpenGL::glDepthMask(GLboolean flag)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDepthMask(ser, flag);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -767,7 +767,7 @@ void WrappedOpenGL::glDepthRange(GLdouble nearVal, GLdouble farVal)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDepthRange(ser, nearVal, farVal);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -795,7 +795,7 @@ void WrappedOpenGL::glDepthRangef(GLfloat nearVal, GLfloat farVal)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDepthRangef(ser, nearVal, farVal);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -830,7 +830,7 @@ void WrappedOpenGL::glDepthRangeIndexed(GLuint index, GLdouble nearVal, GLdouble
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDepthRangeIndexed(ser, index, nearVal, farVal);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -844,7 +844,7 @@ void WrappedOpenGL::glDepthRangeIndexedfOES(GLuint index, GLfloat nearVal, GLflo
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDepthRangeIndexed(ser, index, (GLdouble)nearVal, (GLdouble)farVal);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -889,7 +889,7 @@ void WrappedOpenGL::glDepthRangeArrayv(GLuint first, GLsizei count, const GLdoub
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDepthRangeArrayv(ser, first, count, v);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -909,7 +909,7 @@ void WrappedOpenGL::glDepthRangeArrayfvOES(GLuint first, GLsizei count, const GL
 
     delete[] dv;
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -941,7 +941,7 @@ void WrappedOpenGL::glDepthBoundsEXT(GLclampd nearVal, GLclampd farVal)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDepthBoundsEXT(ser, nearVal, farVal);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -971,7 +971,7 @@ void WrappedOpenGL::glClipControl(GLenum origin, GLenum depth)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glClipControl(ser, origin, depth);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1000,7 +1000,7 @@ void WrappedOpenGL::glProvokingVertex(GLenum mode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glProvokingVertex(ser, mode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1029,7 +1029,7 @@ void WrappedOpenGL::glPrimitiveRestartIndex(GLuint index)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPrimitiveRestartIndex(ser, index);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1073,7 +1073,7 @@ void WrappedOpenGL::glDisable(GLenum cap)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDisable(ser, cap);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1106,7 +1106,7 @@ void WrappedOpenGL::glEnable(GLenum cap)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glEnable(ser, cap);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1136,7 +1136,7 @@ void WrappedOpenGL::glDisablei(GLenum cap, GLuint index)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glDisablei(ser, cap, index);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1166,7 +1166,7 @@ void WrappedOpenGL::glEnablei(GLenum cap, GLuint index)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glEnablei(ser, cap, index);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1195,7 +1195,7 @@ void WrappedOpenGL::glFrontFace(GLenum mode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glFrontFace(ser, mode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1224,7 +1224,7 @@ void WrappedOpenGL::glCullFace(GLenum mode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glCullFace(ser, mode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1254,7 +1254,7 @@ void WrappedOpenGL::glHint(GLenum target, GLenum mode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glHint(ser, target, mode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1288,7 +1288,7 @@ void WrappedOpenGL::glColorMask(GLboolean red, GLboolean green, GLboolean blue,
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glColorMask(ser, red, green, blue, alpha);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1324,7 +1324,7 @@ void WrappedOpenGL::glColorMaski(GLuint buf, GLboolean red, GLboolean green, GLb
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glColorMaski(ser, buf, red, green, blue, alpha);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1354,7 +1354,7 @@ void WrappedOpenGL::glSampleMaski(GLuint maskNumber, GLbitfield mask)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glSampleMaski(ser, maskNumber, mask);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1384,7 +1384,7 @@ void WrappedOpenGL::glSampleCoverage(GLfloat value, GLboolean invert)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glSampleCoverage(ser, value, invert);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1413,7 +1413,7 @@ void WrappedOpenGL::glMinSampleShading(GLfloat value)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glMinSampleShading(ser, value);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1446,7 +1446,7 @@ void WrappedOpenGL::glRasterSamplesEXT(GLuint samples, GLboolean fixedsampleloca
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glRasterSamplesEXT(ser, samples, fixedsamplelocations);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1476,7 +1476,7 @@ void WrappedOpenGL::glPatchParameteri(GLenum pname, GLint value)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPatchParameteri(ser, pname, value);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1507,7 +1507,7 @@ void WrappedOpenGL::glPatchParameterfv(GLenum pname, const GLfloat *values)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPatchParameterfv(ser, pname, values);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1536,7 +1536,7 @@ void WrappedOpenGL::glLineWidth(GLfloat width)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glLineWidth(ser, width);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1565,7 +1565,7 @@ void WrappedOpenGL::glPointSize(GLfloat size)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPointSize(ser, size);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1606,7 +1606,7 @@ void WrappedOpenGL::glPointParameteri(GLenum pname, GLint param)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPointParameteri(ser, pname, param);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1637,7 +1637,7 @@ void WrappedOpenGL::glPointParameteriv(GLenum pname, const GLint *params)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPointParameteriv(ser, pname, params);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1667,7 +1667,7 @@ void WrappedOpenGL::glPointParameterf(GLenum pname, GLfloat param)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPointParameterf(ser, pname, param);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1698,7 +1698,7 @@ void WrappedOpenGL::glPointParameterfv(GLenum pname, const GLfloat *params)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPointParameterfv(ser, pname, params);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1731,7 +1731,7 @@ void WrappedOpenGL::glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glViewport(ser, x, y, width, height);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1763,7 +1763,7 @@ void WrappedOpenGL::glViewportArrayv(GLuint index, GLuint count, const GLfloat *
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glViewportArrayv(ser, index, count, v);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1807,7 +1807,7 @@ void WrappedOpenGL::glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glScissor(ser, x, y, width, height);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1839,7 +1839,7 @@ void WrappedOpenGL::glScissorArrayv(GLuint first, GLsizei count, const GLint *v)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glScissorArrayv(ser, first, count, v);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1881,7 +1881,7 @@ void WrappedOpenGL::glPolygonMode(GLenum face, GLenum mode)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPolygonMode(ser, face, mode);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1911,7 +1911,7 @@ void WrappedOpenGL::glPolygonOffset(GLfloat factor, GLfloat units)
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPolygonOffset(ser, factor, units);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1945,7 +1945,7 @@ void WrappedOpenGL::glPolygonOffsetClamp(GLfloat factor, GLfloat units, GLfloat
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPolygonOffsetClamp(ser, factor, units, clamp);
 
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -1985,7 +1985,7 @@ void WrappedOpenGL::glPrimitiveBoundingBox(GLfloat minX, GLfloat minY, GLfloat m
     USE_SCRATCH_SERIALISER();
     SCOPED_SERIALISE_CHUNK(gl_CurChunk);
     Serialise_glPrimitiveBoundingBox(ser, minX, minY, minZ, minW, maxX, maxY, maxZ, maxW);
-    GetContextRecord()->AddChunk(scope.Get());
+    GetContextRecord()->AddChunk(scope.Get(GetContextChunkAllocator()));
   }
 }
 
@@ -28,6 +28,7 @@
 #include "api/app/renderdoc_app.h"
 #include "common/common.h"
 #include "core/settings.h"
+#include "driver/dxgi/dxgi_common.h"
 #include "driver/shaders/dxil/dxil_bytecode.h"
 #include "lz4/lz4.h"
 #include "serialise/serialiser.h"
@@ -479,7 +480,7 @@ D3D_PRIMITIVE_TOPOLOGY DXBCContainer::GetOutputTopology()
     if(m_DXBCByteCode)
       m_OutputTopology = m_DXBCByteCode->GetOutputTopology();
     else if(m_DXILByteCode)
-      m_OutputTopology = m_DXILByteCode->GetOutputTopology();
+      m_OutputTopology = MakeD3DPrimitiveTopology(m_DXILByteCode->GetOutputTopology());
   }
 
   return m_OutputTopology;
@@ -5656,6 +5656,64 @@ rdcarray<ShaderDebugState> InterpretDebugger::ContinueDebug(DXBCDebug::DebugAPIW
   return ret;
 }
 
+ShaderDebugState InterpretDebugger::RunDebug(DXBCDebug::DebugAPIWrapper *apiWrapper,
+                                             const rdcarray<uint32_t> &breakpoints)
+{
+  DXBCDebug::ThreadState &active = activeLane();
+
+  ShaderDebugState ret;
+
+  // if we've finished, return an empty state to signify that
+  if(active.Finished())
+    return ret;
+
+  // the initial state is implicit, nothing is recorded for it
+  if(steps == 0)
+    steps++;
+
+  rdcarray<DXBCDebug::ThreadState> oldworkgroup = workgroup;
+
+  rdcarray<bool> activeMask;
+
+  // step without recording any changes until the active thread finishes or is about to execute one
+  // of the breakpoints. We always take at least one step so that running again from a breakpoint
+  // makes progress.
+  bool stepped = false;
+  while(!active.Finished())
+  {
+    if(stepped && breakpoints.contains(active.nextInstruction))
+      break;
+
+    for(size_t i = 0; i < oldworkgroup.size(); i++)
+      oldworkgroup[i].variables = workgroup[i].variables;
+
+    CalcActiveMask(activeMask);
+
+    for(int i = 0; i < workgroup.count(); i++)
+    {
+      if(activeMask[i])
+      {
+        workgroup[i].StepNext(NULL, apiWrapper, oldworkgroup);
+
+        if(i == activeLaneIndex)
+        {
+          stepped = true;
+          steps++;
+        }
+      }
+    }
+  }
+
+  ret.stepIndex = steps - 1;
+  ret.nextInstruction = active.nextInstruction;
+  dxbc->FillStateInstructionInfo(ret);
+
+  for(const ShaderVariable &v : active.variables)
+    ret.changes.push_back({ShaderVariable(), v});
+
+  return ret;
+}
+
 };    // namespace ShaderDebug
 
 #if ENABLED(ENABLE_UNIT_TESTS)
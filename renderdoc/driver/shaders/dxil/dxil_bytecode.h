@@ -27,8 +27,9 @@
 #include <stdint.h>
 
 #include "api/replay/apidefs.h"
+#include "api/replay/rdcpair.h"
 #include "api/replay/rdcstr.h"
-#include "driver/dx/official/d3dcommon.h"
+#include "common/common.h"
 #include "driver/shaders/dxbc/dxbc_common.h"
 
 namespace LLVMBC
@@ -508,7 +509,7 @@ public:
   DXBC::ShaderType GetShaderType() { return m_Type; }
   uint32_t GetMajorVersion() { return m_Major; }
   uint32_t GetMinorVersion() { return m_Minor; }
-  D3D_PRIMITIVE_TOPOLOGY GetOutputTopology();
+  Topology GetOutputTopology();
   const rdcstr &GetDisassembly()
   {
     if(m_Disassembly.empty())
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include "api/replay/stringise.h"
+
 namespace DXIL
 {
 enum class ResourceClass
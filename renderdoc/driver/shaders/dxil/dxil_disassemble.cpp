@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <ctype.h>
 #include <math.h>
 #include <stdlib.h>
 #include <algorithm>
@@ -1015,6 +1016,7 @@ void Program::MakeDisassemblyString()
                 break;
               default: break;
             }
+            break;
           }
           case Operation::LoadAtomic:
           {
@@ -1454,6 +1456,7 @@ rdcstr Type::toString() const
             default: return StringFormat::Fmt("fp%u", bitWidth);
           }
       }
+      return "unknown_type";
     }
     case Vector: return StringFormat::Fmt("<%u x %s>", elemCount, inner->toString().c_str());
     case Pointer:
@@ -169,10 +169,10 @@ void Program::FetchComputeProperties(DXBC::Reflection *reflection)
   reflection->DispatchThreadsDimension[2] = 1;
 }
 
-D3D_PRIMITIVE_TOPOLOGY Program::GetOutputTopology()
+Topology Program::GetOutputTopology()
 {
   if(m_Type != DXBC::ShaderType::Geometry && m_Type != DXBC::ShaderType::Domain)
-    return D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    return Topology::TriangleList;
 
   for(size_t i = 0; i < m_NamedMeta.size(); i++)
   {
@@ -192,7 +192,21 @@ D3D_PRIMITIVE_TOPOLOGY Program::GetOutputTopology()
         {
           Metadata &geomData = *tags.children[t + 1];
           RDCASSERTEQUAL(geomData.children.size(), 5);
-          return getival<D3D_PRIMITIVE_TOPOLOGY>(geomData.children[3]);
+
+          // the metadata stores a D3D_PRIMITIVE_TOPOLOGY, of which only the basic types are valid
+          // for geometry shader output
+          switch(getival<uint32_t>(geomData.children[3]))
+          {
+            case 1: return Topology::PointList;
+            case 2: return Topology::LineList;
+            case 3: return Topology::LineStrip;
+            case 4: return Topology::TriangleList;
+            case 5: return Topology::TriangleStrip;
+            default: break;
+          }
+
+          RDCERR("Unexpected geometry shader output topology");
+          return Topology::TriangleList;
         }
       }
 
@@ -202,7 +216,7 @@ D3D_PRIMITIVE_TOPOLOGY Program::GetOutputTopology()
 
   RDCERR("Couldn't find topology tag in shader");
 
-  return D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+  return Topology::TriangleList;
 }
 
 struct DXMeta
@@ -78,7 +78,11 @@ public:
 
     RDCASSERT(bitWidth <= 64);
 
-    ReadBits(bitWidth, scratch);
+    uint64_t val;
+    if(ReadBitsFast(bitWidth, val))
+      memcpy(scratch, &val, sizeof(val));
+    else
+      ReadBits(bitWidth, scratch);
 
     T ret;
     memcpy(&ret, scratch, sizeof(T));
@@ -100,7 +104,11 @@ public:
     uint64_t shift = 0;
     do
     {
-      ReadBits(groupBitSize, &scratch);
+      uint64_t val;
+      if(ReadBitsFast(groupBitSize, val))
+        scratch = byte(val);
+      else
+        ReadBits(groupBitSize, &scratch);
 
       RDCASSERT(shift <= 63);
 
@@ -184,6 +192,25 @@ private:
     }
   }
 
+  // as long as there are 8 bytes left we can read up to 57 bits with one unaligned load, which
+  // covers almost every read. Anything else goes through ReadBits
+  bool ReadBitsFast(size_t bitsToRead, uint64_t &val)
+  {
+    if(bitsToRead > 57 || m_End - m_Bits < 8)
+      return false;
+
+    uint64_t word;
+    memcpy(&word, m_Bits, sizeof(word));
+
+    val = (word >> m_Offset) & ((1ULL << bitsToRead) - 1);
+
+    m_Offset += bitsToRead;
+    m_Bits += m_Offset / 8;
+    m_Offset %= 8;
+
+    return true;
+  }
+
   void ReadBits(size_t bitsToRead, byte *dst)
   {
     if(BitOffset() + bitsToRead > BitLength())
@@ -45,17 +45,41 @@ struct AbbrevParam
   uint64_t value;    // this is also the bitwidth for Fixed/VBR
 };
 
-struct AbbrevDesc
+// abbreviations are stored flattened, so that re-using a list for another block doesn't need to
+// reallocate anything once it's big enough.
+struct AbbrevList
 {
+  // the parameters of all abbreviations, back to back
   rdcarray<AbbrevParam> params;
+  // the index in params where each abbreviation starts
+  rdcarray<uint32_t> starts;
+
+  size_t size() const { return starts.size(); }
+  const AbbrevParam *get(size_t idx, size_t &numParams) const
+  {
+    const size_t end = idx + 1 < starts.size() ? starts[idx + 1] : params.size();
+    numParams = end - starts[idx];
+    return params.data() + starts[idx];
+  }
+  void clear()
+  {
+    params.clear();
+    starts.clear();
+  }
 };
 
 // the temporary context while pushing/popping blocks
 struct BlockContext
 {
-  BlockContext(size_t size = 2) : abbrevSize(size) {}
+  uint32_t id;
   size_t abbrevSize;
-  rdcarray<AbbrevDesc> abbrevs;
+  // whether the visitor wants to know about this block's contents
+  bool visit;
+  // the BLOCKINFO abbreviations for this block, if there are any
+  const BlockInfo *info;
+  // used for BLOCKINFO only
+  BlockInfo *curBlockInfo;
+  AbbrevList abbrevs;
 };
 
 // the permanent block info defined by BLOCKINFO
@@ -63,7 +87,7 @@ struct BlockInfo
 {
   // rdcstr blockname;
   // rdcarray<rdcstr> recordnames;
-  rdcarray<AbbrevDesc> abbrevs;
+  AbbrevList abbrevs;
 };
 
 enum AbbrevId
@@ -84,6 +108,44 @@ enum class BlockInfoRecord
 
 static const uint32_t BitcodeMagic = MAKE_FOURCC('B', 'C', 0xC0, 0xDE);
 
+// builds up a tree of BlockOrRecord for callers that want random access to the whole module
+class TreeBuilder : public BitcodeVisitor
+{
+public:
+  TreeBuilder(BlockOrRecord &root) : m_Root(root) {}
+  bool EnterBlock(uint32_t blockId, uint32_t blockDwordLength) override
+  {
+    BlockOrRecord *block = &m_Root;
+    if(!m_Stack.empty())
+    {
+      m_Stack.back()->children.push_back(BlockOrRecord());
+      block = &m_Stack.back()->children.back();
+    }
+
+    block->id = blockId;
+    block->blockDwordLength = blockDwordLength;
+    m_Stack.push_back(block);
+
+    return true;
+  }
+  void Record(const BitcodeRecord &record) override
+  {
+    BlockOrRecord &parent = *m_Stack.back();
+    parent.children.push_back(BlockOrRecord());
+
+    BlockOrRecord &r = parent.children.back();
+    r.id = record.id;
+    r.ops.assign(record.ops, record.numOps);
+    r.blob = record.blob;
+    r.blobLength = record.blobLength;
+  }
+  void ExitBlock(uint32_t blockId) override { m_Stack.pop_back(); }
+private:
+  BlockOrRecord &m_Root;
+  // pointers are stable since only the children of the innermost block are modified
+  rdcarray<BlockOrRecord *> m_Stack;
+};
+
 bool BitcodeReader::Valid(const byte *bitcode, size_t length)
 {
   return length >= 4 && memcmp(bitcode, &BitcodeMagic, sizeof(uint32_t)) == 0;
@@ -100,17 +162,16 @@ BitcodeReader::~BitcodeReader()
 {
   for(auto it = blockInfo.begin(); it != blockInfo.end(); ++it)
     delete it->second;
+  for(BlockContext *ctx : blockStack)
+    delete ctx;
 }
 
 BlockOrRecord BitcodeReader::ReadToplevelBlock()
 {
   BlockOrRecord ret;
 
-  // should hit ENTER_SUBBLOCK first for top-level block
-  uint32_t abbrevID = b.fixed<uint32_t>(abbrevSize());
-  RDCASSERT(abbrevID == ENTER_SUBBLOCK);
-
-  ReadBlockContents(ret);
+  TreeBuilder builder(ret);
+  VisitToplevelBlock(builder);
 
   return ret;
 }
@@ -120,169 +181,217 @@ bool BitcodeReader::AtEndOfStream()
   return b.AtEndOfStream();
 }
 
-void BitcodeReader::ReadBlockContents(BlockOrRecord &block)
+void BitcodeReader::VisitToplevelBlock(BitcodeVisitor &visitor)
 {
-  block.id = b.vbr<uint32_t>(8);
-
-  blockStack.push_back(new BlockContext(b.vbr<size_t>(4)));
+  // should hit ENTER_SUBBLOCK first for top-level block
+  uint32_t abbrevID = b.fixed<uint32_t>(2);
+  RDCASSERT(abbrevID == ENTER_SUBBLOCK);
 
-  b.align32bits();
-  block.blockDwordLength = b.Read<uint32_t>();
+  EnterBlock(visitor);
 
-  // used for blockinfo only
-  BlockInfo *curBlockInfo = NULL;
+  BitcodeRecord r;
 
-  uint32_t abbrevID = ~0U;
-  do
+  while(blockDepth > 0)
   {
-    abbrevID = b.fixed<uint32_t>(abbrevSize());
+    BlockContext &ctx = *blockStack[blockDepth - 1];
+
+    abbrevID = b.fixed<uint32_t>(ctx.abbrevSize);
 
     if(abbrevID == END_BLOCK)
     {
       b.align32bits();
+
+      blockDepth--;
+
+      if(ctx.visit)
+        visitor.ExitBlock(ctx.id);
     }
     else if(abbrevID == ENTER_SUBBLOCK)
     {
-      BlockOrRecord sub;
-
-      ReadBlockContents(sub);
-
-      block.children.push_back(sub);
+      // this may reallocate blockStack, but ctx is a stable pointer and we don't use it after
+      EnterBlock(visitor);
     }
     else if(abbrevID == DEFINE_ABBREV)
     {
-      AbbrevDesc a;
-
-      uint32_t numops = b.vbr<uint32_t>(5);
-
-      a.params.resize(numops);
-
-      for(uint32_t i = 0; i < numops; i++)
-      {
-        AbbrevParam &param = a.params[i];
-
-        bool lit = b.fixed<bool>(1);
-
-        if(lit)
-        {
-          param.encoding = AbbrevEncoding::Literal;
-          param.value = b.vbr<uint64_t>(8);
-        }
-        else
-        {
-          param.encoding = b.fixed<AbbrevEncoding>(3);
-
-          if(param.encoding == AbbrevEncoding::Fixed || param.encoding == AbbrevEncoding::VBR)
-          {
-            param.value = b.vbr<uint64_t>(5);
-          }
-        }
-      }
-
-      if(curBlockInfo)
-        curBlockInfo->abbrevs.push_back(a);
-      else
-        blockStack.back()->abbrevs.push_back(a);
+      ReadAbbrev(ctx.curBlockInfo ? ctx.curBlockInfo->abbrevs : ctx.abbrevs);
     }
     else if(abbrevID == UNABBREV_RECORD)
     {
-      BlockOrRecord r;
       r.id = b.vbr<uint32_t>(6);
       uint32_t numops = b.vbr<uint32_t>(6);
-      r.ops.resize(numops);
+      ops.resize(numops);
       for(uint32_t i = 0; i < numops; i++)
-        r.ops[i] = b.vbr<uint64_t>(6);
+        ops[i] = b.vbr<uint64_t>(6);
 
-      if(block.id == 0)    // BLOCKINFO is block 0
-      {
-        switch(BlockInfoRecord(r.id))
-        {
-          case BlockInfoRecord::SETBID:
-          {
-            curBlockInfo = blockInfo[(uint32_t)r.ops[0]];
-            if(curBlockInfo == NULL)
-              curBlockInfo = blockInfo[(uint32_t)r.ops[0]] = new BlockInfo;
-            break;
-          }
-          case BlockInfoRecord::BLOCKNAME:
-          {
-            // skipped because this is so rarely used
-            /*
-            for(uint32_t i = 0; i < r.ops.size(); i++)
-              curBlockInfo->blockname.push_back((char)r.ops[i]);
-              */
-            break;
-          }
-          case BlockInfoRecord::SETRECORDNAME:
-          {
-            // skipped because this is so rarely used
-            /*
-            uint32_t record = (uint32_t)r.ops[0];
-            if(record >= curBlockInfo->recordnames.size())
-              curBlockInfo->recordnames.resize(record + 1);
-            r.ops.erase(r.ops.begin());
-            for(uint32_t i = 0; i < r.ops.size(); i++)
-              curBlockInfo->recordnames[record].push_back((char)r.ops[i]);
-              */
-            break;
-          }
-        }
-      }
+      r.ops = ops.data();
+      r.numOps = ops.size();
+      r.blob = NULL;
+      r.blobLength = 0;
+
+      if(ctx.id == 0)    // BLOCKINFO is block 0
+        ProcessBlockInfoRecord(ctx, r);
 
-      block.children.push_back(r);
+      if(ctx.visit)
+        visitor.Record(r);
     }
     else
     {
-      const AbbrevDesc &a = getAbbrev(block.id, abbrevID);
-
-      BlockOrRecord r;
+      size_t numParams = 0;
+      const AbbrevParam *params = getAbbrev(ctx, abbrevID, numParams);
 
       // should have at least one param for the code itself
-      RDCASSERT(!a.params.empty());
+      RDCASSERT(numParams > 0);
 
-      r.id = (uint32_t)decodeAbbrevParam(a.params[0]);
+      r.id = (uint32_t)decodeAbbrevParam(params[0]);
+      r.blob = NULL;
+      r.blobLength = 0;
 
       // process the rest of the operands - since some might be arrays we don't know until we
       // process it how many ops the record will end up with but it will be at least one per
       // parameter.
-      r.ops.reserve(a.params.size() - 1);
-      for(size_t i = 1; i < a.params.size(); i++)
+      ops.clear();
+      ops.reserve(numParams - 1);
+      for(size_t i = 1; i < numParams; i++)
       {
-        const AbbrevParam &param = a.params[i];
+        const AbbrevParam &param = params[i];
 
         if(param.encoding == AbbrevEncoding::Array)
         {
           // must be another param to specify the value type, and it must be the last
-          RDCASSERT(i + 1 == a.params.size() - 1);
-          const AbbrevParam &elType = a.params[i + 1];
+          RDCASSERT(i + 1 == numParams - 1);
+          const AbbrevParam &elType = params[i + 1];
 
           size_t arrayLen = b.vbr<size_t>(6);
 
+          ops.reserve(ops.size() + arrayLen);
           for(size_t el = 0; el < arrayLen; el++)
-            r.ops.push_back(decodeAbbrevParam(elType));
+            ops.push_back(decodeAbbrevParam(elType));
 
           break;
         }
         else if(param.encoding == AbbrevEncoding::Blob)
         {
           // blob must be the last value
-          RDCASSERT(i == a.params.size() - 1);
+          RDCASSERT(i == numParams - 1);
           b.ReadBlob(r.blob, r.blobLength);
 
           break;
         }
         else
         {
-          r.ops.push_back(decodeAbbrevParam(param));
+          ops.push_back(decodeAbbrevParam(param));
         }
       }
 
-      block.children.push_back(r);
+      r.ops = ops.data();
+      r.numOps = ops.size();
+
+      if(ctx.visit)
+        visitor.Record(r);
     }
-  } while(abbrevID != END_BLOCK);
+  }
+}
+
+void BitcodeReader::EnterBlock(BitcodeVisitor &visitor)
+{
+  uint32_t id = b.vbr<uint32_t>(8);
+  size_t abbrevSize = b.vbr<size_t>(4);
+
+  b.align32bits();
+  uint32_t blockDwordLength = b.Read<uint32_t>();
+
+  bool visit = visitor.EnterBlock(id, blockDwordLength);
+
+  // skip the whole block if we can. BLOCKINFO must still be parsed though
+  if(!visit && id != 0)
+  {
+    b.SeekByte(b.ByteOffset() + blockDwordLength * sizeof(uint32_t));
+    return;
+  }
+
+  if(blockDepth == blockStack.size())
+    blockStack.push_back(new BlockContext);
+
+  BlockContext &ctx = *blockStack[blockDepth];
+  blockDepth++;
+
+  ctx.id = id;
+  ctx.abbrevSize = abbrevSize;
+  ctx.visit = visit;
+  ctx.curBlockInfo = NULL;
+  ctx.abbrevs.clear();
 
-  delete blockStack.back();
-  blockStack.erase(blockStack.size() - 1);
+  auto it = blockInfo.find(id);
+  ctx.info = it == blockInfo.end() ? NULL : it->second;
+}
+
+void BitcodeReader::ReadAbbrev(AbbrevList &abbrevs)
+{
+  uint32_t numops = b.vbr<uint32_t>(5);
+
+  abbrevs.starts.push_back((uint32_t)abbrevs.params.size());
+  abbrevs.params.resize(abbrevs.params.size() + numops);
+
+  AbbrevParam *params = abbrevs.params.data() + abbrevs.starts.back();
+
+  for(uint32_t i = 0; i < numops; i++)
+  {
+    AbbrevParam &param = params[i];
+
+    bool lit = b.fixed<bool>(1);
+
+    if(lit)
+    {
+      param.encoding = AbbrevEncoding::Literal;
+      param.value = b.vbr<uint64_t>(8);
+    }
+    else
+    {
+      param.encoding = b.fixed<AbbrevEncoding>(3);
+      param.value = 0;
+
+      if(param.encoding == AbbrevEncoding::Fixed || param.encoding == AbbrevEncoding::VBR)
+      {
+        param.value = b.vbr<uint64_t>(5);
+      }
+    }
+  }
+}
+
+void BitcodeReader::ProcessBlockInfoRecord(BlockContext &ctx, const BitcodeRecord &r)
+{
+  switch(BlockInfoRecord(r.id))
+  {
+    case BlockInfoRecord::SETBID:
+    {
+      BlockInfo *&info = blockInfo[(uint32_t)r.ops[0]];
+      if(info == NULL)
+        info = new BlockInfo;
+      ctx.curBlockInfo = info;
+      break;
+    }
+    case BlockInfoRecord::BLOCKNAME:
+    {
+      // skipped because this is so rarely used
+      /*
+      for(uint32_t i = 0; i < r.numOps; i++)
+        curBlockInfo->blockname.push_back((char)r.ops[i]);
+        */
+      break;
+    }
+    case BlockInfoRecord::SETRECORDNAME:
+    {
+      // skipped because this is so rarely used
+      /*
+      uint32_t record = (uint32_t)r.ops[0];
+      if(record >= curBlockInfo->recordnames.size())
+        curBlockInfo->recordnames.resize(record + 1);
+      for(uint32_t i = 1; i < r.numOps; i++)
+        curBlockInfo->recordnames[record].push_back((char)r.ops[i]);
+        */
+      break;
+    }
+  }
 }
 
 uint64_t BitcodeReader::decodeAbbrevParam(const AbbrevParam &param)
@@ -302,35 +411,26 @@ uint64_t BitcodeReader::decodeAbbrevParam(const AbbrevParam &param)
   return 0;
 }
 
-size_t BitcodeReader::abbrevSize() const
+const AbbrevParam *BitcodeReader::getAbbrev(const BlockContext &ctx, uint32_t abbrevID,
+                                            size_t &numParams)
 {
-  if(blockStack.empty())
-    return 2;
-  return blockStack.back()->abbrevSize;
-}
-
-const AbbrevDesc &BitcodeReader::getAbbrev(uint32_t blockId, uint32_t abbrevID)
-{
-  const BlockInfo *info = blockInfo[blockId];
-
   // IDs start at the first application specified ID. Rebase to that to get 0-base indices
   RDCASSERT(abbrevID >= APPLICATION_ABBREV);
   abbrevID -= APPLICATION_ABBREV;
 
-  if(info)
+  if(ctx.info)
   {
     // IDs are first assigned to those permanently from BLOCKINFO
-    if(abbrevID < info->abbrevs.size())
-      return info->abbrevs[abbrevID];
+    if(abbrevID < ctx.info->abbrevs.size())
+      return ctx.info->abbrevs.get(abbrevID, numParams);
 
     // block-local IDs start after the BLOCKINFO ones
-    abbrevID -= (uint32_t)info->abbrevs.size();
+    abbrevID -= (uint32_t)ctx.info->abbrevs.size();
   }
 
-  RDCASSERT(!blockStack.empty());
-  RDCASSERT(abbrevID < blockStack.back()->abbrevs.size());
+  RDCASSERT(abbrevID < ctx.abbrevs.size());
 
-  return blockStack.back()->abbrevs[abbrevID];
+  return ctx.abbrevs.get(abbrevID, numParams);
 }
 
 rdcstr BlockOrRecord::getString(size_t startOffset) const
@@ -342,11 +442,21 @@ rdcstr BlockOrRecord::getString(size_t startOffset) const
   return ret;
 }
 
+rdcstr BitcodeRecord::getString(size_t startOffset) const
+{
+  rdcstr ret;
+  ret.resize(numOps - startOffset);
+  for(size_t i = 0; i < ret.size(); i++)
+    ret[i] = (char)ops[i + startOffset];
+  return ret;
+}
+
 };    // namespace LLVMBC
 
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "catch/catch.hpp"
+#include "common/formatting.h"
 
 TEST_CASE("Check LLVM bitreader", "[llvm]")
 {
@@ -944,4 +1054,375 @@ TEST_CASE("Check LLVM bitreader", "[llvm]")
   }
 }
 
+
+namespace
+{
+// minimal bitstream writer for generating test bitcode
+struct BitWriter
+{
+  rdcarray<byte> bytes;
+  size_t bit = 0;
+  rdcarray<size_t> lengthWords;
+
+  void fixed(uint64_t val, size_t width)
+  {
+    for(size_t i = 0; i < width; i++, bit++)
+    {
+      if(bit / 8 >= bytes.size())
+        bytes.push_back(0);
+      if((val >> i) & 1)
+        bytes[bit / 8] |= byte(1 << (bit % 8));
+    }
+  }
+  void vbr(uint64_t val, size_t width)
+  {
+    const uint64_t hibit = 1ULL << (width - 1);
+    do
+    {
+      uint64_t chunk = val & (hibit - 1);
+      val >>= width - 1;
+      if(val)
+        chunk |= hibit;
+      fixed(chunk, width);
+    } while(val);
+  }
+  void align32()
+  {
+    while(bit % 32)
+      fixed(0, 1);
+  }
+  void magic()
+  {
+    fixed('B', 8);
+    fixed('C', 8);
+    fixed(0xC0, 8);
+    fixed(0xDE, 8);
+  }
+  void enterBlock(uint32_t id, size_t newWidth, size_t curWidth)
+  {
+    fixed(1, curWidth);
+    vbr(id, 8);
+    vbr(newWidth, 4);
+    align32();
+    lengthWords.push_back(bit / 32);
+    fixed(0, 32);
+  }
+  void endBlock(size_t width)
+  {
+    fixed(0, width);
+    align32();
+    size_t word = lengthWords.back();
+    lengthWords.pop_back();
+    uint32_t len = uint32_t(bit / 32 - word - 1);
+    memcpy(&bytes[word * 4], &len, sizeof(len));
+  }
+  void record(size_t width, uint32_t code, const rdcarray<uint64_t> &ops)
+  {
+    fixed(3, width);
+    vbr(code, 6);
+    vbr(ops.size(), 6);
+    for(uint64_t o : ops)
+      vbr(o, 6);
+  }
+  // params are pairs of encoding (with 0 for literal) and value
+  void defineAbbrev(size_t width, const rdcarray<rdcpair<uint32_t, uint64_t>> &params)
+  {
+    fixed(2, width);
+    vbr(params.size(), 5);
+    for(const rdcpair<uint32_t, uint64_t> &p : params)
+    {
+      if(p.first == 0)
+      {
+        fixed(1, 1);
+        vbr(p.second, 8);
+      }
+      else
+      {
+        fixed(0, 1);
+        fixed(p.first, 3);
+        if(p.first == 1 || p.first == 2)
+          vbr(p.second, 5);
+      }
+    }
+  }
+};
+
+// generates something shaped like a module: a BLOCKINFO block, some module-level records, then a
+// number of function blocks using a mix of global and local abbreviations, each with a nested block.
+rdcarray<byte> MakeTestBitcode(uint32_t numFunctions, uint32_t recordsPerFunction)
+{
+  BitWriter w;
+  w.magic();
+
+  w.enterBlock(8, 3, 2);
+  {
+    w.enterBlock(0, 2, 3);
+    w.record(2, 1, {12});
+    // global abbrev 4 for block 12: code 20, array of vbr6
+    w.defineAbbrev(2, {{0, 20}, {3, 0}, {2, 6}});
+    w.endBlock(2);
+
+    w.record(3, 1, {1, 2, 3});
+    w.record(3, 2, {0xfffffffffULL});
+
+    for(uint32_t f = 0; f < numFunctions; f++)
+    {
+      w.enterBlock(12, 4, 3);
+
+      // local abbrev 5: fixed code, fixed8, blob
+      w.defineAbbrev(4, {{1, 5}, {1, 8}, {5, 0}});
+      // local abbrev 6: literal code, char6, char6, vbr8
+      w.defineAbbrev(4, {{0, 7}, {4, 0}, {4, 0}, {2, 8}});
+
+      for(uint32_t i = 0; i < recordsPerFunction; i++)
+      {
+        switch(i % 4)
+        {
+          case 0:
+          {
+            w.fixed(4, 4);
+            uint32_t len = i % 5 + 1;
+            w.vbr(len, 6);
+            for(uint32_t k = 0; k < len; k++)
+              w.vbr(i * 31 + k + f, 6);
+            break;
+          }
+          case 1:
+          {
+            w.fixed(5, 4);
+            w.fixed(3, 5);
+            w.fixed(i & 0xff, 8);
+            uint32_t len = i % 7;
+            w.vbr(len, 6);
+            w.align32();
+            for(uint32_t k = 0; k < len; k++)
+              w.fixed(k + i, 8);
+            w.align32();
+            break;
+          }
+          case 2: w.record(4, 9, {i, uint64_t(i) << 20, 0}); break;
+          case 3:
+          {
+            w.fixed(6, 4);
+            w.fixed(i % 26, 6);
+            w.fixed(63, 6);
+            w.vbr(i * 1000, 8);
+            break;
+          }
+        }
+      }
+
+      w.enterBlock(11, 2, 4);
+      w.record(2, 1, {f});
+      w.endBlock(2);
+
+      w.endBlock(4);
+    }
+  }
+  w.endBlock(3);
+
+  return w.bytes;
+}
+
+struct LoggingVisitor : public LLVMBC::BitcodeVisitor
+{
+  rdcstr log;
+  uint32_t skipBlock = ~0U;
+
+  bool EnterBlock(uint32_t blockId, uint32_t blockDwordLength) override
+  {
+    if(blockId == skipBlock)
+      return false;
+    log += StringFormat::Fmt("enter %u %u\n", blockId, blockDwordLength);
+    return true;
+  }
+  void Record(const LLVMBC::BitcodeRecord &record) override
+  {
+    log += StringFormat::Fmt("record %u", record.id);
+    for(size_t i = 0; i < record.numOps; i++)
+      log += StringFormat::Fmt(" %llu", record.ops[i]);
+    for(size_t i = 0; i < record.blobLength; i++)
+      log += StringFormat::Fmt(" b%u", record.blob[i]);
+    log += "\n";
+  }
+  void ExitBlock(uint32_t blockId) override { log += StringFormat::Fmt("exit %u\n", blockId); }
+};
+
+void LogTree(const LLVMBC::BlockOrRecord &node, rdcstr &log)
+{
+  if(node.IsBlock())
+  {
+    log += StringFormat::Fmt("enter %u %u\n", node.id, node.blockDwordLength);
+    for(const LLVMBC::BlockOrRecord &child : node.children)
+      LogTree(child, log);
+    log += StringFormat::Fmt("exit %u\n", node.id);
+  }
+  else
+  {
+    log += StringFormat::Fmt("record %u", node.id);
+    for(uint64_t op : node.ops)
+      log += StringFormat::Fmt(" %llu", op);
+    for(size_t i = 0; i < node.blobLength; i++)
+      log += StringFormat::Fmt(" b%u", node.blob[i]);
+    log += "\n";
+  }
+}
+
+struct CountingVisitor : public LLVMBC::BitcodeVisitor
+{
+  uint64_t blocks = 0, records = 0, opsSum = 0;
+
+  bool EnterBlock(uint32_t blockId, uint32_t blockDwordLength) override
+  {
+    blocks++;
+    return true;
+  }
+  void Record(const LLVMBC::BitcodeRecord &record) override
+  {
+    records++;
+    for(size_t i = 0; i < record.numOps; i++)
+      opsSum += record.ops[i];
+  }
+  void ExitBlock(uint32_t blockId) override {}
+};
+};
+
+TEST_CASE("Check LLVM bitcode streaming", "[llvm]")
+{
+  rdcarray<byte> bitcode = MakeTestBitcode(3, 20);
+
+  REQUIRE(LLVMBC::BitcodeReader::Valid(bitcode.data(), bitcode.size()));
+
+  LLVMBC::BlockOrRecord root;
+  {
+    LLVMBC::BitcodeReader reader(bitcode.data(), bitcode.size());
+    root = reader.ReadToplevelBlock();
+    CHECK(reader.AtEndOfStream());
+  }
+
+  SECTION("Tree contents")
+  {
+    CHECK(root.id == 8);
+    REQUIRE(root.children.size() == 6);
+
+    CHECK(root.children[0].IsBlock());
+    CHECK(root.children[0].id == 0);
+
+    CHECK(root.children[1].IsRecord());
+    CHECK(root.children[1].id == 1);
+    CHECK(root.children[1].ops == rdcarray<uint64_t>({1, 2, 3}));
+    CHECK(root.children[2].ops == rdcarray<uint64_t>({0xfffffffffULL}));
+
+    const LLVMBC::BlockOrRecord &func = root.children[4];
+    CHECK(func.id == 12);
+    REQUIRE(func.children.size() == 21);
+
+    // global abbreviation with an array
+    CHECK(func.children[0].id == 20);
+    CHECK(func.children[0].ops == rdcarray<uint64_t>({1}));
+    CHECK(func.children[4].ops ==
+          rdcarray<uint64_t>({4 * 31 + 1, 4 * 31 + 2, 4 * 31 + 3, 4 * 31 + 4, 4 * 31 + 5}));
+
+    // local abbreviation with a blob
+    CHECK(func.children[5].id == 3);
+    CHECK(func.children[5].ops == rdcarray<uint64_t>({5}));
+    REQUIRE(func.children[5].blobLength == 5);
+    CHECK(func.children[5].blob[4] == 9);
+
+    // unabbreviated
+    CHECK(func.children[6].id == 9);
+    CHECK(func.children[6].ops == rdcarray<uint64_t>({6, 6ULL << 20, 0}));
+
+    // literal code with char6
+    CHECK(func.children[7].id == 7);
+    REQUIRE(func.children[7].ops.size() == 3);
+    CHECK(func.children[7].ops[0] == 'h');
+    CHECK(func.children[7].ops[1] == '_');
+    CHECK(func.children[7].ops[2] == 7000);
+
+    CHECK(func.children[20].IsBlock());
+    CHECK(func.children[20].id == 11);
+    REQUIRE(func.children[20].children.size() == 1);
+    CHECK(func.children[20].children[0].ops == rdcarray<uint64_t>({1}));
+  }
+
+  SECTION("Visitor matches tree")
+  {
+    rdcstr expected;
+    LogTree(root, expected);
+
+    LoggingVisitor visitor;
+    LLVMBC::BitcodeReader reader(bitcode.data(), bitcode.size());
+    reader.VisitToplevelBlock(visitor);
+    CHECK(reader.AtEndOfStream());
+
+    CHECK(visitor.log == expected);
+  }
+
+  SECTION("Skipping blocks")
+  {
+    LoggingVisitor visitor;
+    visitor.skipBlock = 12;
+
+    LLVMBC::BitcodeReader reader(bitcode.data(), bitcode.size());
+    reader.VisitToplevelBlock(visitor);
+    CHECK(reader.AtEndOfStream());
+
+    rdcstr expected;
+    LogTree(root.children[0], expected);
+    expected = StringFormat::Fmt("enter 8 %u\n", root.blockDwordLength) + expected;
+    expected += "record 1 1 2 3\nrecord 2 68719476735\nexit 8\n";
+
+    CHECK(visitor.log == expected);
+  }
+
+  SECTION("Skipped BLOCKINFO is still processed")
+  {
+    LoggingVisitor visitor;
+    visitor.skipBlock = 0;
+
+    LLVMBC::BitcodeReader reader(bitcode.data(), bitcode.size());
+    reader.VisitToplevelBlock(visitor);
+    CHECK(reader.AtEndOfStream());
+
+    rdcstr expected;
+    LogTree(root, expected);
+
+    // remove the BLOCKINFO block from the expected log
+    rdcstr blockinfo;
+    LogTree(root.children[0], blockinfo);
+    int32_t offs = expected.find(blockinfo);
+    REQUIRE(offs > 0);
+    expected.erase(offs, blockinfo.size());
+
+    CHECK(visitor.log == expected);
+  }
+}
+
+TEST_CASE("Benchmark LLVM bitcode reading", "[.][benchmark]")
+{
+  // roughly the size of a large shader library
+  rdcarray<byte> bitcode = MakeTestBitcode(2000, 1000);
+
+  uint64_t treeRecords = 0, streamRecords = 0;
+
+  BENCHMARK("Reading into tree")
+  {
+    LLVMBC::BitcodeReader reader(bitcode.data(), bitcode.size());
+    LLVMBC::BlockOrRecord root = reader.ReadToplevelBlock();
+    treeRecords = root.children.size();
+  }
+
+  BENCHMARK("Streaming with visitor")
+  {
+    CountingVisitor visitor;
+    LLVMBC::BitcodeReader reader(bitcode.data(), bitcode.size());
+    reader.VisitToplevelBlock(visitor);
+    streamRecords = visitor.records;
+  }
+
+  CHECK(treeRecords > 0);
+  CHECK(streamRecords > treeRecords);
+}
+
 #endif
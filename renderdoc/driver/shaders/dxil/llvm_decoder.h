@@ -51,8 +51,36 @@ struct BlockOrRecord
   size_t blobLength = 0;
 };
 
+// a record as decoded by the streaming reader. The ops are stored in a scratch arena owned by the
+// reader, so they're only valid for the duration of the visitor callback.
+struct BitcodeRecord
+{
+  uint32_t id;
+
+  const uint64_t *ops = NULL;
+  size_t numOps = 0;
+
+  // if this is an abbreviated record with a blob, this is the last operand
+  const byte *blob = NULL;
+  size_t blobLength = 0;
+
+  rdcstr getString(size_t startOffset = 0) const;
+};
+
+// receives blocks and records in stream order, without anything being materialised in a tree.
+class BitcodeVisitor
+{
+public:
+  virtual ~BitcodeVisitor() {}
+  // return false to skip over the block and everything inside it. The BLOCKINFO block is always
+  // processed internally since later blocks depend on it, but won't be reported if skipped.
+  virtual bool EnterBlock(uint32_t blockId, uint32_t blockDwordLength) = 0;
+  virtual void Record(const BitcodeRecord &record) = 0;
+  virtual void ExitBlock(uint32_t blockId) = 0;
+};
+
 struct AbbrevParam;
-struct AbbrevDesc;
+struct AbbrevList;
 struct BlockContext;
 struct BlockInfo;
 
@@ -62,6 +90,7 @@ public:
   BitcodeReader(const byte *bitcode, size_t length);
   ~BitcodeReader();
   BlockOrRecord ReadToplevelBlock();
+  void VisitToplevelBlock(BitcodeVisitor &visitor);
   bool AtEndOfStream();
 
   static bool Valid(const byte *bitcode, size_t length);
@@ -69,13 +98,19 @@ public:
 private:
   BitReader b;
 
-  void ReadBlockContents(BlockOrRecord &block);
-  const AbbrevDesc &getAbbrev(uint32_t blockId, uint32_t abbrevID);
-  size_t abbrevSize() const;
+  void EnterBlock(BitcodeVisitor &visitor);
+  void ReadAbbrev(AbbrevList &abbrevs);
+  void ProcessBlockInfoRecord(BlockContext &ctx, const BitcodeRecord &r);
+  const AbbrevParam *getAbbrev(const BlockContext &ctx, uint32_t abbrevID, size_t &numParams);
   uint64_t decodeAbbrevParam(const AbbrevParam &param);
 
+  // contexts are kept around once allocated and re-used for later blocks at the same depth
   rdcarray<BlockContext *> blockStack;
+  size_t blockDepth = 0;
   std::map<uint32_t, BlockInfo *> blockInfo;
+
+  // scratch storage for the ops of the current record
+  rdcarray<uint64_t> ops;
 };
 
 };    // namespace LLVMBC
@@ -0,0 +1,140 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+// this file only depends on glslang so that it can be shared with the build-time shader compiler.
+
+#include "glslang/glslang/Include/ResourceLimits.h"
+
+static TBuiltInResource DefaultResources = {
+    /*.maxLights =*/32,
+    /*.maxClipPlanes =*/6,
+    /*.maxTextureUnits =*/32,
+    /*.maxTextureCoords =*/32,
+    /*.maxVertexAttribs =*/64,
+    /*.maxVertexUniformComponents =*/4096,
+    /*.maxVaryingFloats =*/64,
+    /*.maxVertexTextureImageUnits =*/32,
+    /*.maxCombinedTextureImageUnits =*/80,
+    /*.maxTextureImageUnits =*/32,
+    /*.maxFragmentUniformComponents =*/4096,
+    /*.maxDrawBuffers =*/32,
+    /*.maxVertexUniformVectors =*/128,
+    /*.maxVaryingVectors =*/8,
+    /*.maxFragmentUniformVectors =*/16,
+    /*.maxVertexOutputVectors =*/16,
+    /*.maxFragmentInputVectors =*/15,
+    /*.minProgramTexelOffset =*/-8,
+    /*.maxProgramTexelOffset =*/7,
+    /*.maxClipDistances =*/8,
+    /*.maxComputeWorkGroupCountX =*/65535,
+    /*.maxComputeWorkGroupCountY =*/65535,
+    /*.maxComputeWorkGroupCountZ =*/65535,
+    /*.maxComputeWorkGroupSizeX =*/1024,
+    /*.maxComputeWorkGroupSizeY =*/1024,
+    /*.maxComputeWorkGroupSizeZ =*/64,
+    /*.maxComputeUniformComponents =*/1024,
+    /*.maxComputeTextureImageUnits =*/16,
+    /*.maxComputeImageUniforms =*/8,
+    /*.maxComputeAtomicCounters =*/8,
+    /*.maxComputeAtomicCounterBuffers =*/1,
+    /*.maxVaryingComponents =*/60,
+    /*.maxVertexOutputComponents =*/64,
+    /*.maxGeometryInputComponents =*/64,
+    /*.maxGeometryOutputComponents =*/128,
+    /*.maxFragmentInputComponents =*/128,
+    /*.maxImageUnits =*/8,
+    /*.maxCombinedImageUnitsAndFragmentOutputs =*/8,
+    /*.maxCombinedShaderOutputResources =*/8,
+    /*.maxImageSamples =*/0,
+    /*.maxVertexImageUniforms =*/0,
+    /*.maxTessControlImageUniforms =*/0,
+    /*.maxTessEvaluationImageUniforms =*/0,
+    /*.maxGeometryImageUniforms =*/0,
+    /*.maxFragmentImageUniforms =*/8,
+    /*.maxCombinedImageUniforms =*/8,
+    /*.maxGeometryTextureImageUnits =*/16,
+    /*.maxGeometryOutputVertices =*/256,
+    /*.maxGeometryTotalOutputComponents =*/1024,
+    /*.maxGeometryUniformComponents =*/1024,
+    /*.maxGeometryVaryingComponents =*/64,
+    /*.maxTessControlInputComponents =*/128,
+    /*.maxTessControlOutputComponents =*/128,
+    /*.maxTessControlTextureImageUnits =*/16,
+    /*.maxTessControlUniformComponents =*/1024,
+    /*.maxTessControlTotalOutputComponents =*/4096,
+    /*.maxTessEvaluationInputComponents =*/128,
+    /*.maxTessEvaluationOutputComponents =*/128,
+    /*.maxTessEvaluationTextureImageUnits =*/16,
+    /*.maxTessEvaluationUniformComponents =*/1024,
+    /*.maxTessPatchComponents =*/120,
+    /*.maxPatchVertices =*/32,
+    /*.maxTessGenLevel =*/64,
+    /*.maxViewports =*/16,
+    /*.maxVertexAtomicCounters =*/0,
+    /*.maxTessControlAtomicCounters =*/0,
+    /*.maxTessEvaluationAtomicCounters =*/0,
+    /*.maxGeometryAtomicCounters =*/0,
+    /*.maxFragmentAtomicCounters =*/8,
+    /*.maxCombinedAtomicCounters =*/8,
+    /*.maxAtomicCounterBindings =*/1,
+    /*.maxVertexAtomicCounterBuffers =*/0,
+    /*.maxTessControlAtomicCounterBuffers =*/0,
+    /*.maxTessEvaluationAtomicCounterBuffers =*/0,
+    /*.maxGeometryAtomicCounterBuffers =*/0,
+    /*.maxFragmentAtomicCounterBuffers =*/1,
+    /*.maxCombinedAtomicCounterBuffers =*/1,
+    /*.maxAtomicCounterBufferSize =*/16384,
+    /*.maxTransformFeedbackBuffers =*/4,
+    /*.maxTransformFeedbackInterleavedComponents =*/64,
+    /*.maxCullDistances =*/8,
+    /*.maxCombinedClipAndCullDistances =*/8,
+    /*.maxSamples =*/4,
+    /*.maxMeshOutputVerticesNV =*/256,
+    /*.maxMeshOutputPrimitivesNV =*/512,
+    /*.maxMeshWorkGroupSizeX_NV =*/32,
+    /*.maxMeshWorkGroupSizeY_NV =*/1,
+    /*.maxMeshWorkGroupSizeZ_NV =*/1,
+    /*.maxTaskWorkGroupSizeX_NV =*/32,
+    /*.maxTaskWorkGroupSizeY_NV =*/1,
+    /*.maxTaskWorkGroupSizeZ_NV =*/1,
+    /*.maxMeshViewCountNV =*/4,
+
+    /*.limits*/
+    {
+        /*.limits.nonInductiveForLoops =*/1,
+        /*.limits.whileLoops =*/1,
+        /*.limits.doWhileLoops =*/1,
+        /*.limits.generalUniformIndexing =*/1,
+        /*.limits.generalAttributeMatrixVectorIndexing =*/1,
+        /*.limits.generalVaryingIndexing =*/1,
+        /*.limits.generalSamplerIndexing =*/1,
+        /*.limits.generalVariableIndexing =*/1,
+        /*.limits.generalConstantMatrixVectorIndexing =*/1,
+    },
+};
+
+TBuiltInResource *GetDefaultResources()
+{
+  return &DefaultResources;
+}
@@ -252,6 +252,7 @@ public:
                                const SPIRVPatchData &patchData, uint32_t activeIndex);
 
   rdcarray<ShaderDebugState> ContinueDebug();
+  ShaderDebugState RunDebug(const rdcarray<uint32_t> &breakpoints);
 
   Iter GetIterForInstruction(uint32_t inst);
   uint32_t GetInstructionForIter(Iter it);
@@ -289,6 +290,8 @@ private:
   virtual void PostParse();
   virtual void RegisterOp(Iter it);
 
+  void EnterEntryPoint(ShaderDebugState *initial);
+
   uint32_t ApplyDerivatives(uint32_t quadIndex, const Decorations &curDecorations,
                             uint32_t location, const DataType &inType, ShaderVariable &outVar);
 
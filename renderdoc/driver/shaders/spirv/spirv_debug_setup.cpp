@@ -1135,6 +1135,39 @@ ShaderDebugTrace *Debugger::BeginDebug(DebugAPIWrapper *api, const ShaderStage s
   return ret;
 }
 
+void Debugger::EnterEntryPoint(ShaderDebugState *initial)
+{
+  ThreadState &active = GetActiveLane();
+
+  // we should be sitting at the entry point function prologue, step forward into the first block
+  // and past any function-local variable declarations
+  for(size_t lane = 0; lane < workgroup.size(); lane++)
+  {
+    ThreadState &thread = workgroup[lane];
+
+    if(lane == activeLaneIndex && initial)
+    {
+      thread.EnterEntryPoint(initial);
+      thread.FillCallstack(*initial);
+      initial->nextInstruction = thread.nextInstruction;
+      initial->sourceVars = thread.sourceVars;
+    }
+    else
+    {
+      thread.EnterEntryPoint(NULL);
+    }
+  }
+
+  // globals won't be filled out by entering the entry point, ensure their change is registered.
+  if(initial)
+  {
+    for(const Id &v : liveGlobals)
+      initial->changes.push_back({ShaderVariable(), GetPointerValue(active.ids[v])});
+  }
+
+  steps++;
+}
+
 rdcarray<ShaderDebugState> Debugger::ContinueDebug()
 {
   ThreadState &active = GetActiveLane();
@@ -1146,32 +1179,9 @@ rdcarray<ShaderDebugState> Debugger::ContinueDebug()
   {
     ShaderDebugState initial;
 
-    // we should be sitting at the entry point function prologue, step forward into the first block
-    // and past any function-local variable declarations
-    for(size_t lane = 0; lane < workgroup.size(); lane++)
-    {
-      ThreadState &thread = workgroup[lane];
-
-      if(lane == activeLaneIndex)
-      {
-        thread.EnterEntryPoint(&initial);
-        thread.FillCallstack(initial);
-        initial.nextInstruction = thread.nextInstruction;
-        initial.sourceVars = thread.sourceVars;
-      }
-      else
-      {
-        thread.EnterEntryPoint(NULL);
-      }
-    }
-
-    // globals won't be filled out by entering the entry point, ensure their change is registered.
-    for(const Id &v : liveGlobals)
-      initial.changes.push_back({ShaderVariable(), GetPointerValue(active.ids[v])});
+    EnterEntryPoint(&initial);
 
     ret.push_back(initial);
-
-    steps++;
   }
 
   // if we've finished, return an empty set to signify that
@@ -1253,6 +1263,100 @@ rdcarray<ShaderDebugState> Debugger::ContinueDebug()
   return ret;
 }
 
+ShaderDebugState Debugger::RunDebug(const rdcarray<uint32_t> &breakpoints)
+{
+  ThreadState &active = GetActiveLane();
+
+  ShaderDebugState ret;
+
+  // enter the entry point without recording an initial state, nothing is returned for it
+  if(steps == 0)
+    EnterEntryPoint(NULL);
+
+  // if we've finished, return an empty state to signify that
+  if(active.Finished())
+    return ret;
+
+  rdcarray<bool> activeMask;
+
+  // step without recording any changes, source variables or callstacks until the active thread
+  // finishes or is about to execute one of the breakpoints. We always take at least one step so
+  // that running again from a breakpoint makes progress.
+  bool stepped = false;
+  while(!active.Finished())
+  {
+    if(stepped && breakpoints.contains(active.nextInstruction))
+      break;
+
+    if(active.nextInstruction >= instructionOffsets.size())
+      break;
+
+    global.clock++;
+
+    // calculate the current mask of which threads are active
+    CalcActiveMask(activeMask);
+
+    // step all active members of the workgroup
+    for(size_t lane = 0; lane < workgroup.size(); lane++)
+    {
+      ThreadState &thread = workgroup[lane];
+
+      if(!activeMask[lane] || thread.nextInstruction >= instructionOffsets.size())
+        continue;
+
+      if(lane == activeLaneIndex)
+      {
+        // retire any IDs that have died. We still need to keep the live list and any source
+        // variables from previous states accurate in case debugging continues with full states
+        for(size_t l = 0; l < thread.live.size();)
+        {
+          Id id = thread.live[l];
+          if(idDeathOffset[id] < instructionOffsets[thread.nextInstruction])
+          {
+            thread.live.erase(l);
+
+            if(!thread.sourceVars.empty())
+            {
+              rdcstr name = GetRawName(id);
+
+              thread.sourceVars.removeIf([name](const SourceVariableMapping &var) {
+                return var.variables[0].name.beginsWith(name);
+              });
+            }
+
+            continue;
+          }
+
+          l++;
+        }
+
+        thread.StepNext(NULL, workgroup);
+
+        stepped = true;
+        steps++;
+      }
+      else
+      {
+        thread.StepNext(NULL, workgroup);
+      }
+    }
+  }
+
+  ret.stepIndex = steps - 1;
+  ret.nextInstruction = RDCMIN(active.nextInstruction, GetNumInstructions() - 1);
+  ret.sourceVars = active.sourceVars;
+  active.FillCallstack(ret);
+
+  // once the entry point has returned any function-local storage has been freed, so only the
+  // globals are still valid
+  const rdcarray<Id> &live = active.Finished() ? liveGlobals : active.live;
+
+  for(const Id &id : live)
+    ret.changes.push_back({ShaderVariable(), GetPointerValue(active.ids[id])});
+
+  return ret;
+}
+
 ShaderVariable Debugger::MakePointerVariable(Id id, const ShaderVariable *v, uint32_t scalar0,
                                              uint32_t scalar1) const
 {
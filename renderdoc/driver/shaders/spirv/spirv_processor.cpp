@@ -24,9 +24,16 @@
 
 #include "spirv_processor.h"
 #include "common/formatting.h"
+#include "common/threading.h"
+#include "core/settings.h"
 #include "maths/half_convert.h"
+#include "zstd/xxhash.h"
 #include "spirv_op_helpers.h"
 
+RDOC_CONFIG(uint32_t, SPIRV_ParseCacheSizeMB, 64,
+            "The memory budget in megabytes for keeping parsed SPIR-V modules. Identical modules "
+            "are only parsed once while they remain cached. Set to 0 to disable.");
+
 namespace rdcspv
 {
 static void ConstructCompositeConstant(ShaderVariable &v, const rdcarray<ShaderVariable> &members)
@@ -336,6 +343,41 @@ void Decorations::Unregister(const DecorationAndParamData &decoration)
   }
 }
 
+// Captures frequently contain many identical shader modules, e.g. the same shader created for each
+// pipeline or by several threads, and the same module is often parsed again on replay by the
+// reflector, editor and debugger. We keep the base parsed state for each unique module, keyed by a
+// hash of its words, so that parsing a module we've already seen copies that state and only runs
+// the derived class's own registration over the ops.
+struct ParseCache
+{
+  Threading::CriticalSection lock;
+  std::map<uint64_t, rdcarray<rdcspv::Processor *>> entries;
+  uint64_t cachedBytes = 0;
+
+  ~ParseCache() { Clear(); }
+  void Clear()
+  {
+    for(auto it = entries.begin(); it != entries.end(); ++it)
+      for(rdcspv::Processor *p : it->second)
+        delete p;
+    entries.clear();
+    cachedBytes = 0;
+  }
+};
+
+static ParseCache &GetParseCache()
+{
+  static ParseCache cache;
+  return cache;
+}
+
+template <typename Map>
+static uint64_t MapBytes(const Map &map)
+{
+  // approximate the per-node overhead of a std::map/std::set as three pointers and a colour
+  return map.size() * (sizeof(typename Map::value_type) + 4 * sizeof(void *));
+}
+
 Processor::Processor()
 {
 }
@@ -344,6 +386,28 @@ Processor::~Processor()
 {
 }
 
+uint64_t Processor::EstimateParsedBytes() const
+{
+  uint64_t ret = sizeof(*this) + m_SPIRV.byteSize() + idOffsets.byteSize() + idTypes.byteSize() +
+                 decorations.byteSize() + entries.byteSize() + globals.byteSize();
+
+  for(const Decorations &d : decorations)
+    ret += d.others.byteSize();
+
+  ret += MapBytes(extensions) + MapBytes(capabilities) + MapBytes(constants) + MapBytes(specOps) +
+         MapBytes(specConstants) + MapBytes(dataTypes) + MapBytes(imageTypes) +
+         MapBytes(samplerTypes) + MapBytes(sampledImageTypes) + MapBytes(functionTypes) +
+         MapBytes(extSets);
+
+  for(auto it = dataTypes.begin(); it != dataTypes.end(); ++it)
+    ret += it->second.children.byteSize();
+
+  for(auto it = constants.begin(); it != constants.end(); ++it)
+    ret += it->second.children.byteSize();
+
+  return ret;
+}
+
 void Processor::Parse(const rdcarray<uint32_t> &spirvWords)
 {
   m_SPIRV = spirvWords;
@@ -355,6 +419,35 @@ void Processor::Parse(const rdcarray<uint32_t> &spirvWords)
     return;
   }
 
+  m_ParsedFromCache = m_AddToParseCache = false;
+
+  if(SPIRV_ParseCacheSizeMB() > 0)
+  {
+    ParseCache &cache = GetParseCache();
+
+    m_ParseHash = XXH64(spirvWords.data(), (size_t)spirvWords.byteSize(), 0);
+
+    SCOPED_LOCK(cache.lock);
+
+    auto it = cache.entries.find(m_ParseHash);
+    if(it != cache.entries.end())
+    {
+      for(Processor *p : it->second)
+      {
+        if(p->m_SPIRV == spirvWords)
+        {
+          Processor::operator=(*p);
+          m_ParsedFromCache = true;
+          break;
+        }
+      }
+    }
+
+    // the parse itself happens outside the lock so that unrelated modules can be parsed in
+    // parallel
+    m_AddToParseCache = !m_ParsedFromCache;
+  }
+
   uint32_t packedVersion = m_SPIRV[1];
 
   // Bytes: 0 | major | minor | 0
@@ -463,6 +556,8 @@ void Processor::Parse(const rdcarray<uint32_t> &spirvWords)
 
   PostParse();
 
+  m_ParsedFromCache = false;
+
   // ensure we got everything right. First section should start at the beginning
   RDCASSERTEQUAL(m_Sections[Section::First].startOffset, FirstRealWord);
 
@@ -490,6 +585,9 @@ void Processor::PreParse(uint32_t maxId)
 
 void Processor::RegisterOp(Iter it)
 {
+  if(m_ParsedFromCache)
+    return;
+
   OpDecoder opdata(it);
   if(opdata.result != Id() && opdata.resultType != Id())
     idTypes[opdata.result] = opdata.resultType;
@@ -921,6 +1019,34 @@ void Processor::PostParse()
       dataTypes[dec.id].children[dec.member].decorations.Register(dec.dec);
 
   m_MemberDecorations.clear();
+
+  // the base state is now complete, before derived classes make any changes to it in PostParse
+  if(m_AddToParseCache)
+  {
+    m_AddToParseCache = false;
+
+    const uint64_t budget = uint64_t(SPIRV_ParseCacheSizeMB()) * 1024 * 1024;
+    const uint64_t byteSize = EstimateParsedBytes();
+
+    if(byteSize > budget)
+      return;
+
+    ParseCache &cache = GetParseCache();
+
+    SCOPED_LOCK(cache.lock);
+
+    // another thread may have parsed the same module while we were
+    for(Processor *p : cache.entries[m_ParseHash])
+      if(p->m_SPIRV == m_SPIRV)
+        return;
+
+    // when we go over budget, start again from empty rather than tracking usage for eviction.
+    if(cache.cachedBytes + byteSize > budget)
+      cache.Clear();
+
+    cache.entries[m_ParseHash].push_back(new Processor(*this));
+    cache.cachedBytes += byteSize;
+  }
 }
 
 ShaderVariable Processor::MakeNULL(const DataType &type, uint64_t value)
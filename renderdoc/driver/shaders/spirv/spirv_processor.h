@@ -507,7 +507,7 @@ class Processor
 {
 public:
   Processor();
-  ~Processor();
+  virtual ~Processor();
   Processor(const Processor &o) = default;
   Processor &operator=(const Processor &o) = default;
 
@@ -580,6 +580,15 @@ private:
   };
 
   rdcarray<DeferredMemberDecoration> m_MemberDecorations;
+
+  uint64_t EstimateParsedBytes() const;
+
+  // set while parsing a module whose base state was copied from the parse cache, so that only
+  // derived classes register each op.
+  bool m_ParsedFromCache = false;
+  // set while parsing a module that isn't cached yet, so its base state is added once it's complete
+  bool m_AddToParseCache = false;
+  uint64_t m_ParseHash = 0;
 };
 
 };    // namespace rdcspv
@@ -1728,4 +1728,75 @@ TEST_CASE("Validate SPIR-V reflection", "[spirv][reflection]")
   };
 }
 
+TEST_CASE("SPIR-V parse cache", "[spirv][reflection]")
+{
+  rdcspv::Init();
+  RenderDoc::Inst().RegisterShutdownFunction(&rdcspv::Shutdown);
+
+  rdcstr source = R"(
+#version 450 core
+
+layout(location = 0) in vec4 inpos;
+layout(location = 0) out vec4 outcol;
+
+layout(binding = 0) uniform sampler2D tex;
+
+void main()
+{
+  outcol = texture(tex, inpos.xy) * inpos;
+}
+)";
+
+  rdcarray<uint32_t> spirv;
+  rdcspv::CompilationSettings settings(rdcspv::InputLanguage::VulkanGLSL,
+                                       rdcspv::ShaderStage::Fragment);
+  rdcstr errors = rdcspv::Compile(settings, {source}, spirv);
+
+  INFO("SPIR-V compile output: " << errors);
+
+  REQUIRE(!spirv.empty());
+
+  // the second parse should come from the cache, and be identical to the first
+  rdcspv::Reflector first, second;
+  first.Parse(spirv);
+  second.Parse(spirv);
+
+  CHECK(first.GetSPIRV() == spirv);
+  CHECK(second.GetSPIRV() == spirv);
+  CHECK(first.EntryPoints() == second.EntryPoints());
+
+  std::map<size_t, uint32_t> firstLines, secondLines;
+  CHECK(first.Disassemble("main", firstLines) == second.Disassemble("main", secondLines));
+
+  ShaderReflection firstRefl, secondRefl;
+  ShaderBindpointMapping firstMapping, secondMapping;
+  SPIRVPatchData firstPatch, secondPatch;
+  first.MakeReflection(GraphicsAPI::Vulkan, ShaderStage::Pixel, "main", {}, firstRefl,
+                       firstMapping, firstPatch);
+  second.MakeReflection(GraphicsAPI::Vulkan, ShaderStage::Pixel, "main", {}, secondRefl,
+                        secondMapping, secondPatch);
+
+  CHECK(firstRefl.inputSignature.size() == secondRefl.inputSignature.size());
+  CHECK(firstRefl.outputSignature.size() == secondRefl.outputSignature.size());
+  CHECK(firstRefl.readOnlyResources.size() == secondRefl.readOnlyResources.size());
+
+  bool sameMapping = (firstMapping.readOnlyResources == secondMapping.readOnlyResources);
+  CHECK(sameMapping);
+
+  // an editor on the same module shares the cached parse, but must still build its own type
+  // lookups
+  rdcarray<uint32_t> editSpirv = spirv;
+  {
+    rdcspv::Editor editor(editSpirv);
+    editor.Prepare();
+
+    CHECK(editor.GetEntries().size() == first.GetEntries().size());
+    CHECK(editor.GetType(rdcspv::scalar<float>()) != rdcspv::Id());
+    CHECK(editor.GetType(rdcspv::scalar<float>()) ==
+          editor.DeclareType(rdcspv::scalar<float>()));
+  }
+
+  CHECK(editSpirv == spirv);
+}
+
 #endif
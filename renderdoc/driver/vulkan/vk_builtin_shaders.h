@@ -0,0 +1,137 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+// This header is shared between VulkanShaderCache and the vk-shader-bake tool that compiles the
+// builtin shaders at build time, so it must not depend on anything outside the standard library.
+
+#include <stdint.h>
+#include <stdio.h>
+
+// SHADER(name, resource, stage, checks, baseTypeParameterised, textureTypeParameterised)
+//
+// name is the BuiltinShader enum value, resource is the embedded resource name (glsl_ is prepended)
+// which is the filename in data/glsl with the extension's '.' replaced by '_'. stage is the
+// rdcspv::ShaderStage and EShLanguage suffix. checks are the FeatureChecks needed at runtime.
+#define VK_BUILTIN_SHADERS(SHADER)                                                              \
+  SHADER(BlitVS, blit_vert, Vertex, FeatureCheck::NoCheck, false, false)                        \
+  SHADER(CheckerboardFS, checkerboard_frag, Fragment, FeatureCheck::NoCheck, false, false)      \
+  SHADER(TexDisplayFS, texdisplay_frag, Fragment, FeatureCheck::NoCheck, false, false)          \
+  SHADER(FixedColFS, fixedcol_frag, Fragment, FeatureCheck::NoCheck, false, false)              \
+  SHADER(TextVS, vktext_vert, Vertex, FeatureCheck::NoCheck, false, false)                      \
+  SHADER(TextFS, vktext_frag, Fragment, FeatureCheck::NoCheck, false, false)                    \
+  SHADER(MeshVS, mesh_vert, Vertex, FeatureCheck::NoCheck, false, false)                        \
+  SHADER(MeshGS, mesh_geom, Geometry, FeatureCheck::NoCheck, false, false)                      \
+  SHADER(MeshFS, mesh_frag, Fragment, FeatureCheck::NoCheck, false, false)                      \
+  SHADER(MeshCS, mesh_comp, Compute, FeatureCheck::NoCheck, false, false)                       \
+  SHADER(QuadResolveFS, quadresolve_frag, Fragment, FeatureCheck::FragmentStores, false, false) \
+  SHADER(QuadWriteFS, quadwrite_frag, Fragment,                                                 \
+         FeatureCheck::FragmentStores | FeatureCheck::NonMetalBackend, false, false)            \
+  SHADER(TrisizeGS, trisize_geom, Geometry, FeatureCheck::NoCheck, false, false)                \
+  SHADER(TrisizeFS, trisize_frag, Fragment, FeatureCheck::NoCheck, false, false)                \
+  SHADER(MS2ArrayCS, ms2array_comp, Compute,                                                    \
+         FeatureCheck::FormatlessWrite | FeatureCheck::NonMetalBackend, false, false)           \
+  SHADER(Array2MSCS, array2ms_comp, Compute,                                                    \
+         FeatureCheck::ShaderMSAAStorage | FeatureCheck::FormatlessWrite |                      \
+             FeatureCheck::NonMetalBackend,                                                     \
+         false, false)                                                                          \
+  SHADER(DepthMS2ArrayFS, depthms2arr_frag, Fragment, FeatureCheck::NonMetalBackend, false,     \
+         false)                                                                                 \
+  SHADER(DepthArray2MSFS, deptharr2ms_frag, Fragment,                                           \
+         FeatureCheck::SampleShading | FeatureCheck::NonMetalBackend, false, false)             \
+  SHADER(TexRemap, texremap_frag, Fragment, FeatureCheck::NoCheck, true, false)                 \
+  SHADER(PixelHistoryMSCopyCS, pixelhistory_mscopy_comp, Compute, FeatureCheck::NoCheck, false, \
+         false)                                                                                 \
+  SHADER(PixelHistoryMSCopyDepthCS, pixelhistory_mscopy_depth_comp, Compute,                    \
+         FeatureCheck::NoCheck, false, false)                                                   \
+  SHADER(PixelHistoryPrimIDFS, pixelhistory_primid_frag, Fragment, FeatureCheck::NoCheck, false, \
+         false)                                                                                 \
+  SHADER(ShaderDebugSampleVS, shaderdebug_sample_vert, Vertex, FeatureCheck::NoCheck, false,    \
+         false)                                                                                 \
+  SHADER(DiscardFS, discard_frag, Fragment, FeatureCheck::NoCheck, false, false)                \
+  SHADER(HistogramCS, histogram_comp, Compute, FeatureCheck::NoCheck, true, true)               \
+  SHADER(MinMaxTileCS, minmaxtile_comp, Compute, FeatureCheck::NoCheck, true, true)             \
+  SHADER(MinMaxResultCS, minmaxresult_comp, Compute, FeatureCheck::NoCheck, true, false)
+
+enum class BuiltinShader
+{
+#define BUILTIN_SHADER_ENUM(name, resource, stage, checks, baseParam, texParam) name,
+  VK_BUILTIN_SHADERS(BUILTIN_SHADER_ENUM)
+#undef BUILTIN_SHADER_ENUM
+  Count,
+  First = 0,
+};
+
+enum class BuiltinShaderBaseType
+{
+  Float = 0,
+  First = Float,
+  UInt,
+  SInt,
+  Count,
+};
+
+enum class BuiltinShaderTextureType
+{
+  Tex1D = 1,
+  First = Tex1D,
+  Tex2D,
+  Tex3D,
+  Tex2DMS,
+  Count,
+};
+
+// the global defines used when no driver workarounds are needed. vk-shader-bake compiles with these
+static const char BuiltinShaderDefaultDefines[] = "#define HAS_BIT_CONVERSION 1\n";
+
+// appended to the global defines for each base type and texture type permutation
+inline void GetBuiltinShaderPermutationDefines(char (&defines)[128], uint32_t baseType,
+                                               uint32_t textureType)
+{
+  snprintf(defines, sizeof(defines), "#define SHADER_RESTYPE %u\n#define SHADER_BASETYPE %u\n",
+           textureType, baseType);
+}
+
+// the key for a builtin shader in the shader cache and in the table of shaders compiled at build
+// time. This is the same hash as strhash(), repeated here so vk-shader-bake doesn't need the core.
+inline uint32_t GetBuiltinShaderInputHash(const char *source, const char *defines)
+{
+  const char *strs[] = {
+      source, defines,
+      // bump this version if anything inside GenerateGLSLShader changes. This is used to
+      // determine if we can skip the call to GenerateGLSLShader (which calls out to glslang).
+      // Otherwise we'll use the cached SPIR-V generated by the previous call using the same
+      // source & defines.
+      "inputHashVersion1",
+  };
+
+  uint32_t hash = 5381;
+
+  for(const char *str : strs)
+    for(; *str; str++)
+      hash = ((hash << 5) + hash) + *str; /* hash * 33 + c */
+
+  return hash;
+}
@@ -0,0 +1,517 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "core/settings.h"
+#include "vk_core.h"
+
+RDOC_CONFIG(uint32_t, Vulkan_ReplayCheckpointInterval, 0,
+            "The minimum number of events between replay checkpoints. Checkpoints snapshot the "
+            "frame's state between queue submits so that replaying to an event can continue from "
+            "the closest earlier one instead of from the start of the frame. 0 disables them.");
+RDOC_CONFIG(uint32_t, Vulkan_ReplayCheckpointBudgetMB, 1024,
+            "The maximum amount of GPU memory in megabytes that replay checkpoints can use.");
+
+// one copy region per mip covering every layer and aspect, valid both to and from a copy of the
+// image created with the same parameters.
+static rdcarray<VkImageCopy> WholeImageCopies(const VulkanCreationInfo::Image &info)
+{
+  rdcarray<VkImageCopy> regions;
+
+  VkExtent3D extent = info.extent;
+
+  for(uint32_t m = 0; m < info.mipLevels; m++)
+  {
+    VkImageSubresourceLayers sub = {FormatImageAspects(info.format), m, 0, info.arrayLayers};
+
+    regions.push_back({sub, {0, 0, 0}, sub, {0, 0, 0}, extent});
+
+    extent.width = RDCMAX(extent.width >> 1, 1U);
+    extent.height = RDCMAX(extent.height >> 1, 1U);
+    extent.depth = RDCMAX(extent.depth >> 1, 1U);
+  }
+
+  return regions;
+}
+
+void WrappedVulkan::AddCmdBufferRecordRange(ResourceId cmd)
+{
+  auto it = m_CmdBufferBeginOffsets.find(cmd);
+  if(it != m_CmdBufferBeginOffsets.end())
+    m_CmdBufferRecordRanges.push_back({it->second, m_CurChunkOffset});
+}
+
+int32_t WrappedVulkan::FindReplayCheckpoint(uint32_t lastEventID)
+{
+  // drawcall callbacks expect to see every event from the start of the frame
+  if(Vulkan_ReplayCheckpointInterval() == 0 || m_ReplayCheckpointsUnsupported || m_DrawcallCallback)
+    return -1;
+
+  // the checkpoints are sorted by event, find the last one that leaves something to replay
+  int32_t ret = -1;
+  for(int32_t i = 0; i < m_ReplayCheckpoints.count(); i++)
+  {
+    if(m_ReplayCheckpoints[i].eventId > lastEventID)
+      break;
+    ret = i;
+  }
+
+  return ret;
+}
+
+void WrappedVulkan::CreateReplayCheckpoint(uint64_t chunkOffset)
+{
+  const uint32_t interval = Vulkan_ReplayCheckpointInterval();
+
+  if(interval == 0 || m_ReplayCheckpointsUnsupported || m_DrawcallCallback)
+    return;
+
+  // if this submit wasn't replayed completely or it was the last one we're replaying, there's
+  // nothing to snapshot
+  if(m_RootEventID > m_LastEventID)
+    return;
+
+  // don't create checkpoints closer together than the interval
+  size_t idx = 0;
+  while(idx < m_ReplayCheckpoints.size() && m_ReplayCheckpoints[idx].eventId < m_RootEventID)
+    idx++;
+
+  if(idx > 0 && m_RootEventID - m_ReplayCheckpoints[idx - 1].eventId < interval)
+    return;
+  if(idx < m_ReplayCheckpoints.size() &&
+     m_ReplayCheckpoints[idx].eventId - m_RootEventID < interval)
+    return;
+
+  // resuming from here would skip recording any command buffer that's submitted later
+  for(const rdcpair<uint64_t, uint64_t> &range : m_CmdBufferRecordRanges)
+  {
+    if(range.first < chunkOffset && chunkOffset <= range.second)
+      return;
+  }
+
+  // query pools aren't snapshotted, so resuming here could copy results that were overwritten later
+  // in the frame by the last replay. Events don't need a snapshot, as they're kept set while
+  // replaying and resets are never replayed (see vk_sync_funcs.cpp), so they're the same anywhere.
+  if(m_FrameCopiesQueryResults && chunkOffset > m_FirstQueryWriteOffset)
+    return;
+
+  VulkanResourceManager *rm = GetResourceManager();
+  VkDevice d = GetDev();
+  VkResult vkr = VK_SUCCESS;
+
+  // any resource with initial contents could be written in the frame, as could frame-referenced
+  // memory and descriptor sets without them, so those are what we copy. Everything else is either
+  // unchanged or only has its layout tracked.
+  rdcarray<rdcpair<ResourceId, VkResourceType>> frameResources;
+
+  for(ResourceId id : rm->GetInitialContentIDs())
+  {
+    VkInitialContents initial = rm->GetInitialContents(id);
+
+    // buffers only have initial contents when they're sparse, and checkpoints don't snapshot sparse
+    // bindings
+    if(initial.type == eResBuffer)
+    {
+      RDCLOG("Buffer %s has initial contents, replay checkpoints are unavailable",
+             ToStr(id).c_str());
+      m_ReplayCheckpointsUnsupported = true;
+      return;
+    }
+    else if(initial.tag == VkInitialContents::Sparse)
+    {
+      RDCLOG("Sparse image %s in the frame, replay checkpoints are unavailable", ToStr(id).c_str());
+      m_ReplayCheckpointsUnsupported = true;
+      return;
+    }
+
+    frameResources.push_back({id, initial.type});
+  }
+
+  for(ResourceId id : m_UninitialisedFrameResources)
+  {
+    if(rm->HasLiveResource(id))
+      frameResources.push_back({id, IdentifyTypeByPtr(rm->GetLiveResource(id))});
+  }
+
+  rdcarray<ResourceId> memories, descriptorSets;
+  std::set<ResourceId> images;
+  VkDeviceSize size = 0;
+
+  for(const rdcpair<ResourceId, VkResourceType> &res : frameResources)
+  {
+    ResourceId id = res.first;
+    ResourceId liveid = rm->GetLiveID(id);
+
+    if(res.second == eResDeviceMemory)
+    {
+      if(m_CreationInfo.m_Memory[liveid].wholeMemBuf == VK_NULL_HANDLE)
+      {
+        RDCLOG("Memory %s can't be copied, replay checkpoints are unavailable", ToStr(id).c_str());
+        m_ReplayCheckpointsUnsupported = true;
+        return;
+      }
+
+      memories.push_back(liveid);
+      size += m_CreationInfo.m_Memory[liveid].size;
+    }
+    else if(res.second == eResImage)
+    {
+      if(GetYUVPlaneCount(m_CreationInfo.m_Image[liveid].format) > 1)
+      {
+        RDCLOG("Multi-planar image %s in the frame, replay checkpoints are unavailable",
+               ToStr(id).c_str());
+        m_ReplayCheckpointsUnsupported = true;
+        return;
+      }
+
+      images.insert(liveid);
+
+      VkMemoryRequirements mrq = {};
+      ObjDisp(d)->GetImageMemoryRequirements(Unwrap(d), Unwrap(rm->GetLiveHandle<VkImage>(id)),
+                                             &mrq);
+      size += mrq.size;
+    }
+    else if(res.second == eResDescriptorSet)
+    {
+      descriptorSets.push_back(id);
+    }
+  }
+
+  const VkDeviceSize budget = VkDeviceSize(Vulkan_ReplayCheckpointBudgetMB()) * 1024 * 1024;
+
+  if(m_ReplayCheckpointBytes + size > budget)
+  {
+    RDCDEBUG("Replay checkpoint at %u would exceed the budget", m_RootEventID);
+    return;
+  }
+
+  RDCDEBUG("Creating replay checkpoint at %u", m_RootEventID);
+
+  ReplayCheckpoint checkpoint;
+  checkpoint.eventId = m_RootEventID;
+  checkpoint.chunkOffset = chunkOffset;
+
+  // wait for the frame's work so far to finish before copying its results
+  SubmitCmds();
+  FlushQ();
+  ObjDisp(d)->DeviceWaitIdle(Unwrap(d));
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryBarrier memBarrier = {
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_ALL_WRITE_BITS, VK_ACCESS_ALL_READ_BITS,
+  };
+
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  for(ResourceId liveid : memories)
+  {
+    const VkDeviceSize memSize = m_CreationInfo.m_Memory[liveid].size;
+
+    VkBufferCreateInfo bufInfo = {
+        VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        NULL,
+        0,
+        memSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+    };
+
+    VkBuffer buf = VK_NULL_HANDLE;
+
+    vkr = ObjDisp(d)->CreateBuffer(Unwrap(d), &bufInfo, NULL, &buf);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    rm->WrapResource(Unwrap(d), buf);
+
+    MemoryAllocation alloc =
+        AllocateMemoryForResource(buf, MemoryScope::ReplayCheckpoints, MemoryType::GPULocal);
+
+    vkr = ObjDisp(d)->BindBufferMemory(Unwrap(d), Unwrap(buf), Unwrap(alloc.mem), alloc.offs);
+    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+    VkBufferCopy region = {0, 0, memSize};
+    ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_CreationInfo.m_Memory[liveid].wholeMemBuf),
+                                Unwrap(buf), 1, &region);
+
+    checkpoint.memory.push_back({liveid, buf});
+    m_ReplayCheckpointBytes += alloc.size;
+  }
+
+  for(auto it = m_ImageStates.begin(); it != m_ImageStates.end(); ++it)
+  {
+    LockedImageStateRef state = it->second.LockWrite();
+
+    ReplayCheckpoint::Image image;
+    image.id = it->first;
+    image.state = *state;
+
+    if(images.find(it->first) != images.end())
+    {
+      const VulkanCreationInfo::Image &info = m_CreationInfo.m_Image[it->first];
+
+      VkImageCreateInfo imInfo = {
+          VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+          NULL,
+          0,
+          info.type,
+          info.format,
+          info.extent,
+          info.mipLevels,
+          info.arrayLayers,
+          info.samples,
+          VK_IMAGE_TILING_OPTIMAL,
+          VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+          VK_SHARING_MODE_EXCLUSIVE,
+          0,
+          NULL,
+          VK_IMAGE_LAYOUT_UNDEFINED,
+      };
+
+      vkr = ObjDisp(d)->CreateImage(Unwrap(d), &imInfo, NULL, &image.contents);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      rm->WrapResource(Unwrap(d), image.contents);
+
+      MemoryAllocation alloc = AllocateMemoryForResource(
+          image.contents, MemoryScope::ReplayCheckpoints, MemoryType::GPULocal);
+
+      vkr = ObjDisp(d)->BindImageMemory(Unwrap(d), Unwrap(image.contents), Unwrap(alloc.mem),
+                                        alloc.offs);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      m_ReplayCheckpointBytes += alloc.size;
+
+      VkImageMemoryBarrier barrier = {
+          VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+          NULL,
+          0,
+          VK_ACCESS_TRANSFER_WRITE_BIT,
+          VK_IMAGE_LAYOUT_UNDEFINED,
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          VK_QUEUE_FAMILY_IGNORED,
+          VK_QUEUE_FAMILY_IGNORED,
+          Unwrap(image.contents),
+          {FormatImageAspects(info.format), 0, VK_REMAINING_MIP_LEVELS, 0,
+           VK_REMAINING_ARRAY_LAYERS},
+      };
+
+      DoPipelineBarrier(cmd, 1, &barrier);
+
+      ImageBarrierSequence setupBarriers, cleanupBarriers;
+      state->TempTransition(m_QueueFamilyIdx, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                            VK_ACCESS_TRANSFER_READ_BIT, setupBarriers, cleanupBarriers,
+                            GetImageTransitionInfo());
+      InlineSetupImageBarriers(cmd, setupBarriers);
+      m_setupImageBarriers.Merge(setupBarriers);
+
+      rdcarray<VkImageCopy> regions = WholeImageCopies(info);
+
+      ObjDisp(cmd)->CmdCopyImage(
+          Unwrap(cmd), ToUnwrappedHandle<VkImage>(rm->GetCurrentResource(it->first)),
+          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(image.contents),
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+
+      InlineCleanupImageBarriers(cmd, cleanupBarriers);
+      m_cleanupImageBarriers.Merge(cleanupBarriers);
+
+      // leave the copy ready to be copied back from
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+      DoPipelineBarrier(cmd, 1, &barrier);
+    }
+
+    checkpoint.images.push_back(image);
+  }
+
+  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
+  SubmitCmds();
+  FlushQ();
+  SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+
+  for(ResourceId id : descriptorSets)
+  {
+    DescriptorSetSlot *slots = NULL;
+    uint32_t slotCount = 0;
+    byte *inlineData = NULL;
+    size_t inlineSize = 0;
+
+    m_DescriptorSetState[rm->GetLiveID(id)].data.copy(slots, slotCount, inlineData, inlineSize);
+
+    // the tracked contents refer to live resources, but the writes are created from original IDs
+    // as they are when loading initial contents
+    auto toOriginal = [rm](ResourceId &res) {
+      res = rm->HasCurrentResource(res) ? rm->GetOriginalID(res) : ResourceId();
+    };
+
+    for(uint32_t s = 0; s < slotCount; s++)
+    {
+      toOriginal(slots[s].bufferInfo.buffer);
+      toOriginal(slots[s].imageInfo.sampler);
+      toOriginal(slots[s].imageInfo.imageView);
+      toOriginal(slots[s].texelBufferView);
+    }
+
+    VkInitialContents contents;
+    CreateDescriptorWrites(id, slots, slotCount, bytebuf(inlineData, inlineSize), contents);
+
+    checkpoint.descriptorSets.push_back({id, contents});
+
+    SAFE_DELETE_ARRAY(slots);
+    FreeAlignedBuffer(inlineData);
+  }
+
+  m_ReplayCheckpoints.insert(idx, checkpoint);
+}
+
+void WrappedVulkan::ApplyReplayCheckpoint(const ReplayCheckpoint &checkpoint)
+{
+  RENDERDOC_PROFILEFUNCTION();
+  VkMarkerRegion region("ApplyReplayCheckpoint");
+
+  VulkanResourceManager *rm = GetResourceManager();
+  VkResult vkr = VK_SUCCESS;
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryBarrier memBarrier = {
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_ALL_WRITE_BITS, VK_ACCESS_ALL_READ_BITS,
+  };
+
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  for(const rdcpair<ResourceId, VkBuffer> &mem : checkpoint.memory)
+  {
+    VkBufferCopy region = {0, 0, m_CreationInfo.m_Memory[mem.first].size};
+    ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(mem.second),
+                                Unwrap(m_CreationInfo.m_Memory[mem.first].wholeMemBuf), 1, &region);
+  }
+
+  // images may be bound to the memory we just restored, so finish with it before copying them
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  for(const ReplayCheckpoint::Image &image : checkpoint.images)
+  {
+    auto it = m_ImageStates.find(image.id);
+    if(it == m_ImageStates.end())
+      continue;
+
+    LockedImageStateRef state = it->second.LockWrite();
+
+    if(image.contents != VK_NULL_HANDLE)
+    {
+      ImageBarrierSequence setupBarriers;
+      state->DiscardContents();
+      state->Transition(m_QueueFamilyIdx, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                        VK_ACCESS_TRANSFER_WRITE_BIT, setupBarriers, GetImageTransitionInfo());
+      InlineSetupImageBarriers(cmd, setupBarriers);
+      m_setupImageBarriers.Merge(setupBarriers);
+
+      rdcarray<VkImageCopy> regions = WholeImageCopies(m_CreationInfo.m_Image[image.id]);
+
+      ObjDisp(cmd)->CmdCopyImage(Unwrap(cmd), Unwrap(image.contents),
+                                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                 ToUnwrappedHandle<VkImage>(rm->GetCurrentResource(image.id)),
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(),
+                                 regions.data());
+    }
+
+    // return to the layouts at the checkpoint. Any barriers that can't be recorded here are on
+    // other queues and must come after this command buffer.
+    ImageBarrierSequence restoreBarriers;
+    state->Transition(image.state, VK_ACCESS_ALL_WRITE_BITS, VK_ACCESS_ALL_READ_BITS,
+                      restoreBarriers, GetImageTransitionInfo());
+    InlineSetupImageBarriers(cmd, restoreBarriers);
+    m_cleanupImageBarriers.Merge(restoreBarriers);
+
+    *state = image.state;
+  }
+
+  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
+  SubmitCmds();
+  FlushQ();
+  SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+
+  for(const rdcpair<ResourceId, VkInitialContents> &desc : checkpoint.descriptorSets)
+    Apply_InitialState(rm->GetLiveResource(desc.first), desc.second);
+}
+
+void WrappedVulkan::FreeReplayCheckpoints()
+{
+  // the events replayed so far may no longer match what replaying them now would do
+  m_ReplayedEventID = 0;
+
+  if(m_ReplayCheckpoints.empty())
+    return;
+
+  VulkanResourceManager *rm = GetResourceManager();
+  VkDevice d = GetDev();
+
+  ObjDisp(d)->DeviceWaitIdle(Unwrap(d));
+
+  for(ReplayCheckpoint &checkpoint : m_ReplayCheckpoints)
+  {
+    for(rdcpair<ResourceId, VkBuffer> &mem : checkpoint.memory)
+    {
+      ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(mem.second), NULL);
+      rm->ReleaseWrappedResource(mem.second);
+    }
+
+    for(ReplayCheckpoint::Image &image : checkpoint.images)
+    {
+      if(image.contents == VK_NULL_HANDLE)
+        continue;
+
+      ObjDisp(d)->DestroyImage(Unwrap(d), Unwrap(image.contents), NULL);
+      rm->ReleaseWrappedResource(image.contents);
+    }
+
+    for(rdcpair<ResourceId, VkInitialContents> &desc : checkpoint.descriptorSets)
+      desc.second.Free(rm);
+  }
+
+  m_ReplayCheckpoints.clear();
+  m_ReplayCheckpointBytes = 0;
+
+  FreeAllMemory(MemoryScope::ReplayCheckpoints);
+}
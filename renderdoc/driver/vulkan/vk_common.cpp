@@ -344,6 +344,15 @@ bool VkInitParams::IsSupportedVersion(uint64_t ver)
   if(ver == CurrentVersion)
     return true;
 
+  // 0x13 -> 0x14 - large buffers can be stored once in a separate buffer store section, referenced
+  // by their size with the top bit set
+  if(ver == 0x13)
+    return true;
+
+  // 0x12 -> 0x13 - all-zero pages of device memory initial contents are no longer serialised
+  if(ver == 0x12)
+    return true;
+
   // 0x11 -> 0x12 - added inline uniform block support
   if(ver == 0x11)
     return true;
@@ -364,6 +364,7 @@ enum class MemoryScope : uint8_t
   // allocated the same way
   ImmutableReplayDebug = InitialContents,
   IndirectReadback,
+  ReplayCheckpoints,
   Count,
 };
 
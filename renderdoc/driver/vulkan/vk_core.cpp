@@ -26,6 +26,7 @@
 #include <ctype.h>
 #include <algorithm>
 #include "driver/ihv/amd/amd_rgp.h"
+#include "core/settings.h"
 #include "driver/shaders/spirv/spirv_compile.h"
 #include "jpeg-compressor/jpge.h"
 #include "maths/formatpacking.h"
@@ -36,6 +37,10 @@
 
 #include "stb/stb_image_write.h"
 
+RDOC_CONFIG(bool, Vulkan_Debug_SerialShaderReflection, false,
+            "Parse and reflect shaders on the replay thread while loading a capture, instead of "
+            "on worker threads.");
+
 uint64_t VkInitParams::GetSerialiseSize()
 {
   // misc bytes and fixed integer members
@@ -2001,6 +2006,10 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
 
     ser.SetUserData(GetResourceManager());
 
+    // large buffers like initial contents are stored once per unique contents
+    if(rdc)
+      ser.SetBufferStore(rdc->GetBufferStore(), Ownership::Nothing);
+
     {
       SCOPED_SERIALISE_CHUNK(SystemChunk::DriverInit, m_InitParams.GetSerialiseSize());
 
@@ -2278,6 +2287,9 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   if(sectionIdx < 0)
     return ReplayStatus::FileCorrupted;
 
+  // the buffer store is read before the frame capture, since section readers share the file
+  BufferStore *bufferStore = rdc->ReadBufferStore();
+
   StreamReader *reader = rdc->ReadSection(sectionIdx);
 
   if(IsStructuredExporting(m_State))
@@ -2295,6 +2307,7 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   if(reader->IsErrored())
   {
     delete reader;
+    delete bufferStore;
     return ReplayStatus::FileIOFailed;
   }
 
@@ -2302,6 +2315,7 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
 
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
+  ser.SetBufferStore(bufferStore, Ownership::Stream);
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
 
@@ -2331,6 +2345,12 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
   if(m_ReplayOptions.apiValidation)
     sink = new ScopedDebugMessageSink(this);
 
+  // shader reflection doesn't need anything from the GPU, so do it in the background while we
+  // process other chunks.
+  VulkanReflectionJobs reflectionJobs(
+      m_CreationInfo.m_ReflectionJobs,
+      !Vulkan_Debug_SerialShaderReflection() && !IsStructuredExporting(m_State));
+
   for(;;)
   {
     PerformanceTimer timer;
@@ -2404,6 +2424,10 @@ ReplayStatus WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStruct
       for(auto it = m_CreationInfo.m_Memory.begin(); it != m_CreationInfo.m_Memory.end(); ++it)
         it->second.SimplifyBindings();
 
+      // the frame needs all shader reflection to be complete
+      reflectionJobs.Finish();
+      m_CreationInfo.WaitForShaderParsing();
+
       ReplayStatus status = ContextReplayLog(m_State, 0, 0, false);
 
       if(status != ReplayStatus::Succeeded)
@@ -2558,6 +2582,19 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
     // that we ended up selecting (the one that was closest)
     if(startEventID == endEventID && m_RootEventID != m_FirstEventID)
       m_FirstEventID = m_LastEventID = m_RootEventID;
+
+    // continue from the checkpoint instead of the start of the frame
+    if(!partial && m_ResumeCheckpoint >= 0)
+    {
+      const ReplayCheckpoint &checkpoint = m_ReplayCheckpoints[m_ResumeCheckpoint];
+
+      ApplyReplayCheckpoint(checkpoint);
+
+      m_RootEventID = checkpoint.eventId;
+      ser.GetReader()->SetOffset(checkpoint.chunkOffset);
+    }
+
+    m_ResumeCheckpoint = -1;
   }
   else
   {
@@ -2636,6 +2673,21 @@ ReplayStatus WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t sta
          chunktype != VulkanChunk::vkEndCommandBuffer)
         m_BakedCmdBufferInfo[m_LastCmdBufferID].curEventID++;
     }
+
+    if(IsLoading(m_State))
+    {
+      if(chunktype == VulkanChunk::vkCmdEndQuery ||
+         chunktype == VulkanChunk::vkCmdEndQueryIndexedEXT ||
+         chunktype == VulkanChunk::vkCmdWriteTimestamp)
+        m_FirstQueryWriteOffset = RDCMIN(m_FirstQueryWriteOffset, m_CurChunkOffset);
+      else if(chunktype == VulkanChunk::vkCmdCopyQueryPoolResults)
+        m_FrameCopiesQueryResults = true;
+    }
+
+    if(chunktype == VulkanChunk::vkQueueBindSparse)
+      m_ReplayCheckpointsUnsupported = true;
+    else if(!partial && chunktype == VulkanChunk::vkQueueSubmit && IsActiveReplaying(m_State))
+      CreateReplayCheckpoint(ser.GetReader()->GetOffset());
   }
 
   if(!partial && !IsStructuredExporting(m_State))
@@ -3370,6 +3422,9 @@ VkResourceRecord *WrappedVulkan::RegisterSurface(WindowingSystem system, void *h
 
 void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
+  // we don't know where an arbitrary replay leaves things, SeekReplayLog sets this again afterwards
+  m_ReplayedEventID = 0;
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -3380,9 +3435,17 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
 
   if(!partial)
   {
-    VkMarkerRegion::Begin("!!!!RenderDoc Internal: ApplyInitialContents");
-    ApplyInitialContents();
-    VkMarkerRegion::End();
+    // if we have a checkpoint before the events to replay, it's applied once replaying starts and
+    // restores everything that the initial contents would
+    m_ResumeCheckpoint = FindReplayCheckpoint(
+        replayType == eReplay_Full ? endEventID : RDCMAX(1U, endEventID) - 1);
+
+    if(m_ResumeCheckpoint < 0)
+    {
+      VkMarkerRegion::Begin("!!!!RenderDoc Internal: ApplyInitialContents");
+      ApplyInitialContents();
+      VkMarkerRegion::End();
+    }
   }
 
   m_State = CaptureState::ActiveReplaying;
@@ -3516,6 +3579,105 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
   VkMarkerRegion::Set("!!!!RenderDoc Internal: Done replay");
 }
 
+void WrappedVulkan::SeekReplayLog(uint32_t endEventID, ReplayLogType replayType)
+{
+  const uint32_t replayedEventID = m_ReplayedEventID;
+
+  // the last event that has been executed once this replay is done
+  const uint32_t lastEventID =
+      replayType == eReplay_WithoutDraw ? RDCMAX(1U, endEventID) - 1 : endEventID;
+
+  if(replayType == eReplay_OnlyDraw)
+  {
+    ReplayLog(0, endEventID, replayType);
+
+    // the draw only moves our position on if everything before it was already replayed
+    if(replayedEventID != 0 && replayedEventID + 1 == endEventID)
+      m_ReplayedEventID = endEventID;
+  }
+  else if(CanReplayForward(replayedEventID, lastEventID))
+  {
+    // everything up to our position has already executed, and the events after it are all within
+    // the partial command buffer, so we only need to replay those onto an outside command buffer
+    // without restoring initial contents.
+    if(lastEventID > replayedEventID)
+      ReplayLog(replayedEventID + 1, lastEventID, eReplay_Full);
+
+    m_ReplayedEventID = lastEventID;
+  }
+  else
+  {
+    ReplayLog(0, endEventID, replayType);
+
+    // if the replay stopped partway through a command buffer, later events in it can continue on
+    if(m_Partial[Primary].partialParent != ResourceId() &&
+       m_Partial[Secondary].partialParent == ResourceId())
+      m_ReplayedEventID = lastEventID;
+  }
+
+  // a callback may have changed what was executed
+  if(m_DrawcallCallback)
+    m_ReplayedEventID = 0;
+}
+
+bool WrappedVulkan::CanReplayForward(uint32_t fromEventID, uint32_t toEventID)
+{
+  if(fromEventID == 0 || toEventID < fromEventID || m_DrawcallCallback)
+    return false;
+
+  // we can only continue within the primary command buffer the last replay stopped in, secondary
+  // command buffers are replayed from their execute.
+  const PartialReplayData &partialData = m_Partial[Primary];
+  if(partialData.partialParent == ResourceId() ||
+     m_Partial[Secondary].partialParent != ResourceId())
+    return false;
+
+  const uint32_t length = m_BakedCmdBufferInfo[partialData.partialParent].eventCount;
+  if(fromEventID < partialData.baseEvent || toEventID >= partialData.baseEvent + length)
+    return false;
+
+  // these are ended at the end of every partial replay
+  if(!m_RenderState.xfbcounters.empty() || m_RenderState.IsConditionalRenderingEnabled())
+    return false;
+
+  for(uint32_t eid = fromEventID; eid <= toEventID; eid++)
+  {
+    // skipped events mean replays snap to a nearby event, so we can't be sure of our position
+    if(eid >= m_Events.size() || m_Events[eid].eventId != eid)
+      return false;
+
+    VulkanChunk chunk =
+        (VulkanChunk)m_StructuredFile->chunks[m_Events[eid].chunkIndex]->metadata.chunkID;
+
+    switch(chunk)
+    {
+      // a partial replay restores the render pass and image layouts from when the partial command
+      // buffer was set up, so commands that change them can't be replayed piecemeal. Likewise
+      // queries and secondary command buffers must begin and end in the same replay.
+      case VulkanChunk::vkCmdBeginRenderPass:
+      case VulkanChunk::vkCmdBeginRenderPass2:
+      case VulkanChunk::vkCmdNextSubpass:
+      case VulkanChunk::vkCmdNextSubpass2:
+      case VulkanChunk::vkCmdEndRenderPass:
+      case VulkanChunk::vkCmdEndRenderPass2:
+      case VulkanChunk::vkCmdPipelineBarrier:
+      case VulkanChunk::vkCmdWaitEvents:
+      case VulkanChunk::vkCmdExecuteCommands:
+      case VulkanChunk::vkCmdBeginQuery:
+      case VulkanChunk::vkCmdEndQuery:
+      case VulkanChunk::vkCmdBeginQueryIndexedEXT:
+      case VulkanChunk::vkCmdEndQueryIndexedEXT:
+      case VulkanChunk::vkCmdBeginTransformFeedbackEXT:
+      case VulkanChunk::vkCmdEndTransformFeedbackEXT:
+      case VulkanChunk::vkCmdBeginConditionalRenderingEXT:
+      case VulkanChunk::vkCmdEndConditionalRenderingEXT: return false;
+      default: break;
+    }
+  }
+
+  return true;
+}
+
 template <typename SerialiserType>
 void WrappedVulkan::Serialise_DebugMessages(SerialiserType &ser)
 {
@@ -53,7 +53,7 @@ struct VkInitParams
   uint64_t GetSerialiseSize();
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x12;
+  static const uint64_t CurrentVersion = 0x14;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -900,6 +900,70 @@ private:
 
   void ApplyInitialContents();
 
+  bool CreateDescriptorWrites(ResourceId id, const DescriptorSetSlot *Bindings,
+                              uint32_t NumBindings, const bytebuf &InlineData,
+                              VkInitialContents &initialContents);
+
+  // a snapshot of the replayed frame's state between queue submits. A replay to a later event can
+  // apply it and continue from there, instead of applying initial contents and replaying from the
+  // start of the frame. Checkpoints are created lazily as replays pass over queue submits.
+  struct ReplayCheckpoint
+  {
+    // the first event still to replay after applying the checkpoint, and the offset of its chunk
+    uint32_t eventId = 0;
+    uint64_t chunkOffset = 0;
+
+    // copies of the device memory with initial contents, by live ID
+    rdcarray<rdcpair<ResourceId, VkBuffer>> memory;
+
+    struct Image
+    {
+      ResourceId id;
+      ImageState state;
+      // a copy of the image contents, if it has initial contents and so may be written in the frame
+      VkImage contents = VK_NULL_HANDLE;
+    };
+    rdcarray<Image> images;
+
+    // writes restoring each descriptor set referenced in the frame, by original ID
+    rdcarray<rdcpair<ResourceId, VkInitialContents>> descriptorSets;
+  };
+
+  rdcarray<ReplayCheckpoint> m_ReplayCheckpoints;
+  VkDeviceSize m_ReplayCheckpointBytes = 0;
+  // set if the frame does something that checkpoints can't snapshot, such as sparse binding
+  bool m_ReplayCheckpointsUnsupported = false;
+  // the checkpoint that the next full replay resumes from, if any
+  int32_t m_ResumeCheckpoint = -1;
+
+  // device memory and descriptor sets referenced in the frame that have no initial contents, by
+  // original ID. The frame can still write to them, so checkpoints snapshot them as well.
+  std::set<ResourceId> m_UninitialisedFrameResources;
+
+  // the chunk offset of the vkBeginCommandBuffer for the latest recording of each command buffer,
+  // by original ID. Only tracked while loading.
+  std::map<ResourceId, uint64_t> m_CmdBufferBeginOffsets;
+  // chunk offset ranges from where a command buffer's recording begins to where it's submitted, or
+  // executed from a primary. Resuming from a checkpoint inside one would skip the recording, so no
+  // checkpoints are created there.
+  rdcarray<rdcpair<uint64_t, uint64_t>> m_CmdBufferRecordRanges;
+  // the chunk offset of the first query written in the frame, and whether the frame copies query
+  // results on the GPU. Checkpoints don't snapshot query pools, so if results written before one
+  // could be copied after it, no checkpoints are created from that first write onwards.
+  uint64_t m_FirstQueryWriteOffset = ~0ULL;
+  bool m_FrameCopiesQueryResults = false;
+
+  void AddCmdBufferRecordRange(ResourceId cmd);
+  int32_t FindReplayCheckpoint(uint32_t lastEventID);
+  void CreateReplayCheckpoint(uint64_t chunkOffset);
+  void ApplyReplayCheckpoint(const ReplayCheckpoint &checkpoint);
+
+  // the last event executed by SeekReplayLog, or 0 if anything else has been replayed since. Moving
+  // forward from here within the same command buffer only needs to replay the events in between.
+  uint32_t m_ReplayedEventID = 0;
+
+  bool CanReplayForward(uint32_t fromEventID, uint32_t toEventID);
+
   rdcarray<APIEvent> m_RootEvents, m_Events;
   bool m_AddedDrawcall;
 
@@ -1029,6 +1093,9 @@ public:
   }
   void Shutdown();
   void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
+  // replays up to endEventID the same as ReplayLog(0, endEventID, replayType), but continues from
+  // the previous SeekReplayLog's position instead of the start of the frame when possible.
+  void SeekReplayLog(uint32_t endEventID, ReplayLogType replayType);
   void ReplayDraw(VkCommandBuffer cmd, const DrawcallDescription &drawcall);
   ReplayStatus ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
 
@@ -1097,6 +1164,9 @@ public:
   bool ExtendedDynamicState() const { return m_ExtendedDynState; }
   VulkanRenderState &GetRenderState() { return m_RenderState; }
   void SetDrawcallCB(VulkanDrawcallCallback *cb) { m_DrawcallCallback = cb; }
+  // must be called whenever replaying the frame would give different results, e.g. when a shader
+  // is replaced
+  void FreeReplayCheckpoints();
   void SetSubmitChain(void *submitChain) { m_SubmitChain = submitChain; }
   static bool IsSupportedExtension(const char *extName);
   static void FilterToSupportedExtensions(rdcarray<VkExtensionProperties> &exts,
@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "vk_info.h"
+#include "common/threading.h"
 
 VkDynamicState ConvertDynamicState(VulkanDynamicStateIndex idx)
 {
@@ -391,8 +392,8 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan,
 
     ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
 
-    reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
-                  pCreateInfo->pStages[i].stage, shad.specialization);
+    info.ReflectShaderModule(resourceMan, shadid, reflData, shad.entryPoint,
+                             pCreateInfo->pStages[i].stage, shad.specialization);
 
     shad.refl = &reflData.refl;
     shad.mapping = &reflData.mapping;
@@ -720,8 +721,8 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
 
     ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
 
-    reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
-                  pCreateInfo->stage.stage, shad.specialization);
+    info.ReflectShaderModule(resourceMan, shadid, reflData, shad.entryPoint,
+                             pCreateInfo->stage.stage, shad.specialization);
 
     shad.refl = &reflData.refl;
     shad.mapping = &reflData.mapping;
@@ -1258,6 +1259,51 @@ void VulkanCreationInfo::ImageView::Init(VulkanResourceManager *resourceMan, Vul
   componentMapping = pCreateInfo->components;
 }
 
+VulkanReflectionJobs::VulkanReflectionJobs(VulkanReflectionJobs *&owner, bool parallel)
+    : m_Owner(owner), m_Parallel(parallel)
+{
+  m_Owner = this;
+}
+
+VulkanReflectionJobs::~VulkanReflectionJobs()
+{
+  Finish();
+}
+
+void VulkanReflectionJobs::Add(std::function<void()> job)
+{
+  // when running serially, just run the job immediately
+  if(!m_Parallel)
+  {
+    job();
+    return;
+  }
+
+  m_Jobs.Run(job);
+}
+
+Threading::Future<bool> VulkanReflectionJobs::AddWaitable(std::function<void()> job)
+{
+  if(!m_Parallel)
+  {
+    job();
+    return Threading::Future<bool>();
+  }
+
+  return Threading::Async([job]() {
+    job();
+    return true;
+  });
+}
+
+void VulkanReflectionJobs::Finish()
+{
+  if(m_Owner == this)
+    m_Owner = NULL;
+
+  m_Jobs.Wait();
+}
+
 void VulkanCreationInfo::ShaderModule::Init(VulkanResourceManager *resourceMan,
                                             VulkanCreationInfo &info,
                                             const VkShaderModuleCreateInfo *pCreateInfo)
@@ -1270,9 +1316,61 @@ void VulkanCreationInfo::ShaderModule::Init(VulkanResourceManager *resourceMan,
   else
   {
     RDCASSERT(pCreateInfo->codeSize % sizeof(uint32_t) == 0);
-    spirv.Parse(rdcarray<uint32_t>((uint32_t *)(pCreateInfo->pCode),
-                                   pCreateInfo->codeSize / sizeof(uint32_t)));
+    rdcarray<uint32_t> words((uint32_t *)(pCreateInfo->pCode),
+                             pCreateInfo->codeSize / sizeof(uint32_t));
+
+    if(info.m_ReflectionJobs)
+    {
+      ShaderModule *module = this;
+      parse = info.m_ReflectionJobs->AddWaitable([module, words]() { module->spirv.Parse(words); });
+    }
+    else
+    {
+      spirv.Parse(words);
+    }
+  }
+}
+
+void VulkanCreationInfo::WaitForShaderParsing()
+{
+  for(auto it = m_ShaderModule.begin(); it != m_ShaderModule.end(); ++it)
+    it->second.WaitForParse();
+}
+
+void VulkanCreationInfo::ReflectShaderModule(VulkanResourceManager *resourceMan, ResourceId shadid,
+                                             ShaderModuleReflection &reflData, const rdcstr &entry,
+                                             VkShaderStageFlagBits stage,
+                                             const rdcarray<SpecConstant> &specInfo)
+{
+  ShaderModule &module = m_ShaderModule[shadid];
+
+  if(m_ReflectionJobs == NULL)
+  {
+    reflData.Init(resourceMan, shadid, module.spirv, entry, stage, specInfo);
+    return;
   }
+
+  // reflection is shared between pipelines that don't specialise, only the first needs to do it.
+  // Fill out the entry point now so that's the case even while the job is still pending.
+  if(!reflData.entryPoint.empty())
+    return;
+
+  reflData.entryPoint = entry;
+  reflData.stageIndex = StageIndex(stage);
+
+  ShaderModule *mod = &module;
+  ShaderModuleReflection *refl = &reflData;
+  ResourceId origId = resourceMan->GetOriginalID(shadid);
+
+  // the module's parse job was added before this one, so waiting on it can't deadlock
+  m_ReflectionJobs->Add([mod, refl, origId, specInfo]() {
+    mod->WaitForParse();
+
+    mod->spirv.MakeReflection(GraphicsAPI::Vulkan, ShaderStage(refl->stageIndex), refl->entryPoint,
+                              specInfo, refl->refl, refl->mapping, refl->patchData);
+
+    refl->refl.resourceId = origId;
+  });
 }
 
 void VulkanCreationInfo::ShaderModuleReflection::Init(VulkanResourceManager *resourceMan,
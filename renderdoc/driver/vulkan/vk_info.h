@@ -189,6 +189,31 @@ struct DescUpdateTemplate
   rdcarray<VkDescriptorUpdateTemplateEntry> updates;
 };
 
+// While a capture is loading, SPIR-V parsing and shader reflection are run on the task pool since
+// they don't depend on any GPU state. Jobs are only added from the loading thread, so they're
+// started in the order they're added and a job can safely wait on any job that was added before it.
+class VulkanReflectionJobs
+{
+public:
+  // registers itself in owner for the lifetime of the object, or until Finish() is called
+  VulkanReflectionJobs(VulkanReflectionJobs *&owner, bool parallel);
+  ~VulkanReflectionJobs();
+
+  void Add(std::function<void()> job);
+  // runs a job that later jobs can wait on individually. When running serially the job is run
+  // immediately and the returned future is invalid.
+  Threading::Future<bool> AddWaitable(std::function<void()> job);
+
+  // waits for all jobs to complete
+  void Finish();
+
+private:
+  VulkanReflectionJobs *&m_Owner;
+
+  bool m_Parallel;
+  Threading::TaskGroup m_Jobs;
+};
+
 struct VulkanCreationInfo
 {
   struct ShaderModuleReflectionKey
@@ -608,12 +633,31 @@ struct VulkanCreationInfo
 
     rdcspv::Reflector spirv;
 
+    // valid while the SPIR-V is being parsed on a worker thread during load. Only pipeline
+    // creation needs the parsed SPIR-V during load, anything afterwards happens once all parses
+    // are complete.
+    Threading::Future<bool> parse;
+    void WaitForParse()
+    {
+      if(parse.IsValid())
+        parse.Get();
+    }
+
     rdcstr unstrippedPath;
 
     std::map<ShaderModuleReflectionKey, ShaderModuleReflection> m_Reflections;
   };
   std::unordered_map<ResourceId, ShaderModule> m_ShaderModule;
 
+  // reflects an entry point in a shader module, on a worker thread while loading
+  void ReflectShaderModule(VulkanResourceManager *resourceMan, ResourceId shadid,
+                           ShaderModuleReflection &reflData, const rdcstr &entry,
+                           VkShaderStageFlagBits stage, const rdcarray<SpecConstant> &specInfo);
+
+  VulkanReflectionJobs *m_ReflectionJobs = NULL;
+  // waits for any SPIR-V that's still being parsed in the background
+  void WaitForShaderParsing();
+
   struct DescSetPool
   {
     void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
@@ -26,6 +26,15 @@
 #include "vk_core.h"
 #include "vk_debug.h"
 
+RDOC_CONFIG(uint32_t, Vulkan_InitialContentsZeroPageSize, 4096,
+            "The granularity in bytes at which all-zero regions of device memory initial contents "
+            "are detected and left out of the capture. 0 disables zero page elision.");
+
+static VkDeviceSize GetZeroPageSize()
+{
+  return AlignUp4(Vulkan_InitialContentsZeroPageSize());
+}
+
 // VKTODOLOW there's a lot of duplicated code in this file for creating a buffer to do
 // a memory copy and saving to disk.
 
@@ -534,13 +543,83 @@ uint64_t WrappedVulkan::GetSize_InitialState(ResourceId id, const VkInitialConte
       return GetSize_SparseInitialState(id, initial);
 
     // the size primarily comes from the buffer, the size of which we conveniently have stored.
-    return uint64_t(128 + initial.mem.size + WriteSerialiser::GetChunkAlignment());
+    uint64_t ret = uint64_t(128 + initial.mem.size + WriteSerialiser::GetChunkAlignment());
+
+    // device memory also stores the list of non-zero ranges. In the worst case every other page is
+    // zero, so allow for one range per page.
+    if(initial.type == eResDeviceMemory)
+    {
+      VkDeviceSize pageSize = GetZeroPageSize();
+      uint64_t maxRanges = pageSize == 0 ? 1 : initial.mem.size / pageSize + 1;
+      ret += maxRanges * sizeof(VkBufferCopy);
+    }
+
+    return ret;
   }
 
   RDCERR("Unhandled resource type %s", ToStr(initial.type).c_str());
   return 128;
 }
 
+// checks a block of memory for any non-zero bytes. The bulk is processed 64 bytes at a time with
+// independent loads so that the compiler can vectorise it.
+static bool IsZeroBlock(const byte *data, size_t size)
+{
+  size_t i = 0;
+
+  if((uintptr_t(data) % sizeof(uint64_t)) == 0)
+  {
+    const uint64_t *words = (const uint64_t *)data;
+    for(; i + 64 <= size; i += 64, words += 8)
+    {
+      uint64_t bits = (words[0] | words[1]) | (words[2] | words[3]) | (words[4] | words[5]) |
+                      (words[6] | words[7]);
+      if(bits != 0)
+        return false;
+    }
+  }
+
+  for(; i < size; i++)
+    if(data[i] != 0)
+      return false;
+
+  return true;
+}
+
+// returns the ranges of data that contain non-zero bytes, at pageSize granularity. dstOffset is the
+// offset in data and srcOffset is the offset once the ranges are packed together.
+static rdcarray<VkBufferCopy> FindNonZeroRanges(const byte *data, VkDeviceSize size,
+                                                VkDeviceSize pageSize)
+{
+  rdcarray<VkBufferCopy> ret;
+
+  if(pageSize == 0)
+  {
+    if(size > 0)
+      ret.push_back({0, 0, size});
+    return ret;
+  }
+
+  VkDeviceSize packedSize = 0;
+
+  for(VkDeviceSize offs = 0; offs < size; offs += pageSize)
+  {
+    VkDeviceSize len = RDCMIN(pageSize, size - offs);
+
+    if(IsZeroBlock(data + offs, (size_t)len))
+      continue;
+
+    if(!ret.empty() && ret.back().dstOffset + ret.back().size == offs)
+      ret.back().size += len;
+    else
+      ret.push_back({packedSize, offs, len});
+
+    packedSize += len;
+  }
+
+  return ret;
+}
+
 static rdcliteral NameOfType(VkResourceType type)
 {
   switch(type)
@@ -603,7 +682,6 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
     // while reading, fetch the binding information and allocate a VkWriteDescriptorSet array
     if(IsReplayingAndReading())
     {
-      WrappedVkRes *res = GetResourceManager()->GetLiveResource(id);
       ResourceId liveid = GetResourceManager()->GetLiveID(id);
 
       const DescSetLayout &layout =
@@ -615,273 +693,10 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
         return true;
       }
 
-      VkInitialContents initialContents(type, VkInitialContents::DescriptorSet);
-
-      initialContents.numDescriptors = (uint32_t)layout.bindings.size();
-      initialContents.descriptorInfo = new VkDescriptorBufferInfo[NumBindings];
-      initialContents.inlineInfo = NULL;
-
-      if(layout.inlineCount > 0)
-      {
-        initialContents.inlineInfo =
-            new VkWriteDescriptorSetInlineUniformBlockEXT[layout.inlineCount];
-        initialContents.inlineData = AllocAlignedBuffer(InlineData.size());
-        RDCASSERTEQUAL(layout.inlineByteSize, InlineData.size());
-        memcpy(initialContents.inlineData, InlineData.data(), InlineData.size());
-      }
-
-      // if we have partially-valid arrays, we need to split up writes. The worst case will never be
-      // == number of bindings since that implies all arrays are valid, but it is an upper bound as
-      // we'll never need more writes than bindings
-      initialContents.descriptorWrites = new VkWriteDescriptorSet[NumBindings];
-
-      RDCCOMPILE_ASSERT(sizeof(VkDescriptorBufferInfo) >= sizeof(VkDescriptorImageInfo),
-                        "Descriptor structs sizes are unexpected, ensure largest size is used");
-
-      VkWriteDescriptorSet *writes = initialContents.descriptorWrites;
-      VkDescriptorBufferInfo *dstData = initialContents.descriptorInfo;
-      VkWriteDescriptorSetInlineUniformBlockEXT *dstInline = initialContents.inlineInfo;
-      DescriptorSetSlot *srcData = Bindings;
-
-      byte *srcInlineData = initialContents.inlineData;
-
-      // validBinds counts up as we make a valid VkWriteDescriptorSet, so can be used to index into
-      // writes[] along the way as the 'latest' write.
-      uint32_t bind = 0;
-
-      for(uint32_t j = 0; j < initialContents.numDescriptors; j++)
-      {
-        uint32_t descriptorCount = layout.bindings[j].descriptorCount;
-
-        if(layout.bindings[j].variableSize)
-          descriptorCount = m_DescriptorSetState[liveid].data.variableDescriptorCount;
-
-        if(descriptorCount == 0)
-          continue;
-
-        uint32_t inlineSize = 0;
-
-        if(layout.bindings[j].descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK_EXT)
-        {
-          inlineSize = descriptorCount;
-          descriptorCount = 1;
-        }
-
-        writes[bind].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[bind].pNext = NULL;
-
-        // template for this write. We will expand it to include more descriptors as we find valid
-        // descriptors to update.
-        writes[bind].dstSet = (VkDescriptorSet)(uint64_t)res;
-        writes[bind].dstBinding = j;
-        writes[bind].dstArrayElement = 0;
-        // descriptor count starts at 0. We increment it as we find valid descriptors
-        writes[bind].descriptorCount = 0;
-        writes[bind].descriptorType = layout.bindings[j].descriptorType;
-
-        ResourceId *immutableSamplers = layout.bindings[j].immutableSampler;
-
-        DescriptorSetSlot *src = srcData;
-        srcData += descriptorCount;
-
-        // will be cast to the appropriate type, we just need to increment
-        // the dstData pointer by worst case size
-        VkDescriptorBufferInfo *dstBuffer = dstData;
-        VkDescriptorImageInfo *dstImage = (VkDescriptorImageInfo *)dstData;
-        VkBufferView *dstTexelBuffer = (VkBufferView *)dstData;
-        dstData += descriptorCount;
-
-        RDCCOMPILE_ASSERT(
-            sizeof(VkDescriptorImageInfo) <= sizeof(VkDescriptorBufferInfo),
-            "VkDescriptorBufferInfo should be large enough for all descriptor write types");
-        RDCCOMPILE_ASSERT(
-            sizeof(VkBufferView) <= sizeof(VkDescriptorBufferInfo),
-            "VkDescriptorBufferInfo should be large enough for all descriptor write types");
-
-        // the correct one will be set below
-        writes[bind].pBufferInfo = NULL;
-        writes[bind].pImageInfo = NULL;
-        writes[bind].pTexelBufferView = NULL;
-
-        // check that the resources we need for this write are present, as some might have been
-        // skipped due to stale descriptor set slots or otherwise unreferenced objects (the
-        // descriptor set initial contents do not cause a frame reference for their resources).
-        //
-        // For the non-array case it's trivial as either the descriptor is valid, in which case it
-        // gets a write, or not, in which case we skip.
-        // For the array case we batch up updates as much as possible, iterating along the array and
-        // skipping any invalid descriptors.
-
-        if(writes[bind].descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK_EXT)
-        {
-          // handle inline uniform block specially because the descriptorCount doesn't mean what it
-          // normally means in the write.
-
-          dstInline->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_INLINE_UNIFORM_BLOCK_EXT;
-          dstInline->pNext = NULL;
-          dstInline->pData = srcInlineData + src->inlineOffset;
-          dstInline->dataSize = inlineSize;
-
-          writes[bind].pNext = dstInline;
-          writes[bind].descriptorCount = inlineSize;
-          bind++;
-
-          dstInline++;
-        }
-        // quick check for slots that were completely uninitialised and so don't have valid data
-        else if(!NULLDescriptorsAllowed() && descriptorCount == 1 &&
-                src->texelBufferView == ResourceId() && src->imageInfo.sampler == ResourceId() &&
-                src->imageInfo.imageView == ResourceId() && src->bufferInfo.buffer == ResourceId())
-        {
-          // do nothing - don't increment bind so that the same write descriptor is used next time.
-          continue;
-        }
-        else
-        {
-          // first we copy the right data over unconditionally
-          switch(writes[bind].descriptorType)
-          {
-            case VK_DESCRIPTOR_TYPE_SAMPLER:
-            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-            case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
-            {
-              for(uint32_t d = 0; d < descriptorCount; d++)
-              {
-                if(writes[bind].descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER &&
-                   GetResourceManager()->HasLiveResource(src[d].imageInfo.imageView))
-                  dstImage[d].imageView =
-                      GetResourceManager()->GetLiveHandle<VkImageView>(src[d].imageInfo.imageView);
-                else
-                  dstImage[d].imageView = VK_NULL_HANDLE;
-
-                if((writes[bind].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
-                    writes[bind].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) &&
-                   GetResourceManager()->HasLiveResource(src[d].imageInfo.sampler))
-                  dstImage[d].sampler =
-                      GetResourceManager()->GetLiveHandle<VkSampler>(src[d].imageInfo.sampler);
-                else
-                  dstImage[d].sampler = VK_NULL_HANDLE;
-
-                dstImage[d].imageLayout = src[d].imageInfo.imageLayout;
-              }
-
-              // if we're not updating a SAMPLER descriptor fill in immutable samplers so that our
-              // validity checking doesn't have to look them up.
-              if(immutableSamplers && writes[bind].descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER)
-              {
-                for(uint32_t d = 0; d < descriptorCount; d++)
-                  dstImage[d].sampler =
-                      GetResourceManager()->GetCurrentHandle<VkSampler>(immutableSamplers[d]);
-              }
+      VkInitialContents initialContents;
 
-              writes[bind].pImageInfo = dstImage;
-              // NULL the others
-              dstBuffer = NULL;
-              dstTexelBuffer = NULL;
-              break;
-            }
-            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
-            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-            {
-              for(uint32_t d = 0; d < descriptorCount; d++)
-              {
-                if(GetResourceManager()->HasLiveResource(src[d].texelBufferView))
-                  dstTexelBuffer[d] =
-                      GetResourceManager()->GetLiveHandle<VkBufferView>(src[d].texelBufferView);
-                else
-                  dstTexelBuffer[d] = VK_NULL_HANDLE;
-              }
-
-              writes[bind].pTexelBufferView = dstTexelBuffer;
-              // NULL the others
-              dstBuffer = NULL;
-              dstImage = NULL;
-              break;
-            }
-            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
-            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
-            {
-              for(uint32_t d = 0; d < descriptorCount; d++)
-              {
-                if(GetResourceManager()->HasLiveResource(src[d].bufferInfo.buffer))
-                  dstBuffer[d].buffer =
-                      GetResourceManager()->GetLiveHandle<VkBuffer>(src[d].bufferInfo.buffer);
-                else
-                  dstBuffer[d].buffer = VK_NULL_HANDLE;
-                dstBuffer[d].offset = src[d].bufferInfo.offset;
-                dstBuffer[d].range = src[d].bufferInfo.range;
-              }
-
-              writes[bind].pBufferInfo = dstBuffer;
-              // NULL the others
-              dstImage = NULL;
-              dstTexelBuffer = NULL;
-              break;
-            }
-            default:
-            {
-              RDCERR("Unexpected descriptor type %d", writes[bind].descriptorType);
-              ret = false;
-            }
-          }
-
-          // iterate over all the descriptors coalescing valid writes. At all times writes[bind] is
-          // the 'current' batched update
-          for(uint32_t d = 0; d < descriptorCount; d++)
-          {
-            // is this array element in the write valid? Note that below when we encounter an
-            // invalid write, the next one starts from a later point in the array, so we need to
-            // check relative to the dstArrayElement
-            if(IsValid(NULLDescriptorsAllowed(), writes[bind], d - writes[bind].dstArrayElement))
-            {
-              // if this descriptor is valid, just increment the number of descriptors. The data
-              // and dstArrayElement is pointing to the start of the valid range
-              writes[bind].descriptorCount++;
-            }
-            else
-            {
-              // if this descriptor is *invalid* we must skip it. First see if we have some
-              // previously valid range and commit it
-              if(writes[bind].descriptorCount)
-              {
-                bind++;
-
-                // copy over the previous data for the sake of the things that won't be reset below
-                writes[bind] = writes[bind - 1];
-              }
-
-              // now offset to the next potentially valid descriptor. Note that at the end of the
-              // iteration there is no next descriptor so these pointer values will be off the end
-              // of the array, but descriptorCount will be 0 so this will be treated as invalid and
-              // skipped
-              writes[bind].dstArrayElement = d + 1;
-
-              // start counting from 0 again
-              writes[bind].descriptorCount = 0;
-
-              // offset the array being used
-              if(dstBuffer)
-                writes[bind].pBufferInfo = dstBuffer + d + 1;
-              else if(dstImage)
-                writes[bind].pImageInfo = dstImage + d + 1;
-              else if(dstTexelBuffer)
-                writes[bind].pTexelBufferView = dstTexelBuffer + d + 1;
-            }
-          }
-
-          // after the loop there may be a valid write which hasn't been accounted for. If the
-          // current write has a descriptor count that means it has some descriptors, so
-          // increment i and validBinds so that it's accounted for.
-          if(writes[bind].descriptorCount)
-            bind++;
-        }
-      }
-
-      initialContents.numDescriptors = bind;
+      if(!CreateDescriptorWrites(id, Bindings, NumBindings, InlineData, initialContents))
+        ret = false;
 
       GetResourceManager()->SetInitialContents(id, initialContents);
     }
@@ -954,14 +769,37 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
         RDCASSERTEQUAL(vkr, VK_SUCCESS);
       }
     }
-    else if(IsReplayingAndReading() && !ser.IsErrored())
+
+    // device memory only stores its non-zero pages, packed together. Images are left whole as their
+    // contents are copied per-subresource from the upload buffer.
+    const bool packed = type == eResDeviceMemory && ser.VersionAtLeast(0x13);
+    VkDeviceSize UploadSize = ContentsSize;
+
+    // zero bytes after the packed data, that unaligned zero ranges can be copied from on apply
+    const VkDeviceSize zeroPadSize = 16;
+
+    rdcarray<VkBufferCopy> DataRanges;
+
+    if(packed)
+    {
+      if(ser.IsWriting() && Contents)
+        DataRanges = FindNonZeroRanges(Contents, ContentsSize, GetZeroPageSize());
+
+      SERIALISE_ELEMENT(DataRanges);
+
+      UploadSize = 0;
+      for(const VkBufferCopy &r : DataRanges)
+        UploadSize += r.size;
+    }
+
+    if(IsReplayingAndReading() && !ser.IsErrored())
     {
       // create a buffer with memory attached, which we will fill with the initial contents
       VkBufferCreateInfo bufInfo = {
           VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
           NULL,
           0,
-          ContentsSize,
+          packed ? UploadSize + zeroPadSize : ContentsSize,
           VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
       };
 
@@ -978,11 +816,30 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
 
       ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(mappedMem.mem), mappedMem.offs,
                             AlignUp(mappedMem.size, nonCoherentAtomSize), 0, (void **)&Contents);
+
+      if(packed && Contents)
+        memset(Contents + UploadSize, 0, (size_t)zeroPadSize);
     }
 
-    // not using SERIALISE_ELEMENT_ARRAY so we can deliberately avoid allocation - we serialise
-    // directly into upload memory
-    ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags);
+    // when writing, gather the non-zero ranges together unless they already cover everything
+    byte *PackedContents = NULL;
+    if(ser.IsWriting() && packed && Contents && UploadSize > 0 && UploadSize < ContentsSize)
+    {
+      PackedContents = AllocAlignedBuffer(UploadSize);
+
+      for(const VkBufferCopy &r : DataRanges)
+        memcpy(PackedContents + r.srcOffset, Contents + r.dstOffset, (size_t)r.size);
+    }
+
+    {
+      byte *SerialisedContents = PackedContents ? PackedContents : Contents;
+
+      // not using SERIALISE_ELEMENT_ARRAY so we can deliberately avoid allocation - we serialise
+      // directly into upload memory
+      ser.Serialise("Contents"_lit, SerialisedContents, UploadSize, SerialiserFlags::NoFlags);
+    }
+
+    FreeAlignedBuffer(PackedContents);
 
     // unmap the resource we mapped before - we need to do this on read and on write.
     if(!IsStructuredExporting(m_State) && mappedMem.mem != VK_NULL_HANDLE)
@@ -1018,6 +875,17 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
         VkInitialContents initialContents(type, uploadMemory);
         initialContents.buf = uploadBuf;
 
+        if(packed)
+        {
+          initialContents.tag = VkInitialContents::PackedBufferCopy;
+          initialContents.numDataRanges = (uint32_t)DataRanges.size();
+          if(!DataRanges.empty())
+          {
+            initialContents.dataRanges = new VkBufferCopy[DataRanges.size()];
+            memcpy(initialContents.dataRanges, DataRanges.data(), DataRanges.byteSize());
+          }
+        }
+
         GetResourceManager()->SetInitialContents(id, initialContents);
       }
       else
@@ -1204,6 +1072,287 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
   return ret;
 }
 
+bool WrappedVulkan::CreateDescriptorWrites(ResourceId id, const DescriptorSetSlot *Bindings,
+                                           uint32_t NumBindings, const bytebuf &InlineData,
+                                           VkInitialContents &initialContents)
+{
+  bool ret = true;
+
+  WrappedVkRes *res = GetResourceManager()->GetLiveResource(id);
+  ResourceId liveid = GetResourceManager()->GetLiveID(id);
+
+  const DescSetLayout &layout = m_CreationInfo.m_DescSetLayout[m_DescriptorSetState[liveid].layout];
+
+  initialContents = VkInitialContents(eResDescriptorSet, VkInitialContents::DescriptorSet);
+
+  initialContents.numDescriptors = (uint32_t)layout.bindings.size();
+  initialContents.descriptorInfo = new VkDescriptorBufferInfo[NumBindings];
+  initialContents.inlineInfo = NULL;
+
+  if(layout.inlineCount > 0)
+  {
+    initialContents.inlineInfo = new VkWriteDescriptorSetInlineUniformBlockEXT[layout.inlineCount];
+    initialContents.inlineData = AllocAlignedBuffer(InlineData.size());
+    RDCASSERTEQUAL(layout.inlineByteSize, InlineData.size());
+    memcpy(initialContents.inlineData, InlineData.data(), InlineData.size());
+  }
+
+  // if we have partially-valid arrays, we need to split up writes. The worst case will never be
+  // == number of bindings since that implies all arrays are valid, but it is an upper bound as
+  // we'll never need more writes than bindings
+  initialContents.descriptorWrites = new VkWriteDescriptorSet[NumBindings];
+
+  RDCCOMPILE_ASSERT(sizeof(VkDescriptorBufferInfo) >= sizeof(VkDescriptorImageInfo),
+                    "Descriptor structs sizes are unexpected, ensure largest size is used");
+
+  VkWriteDescriptorSet *writes = initialContents.descriptorWrites;
+  VkDescriptorBufferInfo *dstData = initialContents.descriptorInfo;
+  VkWriteDescriptorSetInlineUniformBlockEXT *dstInline = initialContents.inlineInfo;
+  const DescriptorSetSlot *srcData = Bindings;
+
+  byte *srcInlineData = initialContents.inlineData;
+
+  // validBinds counts up as we make a valid VkWriteDescriptorSet, so can be used to index into
+  // writes[] along the way as the 'latest' write.
+  uint32_t bind = 0;
+
+  for(uint32_t j = 0; j < initialContents.numDescriptors; j++)
+  {
+    uint32_t descriptorCount = layout.bindings[j].descriptorCount;
+
+    if(layout.bindings[j].variableSize)
+      descriptorCount = m_DescriptorSetState[liveid].data.variableDescriptorCount;
+
+    if(descriptorCount == 0)
+      continue;
+
+    uint32_t inlineSize = 0;
+
+    if(layout.bindings[j].descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK_EXT)
+    {
+      inlineSize = descriptorCount;
+      descriptorCount = 1;
+    }
+
+    writes[bind].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[bind].pNext = NULL;
+
+    // template for this write. We will expand it to include more descriptors as we find valid
+    // descriptors to update.
+    writes[bind].dstSet = (VkDescriptorSet)(uint64_t)res;
+    writes[bind].dstBinding = j;
+    writes[bind].dstArrayElement = 0;
+    // descriptor count starts at 0. We increment it as we find valid descriptors
+    writes[bind].descriptorCount = 0;
+    writes[bind].descriptorType = layout.bindings[j].descriptorType;
+
+    ResourceId *immutableSamplers = layout.bindings[j].immutableSampler;
+
+    const DescriptorSetSlot *src = srcData;
+    srcData += descriptorCount;
+
+    // will be cast to the appropriate type, we just need to increment
+    // the dstData pointer by worst case size
+    VkDescriptorBufferInfo *dstBuffer = dstData;
+    VkDescriptorImageInfo *dstImage = (VkDescriptorImageInfo *)dstData;
+    VkBufferView *dstTexelBuffer = (VkBufferView *)dstData;
+    dstData += descriptorCount;
+
+    RDCCOMPILE_ASSERT(
+        sizeof(VkDescriptorImageInfo) <= sizeof(VkDescriptorBufferInfo),
+        "VkDescriptorBufferInfo should be large enough for all descriptor write types");
+    RDCCOMPILE_ASSERT(
+        sizeof(VkBufferView) <= sizeof(VkDescriptorBufferInfo),
+        "VkDescriptorBufferInfo should be large enough for all descriptor write types");
+
+    // the correct one will be set below
+    writes[bind].pBufferInfo = NULL;
+    writes[bind].pImageInfo = NULL;
+    writes[bind].pTexelBufferView = NULL;
+
+    // check that the resources we need for this write are present, as some might have been
+    // skipped due to stale descriptor set slots or otherwise unreferenced objects (the
+    // descriptor set initial contents do not cause a frame reference for their resources).
+    //
+    // For the non-array case it's trivial as either the descriptor is valid, in which case it
+    // gets a write, or not, in which case we skip.
+    // For the array case we batch up updates as much as possible, iterating along the array and
+    // skipping any invalid descriptors.
+
+    if(writes[bind].descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK_EXT)
+    {
+      // handle inline uniform block specially because the descriptorCount doesn't mean what it
+      // normally means in the write.
+
+      dstInline->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_INLINE_UNIFORM_BLOCK_EXT;
+      dstInline->pNext = NULL;
+      dstInline->pData = srcInlineData + src->inlineOffset;
+      dstInline->dataSize = inlineSize;
+
+      writes[bind].pNext = dstInline;
+      writes[bind].descriptorCount = inlineSize;
+      bind++;
+
+      dstInline++;
+    }
+    // quick check for slots that were completely uninitialised and so don't have valid data
+    else if(!NULLDescriptorsAllowed() && descriptorCount == 1 &&
+            src->texelBufferView == ResourceId() && src->imageInfo.sampler == ResourceId() &&
+            src->imageInfo.imageView == ResourceId() && src->bufferInfo.buffer == ResourceId())
+    {
+      // do nothing - don't increment bind so that the same write descriptor is used next time.
+      continue;
+    }
+    else
+    {
+      // first we copy the right data over unconditionally
+      switch(writes[bind].descriptorType)
+      {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+        {
+          for(uint32_t d = 0; d < descriptorCount; d++)
+          {
+            if(writes[bind].descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER &&
+               GetResourceManager()->HasLiveResource(src[d].imageInfo.imageView))
+              dstImage[d].imageView =
+                  GetResourceManager()->GetLiveHandle<VkImageView>(src[d].imageInfo.imageView);
+            else
+              dstImage[d].imageView = VK_NULL_HANDLE;
+
+            if((writes[bind].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                writes[bind].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) &&
+               GetResourceManager()->HasLiveResource(src[d].imageInfo.sampler))
+              dstImage[d].sampler =
+                  GetResourceManager()->GetLiveHandle<VkSampler>(src[d].imageInfo.sampler);
+            else
+              dstImage[d].sampler = VK_NULL_HANDLE;
+
+            dstImage[d].imageLayout = src[d].imageInfo.imageLayout;
+          }
+
+          // if we're not updating a SAMPLER descriptor fill in immutable samplers so that our
+          // validity checking doesn't have to look them up.
+          if(immutableSamplers && writes[bind].descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER)
+          {
+            for(uint32_t d = 0; d < descriptorCount; d++)
+              dstImage[d].sampler =
+                  GetResourceManager()->GetCurrentHandle<VkSampler>(immutableSamplers[d]);
+          }
+
+          writes[bind].pImageInfo = dstImage;
+          // NULL the others
+          dstBuffer = NULL;
+          dstTexelBuffer = NULL;
+          break;
+        }
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+        {
+          for(uint32_t d = 0; d < descriptorCount; d++)
+          {
+            if(GetResourceManager()->HasLiveResource(src[d].texelBufferView))
+              dstTexelBuffer[d] =
+                  GetResourceManager()->GetLiveHandle<VkBufferView>(src[d].texelBufferView);
+            else
+              dstTexelBuffer[d] = VK_NULL_HANDLE;
+          }
+
+          writes[bind].pTexelBufferView = dstTexelBuffer;
+          // NULL the others
+          dstBuffer = NULL;
+          dstImage = NULL;
+          break;
+        }
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+        {
+          for(uint32_t d = 0; d < descriptorCount; d++)
+          {
+            if(GetResourceManager()->HasLiveResource(src[d].bufferInfo.buffer))
+              dstBuffer[d].buffer =
+                  GetResourceManager()->GetLiveHandle<VkBuffer>(src[d].bufferInfo.buffer);
+            else
+              dstBuffer[d].buffer = VK_NULL_HANDLE;
+            dstBuffer[d].offset = src[d].bufferInfo.offset;
+            dstBuffer[d].range = src[d].bufferInfo.range;
+          }
+
+          writes[bind].pBufferInfo = dstBuffer;
+          // NULL the others
+          dstImage = NULL;
+          dstTexelBuffer = NULL;
+          break;
+        }
+        default:
+        {
+          RDCERR("Unexpected descriptor type %d", writes[bind].descriptorType);
+          ret = false;
+        }
+      }
+
+      // iterate over all the descriptors coalescing valid writes. At all times writes[bind] is
+      // the 'current' batched update
+      for(uint32_t d = 0; d < descriptorCount; d++)
+      {
+        // is this array element in the write valid? Note that below when we encounter an
+        // invalid write, the next one starts from a later point in the array, so we need to
+        // check relative to the dstArrayElement
+        if(IsValid(NULLDescriptorsAllowed(), writes[bind], d - writes[bind].dstArrayElement))
+        {
+          // if this descriptor is valid, just increment the number of descriptors. The data
+          // and dstArrayElement is pointing to the start of the valid range
+          writes[bind].descriptorCount++;
+        }
+        else
+        {
+          // if this descriptor is *invalid* we must skip it. First see if we have some
+          // previously valid range and commit it
+          if(writes[bind].descriptorCount)
+          {
+            bind++;
+
+            // copy over the previous data for the sake of the things that won't be reset below
+            writes[bind] = writes[bind - 1];
+          }
+
+          // now offset to the next potentially valid descriptor. Note that at the end of the
+          // iteration there is no next descriptor so these pointer values will be off the end
+          // of the array, but descriptorCount will be 0 so this will be treated as invalid and
+          // skipped
+          writes[bind].dstArrayElement = d + 1;
+
+          // start counting from 0 again
+          writes[bind].descriptorCount = 0;
+
+          // offset the array being used
+          if(dstBuffer)
+            writes[bind].pBufferInfo = dstBuffer + d + 1;
+          else if(dstImage)
+            writes[bind].pImageInfo = dstImage + d + 1;
+          else if(dstTexelBuffer)
+            writes[bind].pTexelBufferView = dstTexelBuffer + d + 1;
+        }
+      }
+
+      // after the loop there may be a valid write which hasn't been accounted for. If the
+      // current write has a descriptor count that means it has some descriptors, so
+      // increment i and validBinds so that it's accounted for.
+      if(writes[bind].descriptorCount)
+        bind++;
+    }
+  }
+
+  initialContents.numDescriptors = bind;
+
+  return ret;
+}
+
 template bool WrappedVulkan::Serialise_InitialState(ReadSerialiser &ser, ResourceId id,
                                                     VkResourceRecord *record,
                                                     const VkInitialContents *initial);
@@ -1231,6 +1380,9 @@ void WrappedVulkan::Create_InitialState(ResourceId id, WrappedVkRes *live, bool)
     // used. The initial states we have prepared won't have anything valid for 5 so when
     // we apply we won't even write anything into slot 5 - the same case as if we had
     // no initial states at all for that descriptor set
+
+    // the frame may still write it though, so replay checkpoints need to snapshot it
+    m_UninitialisedFrameResources.insert(id);
   }
   else if(type == eResImage)
   {
@@ -1254,7 +1406,10 @@ void WrappedVulkan::Create_InitialState(ResourceId id, WrappedVkRes *live, bool)
   }
   else if(type == eResDeviceMemory || type == eResBuffer)
   {
-    // ignore, it was probably dirty but not referenced in the frame
+    // ignore, it was probably dirty but not referenced in the frame. Replay checkpoints still
+    // snapshot the memory in case it was
+    if(type == eResDeviceMemory)
+      m_UninitialisedFrameResources.insert(id);
   }
   else
   {
@@ -1775,11 +1930,15 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, const VkInitialConten
     ResourceId orig = GetResourceManager()->GetOriginalID(id);
     MemRefs *memRefs = GetResourceManager()->FindMemRefs(orig);
 
+    // packed contents only hold the non-zero data, so the upload memory is smaller than the memory
+    const bool packed = initial.tag == VkInitialContents::PackedBufferCopy;
+    const VkDeviceSize memSize = packed ? m_CreationInfo.m_Memory[id].size : initial.mem.size;
+
     if(!memRefs)
     {
       // No information about the memory usage in the frame.
       // Pessimistically assume the entire memory needs to be reset.
-      resetReq.update(0, initial.mem.size, eInitReq_Copy,
+      resetReq.update(0, memSize, eInitReq_Copy,
                       [](InitReqType x, InitReqType y) -> InitReqType { return RDCMAX(x, y); });
     }
     else
@@ -1828,22 +1987,83 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, const VkInitialConten
 
     rdcarray<VkBufferCopy> regions;
     uint32_t fillCount = 0;
+
+    const VkBufferCopy *dataBegin = initial.dataRanges;
+    const VkBufferCopy *dataEnd = initial.dataRanges + initial.numDataRanges;
+
+    // the zero padding after the packed data
+    const VkDeviceSize zeroOffs =
+        initial.numDataRanges > 0 ? dataEnd[-1].srcOffset + dataEnd[-1].size : 0;
+
+    // zero a range that was elided from packed contents. Fills must be 4-byte aligned, so any
+    // unaligned bytes at either end are copied from the zero padding instead.
+    auto zeroRange = [&](VkDeviceSize start, VkDeviceSize finish) {
+      VkDeviceSize fillStart = AlignUp4(start);
+      VkDeviceSize fillFinish = finish & ~VkDeviceSize(3);
+
+      if(fillStart >= fillFinish)
+      {
+        regions.push_back({zeroOffs, start, finish - start});
+        return;
+      }
+
+      if(fillStart > start)
+        regions.push_back({zeroOffs, start, fillStart - start});
+
+      ObjDisp(cmd)->CmdFillBuffer(Unwrap(cmd), Unwrap(dstBuf), fillStart, fillFinish - fillStart,
+                                  0);
+      fillCount++;
+
+      if(finish > fillFinish)
+        regions.push_back({zeroOffs, fillFinish, finish - fillFinish});
+    };
+
     for(auto it = resetReq.begin(); it != resetReq.end(); it++)
     {
-      if(it->start() >= initial.mem.size)
+      if(it->start() >= memSize)
         continue;
       VkDeviceSize start = it->start();
-      VkDeviceSize finish = RDCMIN(it->finish(), initial.mem.size);
+      VkDeviceSize finish = RDCMIN(it->finish(), memSize);
       VkDeviceSize size = finish - start;
       switch(it->value())
       {
         case eInitReq_Clear:
-          if(finish >= initial.mem.size)
+          if(finish >= memSize)
             size = VK_WHOLE_SIZE;
           ObjDisp(cmd)->CmdFillBuffer(Unwrap(cmd), Unwrap(dstBuf), start, size, 0);
           fillCount++;
           break;
-        case eInitReq_Copy: regions.push_back({start, start, size}); break;
+        case eInitReq_Copy:
+          if(packed)
+          {
+            // copy the overlapping non-zero ranges and zero everything in between
+            const VkBufferCopy *r = std::lower_bound(
+                dataBegin, dataEnd, start, [](const VkBufferCopy &range, VkDeviceSize offs) {
+                  return range.dstOffset + range.size <= offs;
+                });
+
+            VkDeviceSize cur = start;
+            for(; r != dataEnd && r->dstOffset < finish; r++)
+            {
+              VkDeviceSize copyStart = RDCMAX(start, r->dstOffset);
+              VkDeviceSize copyFinish = RDCMIN(finish, r->dstOffset + r->size);
+
+              if(copyStart > cur)
+                zeroRange(cur, copyStart);
+
+              regions.push_back({r->srcOffset + (copyStart - r->dstOffset), copyStart,
+                                 copyFinish - copyStart});
+              cur = copyFinish;
+            }
+
+            if(cur < finish)
+              zeroRange(cur, finish);
+          }
+          else
+          {
+            regions.push_back({start, start, size});
+          }
+          break;
         default: break;
       }
     }
@@ -1867,3 +2087,64 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, const VkInitialConten
     RDCERR("Unhandled resource type %d", type);
   }
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#undef None
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Check zero page detection in memory contents", "[vulkan]")
+{
+  bytebuf data;
+  data.resize(4096 * 8 + 100);
+
+  SECTION("All zero contents have no ranges")
+  {
+    CHECK(FindNonZeroRanges(data.data(), data.size(), 4096).empty());
+  }
+
+  SECTION("Adjacent pages are merged and ranges are packed")
+  {
+    data[4096 * 1 + 5] = 1;
+    data[4096 * 2 + 4095] = 2;
+    data[4096 * 5] = 3;
+    data[4096 * 8 + 99] = 4;
+
+    rdcarray<VkBufferCopy> ranges = FindNonZeroRanges(data.data(), data.size(), 4096);
+
+    REQUIRE(ranges.size() == 3);
+
+    CHECK(ranges[0].srcOffset == 0);
+    CHECK(ranges[0].dstOffset == 4096);
+    CHECK(ranges[0].size == 4096 * 2);
+
+    CHECK(ranges[1].srcOffset == 4096 * 2);
+    CHECK(ranges[1].dstOffset == 4096 * 5);
+    CHECK(ranges[1].size == 4096);
+
+    // the trailing partial page is included
+    CHECK(ranges[2].srcOffset == 4096 * 3);
+    CHECK(ranges[2].dstOffset == 4096 * 8);
+    CHECK(ranges[2].size == 100);
+  }
+
+  SECTION("A page size of 0 disables elision")
+  {
+    rdcarray<VkBufferCopy> ranges = FindNonZeroRanges(data.data(), data.size(), 0);
+
+    REQUIRE(ranges.size() == 1);
+    CHECK(ranges[0].dstOffset == 0);
+    CHECK(ranges[0].size == data.size());
+  }
+
+  SECTION("Unaligned data is checked bytewise")
+  {
+    data[4096 + 63] = 1;
+
+    CHECK_FALSE(IsZeroBlock(data.data() + 4096 + 1, 4096));
+    CHECK(IsZeroBlock(data.data() + 4096 + 64, 4096));
+  }
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
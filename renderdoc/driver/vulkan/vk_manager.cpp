@@ -942,9 +942,20 @@ rdcarray<ResourceId> VulkanResourceManager::InitialContentResources()
 {
   rdcarray<ResourceId> resources =
       ResourceManager<VulkanResourceManagerConfiguration>::InitialContentResources();
-  std::sort(resources.begin(), resources.end(), [this](ResourceId a, ResourceId b) {
-    return m_InitialContents[a].data.type < m_InitialContents[b].data.type;
-  });
+
+  // look up each type once up front rather than on every comparison
+  rdcarray<rdcpair<VkResourceType, ResourceId>> typed;
+  typed.reserve(resources.size());
+  for(ResourceId id : resources)
+    typed.push_back(make_rdcpair(m_InitialContents.Find(id).data.type, id));
+
+  std::stable_sort(typed.begin(), typed.end(),
+                   [](const rdcpair<VkResourceType, ResourceId> &a,
+                      const rdcpair<VkResourceType, ResourceId> &b) { return a.first < b.first; });
+
+  for(size_t i = 0; i < typed.size(); i++)
+    resources[i] = typed[i].second;
+
   return resources;
 }
 
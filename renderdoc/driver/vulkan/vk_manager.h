@@ -87,6 +87,7 @@ struct VkInitialContents
     ClearDepthStencilImage,
     Sparse,
     DescriptorSet,
+    PackedBufferCopy,
   };
 
   VkInitialContents()
@@ -119,6 +120,7 @@ struct VkInitialContents
     SAFE_DELETE_ARRAY(descriptorInfo);
     SAFE_DELETE_ARRAY(inlineInfo);
     FreeAlignedBuffer(inlineData);
+    SAFE_DELETE_ARRAY(dataRanges);
 
     rm->ResourceTypeRelease(GetWrapped(buf));
     rm->ResourceTypeRelease(GetWrapped(img));
@@ -161,6 +163,11 @@ struct VkInitialContents
   MemoryAllocation mem;
   Tag tag;
 
+  // for PackedBufferCopy device memory, buf only contains the non-zero ranges of the contents
+  // packed together and followed by a few zero bytes. Everything outside these ranges is zero.
+  VkBufferCopy *dataRanges;
+  uint32_t numDataRanges;
+
   // sparse resources need extra information. Which one is valid, depends on the value of type above
   union
   {
@@ -347,9 +354,8 @@ public:
   {
     ResourceId id = GetResID(obj);
 
-    auto origit = m_OriginalIDs.find(id);
-    if(origit != m_OriginalIDs.end())
-      EraseLiveResource(origit->second);
+    if(const ResourceId *origid = m_OriginalIDs.Find(id))
+      EraseLiveResource(*origid);
 
     if(IsReplayMode(m_State))
       ResourceManager::RemoveWrapper(ToTypedHandle(Unwrap(obj)));
@@ -454,6 +460,9 @@ public:
   MemRefs *FindMemRefs(ResourceId mem);
   ImgRefs *FindImgRefs(ResourceId img);
 
+  // the original IDs of the live resources with initial contents, in the order they're applied
+  rdcarray<ResourceId> GetInitialContentIDs() { return InitialContentResources(); }
+
   inline InitPolicy GetInitPolicy() { return m_InitPolicy; }
   void SetOptimisationLevel(ReplayOptimisationLevel level)
   {
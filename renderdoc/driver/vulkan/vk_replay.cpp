@@ -200,7 +200,7 @@ ReplayStatus VulkanReplay::ReadLogInitialisation(RDCFile *rdc, bool storeStructu
 
 void VulkanReplay::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
 {
-  m_pDriver->ReplayLog(0, endEventID, replayType);
+  m_pDriver->SeekReplayLog(endEventID, replayType);
 }
 
 const SDFile &VulkanReplay::GetStructuredFile()
@@ -3937,6 +3937,8 @@ void VulkanReplay::ReplaceResource(ResourceId from, ResourceId to)
   // now update any derived resources
   RefreshDerivedReplacements();
 
+  m_pDriver->FreeReplayCheckpoints();
+
   ClearPostVSCache();
   ClearFeedbackCache();
 }
@@ -3949,6 +3951,8 @@ void VulkanReplay::RemoveReplacement(ResourceId id)
 
     RefreshDerivedReplacements();
 
+    m_pDriver->FreeReplayCheckpoints();
+
     ClearPostVSCache();
     ClearFeedbackCache();
   }
@@ -384,6 +384,7 @@ public:
   ShaderDebugTrace *DebugThread(uint32_t eventId, const uint32_t groupid[3],
                                 const uint32_t threadid[3]);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
+  ShaderDebugState RunDebug(ShaderDebugger *debugger, const rdcarray<uint32_t> &breakpoints);
   void FreeDebugger(ShaderDebugger *debugger);
 
   uint32_t PickVertex(uint32_t eventId, int32_t width, int32_t height, const MeshDisplay &cfg,
@@ -428,6 +429,8 @@ private:
   void FetchShaderFeedback(uint32_t eventId);
   void ClearFeedbackCache();
 
+  void PrepareShaderDebugDummyWrites();
+
   void PatchReservedDescriptors(const VulkanStatePipeline &pipe, VkDescriptorPool &descpool,
                                 rdcarray<VkDescriptorSetLayout> &setLayouts,
                                 rdcarray<VkDescriptorSet> &descSets,
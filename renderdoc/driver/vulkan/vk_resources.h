@@ -144,6 +144,13 @@ struct TypedRealHandle
   bool operator!=(const TypedRealHandle o) const { return !(*this == o); }
 };
 
+// used to pick the resource manager's wrapper map shard. Only the handle is hashed, since NULL
+// handles compare equal regardless of type
+inline uint64_t ShardHash(const TypedRealHandle &h)
+{
+  return h.real.handle;
+}
+
 struct WrappedVkNonDispRes : public WrappedVkRes
 {
   template <typename T>
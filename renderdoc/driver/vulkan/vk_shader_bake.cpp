@@ -0,0 +1,340 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2020 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+// Build-time tool that compiles the builtin Vulkan shader permutations to SPIR-V, so that replay
+// doesn't need to run glslang on a cold shader cache. This only depends on glslang since it's built
+// and run before the library, and it mirrors what VulkanShaderCache does at runtime:
+// GenerateGLSLShader() followed by rdcspv::Compile().
+//
+// The list of shaders, their permutations, the defines and the input hash they're keyed by all come
+// from vk_builtin_shaders.h which the runtime shader cache shares. If the source is modified after
+// building, or a driver needs workaround defines, the hashes won't match and those shaders will be
+// compiled at runtime as before.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "glslang/SPIRV/GlslangToSpv.h"
+#include "glslang/glslang/Public/ShaderLang.h"
+
+#include "vk_builtin_shaders.h"
+
+extern TBuiltInResource *GetDefaultResources();
+
+struct BuiltinShaderConfig
+{
+  const char *resource;
+  EShLanguage stage;
+  bool baseTypeParameterised;
+  bool textureTypeParameterised;
+};
+
+static const BuiltinShaderConfig builtinShaders[] = {
+#define BUILTIN_SHADER_CONFIG(name, resource, stage, checks, baseParam, texParam) \
+  {#resource, EShLang##stage, baseParam, texParam},
+    VK_BUILTIN_SHADERS(BUILTIN_SHADER_CONFIG)
+#undef BUILTIN_SHADER_CONFIG
+};
+
+static bool ReadFile(const std::string &path, std::string &contents)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if(!in)
+    return false;
+
+  std::stringstream ss;
+  ss << in.rdbuf();
+  contents = ss.str();
+  return true;
+}
+
+class DirectoryIncluder : public glslang::TShader::Includer
+{
+public:
+  DirectoryIncluder(const std::string &dir) : m_Dir(dir) {}
+  virtual IncludeResult *includeSystem(const char *headerName, const char *includerName,
+                                       size_t inclusionDepth) override
+  {
+    std::string *contents = new std::string;
+    if(!ReadFile(m_Dir + "/" + headerName, *contents))
+    {
+      delete contents;
+      return NULL;
+    }
+
+    return new IncludeResult(headerName, contents->data(), contents->length(), contents);
+  }
+
+  virtual IncludeResult *includeLocal(const char *headerName, const char *includerName,
+                                      size_t inclusionDepth) override
+  {
+    return includeSystem(headerName, includerName, inclusionDepth);
+  }
+
+  virtual void releaseInclude(IncludeResult *result) override
+  {
+    if(result)
+      delete(std::string *)result->userData;
+    delete result;
+  }
+
+private:
+  std::string m_Dir;
+};
+
+static bool Preprocess(const std::string &dir, const std::string &source,
+                       const std::string &defines, std::string &output)
+{
+  glslang::TShader sh(EShLangFragment);
+
+  const std::string include_ext = "#extension GL_GOOGLE_include_directive : require\n";
+
+  std::string combined = "#version 430 core\n" + include_ext + defines + source;
+
+  const char *c_src = combined.c_str();
+  sh.setStrings(&c_src, 1);
+  sh.setEnvInput(glslang::EShSourceGlsl, EShLangFragment, glslang::EShClientVulkan, 100);
+  sh.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+  sh.setEnvTarget(glslang::EShTargetNone, glslang::EShTargetSpv_1_0);
+
+  DirectoryIncluder incl(dir);
+
+  EShMessages flags = EShMessages(EShMsgOnlyPreprocessor | EShMsgSpvRules | EShMsgVulkanRules);
+
+  if(!sh.preprocess(GetDefaultResources(), 100, ENoProfile, false, false, flags, &output, incl))
+  {
+    fprintf(stderr, "%s\n", sh.getInfoLog());
+    return false;
+  }
+
+  size_t offs = output.find(include_ext);
+  if(offs != std::string::npos)
+    output.erase(offs, include_ext.size());
+
+  offs = output.find("\n#line ");
+  while(offs != std::string::npos)
+  {
+    size_t eol = output.find('\n', offs + 2);
+
+    if(eol == std::string::npos)
+      output.erase(offs + 1);
+    else
+      output.erase(offs + 1, eol - offs);
+
+    offs = output.find("\n#line ", offs);
+  }
+
+  return true;
+}
+
+static bool Compile(EShLanguage lang, const std::string &source, std::vector<uint32_t> &spirv)
+{
+  const char *str = source.c_str();
+  const char *name = "source0.glsl";
+
+  glslang::TShader shader(lang);
+  shader.setStringsWithLengthsAndNames(&str, NULL, &name, 1);
+
+  if(!shader.parse(GetDefaultResources(), 110, false,
+                   EShMessages(EShMsgSpvRules | EShMsgVulkanRules)))
+  {
+    fprintf(stderr, "%s\n%s\n", shader.getInfoLog(), shader.getInfoDebugLog());
+    return false;
+  }
+
+  glslang::TProgram program;
+  program.addShader(&shader);
+
+  if(!program.link(EShMsgDefault))
+  {
+    fprintf(stderr, "%s\n%s\n", program.getInfoLog(), program.getInfoDebugLog());
+    return false;
+  }
+
+  glslang::SpvOptions opts;
+  glslang::GlslangToSpv(*program.getIntermediate(lang), spirv, &opts);
+
+  return true;
+}
+
+struct BakedShader
+{
+  uint32_t inputHash;
+  std::string name;
+  std::vector<uint32_t> spirv;
+};
+
+int main(int argc, char *argv[])
+{
+  if(argc != 3)
+  {
+    fprintf(stderr, "Usage: vk-shader-bake <glsl dir> <output.cpp>\n");
+    return 1;
+  }
+
+  std::string dir = argv[1];
+  std::string output = argv[2];
+
+  glslang::InitializeProcess();
+
+  std::vector<BakedShader> shaders;
+  bool success = true;
+
+  for(const BuiltinShaderConfig &config : builtinShaders)
+  {
+    // embedded resources are named after the file with the extension's '.' replaced by '_'
+    std::string filename = config.resource;
+    filename[filename.find_last_of('_')] = '.';
+
+    std::string source;
+
+    if(!ReadFile(dir + "/" + filename, source))
+    {
+      fprintf(stderr, "Couldn't read %s/%s\n", dir.c_str(), filename.c_str());
+      success = false;
+      break;
+    }
+
+    // unparameterised shaders only use the first entry, the same as the runtime
+    uint32_t baseFirst = (uint32_t)BuiltinShaderBaseType::First;
+    uint32_t texFirst = (uint32_t)BuiltinShaderTextureType::First;
+    uint32_t baseEnd =
+        config.baseTypeParameterised ? (uint32_t)BuiltinShaderBaseType::Count : baseFirst + 1;
+    uint32_t texEnd =
+        config.textureTypeParameterised ? (uint32_t)BuiltinShaderTextureType::Count : texFirst + 1;
+
+    for(uint32_t baseType = baseFirst; baseType < baseEnd && success; baseType++)
+    {
+      for(uint32_t texType = texFirst; texType < texEnd && success; texType++)
+      {
+        char permutationDefines[128];
+        GetBuiltinShaderPermutationDefines(permutationDefines, baseType, texType);
+
+        std::string defines = std::string(BuiltinShaderDefaultDefines) + permutationDefines;
+
+        BakedShader baked;
+        baked.name = filename + " (baseType " + std::to_string(baseType) + " textureType " +
+                     std::to_string(texType) + ")";
+
+        baked.inputHash = GetBuiltinShaderInputHash(source.c_str(), defines.c_str());
+
+        std::string preprocessed;
+        success = Preprocess(dir, source, defines, preprocessed) &&
+                  Compile(config.stage, preprocessed, baked.spirv);
+
+        if(success)
+          shaders.push_back(baked);
+        else
+          fprintf(stderr, "Failed to compile %s\n", baked.name.c_str());
+      }
+    }
+
+    if(!success)
+      break;
+  }
+
+  glslang::FinalizeProcess();
+
+  if(!success)
+    return 1;
+
+  std::sort(shaders.begin(), shaders.end(), [](const BakedShader &a, const BakedShader &b) {
+    return a.inputHash < b.inputHash;
+  });
+
+  for(size_t i = 1; i < shaders.size(); i++)
+  {
+    if(shaders[i].inputHash == shaders[i - 1].inputHash)
+    {
+      fprintf(stderr, "Input hash collision between %s and %s\n", shaders[i].name.c_str(),
+              shaders[i - 1].name.c_str());
+      return 1;
+    }
+  }
+
+  std::ofstream out(output.c_str(), std::ios::binary);
+  if(!out)
+  {
+    fprintf(stderr, "Couldn't open %s for writing\n", output.c_str());
+    return 1;
+  }
+
+  out << "// Generated by vk-shader-bake, do not edit\n\n";
+  out << "#include <stddef.h>\n#include <stdint.h>\n\n";
+
+  for(size_t i = 0; i < shaders.size(); i++)
+  {
+    out << "// " << shaders[i].name << "\n";
+    out << "static const uint32_t spirv" << i << "[] = {";
+    for(size_t w = 0; w < shaders[i].spirv.size(); w++)
+    {
+      if(w % 8 == 0)
+        out << "\n   ";
+      char word[16];
+      snprintf(word, sizeof(word), " 0x%08x,", shaders[i].spirv[w]);
+      out << word;
+    }
+    out << "\n};\n\n";
+  }
+
+  out << "static const struct\n{\n  uint32_t inputHash;\n  const uint32_t *words;\n"
+         "  size_t numWords;\n} bakedShaders[] = {\n";
+  for(size_t i = 0; i < shaders.size(); i++)
+    out << "    {" << shaders[i].inputHash << "U, spirv" << i << ", " << shaders[i].spirv.size()
+        << "},\n";
+  if(shaders.empty())
+    out << "    {0, NULL, 0},\n";
+  out << "};\n\n";
+
+  out << "const uint32_t *GetBakedBuiltinShader(uint32_t inputHash, size_t &numWords)\n"
+         "{\n"
+         "  size_t lo = 0, hi = "
+      << shaders.size()
+      << ";\n"
+         "  while(lo < hi)\n"
+         "  {\n"
+         "    size_t mid = (lo + hi) / 2;\n"
+         "    if(bakedShaders[mid].inputHash == inputHash)\n"
+         "    {\n"
+         "      numWords = bakedShaders[mid].numWords;\n"
+         "      return bakedShaders[mid].words;\n"
+         "    }\n"
+         "    if(bakedShaders[mid].inputHash < inputHash)\n"
+         "      lo = mid + 1;\n"
+         "    else\n"
+         "      hi = mid;\n"
+         "  }\n"
+         "  numWords = 0;\n"
+         "  return NULL;\n"
+         "}\n";
+
+  return out.good() ? 0 : 1;
+}
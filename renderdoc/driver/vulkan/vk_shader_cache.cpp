@@ -48,6 +48,17 @@ enum class BuiltinShaderFlags
 
 BITMASK_OPERATORS(BuiltinShaderFlags);
 
+#if defined(RENDERDOC_PRECOMPILED_SHADERS)
+// generated at build time by vk-shader-bake, looked up by the same input hash as the shader cache
+const uint32_t *GetBakedBuiltinShader(uint32_t inputHash, size_t &numWords);
+#else
+static const uint32_t *GetBakedBuiltinShader(uint32_t inputHash, size_t &numWords)
+{
+  numWords = 0;
+  return NULL;
+}
+#endif
+
 struct BuiltinShaderConfig
 {
   BuiltinShaderConfig(BuiltinShader builtin, EmbeddedResourceType resource,
@@ -64,73 +75,14 @@ struct BuiltinShaderConfig
 };
 
 static const BuiltinShaderConfig builtinShaders[] = {
-    BuiltinShaderConfig(BuiltinShader::BlitVS, EmbeddedResource(glsl_blit_vert),
-                        rdcspv::ShaderStage::Vertex),
-    BuiltinShaderConfig(BuiltinShader::CheckerboardFS, EmbeddedResource(glsl_checkerboard_frag),
-                        rdcspv::ShaderStage::Fragment),
-    BuiltinShaderConfig(BuiltinShader::TexDisplayFS, EmbeddedResource(glsl_texdisplay_frag),
-                        rdcspv::ShaderStage::Fragment),
-    BuiltinShaderConfig(BuiltinShader::FixedColFS, EmbeddedResource(glsl_fixedcol_frag),
-                        rdcspv::ShaderStage::Fragment),
-    BuiltinShaderConfig(BuiltinShader::TextVS, EmbeddedResource(glsl_vktext_vert),
-                        rdcspv::ShaderStage::Vertex),
-    BuiltinShaderConfig(BuiltinShader::TextFS, EmbeddedResource(glsl_vktext_frag),
-                        rdcspv::ShaderStage::Fragment),
-    BuiltinShaderConfig(BuiltinShader::MeshVS, EmbeddedResource(glsl_mesh_vert),
-                        rdcspv::ShaderStage::Vertex),
-    BuiltinShaderConfig(BuiltinShader::MeshGS, EmbeddedResource(glsl_mesh_geom),
-                        rdcspv::ShaderStage::Geometry),
-    BuiltinShaderConfig(BuiltinShader::MeshFS, EmbeddedResource(glsl_mesh_frag),
-                        rdcspv::ShaderStage::Fragment),
-    BuiltinShaderConfig(BuiltinShader::MeshCS, EmbeddedResource(glsl_mesh_comp),
-                        rdcspv::ShaderStage::Compute),
-    BuiltinShaderConfig(BuiltinShader::QuadResolveFS, EmbeddedResource(glsl_quadresolve_frag),
-                        rdcspv::ShaderStage::Fragment, FeatureCheck::FragmentStores),
-    BuiltinShaderConfig(BuiltinShader::QuadWriteFS, EmbeddedResource(glsl_quadwrite_frag),
-                        rdcspv::ShaderStage::Fragment,
-                        FeatureCheck::FragmentStores | FeatureCheck::NonMetalBackend),
-    BuiltinShaderConfig(BuiltinShader::TrisizeGS, EmbeddedResource(glsl_trisize_geom),
-                        rdcspv::ShaderStage::Geometry),
-    BuiltinShaderConfig(BuiltinShader::TrisizeFS, EmbeddedResource(glsl_trisize_frag),
-                        rdcspv::ShaderStage::Fragment),
-    BuiltinShaderConfig(BuiltinShader::MS2ArrayCS, EmbeddedResource(glsl_ms2array_comp),
-                        rdcspv::ShaderStage::Compute,
-                        FeatureCheck::FormatlessWrite | FeatureCheck::NonMetalBackend),
-    BuiltinShaderConfig(BuiltinShader::Array2MSCS, EmbeddedResource(glsl_array2ms_comp),
-                        rdcspv::ShaderStage::Compute,
-                        FeatureCheck::ShaderMSAAStorage | FeatureCheck::FormatlessWrite |
-                            FeatureCheck::NonMetalBackend),
-    BuiltinShaderConfig(BuiltinShader::DepthMS2ArrayFS, EmbeddedResource(glsl_depthms2arr_frag),
-                        rdcspv::ShaderStage::Fragment, FeatureCheck::NonMetalBackend),
-    BuiltinShaderConfig(BuiltinShader::DepthArray2MSFS, EmbeddedResource(glsl_deptharr2ms_frag),
-                        rdcspv::ShaderStage::Fragment,
-                        FeatureCheck::SampleShading | FeatureCheck::NonMetalBackend),
-    BuiltinShaderConfig(BuiltinShader::TexRemap, EmbeddedResource(glsl_texremap_frag),
-                        rdcspv::ShaderStage::Fragment, FeatureCheck::NoCheck,
-                        BuiltinShaderFlags::BaseTypeParameterised),
-    BuiltinShaderConfig(BuiltinShader::PixelHistoryMSCopyCS,
-                        EmbeddedResource(glsl_pixelhistory_mscopy_comp), rdcspv::ShaderStage::Compute),
-    BuiltinShaderConfig(BuiltinShader::PixelHistoryMSCopyDepthCS,
-                        EmbeddedResource(glsl_pixelhistory_mscopy_depth_comp),
-                        rdcspv::ShaderStage::Compute),
-    BuiltinShaderConfig(BuiltinShader::PixelHistoryPrimIDFS,
-                        EmbeddedResource(glsl_pixelhistory_primid_frag),
-                        rdcspv::ShaderStage::Fragment),
-    BuiltinShaderConfig(BuiltinShader::ShaderDebugSampleVS,
-                        EmbeddedResource(glsl_shaderdebug_sample_vert), rdcspv::ShaderStage::Vertex),
-    BuiltinShaderConfig(BuiltinShader::DiscardFS, EmbeddedResource(glsl_discard_frag),
-                        rdcspv::ShaderStage::Fragment),
-    BuiltinShaderConfig(
-        BuiltinShader::HistogramCS, EmbeddedResource(glsl_histogram_comp),
-        rdcspv::ShaderStage::Compute, FeatureCheck::NoCheck,
-        BuiltinShaderFlags::BaseTypeParameterised | BuiltinShaderFlags::TextureTypeParameterised),
-    BuiltinShaderConfig(
-        BuiltinShader::MinMaxTileCS, EmbeddedResource(glsl_minmaxtile_comp),
-        rdcspv::ShaderStage::Compute, FeatureCheck::NoCheck,
-        BuiltinShaderFlags::BaseTypeParameterised | BuiltinShaderFlags::TextureTypeParameterised),
-    BuiltinShaderConfig(BuiltinShader::MinMaxResultCS, EmbeddedResource(glsl_minmaxresult_comp),
-                        rdcspv::ShaderStage::Compute, FeatureCheck::NoCheck,
-                        BuiltinShaderFlags::BaseTypeParameterised),
+#define BUILTIN_SHADER_CONFIG(name, resource, stage, checks, baseParam, texParam)           \
+  BuiltinShaderConfig(                                                                       \
+      BuiltinShader::name, EmbeddedResource(glsl_##resource), rdcspv::ShaderStage::stage,    \
+      checks,                                                                                \
+      (baseParam ? BuiltinShaderFlags::BaseTypeParameterised : BuiltinShaderFlags::None) |   \
+          (texParam ? BuiltinShaderFlags::TextureTypeParameterised : BuiltinShaderFlags::None)),
+    VK_BUILTIN_SHADERS(BUILTIN_SHADER_CONFIG)
+#undef BUILTIN_SHADER_CONFIG
 };
 
 RDCCOMPILE_ASSERT(ARRAY_COUNT(builtinShaders) == arraydim<BuiltinShader>(),
@@ -184,6 +136,19 @@ static bool PassesChecks(const BuiltinShaderConfig &config, const VkDriverInfo &
   return true;
 }
 
+static rdcstr GetBuiltinDefines(const rdcstr &globalDefines, size_t baseType, size_t textureType)
+{
+  char permutationDefines[128];
+  GetBuiltinShaderPermutationDefines(permutationDefines, (uint32_t)baseType, (uint32_t)textureType);
+
+  return globalDefines + permutationDefines;
+}
+
+static uint32_t GetBuiltinInputHash(const rdcstr &source, const rdcstr &defines)
+{
+  return GetBuiltinShaderInputHash(source.c_str(), defines.c_str());
+}
+
 struct VulkanBlobShaderCallbacks
 {
   bool Create(uint32_t size, byte *data, SPIRVBlob *ret) const
@@ -233,7 +198,7 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
   const VkPhysicalDeviceFeatures &enabledFeatures = driver->GetDeviceEnabledFeatures();
   const VkPhysicalDeviceFeatures &availFeatures = driver->GetDeviceAvailableFeatures();
 
-  rdcstr globalDefines = "#define HAS_BIT_CONVERSION 1\n";
+  rdcstr globalDefines = BuiltinShaderDefaultDefines;
   if(driverVersion.TexelFetchBrokenDriver())
     globalDefines += "#define NO_TEXEL_FETCH\n";
   if(driverVersion.RunningOnMetal())
@@ -247,6 +212,23 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
   m_Array2MSSupported =
       PassesChecks(builtinShaders[(size_t)BuiltinShader::Array2MSCS], driverVersion, availFeatures);
 
+  uint32_t numBaked = 0;
+
+  struct CompiledBuiltin
+  {
+    SPIRVBlob blob = NULL;
+    rdcstr err;
+  };
+
+  struct PendingBuiltin
+  {
+    size_t builtin, baseType, textureType;
+    uint32_t inputHash;
+    Threading::Future<CompiledBuiltin> result;
+  };
+
+  rdcarray<PendingBuiltin> pendingBuiltins;
+
   for(auto i : indices<BuiltinShader>())
   {
     const BuiltinShaderConfig &config = builtinShaders[i];
@@ -275,67 +257,83 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
       for(size_t textureType = (size_t)BuiltinShaderTextureType::First;
           textureType < textureTypeCount; textureType++)
       {
-        rdcstr defines = globalDefines;
-
-        defines += rdcstr("#define SHADER_RESTYPE ") + ToStr(textureType) + "\n";
-        defines += rdcstr("#define SHADER_BASETYPE ") + ToStr(baseType) + "\n";
+        rdcstr defines = GetBuiltinDefines(globalDefines, baseType, textureType);
 
         SPIRVBlob &blob = m_BuiltinShaderBlobs[i][baseType][textureType];
         rdcstr source = GetDynamicEmbeddedResource(config.resource);
 
-        uint32_t inputHash = strhash(source.c_str());
-        inputHash = strhash(defines.c_str(), inputHash);
-
-        // bump this version if anything inside GenerateGLSLShader changes. This is used to
-        // determine if we can skip the call to GenerateGLSLShader (which calls out to glslang).
-        // Otherwise we'll use the cached SPIR-V generated by the previous call using the same
-        // source & defines.
-        inputHash = strhash("inputHashVersion1", inputHash);
-
-        rdcstr err;
+        uint32_t inputHash = GetBuiltinInputHash(source, defines);
 
         if(m_ShaderCache.find(inputHash) != m_ShaderCache.end())
           blob = m_ShaderCache[inputHash];
 
+        // if the shader was compiled at build time, use that. This only misses when we need
+        // different defines for driver workarounds or the source has been modified since.
         if(blob == NULL)
         {
-          err = GetSPIRVBlob(compileSettings,
-                             GenerateGLSLShader(source, ShaderType::Vulkan, 430, defines), blob);
+          size_t numWords = 0;
+          const uint32_t *baked = GetBakedBuiltinShader(inputHash, numWords);
 
-          // if we missed the inputHash, make a copy there too.
-          if(m_CacheShaders)
+          if(baked)
           {
-            m_ShaderCache[inputHash] = new rdcarray<uint32_t>(*blob);
-            m_ShaderCacheDirty = true;
+            blob = new rdcarray<uint32_t>(baked, numWords);
+
+            // the cache owns the blob, but there's no need to mark it dirty
+            m_ShaderCache[inputHash] = blob;
+            numBaked++;
           }
         }
 
-        if(!err.empty() || blob == VK_NULL_HANDLE)
-        {
-          RDCERR("Error compiling builtin %u (baseType %zu textureType %zu): %s", (uint32_t)i,
-                 baseType, textureType, err.c_str());
-        }
-        else
+        if(blob == NULL)
         {
-          VkShaderModuleCreateInfo modinfo = {
-              VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-              NULL,
-              0,
-              blob->size() * sizeof(uint32_t),
-              blob->data(),
+          // the permutations are independent, so compile them on the task pool. Each compile only
+          // touches its own glslang objects, and the results are handled below on this thread.
+          PendingBuiltin pending = {
+              (size_t)i, baseType, textureType, inputHash,
+              Threading::Async([compileSettings, source, defines]() {
+                CompiledBuiltin ret;
+                ret.blob = new rdcarray<uint32_t>();
+                ret.err = rdcspv::Compile(
+                    compileSettings, {GenerateGLSLShader(source, ShaderType::Vulkan, 430, defines)},
+                    *ret.blob);
+                if(!ret.err.empty())
+                  SAFE_DELETE(ret.blob);
+                return ret;
+              }),
           };
 
-          VkResult vkr = driver->vkCreateShaderModule(
-              m_Device, &modinfo, NULL, &m_BuiltinShaderModules[i][baseType][textureType]);
-          RDCASSERTEQUAL(vkr, VK_SUCCESS);
-
-          driver->GetResourceManager()->SetInternalResource(
-              GetResID(m_BuiltinShaderModules[i][baseType][textureType]));
+          pendingBuiltins.push_back(std::move(pending));
+          continue;
         }
+
+        CreateBuiltinModule((size_t)i, baseType, textureType, rdcstr());
       }
     }
   }
 
+  // create modules as the compiles finish. Waiting on each result runs other pending compiles on
+  // this thread, so it contributes to the work rather than just blocking.
+  for(PendingBuiltin &pending : pendingBuiltins)
+  {
+    CompiledBuiltin &compiled = pending.result.Get();
+
+    m_BuiltinShaderBlobs[pending.builtin][pending.baseType][pending.textureType] = compiled.blob;
+
+    if(compiled.blob && m_CacheShaders)
+    {
+      m_ShaderCache[pending.inputHash] = compiled.blob;
+      m_ShaderCacheDirty = true;
+    }
+
+    CreateBuiltinModule(pending.builtin, pending.baseType, pending.textureType, compiled.err);
+  }
+
+  if(!pendingBuiltins.empty())
+    RDCLOG("Compiled %zu builtin shaders", pendingBuiltins.size());
+
+  if(numBaked > 0)
+    RDCDEBUG("Used %u builtin shaders compiled at build time", numBaked);
+
   {
     VkPipelineCacheCreateInfo createInfo = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
 
@@ -413,6 +411,34 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
   SetCaching(false);
 }
 
+void VulkanShaderCache::CreateBuiltinModule(size_t builtin, size_t baseType, size_t textureType,
+                                            const rdcstr &err)
+{
+  SPIRVBlob blob = m_BuiltinShaderBlobs[builtin][baseType][textureType];
+
+  if(!err.empty() || blob == NULL)
+  {
+    RDCERR("Error compiling builtin %u (baseType %zu textureType %zu): %s", (uint32_t)builtin,
+           baseType, textureType, err.c_str());
+    return;
+  }
+
+  VkShaderModuleCreateInfo modinfo = {
+      VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+      NULL,
+      0,
+      blob->size() * sizeof(uint32_t),
+      blob->data(),
+  };
+
+  VkResult vkr = m_pDriver->vkCreateShaderModule(
+      m_Device, &modinfo, NULL, &m_BuiltinShaderModules[builtin][baseType][textureType]);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  m_pDriver->GetResourceManager()->SetInternalResource(
+      GetResID(m_BuiltinShaderModules[builtin][baseType][textureType]));
+}
+
 VulkanShaderCache::~VulkanShaderCache()
 {
   if(m_PipelineCache != VK_NULL_HANDLE)
@@ -966,3 +992,97 @@ void VulkanShaderCache::MakeComputePipelineInfo(VkComputePipelineCreateInfo &pip
 
   pipeCreateInfo = ret;
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS) && defined(RENDERDOC_PRECOMPILED_SHADERS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Check builtin shaders compiled at build time", "[vulkan]")
+{
+  rdcspv::Init();
+
+  rdcspv::CompilationSettings compileSettings;
+  compileSettings.lang = rdcspv::InputLanguage::VulkanGLSL;
+
+  struct Permutation
+  {
+    uint32_t builtin;
+    size_t baseType, textureType;
+    rdcarray<uint32_t> baked;
+    rdcarray<uint32_t> compiled;
+    rdcstr err;
+  };
+
+  rdcarray<Permutation> permutations;
+
+  for(auto i : indices<BuiltinShader>())
+  {
+    const BuiltinShaderConfig &config = builtinShaders[i];
+
+    size_t baseTypeCount = size_t(BuiltinShaderBaseType::First) + 1,
+           textureTypeCount = size_t(BuiltinShaderTextureType::First) + 1;
+
+    if(config.flags & BuiltinShaderFlags::BaseTypeParameterised)
+      baseTypeCount = (size_t)BuiltinShaderBaseType::Count;
+    if(config.flags & BuiltinShaderFlags::TextureTypeParameterised)
+      textureTypeCount = (size_t)BuiltinShaderTextureType::Count;
+
+    for(size_t baseType = (size_t)BuiltinShaderBaseType::First; baseType < baseTypeCount; baseType++)
+    {
+      for(size_t textureType = (size_t)BuiltinShaderTextureType::First;
+          textureType < textureTypeCount; textureType++)
+      {
+        rdcstr defines = GetBuiltinDefines(BuiltinShaderDefaultDefines, baseType, textureType);
+        rdcstr source = GetDynamicEmbeddedResource(config.resource);
+
+        Permutation perm;
+        perm.builtin = (uint32_t)i;
+        perm.baseType = baseType;
+        perm.textureType = textureType;
+
+        size_t numWords = 0;
+        const uint32_t *baked =
+            GetBakedBuiltinShader(GetBuiltinInputHash(source, defines), numWords);
+        if(baked)
+          perm.baked.assign(baked, numWords);
+
+        permutations.push_back(perm);
+      }
+    }
+  }
+
+  // compile concurrently the same way the shader cache does on a cold start, which also checks
+  // that compiling on several threads at once gives the same results.
+  Threading::ParallelFor(
+      0, (uint32_t)permutations.size(),
+      [&permutations, compileSettings](uint32_t idx) {
+        Permutation &perm = permutations[idx];
+        const BuiltinShaderConfig &config = builtinShaders[perm.builtin];
+
+        rdcspv::CompilationSettings settings = compileSettings;
+        settings.stage = config.stage;
+
+        rdcstr defines =
+            GetBuiltinDefines(BuiltinShaderDefaultDefines, perm.baseType, perm.textureType);
+        rdcstr source = GetDynamicEmbeddedResource(config.resource);
+
+        rdcstr glsl = GenerateGLSLShader(source, ShaderType::Vulkan, 430, defines);
+
+        perm.err = rdcspv::Compile(settings, {glsl}, perm.compiled);
+      },
+      1);
+
+  for(const Permutation &perm : permutations)
+  {
+    INFO("builtin " << perm.builtin << " baseType " << perm.baseType << " textureType "
+                    << perm.textureType);
+
+    // every builtin should have been compiled at build time
+    CHECK(!perm.baked.empty());
+
+    CHECK(perm.err == "");
+    CHECK((perm.compiled == perm.baked));
+  }
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS) && defined(RENDERDOC_PRECOMPILED_SHADERS)
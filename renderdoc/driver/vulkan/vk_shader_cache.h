@@ -26,66 +26,13 @@
 
 #include "core/core.h"
 #include "driver/shaders/spirv/spirv_compile.h"
+#include "vk_builtin_shaders.h"
 #include "vk_core.h"
 
 typedef rdcarray<uint32_t> *SPIRVBlob;
 
-enum class BuiltinShader
-{
-  BlitVS,
-  First = BlitVS,
-  CheckerboardFS,
-  TexDisplayFS,
-  FixedColFS,
-  TextVS,
-  TextFS,
-  MeshVS,
-  MeshGS,
-  MeshFS,
-  MeshCS,
-  QuadResolveFS,
-  QuadWriteFS,
-  TrisizeGS,
-  TrisizeFS,
-  MS2ArrayCS,
-  Array2MSCS,
-  DepthMS2ArrayFS,
-  DepthArray2MSFS,
-  TexRemap,
-  PixelHistoryMSCopyCS,
-  PixelHistoryMSCopyDepthCS,
-  PixelHistoryPrimIDFS,
-  ShaderDebugSampleVS,
-  DiscardFS,
-  HistogramCS,
-  MinMaxTileCS,
-  MinMaxResultCS,
-  Count,
-};
-
 ITERABLE_OPERATORS(BuiltinShader);
-
-enum class BuiltinShaderBaseType
-{
-  Float = 0,
-  First = Float,
-  UInt,
-  SInt,
-  Count,
-};
-
 ITERABLE_OPERATORS(BuiltinShaderBaseType);
-
-enum class BuiltinShaderTextureType
-{
-  Tex1D = 1,
-  First = Tex1D,
-  Tex2D,
-  Tex3D,
-  Tex2DMS,
-  Count,
-};
-
 ITERABLE_OPERATORS(BuiltinShaderTextureType);
 
 class VulkanShaderCache
@@ -120,6 +67,7 @@ private:
   static const uint32_t m_ShaderCacheVersion = 1;
 
   void GetPipeCacheBlob();
+  void CreateBuiltinModule(size_t builtin, size_t baseType, size_t textureType, const rdcstr &err);
   void SetPipeCacheBlob(bytebuf &blob);
 
   WrappedVulkan *m_pDriver = NULL;
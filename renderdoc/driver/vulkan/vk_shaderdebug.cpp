@@ -4659,15 +4659,8 @@ ShaderDebugTrace *VulkanReplay::DebugThread(uint32_t eventId, const uint32_t gro
   return ret;
 }
 
-rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
+void VulkanReplay::PrepareShaderDebugDummyWrites()
 {
-  rdcspv::Debugger *spvDebugger = (rdcspv::Debugger *)debugger;
-
-  if(!spvDebugger)
-    return {};
-
-  VkMarkerRegion region("ContinueDebug Simulation Loop");
-
   for(size_t fmt = 0; fmt < ARRAY_COUNT(m_TexRender.DummyImageViews); fmt++)
   {
     for(size_t dim = 0; dim < ARRAY_COUNT(m_TexRender.DummyImageViews[0]); dim++)
@@ -4703,6 +4696,18 @@ rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
     m_ShaderDebugData.DummyWrites[fmt][6].pTexelBufferView =
         UnwrapPtr(m_TexRender.DummyBufferView[fmt]);
   }
+}
+
+rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
+{
+  rdcspv::Debugger *spvDebugger = (rdcspv::Debugger *)debugger;
+
+  if(!spvDebugger)
+    return {};
+
+  VkMarkerRegion region("ContinueDebug Simulation Loop");
+
+  PrepareShaderDebugDummyWrites();
 
   rdcarray<ShaderDebugState> ret = spvDebugger->ContinueDebug();
 
@@ -4712,6 +4717,26 @@ rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
   return ret;
 }
 
+ShaderDebugState VulkanReplay::RunDebug(ShaderDebugger *debugger,
+                                        const rdcarray<uint32_t> &breakpoints)
+{
+  rdcspv::Debugger *spvDebugger = (rdcspv::Debugger *)debugger;
+
+  if(!spvDebugger)
+    return {};
+
+  VkMarkerRegion region("RunDebug Simulation Loop");
+
+  PrepareShaderDebugDummyWrites();
+
+  ShaderDebugState ret = spvDebugger->RunDebug(breakpoints);
+
+  VulkanAPIWrapper *api = (VulkanAPIWrapper *)spvDebugger->GetAPIWrapper();
+  api->ResetReplay();
+
+  return ret;
+}
+
 void VulkanReplay::FreeDebugger(ShaderDebugger *debugger)
 {
   delete debugger;
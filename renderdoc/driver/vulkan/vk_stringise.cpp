@@ -240,6 +240,7 @@ rdcstr DoStringise(const MemoryScope &el)
   {
     STRINGISE_ENUM_CLASS(InitialContents);
     STRINGISE_ENUM_CLASS(IndirectReadback);
+    STRINGISE_ENUM_CLASS(ReplayCheckpoints);
   }
   END_ENUM_STRINGISE()
 }
@@ -747,6 +747,10 @@ bool WrappedVulkan::Serialise_vkBeginCommandBuffer(SerialiserType &ser, VkComman
 
     m_LastCmdBufferID = CommandBuffer;
 
+    // remember where this recording starts, for replay checkpoints
+    if(IsLoading(m_State))
+      m_CmdBufferBeginOffsets[CommandBuffer] = m_CurChunkOffset;
+
     // when loading, allocate a new resource ID for each push descriptor slot in this command buffer
     if(IsLoading(m_State))
     {
@@ -3889,6 +3893,8 @@ bool WrappedVulkan::Serialise_vkCmdExecuteCommands(SerialiserType &ser, VkComman
           ResourceId origSecondId = GetResourceManager()->GetOriginalID(GetResID(pCommandBuffers[i]));
           BakedCmdBufferInfo &src = m_BakedCmdBufferInfo[origSecondId];
 
+          AddCmdBufferRecordRange(origSecondId);
+
           dst.indirectCopies.append(src.indirectCopies);
 
           ImageState::Merge(dst.imageStates, src.imageStates, GetImageTransitionInfo());
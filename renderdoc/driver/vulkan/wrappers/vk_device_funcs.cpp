@@ -888,6 +888,8 @@ void WrappedVulkan::Shutdown()
 
   FreeAllMemory(MemoryScope::InitialContents);
 
+  FreeReplayCheckpoints();
+
   // we do more in Shutdown than the equivalent vkDestroyInstance since on replay there's
   // no explicit vkDestroyDevice, we destroy the device here then the instance
 
@@ -270,6 +270,8 @@ bool WrappedVulkan::Serialise_vkQueueSubmit(SerialiserType &ser, VkQueue queue,
 
           UpdateImageStates(m_BakedCmdBufferInfo[cmd].imageStates);
 
+          AddCmdBufferRecordRange(cmd);
+
           rdcstr name = StringFormat::Fmt("=> %s[%u]: vkBeginCommandBuffer(%s)", basename.c_str(),
                                           c, ToStr(cmd).c_str());
 
@@ -29,6 +29,7 @@
 #include "common/common.h"
 #include "common/formatting.h"
 #include "core/core.h"
+#include "core/profiler.h"
 #include "maths/camera.h"
 #include "maths/formatpacking.h"
 #include "miniz/miniz.h"
@@ -580,6 +581,36 @@ extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_EndSelfHostCapture(const ch
   rdoc->EndFrameCapture(NULL, NULL);
 }
 
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_StartProfiling()
+{
+  Profiler::Start();
+}
+
+extern "C" RENDERDOC_API bool RENDERDOC_CC RENDERDOC_EndProfiling(const rdcstr &filename)
+{
+  if(!Profiler::IsActive())
+  {
+    RDCERR("Profiling was not started");
+    return false;
+  }
+
+  rdcstr json = Profiler::Stop();
+
+  FILE *f = FileIO::fopen(filename.c_str(), "wb");
+
+  if(!f)
+  {
+    RDCERR("Couldn't open '%s' to write profile", filename.c_str());
+    return false;
+  }
+
+  bool success = FileIO::fwrite(json.data(), 1, json.size(), f) == json.size();
+
+  FileIO::fclose(f);
+
+  return success;
+}
+
 extern "C" RENDERDOC_API bool RENDERDOC_CC
 RENDERDOC_NeedVulkanLayerRegistration(VulkanLayerRegistrationInfo *info)
 {
@@ -989,9 +1020,11 @@ extern "C" RENDERDOC_API int RENDERDOC_CC RENDERDOC_RunFunctionalTests(int pytho
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_BeginProfileRegion(const rdcstr &name)
 {
   Superluminal::BeginProfileRange(name);
+  Profiler::BeginRegion(name);
 }
 
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_EndProfileRegion()
 {
   Superluminal::EndProfileRange();
+  Profiler::EndRegion();
 }
@@ -816,6 +816,18 @@ void DoSerialise(SerialiserType &ser, MeshFormat &el)
   SIZE_CHECK(128);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, MeshStatistics &el)
+{
+  SERIALISE_MEMBER(minimum);
+  SERIALISE_MEMBER(maximum);
+  SERIALISE_MEMBER(average);
+  SERIALISE_MEMBER(vertexCount);
+  SERIALISE_MEMBER(nonFiniteCount);
+
+  SIZE_CHECK(56);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, FloatVector &el)
 {
@@ -2324,6 +2336,7 @@ INSTANTIATE_SERIALISE_TYPE(FrameStatistics)
 INSTANTIATE_SERIALISE_TYPE(FrameDescription)
 INSTANTIATE_SERIALISE_TYPE(FrameRecord)
 INSTANTIATE_SERIALISE_TYPE(MeshFormat)
+INSTANTIATE_SERIALISE_TYPE(MeshStatistics)
 INSTANTIATE_SERIALISE_TYPE(FloatVector)
 INSTANTIATE_SERIALISE_TYPE(Uuid)
 INSTANTIATE_SERIALISE_TYPE(CounterDescription)
@@ -24,14 +24,18 @@
  ******************************************************************************/
 
 #include "replay_controller.h"
+#include <float.h>
 #include <string.h>
 #include <time.h>
 #include "common/dds_readwrite.h"
+#include "common/threading.h"
+#include "core/settings.h"
 #include "driver/ihv/amd/amd_isa.h"
 #include "driver/ihv/amd/amd_rgp.h"
 #include "jpeg-compressor/jpgd.h"
 #include "jpeg-compressor/jpge.h"
 #include "maths/formatpacking.h"
+#include "maths/half_convert.h"
 #include "os/os_specific.h"
 #include "serialise/rdcfile.h"
 #include "serialise/serialiser.h"
@@ -40,6 +44,132 @@
 #include "strings/string_utils.h"
 #include "tinyexr/tinyexr.h"
 
+RDOC_CONFIG(uint32_t, Replay_PipelineStateCacheSizeMB, 64,
+            "The amount of memory in MB used to keep the pipeline state of recently selected "
+            "events, so that selecting one of them again doesn't need the state to be fetched from "
+            "the driver again.");
+
+// most of the data in a pipeline state is in the arrays of resource bindings. The pipeline state
+// structs only have copy operators, so to move a state out of the device these arrays are swapped
+// out and the rest is copied. The device is left with empty bindings, which is fine as drivers
+// only use their own copy for the shaders and outputs, e.g. for overlays or shader debugging.
+template <typename T>
+static void TakeArray(rdcarray<T> &dst, rdcarray<T> &src)
+{
+  dst.swap(src);
+  src.clear();
+}
+
+template <typename T>
+static size_t ArrayBytes(const rdcarray<T> &arr)
+{
+  return arr.capacity() * sizeof(T);
+}
+
+static void TakeBindings(D3D11Pipe::Shader &dst, D3D11Pipe::Shader &src)
+{
+  TakeArray(dst.srvs, src.srvs);
+  TakeArray(dst.uavs, src.uavs);
+  TakeArray(dst.samplers, src.samplers);
+  TakeArray(dst.constantBuffers, src.constantBuffers);
+  TakeArray(dst.classInstances, src.classInstances);
+}
+
+static void TakeBindings(D3D11Pipe::State &dst, D3D11Pipe::State &src)
+{
+  TakeBindings(dst.vertexShader, src.vertexShader);
+  TakeBindings(dst.hullShader, src.hullShader);
+  TakeBindings(dst.domainShader, src.domainShader);
+  TakeBindings(dst.geometryShader, src.geometryShader);
+  TakeBindings(dst.pixelShader, src.pixelShader);
+  TakeBindings(dst.computeShader, src.computeShader);
+}
+
+static void TakeBindings(D3D12Pipe::State &dst, D3D12Pipe::State &src)
+{
+  TakeArray(dst.rootElements, src.rootElements);
+  TakeArray(dst.resourceStates, src.resourceStates);
+}
+
+static void TakeBindings(GLPipe::State &dst, GLPipe::State &src)
+{
+  TakeArray(dst.textures, src.textures);
+  TakeArray(dst.samplers, src.samplers);
+  TakeArray(dst.atomicBuffers, src.atomicBuffers);
+  TakeArray(dst.uniformBuffers, src.uniformBuffers);
+  TakeArray(dst.shaderStorageBuffers, src.shaderStorageBuffers);
+  TakeArray(dst.images, src.images);
+}
+
+static void TakeBindings(VKPipe::State &dst, VKPipe::State &src)
+{
+  TakeArray(dst.graphics.descriptorSets, src.graphics.descriptorSets);
+  TakeArray(dst.compute.descriptorSets, src.compute.descriptorSets);
+  TakeArray(dst.images, src.images);
+}
+
+template <typename State>
+static void TakePipelineState(State &dst, const State *device)
+{
+  // the device's state is only exposed as const, but it's the device's own mutable copy that it
+  // overwrites in SavePipelineState
+  State &src = *const_cast<State *>(device);
+
+  State bindings;
+  TakeBindings(bindings, src);
+  dst = src;
+  TakeBindings(dst, bindings);
+}
+
+// estimates the memory used by a pipeline state, counting the bindings that make up the bulk of it
+static size_t PipelineStateBytes(const D3D11Pipe::State &state)
+{
+  size_t ret = sizeof(state);
+  for(const D3D11Pipe::Shader *shader :
+      {&state.vertexShader, &state.hullShader, &state.domainShader, &state.geometryShader,
+       &state.pixelShader, &state.computeShader})
+  {
+    ret += ArrayBytes(shader->srvs) + ArrayBytes(shader->uavs) + ArrayBytes(shader->samplers) +
+           ArrayBytes(shader->constantBuffers) + ArrayBytes(shader->classInstances);
+  }
+  return ret;
+}
+
+static size_t PipelineStateBytes(const D3D12Pipe::State &state)
+{
+  size_t ret = sizeof(state) + ArrayBytes(state.rootElements) + ArrayBytes(state.resourceStates);
+  for(const D3D12Pipe::RootSignatureRange &range : state.rootElements)
+    ret += ArrayBytes(range.views) + ArrayBytes(range.samplers) + ArrayBytes(range.constantBuffers);
+  for(const D3D12Pipe::ResourceData &res : state.resourceStates)
+    ret += ArrayBytes(res.states);
+  return ret;
+}
+
+static size_t PipelineStateBytes(const GLPipe::State &state)
+{
+  return sizeof(state) + ArrayBytes(state.textures) + ArrayBytes(state.samplers) +
+         ArrayBytes(state.atomicBuffers) + ArrayBytes(state.uniformBuffers) +
+         ArrayBytes(state.shaderStorageBuffers) + ArrayBytes(state.images);
+}
+
+static size_t PipelineStateBytes(const VKPipe::State &state)
+{
+  size_t ret = sizeof(state) + ArrayBytes(state.images);
+  for(const VKPipe::Pipeline *pipe : {&state.graphics, &state.compute})
+  {
+    ret += ArrayBytes(pipe->descriptorSets);
+    for(const VKPipe::DescriptorSet &set : pipe->descriptorSets)
+    {
+      ret += ArrayBytes(set.bindings);
+      for(const VKPipe::DescriptorBinding &bind : set.bindings)
+        ret += ArrayBytes(bind.binds);
+    }
+  }
+  for(const VKPipe::ImageData &img : state.images)
+    ret += ArrayBytes(img.layouts);
+  return ret;
+}
+
 static void fileWriteFunc(void *context, void *data, int size)
 {
   FileIO::fwrite(data, 1, size, (FILE *)context);
@@ -73,6 +203,8 @@ ReplayController::~ReplayController()
 
   m_Outputs.clear();
 
+  ClearPipelineStateCache();
+
   for(auto it = m_CustomShaders.begin(); it != m_CustomShaders.end(); ++it)
     m_pDevice->FreeCustomShader(*it);
 
@@ -513,6 +645,328 @@ MeshFormat ReplayController::GetPostVSData(uint32_t instID, uint32_t viewID, Mes
   return m_pDevice->GetPostVSBuffers(draw->eventId, instID, viewID, stage);
 }
 
+namespace
+{
+struct MeshStatisticsJob
+{
+  const MeshFormat *fmt = NULL;
+  // the vertex index for each vertex to read, or ~0U to skip. Empty if not indexed
+  const rdcarray<uint32_t> *indices = NULL;
+  // the vertex data, starting at the element in the first vertex
+  const byte *data = NULL;
+  const byte *end = NULL;
+  MeshStatistics *out = NULL;
+};
+
+struct MeshStatisticsAccumulator
+{
+  float minimum[4] = {FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX};
+  float maximum[4] = {-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX};
+  double sum[4] = {};
+  uint32_t count[4] = {};
+  uint32_t vertexCount = 0;
+  uint32_t nonFiniteCount = 0;
+};
+
+// the decode function is a template parameter so the per-vertex loop compiles down to a tight loop
+// for each of the common formats, with no per-component branching on the format.
+template <uint32_t compCount, typename DecodeFunc>
+void AccumulateMeshStatistics(const MeshStatisticsJob &job, MeshStatisticsAccumulator &acc,
+                              DecodeFunc decode)
+{
+  const MeshFormat &fmt = *job.fmt;
+  const uint32_t stride = fmt.vertexByteStride;
+  const size_t elemSize = fmt.format.ElementSize();
+
+  uint32_t numVerts = fmt.instanced ? 1 : fmt.numIndices;
+  if(job.indices && !fmt.instanced)
+    numVerts = (uint32_t)job.indices->size();
+
+  float v[4];
+
+  for(uint32_t i = 0; i < numVerts; i++)
+  {
+    uint32_t idx = i;
+
+    if(job.indices && !fmt.instanced)
+    {
+      idx = (*job.indices)[i];
+      if(idx == ~0U)
+        continue;
+    }
+
+    const byte *vert = job.data + uint64_t(idx) * stride;
+    if(vert + elemSize > job.end)
+      continue;
+
+    decode(vert, v);
+
+    acc.vertexCount++;
+
+    for(uint32_t c = 0; c < compCount; c++)
+    {
+      if(!RDCISFINITE(v[c]))
+      {
+        acc.nonFiniteCount++;
+        continue;
+      }
+
+      acc.minimum[c] = RDCMIN(acc.minimum[c], v[c]);
+      acc.maximum[c] = RDCMAX(acc.maximum[c], v[c]);
+      acc.sum[c] += v[c];
+      acc.count[c]++;
+    }
+  }
+}
+
+template <uint32_t compCount>
+void AccumulateFloatMeshStatistics(const MeshStatisticsJob &job, MeshStatisticsAccumulator &acc)
+{
+  AccumulateMeshStatistics<compCount>(job, acc, [](const byte *vert, float *v) {
+    memcpy(v, vert, sizeof(float) * compCount);
+  });
+}
+
+template <uint32_t compCount>
+void AccumulateHalfMeshStatistics(const MeshStatisticsJob &job, MeshStatisticsAccumulator &acc)
+{
+  AccumulateMeshStatistics<compCount>(job, acc, [](const byte *vert, float *v) {
+    uint16_t h[compCount];
+    memcpy(h, vert, sizeof(h));
+    for(uint32_t c = 0; c < compCount; c++)
+      v[c] = ConvertFromHalf(h[c]);
+  });
+}
+
+void CalcMeshStatistics(const MeshStatisticsJob &job)
+{
+  const ResourceFormat &format = job.fmt->format;
+
+  MeshStatisticsAccumulator acc;
+
+  uint32_t compCount = RDCMIN(4U, (uint32_t)format.compCount);
+
+  if(job.data)
+  {
+    const bool regular = !format.Special() && !format.BGRAOrder();
+
+    if(regular && format.compType == CompType::Float && format.compByteWidth == 4)
+    {
+      switch(compCount)
+      {
+        case 1: AccumulateFloatMeshStatistics<1>(job, acc); break;
+        case 2: AccumulateFloatMeshStatistics<2>(job, acc); break;
+        case 3: AccumulateFloatMeshStatistics<3>(job, acc); break;
+        case 4: AccumulateFloatMeshStatistics<4>(job, acc); break;
+        default: break;
+      }
+    }
+    else if(regular && format.compType == CompType::Float && format.compByteWidth == 2)
+    {
+      switch(compCount)
+      {
+        case 1: AccumulateHalfMeshStatistics<1>(job, acc); break;
+        case 2: AccumulateHalfMeshStatistics<2>(job, acc); break;
+        case 3: AccumulateHalfMeshStatistics<3>(job, acc); break;
+        case 4: AccumulateHalfMeshStatistics<4>(job, acc); break;
+        default: break;
+      }
+    }
+    else
+    {
+      // anything else goes through the generic decode
+      AccumulateMeshStatistics<4>(job, acc, [&format](const byte *vert, float *v) {
+        FloatVector f = DecodeFormattedComponents(format, vert);
+        v[0] = f.x;
+        v[1] = f.y;
+        v[2] = f.z;
+        v[3] = f.w;
+      });
+    }
+  }
+
+  MeshStatistics &ret = *job.out;
+
+  float *minimum = &ret.minimum.x;
+  float *maximum = &ret.maximum.x;
+  float *average = &ret.average.x;
+
+  for(uint32_t c = 0; c < compCount; c++)
+  {
+    minimum[c] = acc.minimum[c];
+    maximum[c] = acc.maximum[c];
+    if(acc.count[c] > 0)
+      average[c] = float(acc.sum[c] / double(acc.count[c]));
+  }
+
+  ret.vertexCount = acc.vertexCount;
+  ret.nonFiniteCount = acc.nonFiniteCount;
+}
+};
+
+rdcarray<MeshStatistics> ReplayController::GetMeshStatistics(const rdcarray<MeshFormat> &streams)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  rdcarray<MeshStatistics> ret;
+  ret.resize(streams.size());
+
+  // decode each distinct index buffer once, with primitive restarts and the base vertex applied
+  struct IndexData
+  {
+    const MeshFormat *fmt;
+    rdcarray<uint32_t> indices;
+  };
+  rdcarray<IndexData> indexData;
+  rdcarray<int32_t> streamIndices;
+  streamIndices.fill(streams.size(), -1);
+
+  for(size_t s = 0; s < streams.size(); s++)
+  {
+    const MeshFormat &fmt = streams[s];
+
+    if(fmt.indexResourceId == ResourceId() || fmt.indexByteStride == 0 || fmt.instanced)
+      continue;
+
+    for(size_t i = 0; i < indexData.size(); i++)
+    {
+      const MeshFormat &o = *indexData[i].fmt;
+      if(o.indexResourceId == fmt.indexResourceId && o.indexByteOffset == fmt.indexByteOffset &&
+         o.indexByteStride == fmt.indexByteStride && o.numIndices == fmt.numIndices &&
+         o.baseVertex == fmt.baseVertex && o.allowRestart == fmt.allowRestart &&
+         o.restartIndex == fmt.restartIndex)
+      {
+        streamIndices[s] = (int32_t)i;
+        break;
+      }
+    }
+
+    if(streamIndices[s] >= 0)
+      continue;
+
+    streamIndices[s] = (int32_t)indexData.size();
+    indexData.push_back({&fmt, {}});
+
+    uint64_t len = uint64_t(fmt.numIndices) * fmt.indexByteStride;
+    if(fmt.indexByteSize > 0)
+      len = RDCMIN(len, fmt.indexByteSize);
+
+    bytebuf idata = GetBufferData(fmt.indexResourceId, fmt.indexByteOffset, len);
+
+    const uint32_t stride = fmt.indexByteStride;
+    const uint32_t numIndices = uint32_t(idata.size() / stride);
+    const uint32_t restart =
+        stride >= 4 ? fmt.restartIndex : (fmt.restartIndex & ((1U << (stride * 8)) - 1));
+
+    rdcarray<uint32_t> &indices = indexData.back().indices;
+    indices.resize(numIndices);
+
+    for(uint32_t i = 0; i < numIndices; i++)
+    {
+      uint32_t idx = 0;
+      if(stride == 1)
+        idx = idata[i];
+      else if(stride == 2)
+        idx = ((uint16_t *)idata.data())[i];
+      else
+        idx = ((uint32_t *)idata.data())[i];
+
+      int64_t vert = int64_t(idx) + fmt.baseVertex;
+
+      if((fmt.allowRestart && idx == restart) || vert < 0 || vert >= UINT32_MAX)
+        indices[i] = ~0U;
+      else
+        indices[i] = uint32_t(vert);
+    }
+  }
+
+  // work out the range needed from each vertex buffer, so that each is only fetched once
+  struct VertexData
+  {
+    ResourceId id;
+    uint64_t start, end;
+    bytebuf data;
+  };
+  rdcarray<VertexData> vertexData;
+  rdcarray<int32_t> streamVertices;
+  streamVertices.fill(streams.size(), -1);
+
+  for(size_t s = 0; s < streams.size(); s++)
+  {
+    const MeshFormat &fmt = streams[s];
+
+    if(fmt.vertexResourceId == ResourceId())
+      continue;
+
+    uint32_t maxVert = 0;
+    if(fmt.instanced)
+      maxVert = 0;
+    else if(streamIndices[s] >= 0)
+      for(uint32_t idx : indexData[streamIndices[s]].indices)
+        maxVert = idx == ~0U ? maxVert : RDCMAX(maxVert, idx);
+    else if(fmt.numIndices > 0)
+      maxVert = fmt.numIndices - 1;
+
+    uint64_t start = fmt.vertexByteOffset;
+    uint64_t end = start + uint64_t(maxVert) * fmt.vertexByteStride + fmt.format.ElementSize();
+
+    int32_t idx = -1;
+    for(size_t v = 0; v < vertexData.size(); v++)
+    {
+      if(vertexData[v].id == fmt.vertexResourceId)
+      {
+        idx = (int32_t)v;
+        break;
+      }
+    }
+
+    if(idx < 0)
+    {
+      idx = (int32_t)vertexData.size();
+      vertexData.push_back({fmt.vertexResourceId, start, end, {}});
+    }
+    else
+    {
+      vertexData[idx].start = RDCMIN(vertexData[idx].start, start);
+      vertexData[idx].end = RDCMAX(vertexData[idx].end, end);
+    }
+
+    streamVertices[s] = idx;
+  }
+
+  for(VertexData &v : vertexData)
+    v.data = GetBufferData(v.id, v.start, v.end - v.start);
+
+  rdcarray<MeshStatisticsJob> jobs;
+  jobs.resize(streams.size());
+
+  for(size_t s = 0; s < streams.size(); s++)
+  {
+    MeshStatisticsJob &job = jobs[s];
+    job.fmt = &streams[s];
+    job.out = &ret[s];
+
+    if(streamIndices[s] >= 0)
+      job.indices = &indexData[streamIndices[s]].indices;
+
+    if(streamVertices[s] >= 0)
+    {
+      const VertexData &v = vertexData[streamVertices[s]];
+      job.data = v.data.data() + (streams[s].vertexByteOffset - v.start);
+      job.end = v.data.data() + v.data.size();
+    }
+  }
+
+  // the buffers are all fetched, so the decoding can be spread across threads with one element at
+  // a time.
+  Threading::ParallelFor(0, (uint32_t)jobs.size(),
+                         [&jobs](uint32_t j) { CalcMeshStatistics(jobs[j]); }, 1);
+
+  return ret;
+}
+
 bytebuf ReplayController::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len)
 {
   CHECK_REPLAY_THREAD();
@@ -1644,6 +2098,18 @@ rdcarray<ShaderDebugState> ReplayController::ContinueDebug(ShaderDebugger *debug
   return ret;
 }
 
+ShaderDebugState ReplayController::RunDebug(ShaderDebugger *debugger,
+                                            const rdcarray<uint32_t> &breakpoints)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  ShaderDebugState ret = m_pDevice->RunDebug(debugger, breakpoints);
+
+  return ret;
+}
+
 void ReplayController::FreeTrace(ShaderDebugTrace *trace)
 {
   CHECK_REPLAY_THREAD();
@@ -1973,6 +2439,9 @@ void ReplayController::ReplaceResource(ResourceId from, ResourceId to)
 
   m_pDevice->ReplaceResource(from, to);
 
+  // the pipeline state reflects the replaced resources
+  ClearPipelineStateCache();
+
   SetFrameEvent(m_EventID, true);
 
   for(size_t i = 0; i < m_Outputs.size(); i++)
@@ -1986,6 +2455,9 @@ void ReplayController::RemoveReplacement(ResourceId id)
 
   m_pDevice->RemoveReplacement(id);
 
+  // the pipeline state reflects the replaced resources
+  ClearPipelineStateCache();
+
   SetFrameEvent(m_EventID, true);
 
   for(size_t i = 0; i < m_Outputs.size(); i++)
@@ -2082,13 +2554,99 @@ void ReplayController::FetchPipelineState(uint32_t eventId)
 
   RENDERDOC_PROFILEFUNCTION();
 
-  m_pDevice->SavePipelineState(eventId);
+  CachedPipelineState *cached = NULL;
+
+  for(size_t i = 0; i < m_PipelineStateCache.size(); i++)
+  {
+    if(m_PipelineStateCache[i]->eventId == eventId)
+    {
+      cached = m_PipelineStateCache[i];
+      m_PipelineStateCache.erase(i);
+      break;
+    }
+  }
+
+  if(cached == NULL)
+  {
+    // always save here, even if the device was already at this event, since the bindings in its
+    // state are moved into the cache below
+    m_pDevice->SavePipelineState(eventId);
+    m_DevicePipelineStateEID = eventId;
+
+    cached = new CachedPipelineState;
+    cached->eventId = eventId;
+
+    if(m_pDevice->GetD3D11PipelineState())
+    {
+      TakePipelineState(cached->d3d11, m_pDevice->GetD3D11PipelineState());
+      cached->byteSize = PipelineStateBytes(cached->d3d11);
+    }
+    if(m_pDevice->GetD3D12PipelineState())
+    {
+      TakePipelineState(cached->d3d12, m_pDevice->GetD3D12PipelineState());
+      cached->byteSize = PipelineStateBytes(cached->d3d12);
+    }
+    if(m_pDevice->GetGLPipelineState())
+    {
+      TakePipelineState(cached->gl, m_pDevice->GetGLPipelineState());
+      cached->byteSize = PipelineStateBytes(cached->gl);
+    }
+    if(m_pDevice->GetVulkanPipelineState())
+    {
+      TakePipelineState(cached->vulkan, m_pDevice->GetVulkanPipelineState());
+      cached->byteSize = PipelineStateBytes(cached->vulkan);
+    }
+
+    m_PipelineStateCacheBytes += cached->byteSize;
+
+    // evict the least recently used entries until the cache is within budget. The current event's
+    // state is always kept even if it's over budget on its own.
+    const uint64_t budget = uint64_t(Replay_PipelineStateCacheSizeMB()) * 1024 * 1024;
+    while(!m_PipelineStateCache.empty() && m_PipelineStateCacheBytes > budget)
+    {
+      CachedPipelineState *evict = m_PipelineStateCache.back();
+      m_PipelineStateCache.pop_back();
+
+      m_PipelineStateCacheBytes -= evict->byteSize;
+      delete evict;
+    }
+  }
 
-  m_D3D11PipelineState = m_pDevice->GetD3D11PipelineState();
-  m_D3D12PipelineState = m_pDevice->GetD3D12PipelineState();
-  m_GLPipelineState = m_pDevice->GetGLPipelineState();
-  m_VulkanPipelineState = m_pDevice->GetVulkanPipelineState();
+  m_PipelineStateCache.insert(0, cached);
+
+  m_D3D11PipelineState = m_pDevice->GetD3D11PipelineState() ? &cached->d3d11 : NULL;
+  m_D3D12PipelineState = m_pDevice->GetD3D12PipelineState() ? &cached->d3d12 : NULL;
+  m_GLPipelineState = m_pDevice->GetGLPipelineState() ? &cached->gl : NULL;
+  m_VulkanPipelineState = m_pDevice->GetVulkanPipelineState() ? &cached->vulkan : NULL;
 
   m_PipeState.SetStates(m_APIProps, m_D3D11PipelineState, m_D3D12PipelineState, m_GLPipelineState,
                         m_VulkanPipelineState);
 }
+
+void ReplayController::ClearPipelineStateCache()
+{
+  for(CachedPipelineState *cached : m_PipelineStateCache)
+    delete cached;
+  m_PipelineStateCache.clear();
+  m_PipelineStateCacheBytes = 0;
+
+  m_DevicePipelineStateEID = ~0U;
+
+  m_D3D11PipelineState = NULL;
+  m_D3D12PipelineState = NULL;
+  m_GLPipelineState = NULL;
+  m_VulkanPipelineState = NULL;
+  m_PipeState.SetStates(m_APIProps, NULL, NULL, NULL, NULL);
+}
+
+void ReplayController::SyncDevicePipelineState()
+{
+  CHECK_REPLAY_THREAD();
+
+  // the device uses its copy of the pipeline state to find the current render outputs
+  if(m_DevicePipelineStateEID != m_EventID)
+  {
+    m_pDevice->SavePipelineState(m_EventID);
+    m_DevicePipelineStateEID = m_EventID;
+  }
+}
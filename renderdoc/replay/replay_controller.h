@@ -189,9 +189,11 @@ public:
   ShaderDebugTrace *DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive);
   ShaderDebugTrace *DebugThread(const uint32_t groupid[3], const uint32_t threadid[3]);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
+  ShaderDebugState RunDebug(ShaderDebugger *debugger, const rdcarray<uint32_t> &breakpoints);
   void FreeTrace(ShaderDebugTrace *trace);
 
   MeshFormat GetPostVSData(uint32_t instID, uint32_t viewID, MeshDataStage stage);
+  rdcarray<MeshStatistics> GetMeshStatistics(const rdcarray<MeshFormat> &streams);
 
   rdcarray<EventUsage> GetUsage(ResourceId id);
 
@@ -221,6 +223,8 @@ private:
   ReplayStatus PostCreateInit(IReplayDriver *device, RDCFile *rdc);
 
   void FetchPipelineState(uint32_t eventId);
+  void ClearPipelineStateCache();
+  void SyncDevicePipelineState();
 
   DrawcallDescription *GetDrawcallByEID(uint32_t eventId);
   bool ContainsMarker(const rdcarray<DrawcallDescription> &draws);
@@ -246,6 +250,24 @@ private:
   const VKPipe::State *m_VulkanPipelineState;
   PipeState m_PipeState;
 
+  // the pipeline state at recently selected events, most recently used first, so going back to one
+  // of them doesn't need the state to be derived again.
+  struct CachedPipelineState
+  {
+    uint32_t eventId = 0;
+    size_t byteSize = 0;
+    D3D11Pipe::State d3d11;
+    D3D12Pipe::State d3d12;
+    GLPipe::State gl;
+    VKPipe::State vulkan;
+  };
+  rdcarray<CachedPipelineState *> m_PipelineStateCache;
+  uint64_t m_PipelineStateCacheBytes = 0;
+
+  // the event that the device's own copy of the pipeline state was last saved at. Only overlays
+  // need it, so after a cache hit it's left behind until one is rendered.
+  uint32_t m_DevicePipelineStateEID = ~0U;
+
   rdcarray<ReplayOutput *> m_Outputs;
 
   rdcarray<ResourceDescription> m_Resources;
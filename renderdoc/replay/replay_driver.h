@@ -206,6 +206,8 @@ public:
   virtual ShaderDebugTrace *DebugThread(uint32_t eventId, const uint32_t groupid[3],
                                         const uint32_t threadid[3]) = 0;
   virtual rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger) = 0;
+  virtual ShaderDebugState RunDebug(ShaderDebugger *debugger,
+                                    const rdcarray<uint32_t> &breakpoints) = 0;
   virtual void FreeDebugger(ShaderDebugger *debugger) = 0;
 
   virtual ResourceId RenderOverlay(ResourceId texid, FloatVector clearCol, DebugOverlay overlay,
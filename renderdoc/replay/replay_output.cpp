@@ -266,6 +266,8 @@ void ReplayOutput::RefreshOverlay()
 
   if(m_Type == ReplayOutputType::Texture && m_RenderData.texDisplay.overlay != DebugOverlay::NoOverlay)
   {
+    m_pRenderer->SyncDevicePipelineState();
+
     ResourceId id = m_pDevice->GetLiveID(m_RenderData.texDisplay.resourceId);
 
     if(draw && m_pDevice->IsRenderOutput(id))
@@ -746,6 +748,9 @@ void ReplayOutput::DisplayTex()
 
   ResourceId id = m_pDevice->GetLiveID(m_RenderData.texDisplay.resourceId);
 
+  if(m_RenderData.texDisplay.overlay != DebugOverlay::NoOverlay)
+    m_pRenderer->SyncDevicePipelineState();
+
   if(m_RenderData.texDisplay.overlay != DebugOverlay::NoOverlay && draw &&
      m_pDevice->IsRenderOutput(id) && m_RenderData.texDisplay.overlay != DebugOverlay::NaN &&
      m_RenderData.texDisplay.overlay != DebugOverlay::Clipping && m_OverlayResourceId != ResourceId())
@@ -367,6 +367,12 @@ static ReplayStatus Structured2XML(const char *filename, const RDCFile &file, ui
       delete reader;
       continue;
     }
+    else if(props.type == SectionType::BufferStore)
+    {
+      // stored buffers were already resolved into the structured data's buffers
+      delete reader;
+      continue;
+    }
 
     pugi::xml_node xSection = xRoot.append_child("section");
 
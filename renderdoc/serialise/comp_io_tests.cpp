@@ -28,6 +28,10 @@
 
 #if ENABLED(ENABLE_UNIT_TESTS)
 
+#include "common/formatting.h"
+#include "common/timing.h"
+#include "core/core.h"
+
 #include "catch/catch.hpp"
 
 TEST_CASE("Test LZ4 compression/decompression", "[streamio][lz4]")
@@ -190,4 +194,273 @@ TEST_CASE("Test ZSTD compression/decompression", "[streamio][zstd]")
   delete[] randomData;
 };
 
+TEST_CASE("Test coalesced small writes to a compressor", "[streamio][lz4]")
+{
+  StreamWriter buf(StreamWriter::DefaultScratchSize);
+
+  const uint32_t numWrites = 200000;
+  const uint64_t totalSize = numWrites * 7ULL + 4 * 1024 * 1024;
+
+  byte *largeData = new byte[1024 * 1024];
+
+  for(int i = 0; i < 1024 * 1024; i++)
+    largeData[i] = rand() & 0xff;
+
+  // interleave tiny fixed-size writes with the odd large write that bypasses the coalescing block
+  {
+    StreamWriter writer(new LZ4Compressor(&buf, Ownership::Nothing), Ownership::Stream);
+
+    for(uint32_t i = 0; i < numWrites; i++)
+    {
+      writer.Write(i);
+      writer.Write(uint16_t(i & 0xffff));
+      writer.Write(byte(i & 0xff));
+
+      if((i % 50000) == 0)
+        writer.Write(largeData, 1024 * 1024);
+    }
+
+    CHECK_FALSE(writer.IsErrored());
+    CHECK(writer.GetOffset() == totalSize);
+
+    writer.Finish();
+
+    CHECK_FALSE(writer.IsErrored());
+  }
+
+  {
+    StreamReader reader(
+        new LZ4Decompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream),
+        totalSize, Ownership::Stream);
+
+    byte *readData = new byte[1024 * 1024];
+
+    bool matches = true;
+
+    for(uint32_t i = 0; i < numWrites; i++)
+    {
+      uint32_t a = 0;
+      uint16_t b = 0;
+      byte c = 0;
+      reader.Read(a);
+      reader.Read(b);
+      reader.Read(c);
+
+      matches &= (a == i && b == uint16_t(i & 0xffff) && c == byte(i & 0xff));
+
+      if((i % 50000) == 0)
+      {
+        reader.Read(readData, 1024 * 1024);
+        matches &= memcmp(readData, largeData, 1024 * 1024) == 0;
+      }
+    }
+
+    CHECK(matches);
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+
+    delete[] readData;
+  }
+
+  delete[] largeData;
+}
+
+TEST_CASE("Test read-ahead decompression", "[streamio][zstd]")
+{
+  StreamWriter buf(StreamWriter::DefaultScratchSize);
+
+  const uint32_t numValues = 1500000;
+  const uint64_t largeSize = ReadAheadDecompressor::BlockSize * 3 + 123;
+  const uint64_t totalSize = numValues * sizeof(uint32_t) + largeSize;
+
+  byte *largeData = new byte[(size_t)largeSize];
+
+  for(uint64_t i = 0; i < largeSize; i++)
+    largeData[i] = rand() & 0xff;
+
+  {
+    StreamWriter writer(new ZSTDCompressor(&buf, Ownership::Nothing), Ownership::Stream);
+
+    for(uint32_t i = 0; i < numValues / 2; i++)
+      writer.Write(i);
+
+    writer.Write(largeData, largeSize);
+
+    for(uint32_t i = numValues / 2; i < numValues; i++)
+      writer.Write(i);
+
+    writer.Finish();
+
+    CHECK_FALSE(writer.IsErrored());
+  }
+
+  auto makeDecompressor = [&]() {
+    return new ReadAheadDecompressor(
+        new ZSTDDecompressor(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream),
+        totalSize, 2, Ownership::Stream);
+  };
+
+  SECTION("Reads across blocks")
+  {
+    StreamReader reader(makeDecompressor(), totalSize, Ownership::Stream);
+
+    byte *readData = new byte[(size_t)largeSize];
+
+    bool matches = true;
+
+    for(uint32_t i = 0; i < numValues / 2; i++)
+    {
+      uint32_t val = 0;
+      reader.Read(val);
+      matches &= (val == i);
+    }
+
+    // this is larger than the whole ring, so is satisfied over several blocks
+    reader.Read(readData, largeSize);
+    matches &= memcmp(readData, largeData, (size_t)largeSize) == 0;
+
+    for(uint32_t i = numValues / 2; i < numValues; i++)
+    {
+      uint32_t val = 0;
+      reader.Read(val);
+      matches &= (val == i);
+    }
+
+    CHECK(matches);
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+
+    delete[] readData;
+  }
+
+  SECTION("Reading past the end fails")
+  {
+    ReadAheadDecompressor *decomp = makeDecompressor();
+
+    byte *readData = new byte[(size_t)totalSize];
+
+    CHECK(decomp->Read(readData, totalSize - 16));
+    CHECK_FALSE(decomp->Read(readData, 32));
+    CHECK_FALSE(decomp->Read(readData, 4));
+
+    delete decomp;
+
+    delete[] readData;
+  }
+
+  SECTION("Stopping early")
+  {
+    // destroying the reader while the thread is still decompressing ahead must be safe
+    StreamReader reader(makeDecompressor(), totalSize, Ownership::Stream);
+
+    uint32_t val = ~0U;
+    reader.Read(val);
+    CHECK(val == 0);
+  }
+
+  SECTION("Recompressing")
+  {
+    StreamWriter recompressed(StreamWriter::DefaultScratchSize);
+
+    {
+      LZ4Compressor comp(&recompressed, Ownership::Nothing);
+
+      ReadAheadDecompressor *decomp = makeDecompressor();
+      CHECK(decomp->Recompress(&comp));
+      delete decomp;
+    }
+
+    StreamReader reader(new LZ4Decompressor(new StreamReader(recompressed.GetData(),
+                                                             recompressed.GetOffset()),
+                                            Ownership::Stream),
+                        totalSize, Ownership::Stream);
+
+    reader.SkipBytes(numValues / 2 * sizeof(uint32_t));
+
+    byte *readData = new byte[(size_t)largeSize];
+    reader.Read(readData, largeSize);
+    CHECK(memcmp(readData, largeData, (size_t)largeSize) == 0);
+
+    delete[] readData;
+
+    CHECK_FALSE(reader.IsErrored());
+  }
+
+  delete[] largeData;
+}
+
+TEST_CASE("Benchmark compressed chunk streams", "[.][benchmark]")
+{
+  const int numChunks = 200000;
+
+  byte *bufferContents = new byte[4096];
+  for(int i = 0; i < 4096; i++)
+    bufferContents[i] = byte(i * 7 + (i >> 4));
+
+  StreamWriter buf(64 * 1024 * 1024);
+
+  // roughly the size and shape of a capture's chunk stream - mostly small state-setting and draw
+  // calls, with the occasional buffer upload
+  auto serialiseChunks = [&](bool zstd) {
+    buf.Rewind();
+
+    StreamWriter *writer;
+    if(zstd)
+      writer = new StreamWriter(new ZSTDCompressor(&buf, Ownership::Nothing), Ownership::Stream);
+    else
+      writer = new StreamWriter(new LZ4Compressor(&buf, Ownership::Nothing), Ownership::Stream);
+
+    WriteSerialiser ser(writer, Ownership::Stream);
+
+    for(int i = 0; i < numChunks; i++)
+    {
+      SCOPED_SERIALISE_CHUNK(1 + (i % 8));
+      uint64_t id = 1000 + (i % 300);
+      SERIALISE_ELEMENT(id);
+      uint32_t params[12] = {};
+      params[0] = i;
+      params[5] = i % 3;
+      SERIALISE_ELEMENT(params);
+      float colour[4] = {0.5f, 0.25f, float(i), 1.0f};
+      SERIALISE_ELEMENT(colour);
+
+      if((i % 64) == 0)
+      {
+        uint64_t size = 256 + (i % 3840);
+        SERIALISE_ELEMENT_ARRAY(bufferContents, size);
+      }
+    }
+
+    return writer->GetOffset();
+  };
+
+  SDObject *blockSetting = RenderDoc::Inst().SetConfigSetting("Serialise.CompressWriteBlockKB");
+  const uint64_t defaultBlockKB = blockSetting->data.basic.u;
+
+  auto run = [&](const char *name, uint64_t blockKB, bool zstd) {
+    blockSetting->data.basic.u = blockKB;
+
+    uint64_t bytes = 0;
+    PerformanceTimer timer;
+
+    BENCHMARK(name)
+    {
+      bytes += serialiseChunks(zstd);
+    }
+
+    double seconds = timer.GetMilliseconds() / 1000.0;
+
+    WARN(StringFormat::Fmt("%s: %.1f MB/s", name, double(bytes) / (1024.0 * 1024.0) / seconds));
+  };
+
+  run("LZ4, uncoalesced writes", 0, false);
+  run("LZ4, coalesced writes", defaultBlockKB, false);
+  run("ZSTD, uncoalesced writes", 0, true);
+  run("ZSTD, coalesced writes", defaultBlockKB, true);
+
+  blockSetting->data.basic.u = defaultBlockKB;
+
+  delete[] bufferContents;
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -23,7 +23,13 @@
  ******************************************************************************/
 
 #include "lz4io.h"
+#include "core/settings.h"
 
+RDOC_CONFIG(uint32_t, Serialise_LZ4Acceleration, 20,
+            "The acceleration factor passed to LZ4 when compressing. Higher values compress faster "
+            "but less well, 1 is LZ4's default.");
+
+// the block size is fixed by the format, readers rely on every block but the last being this size
 static const uint64_t lz4BlockSize = 64 * 1024;
 
 LZ4Compressor::LZ4Compressor(StreamWriter *write, Ownership own) : Compressor(write, own)
@@ -34,6 +40,8 @@ LZ4Compressor::LZ4Compressor(StreamWriter *write, Ownership own) : Compressor(wr
 
   m_PageOffset = 0;
 
+  m_Acceleration = (int)RDCMAX(1U, Serialise_LZ4Acceleration());
+
   m_LZ4Comp = LZ4_createStream();
 }
 
@@ -125,9 +133,9 @@ bool LZ4Compressor::FlushPage0()
     return false;
 
   // m_PageOffset is the amount written, usually equal to lz4BlockSize except the last block.
-  int32_t compSize =
-      LZ4_compress_fast_continue(m_LZ4Comp, (const char *)m_Page[0], (char *)m_CompressBuffer,
-                                 (int)m_PageOffset, (int)LZ4_COMPRESSBOUND(lz4BlockSize), 20);
+  int32_t compSize = LZ4_compress_fast_continue(
+      m_LZ4Comp, (const char *)m_Page[0], (char *)m_CompressBuffer, (int)m_PageOffset,
+      (int)LZ4_COMPRESSBOUND(lz4BlockSize), m_Acceleration);
 
   if(compSize < 0)
   {
@@ -42,6 +42,7 @@ private:
   byte *m_Page[2];
   byte *m_CompressBuffer;
   uint64_t m_PageOffset;
+  int m_Acceleration;
 
   LZ4_stream_t *m_LZ4Comp;
 };
@@ -27,11 +27,24 @@
 #include "api/replay/version.h"
 #include "common/dds_readwrite.h"
 #include "common/formatting.h"
+#include "core/settings.h"
 #include "jpeg-compressor/jpge.h"
 #include "stb/stb_image.h"
 #include "lz4io.h"
+#include "serialiser.h"
 #include "zstdio.h"
 
+RDOC_CONFIG(uint32_t, Serialise_ReadAheadBlocks, 4,
+            "The number of 1MB blocks that large compressed sections are decompressed ahead of "
+            "the reader on a helper thread. If set to 0, sections are decompressed as they're read.");
+
+RDOC_CONFIG(bool, Capture_DeduplicateInitialContents, true,
+            "Store each unique initial contents buffer only once in a capture, with references to "
+            "it from the resources that share its contents.");
+
+// 1 -> 2 - buffers are LZ4 compressed individually instead of compressing the whole section
+static const uint64_t BufferStoreVersion = 2;
+
 // not provided by tinyexr, just do by hand
 bool is_exr_file(FILE *f)
 {
@@ -244,10 +257,76 @@ struct BinarySectionHeader
     return;                       \
   }
 
+static const uint64_t DeferredBlockSize = 4 * 1024 * 1024;
+
+// not really a compressor, this just appends written data to a list of fixed-size blocks so that a
+// deferred section can be buffered in memory without repeatedly reallocating and copying as it
+// grows. If the file's buffering limit is reached, the section is written out and the rest of it is
+// passed straight through to the file.
+class DeferredSectionWriter : public Compressor
+{
+public:
+  DeferredSectionWriter(RDCFile *rdc, RDCFile::DeferredSection *section)
+      : Compressor(NULL, Ownership::Nothing), m_RDC(rdc), m_Section(section)
+  {
+  }
+
+  ~DeferredSectionWriter() { SAFE_DELETE(m_Direct); }
+  bool Write(const void *data, uint64_t numBytes)
+  {
+    if(m_Direct)
+      return m_Direct->Write(data, numBytes);
+
+    const byte *src = (const byte *)data;
+
+    while(numBytes > 0)
+    {
+      uint64_t blockOffs = m_Section->size % DeferredBlockSize;
+
+      if(blockOffs == 0)
+      {
+        if(m_RDC->GetDeferredSize() + DeferredBlockSize > m_RDC->m_DeferLimit)
+        {
+          m_Direct = m_RDC->StopDeferring(m_Section);
+          m_Section = NULL;
+          return m_Direct->Write(src, numBytes);
+        }
+
+        m_Section->blocks.push_back(AllocAlignedBuffer(DeferredBlockSize));
+      }
+
+      uint64_t chunkSize = RDCMIN(numBytes, DeferredBlockSize - blockOffs);
+
+      memcpy(m_Section->blocks.back() + blockOffs, src, (size_t)chunkSize);
+
+      m_Section->size += chunkSize;
+      src += chunkSize;
+      numBytes -= chunkSize;
+    }
+
+    return true;
+  }
+
+  bool Finish() { return m_Direct ? m_Direct->Finish() : true; }
+private:
+  RDCFile *m_RDC;
+  RDCFile::DeferredSection *m_Section;
+  StreamWriter *m_Direct = NULL;
+};
+
 RDCFile::~RDCFile()
 {
   if(m_File)
     FileIO::fclose(m_File);
+
+  SAFE_DELETE(m_BufferStore);
+
+  for(DeferredSection *section : m_DeferredSections)
+  {
+    for(byte *block : section->blocks)
+      FreeAlignedBuffer(block);
+    delete section;
+  }
 }
 
 void RDCFile::Open(const char *path)
@@ -840,18 +919,24 @@ StreamReader *RDCFile::ReadSection(int index) const
   StreamReader *fileReader = new StreamReader(m_File, offsetSize.diskLength, Ownership::Nothing);
 
   StreamReader *compReader = NULL;
+  Decompressor *decompressor = NULL;
 
   if(props.flags & SectionFlags::LZ4Compressed)
-  {
-    // the user will delete the compressed reader, and then it will delete the compressor and the
-    // file reader
-    compReader = new StreamReader(new LZ4Decompressor(fileReader, Ownership::Stream),
-                                  props.uncompressedSize, Ownership::Stream);
-  }
+    decompressor = new LZ4Decompressor(fileReader, Ownership::Stream);
   else if(props.flags & SectionFlags::ZstdCompressed)
+    decompressor = new ZSTDDecompressor(fileReader, Ownership::Stream);
+
+  if(decompressor)
   {
-    compReader = new StreamReader(new ZSTDDecompressor(fileReader, Ownership::Stream),
-                                  props.uncompressedSize, Ownership::Stream);
+    // for large sections, decompress on another thread ahead of where the section is being read
+    uint32_t readAheadBlocks = Serialise_ReadAheadBlocks();
+    if(readAheadBlocks > 0 && props.uncompressedSize > ReadAheadDecompressor::BlockSize * 4)
+      decompressor = new ReadAheadDecompressor(decompressor, props.uncompressedSize,
+                                               readAheadBlocks, Ownership::Stream);
+
+    // the user will delete the compressed reader, and then it will delete the decompressors and
+    // the file reader
+    compReader = new StreamReader(decompressor, props.uncompressedSize, Ownership::Stream);
   }
 
   // if we're compressing return that writer, otherwise return the file writer directly
@@ -882,6 +967,15 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
     return w;
   }
 
+  if(m_DeferWrites)
+  {
+    DeferredSection *section = new DeferredSection;
+    section->props = props;
+    m_DeferredSections.push_back(section);
+
+    return new StreamWriter(new DeferredSectionWriter(this, section), Ownership::Stream);
+  }
+
   // re-open the file as read-write
   {
     uint64_t offs = FileIO::ftell64(m_File);
@@ -1243,6 +1337,143 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
   return compWriter ? compWriter : fileWriter;
 }
 
+BufferStore *RDCFile::GetBufferStore()
+{
+  if(!m_BufferStore && Capture_DeduplicateInitialContents())
+    m_BufferStore = new BufferStore;
+
+  return m_BufferStore;
+}
+
+void RDCFile::WriteBufferStore()
+{
+  if(!m_BufferStore)
+    return;
+
+  if(m_BufferStore->NumBuffers() > 0)
+  {
+    // the buffers are compressed individually as they're added, so the section itself isn't
+    SectionProperties props;
+    props.type = SectionType::BufferStore;
+    props.version = BufferStoreVersion;
+
+    StreamWriter *w = WriteSection(props);
+
+    m_BufferStore->Write(*w);
+
+    w->Finish();
+
+    if(w->IsErrored())
+      RDCERR("Error writing buffer store section");
+
+    delete w;
+
+    // the compressed size is only known once the store has been written
+    RDCLOG("Wrote %llu unique buffers (%.2f MB, %.2f MB compressed), %.2f MB of duplicates "
+           "removed",
+           m_BufferStore->NumBuffers(), double(m_BufferStore->GetStoredBytes()) / (1024.0 * 1024.0),
+           double(m_BufferStore->GetCompressedBytes()) / (1024.0 * 1024.0),
+           double(m_BufferStore->GetDeduplicatedBytes()) / (1024.0 * 1024.0));
+  }
+
+  SAFE_DELETE(m_BufferStore);
+}
+
+BufferStore *RDCFile::ReadBufferStore() const
+{
+  int idx = SectionIndex(SectionType::BufferStore);
+
+  if(idx < 0)
+    return NULL;
+
+  if(m_Sections[idx].version != BufferStoreVersion)
+  {
+    RDCERR("Unsupported buffer store section version %llu", m_Sections[idx].version);
+    return NULL;
+  }
+
+  StreamReader *reader = ReadSection(idx);
+
+  BufferStore *ret = new BufferStore;
+
+  if(!ret->Read(*reader))
+  {
+    RDCERR("Couldn't read buffer store section");
+    SAFE_DELETE(ret);
+  }
+
+  delete reader;
+
+  return ret;
+}
+
+uint64_t RDCFile::GetDeferredSize() const
+{
+  uint64_t ret = 0;
+  for(const DeferredSection *section : m_DeferredSections)
+    ret += section->size;
+  return ret;
+}
+
+void RDCFile::FlushDeferredSections(RENDERDOC_ProgressCallback progress)
+{
+  m_DeferWrites = false;
+
+  const uint64_t total = GetDeferredSize();
+  uint64_t written = 0;
+
+  for(DeferredSection *section : m_DeferredSections)
+  {
+    StreamWriter *w = WriteSection(section->props);
+
+    for(size_t i = 0; i < section->blocks.size(); i++)
+    {
+      uint64_t len = RDCMIN(DeferredBlockSize, section->size - i * DeferredBlockSize);
+
+      w->Write(section->blocks[i], len);
+
+      // release memory as we go, the section is already mostly gone from memory by the end
+      FreeAlignedBuffer(section->blocks[i]);
+      section->blocks[i] = NULL;
+
+      written += len;
+
+      if(progress)
+        progress(float(written) / float(total));
+    }
+
+    w->Finish();
+    delete w;
+
+    delete section;
+  }
+
+  m_DeferredSections.clear();
+}
+
+StreamWriter *RDCFile::StopDeferring(DeferredSection *current)
+{
+  RDCLOG("Buffered capture data reached the %.2f MB limit, writing the rest of '%s' directly",
+         double(m_DeferLimit) / (1024.0 * 1024.0), m_Filename.c_str());
+
+  // the sections completed so far come first in the file
+  m_DeferredSections.removeOne(current);
+  FlushDeferredSections(RENDERDOC_ProgressCallback());
+
+  // then what's been buffered of the section in progress, which the caller continues writing to
+  StreamWriter *w = WriteSection(current->props);
+
+  for(size_t i = 0; i < current->blocks.size(); i++)
+  {
+    w->Write(current->blocks[i], RDCMIN(DeferredBlockSize, current->size - i * DeferredBlockSize));
+    FreeAlignedBuffer(current->blocks[i]);
+  }
+
+  delete current;
+
+  return w;
+}
+
 FILE *RDCFile::StealImageFileHandle(rdcstr &filename)
 {
   if(m_Driver != RDCDriver::Image)
@@ -1257,3 +1488,273 @@ FILE *RDCFile::StealImageFileHandle(rdcstr &filename)
   m_File = NULL;
   return ret;
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Check deferred RDC section writing", "[rdcfile]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "/deferred_write.rdc";
+
+  // larger than one deferred block, so the data spans several
+  bytebuf frameData;
+  frameData.resize(9 * 1024 * 1024 + 123);
+  for(size_t i = 0; i < frameData.size(); i++)
+    frameData[i] = byte((i * 7) ^ (i >> 12));
+
+  const char extraData[] = "extra section contents";
+
+  // with a limit smaller than the frame section, the file stops buffering partway through it
+  bool overLimit = false;
+
+  SECTION("Within the memory limit")
+  {
+    overLimit = false;
+  }
+
+  SECTION("Over the memory limit")
+  {
+    overLimit = true;
+  }
+
+  {
+    RDCFile rdc;
+    rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL, 0, 1.0);
+    rdc.Create(filename.c_str());
+    REQUIRE((rdc.ErrorCode() == ContainerError::NoError));
+
+    rdc.SetDeferredWriting(true, overLimit ? 5 * 1024 * 1024 : ~0ULL);
+
+    SectionProperties props;
+    props.flags = SectionFlags::LZ4Compressed;
+    props.type = SectionType::FrameCapture;
+    props.version = 1;
+
+    StreamWriter *w = rdc.WriteSection(props);
+    // write in uneven pieces to cross block boundaries mid-write
+    for(size_t offs = 0; offs < frameData.size(); offs += 1000003)
+      w->Write(frameData.data() + offs, RDCMIN(frameData.size() - offs, (size_t)1000003));
+    w->Finish();
+    delete w;
+
+    props = SectionProperties();
+    props.type = SectionType::EmbeddedLogfile;
+    props.version = 1;
+
+    w = rdc.WriteSection(props);
+    w->Write(extraData, sizeof(extraData));
+    w->Finish();
+    delete w;
+
+    if(overLimit)
+    {
+      // nothing is left buffered, both sections were written directly
+      CHECK(rdc.NumSections() == 2);
+      CHECK(rdc.GetDeferredSize() == 0);
+    }
+    else
+    {
+      CHECK(rdc.NumSections() == 0);
+      CHECK(rdc.GetDeferredSize() == frameData.size() + sizeof(extraData));
+
+      float lastProgress = 0.0f;
+      rdc.FlushDeferredSections([&lastProgress](float p) {
+        CHECK(p >= lastProgress);
+        lastProgress = p;
+      });
+
+      CHECK(lastProgress == 1.0f);
+      CHECK(rdc.GetDeferredSize() == 0);
+      CHECK(rdc.NumSections() == 2);
+    }
+  }
+
+  {
+    RDCFile rdc;
+    rdc.Open(filename.c_str());
+    REQUIRE((rdc.ErrorCode() == ContainerError::NoError));
+    REQUIRE(rdc.NumSections() == 2);
+
+    int idx = rdc.SectionIndex(SectionType::FrameCapture);
+    REQUIRE(idx == 0);
+
+    StreamReader *r = rdc.ReadSection(idx);
+    REQUIRE(r->GetSize() == frameData.size());
+
+    bytebuf readData;
+    readData.resize(frameData.size());
+    r->Read(readData.data(), readData.size());
+    delete r;
+
+    CHECK((readData == frameData));
+
+    idx = rdc.SectionIndex(SectionType::EmbeddedLogfile);
+    REQUIRE(idx == 1);
+
+    r = rdc.ReadSection(idx);
+    REQUIRE(r->GetSize() == sizeof(extraData));
+
+    char readExtra[sizeof(extraData)] = {};
+    r->Read(readExtra, sizeof(readExtra));
+    delete r;
+
+    CHECK(rdcstr(readExtra) == extraData);
+  }
+
+  FileIO::Delete(filename.c_str());
+}
+
+TEST_CASE("Check deduplicated buffers in RDC files", "[rdcfile]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "/buffer_store.rdc";
+
+  bytebuf zeroes, pattern, small;
+  zeroes.resize(64 * 1024);
+  pattern.resize(12345);
+  for(size_t i = 0; i < pattern.size(); i++)
+    pattern[i] = byte(i * 31);
+  small.resize(100);
+
+  // buffers below the minimum size are always stored inline. Use enough of them to take the frame
+  // section over 64KB, so it isn't read in a single block before the store is read.
+  bytebuf inlined;
+  inlined.resize(size_t(BufferStore::MinimumSize - 1));
+  for(size_t i = 0; i < inlined.size(); i++)
+    inlined[i] = byte((i * 7) ^ (i >> 8));
+
+  // the contents written for each chunk, with several identical buffers
+  rdcarray<const bytebuf *> contents;
+  for(const bytebuf *b : {&zeroes, &pattern, &zeroes, &small, &pattern, &zeroes})
+  {
+    contents.push_back(b);
+    contents.append({&inlined, &inlined, &inlined});
+  }
+  contents.append({&inlined, &inlined});
+
+  const uint64_t inlineBytes = small.size() + inlined.size() * 20;
+
+  uint64_t frameSize = 0;
+
+  {
+    RDCFile rdc;
+    rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL, 0, 1.0);
+    rdc.Create(filename.c_str());
+    REQUIRE((rdc.ErrorCode() == ContainerError::NoError));
+
+    SectionProperties props;
+    props.type = SectionType::FrameCapture;
+    props.version = 1;
+
+    {
+      WriteSerialiser ser(rdc.WriteSection(props), Ownership::Stream);
+      ser.SetBufferStore(rdc.GetBufferStore(), Ownership::Nothing);
+      REQUIRE(ser.GetBufferStore());
+
+      for(const bytebuf *b : contents)
+      {
+        SCOPED_SERIALISE_CHUNK(1, 256 + (b->size() < BufferStore::MinimumSize ? b->size() : 0));
+        uint64_t size = b->size();
+        byte *data = (byte *)b->data();
+        ser.Serialise("Size"_lit, size);
+        ser.Serialise("Contents"_lit, data, size);
+      }
+
+      // a reference to a real stored buffer, but with a size that doesn't match. This must be
+      // rejected before anything is allocated for it.
+      {
+        SCOPED_SERIALISE_CHUNK(2, 256);
+        uint64_t size = 0x7fffffffffffULL;
+        uint64_t storedSize = size | (1ULL << 63);
+        uint64_t storeIndex = 0;
+        ser.Serialise("Size"_lit, size);
+        ser.Serialise("Contents"_lit, storedSize);
+        ser.Serialise("Contents"_lit, storeIndex);
+      }
+
+      CHECK(ser.GetBufferStore()->NumBuffers() == 2);
+      CHECK(ser.GetBufferStore()->GetDeduplicatedBytes() == zeroes.size() * 2 + pattern.size());
+
+      frameSize = ser.GetWriter()->GetOffset();
+    }
+
+    // only the small buffers are stored inline
+    CHECK(frameSize > 64 * 1024);
+    CHECK(frameSize < inlineBytes + contents.size() * 512);
+
+    rdc.WriteBufferStore();
+
+    CHECK(rdc.NumSections() == 2);
+  }
+
+  {
+    RDCFile rdc;
+    rdc.Open(filename.c_str());
+    REQUIRE((rdc.ErrorCode() == ContainerError::NoError));
+    REQUIRE(rdc.SectionIndex(SectionType::BufferStore) == 1);
+
+    BufferStore *store = rdc.ReadBufferStore();
+
+    ReadSerialiser ser(rdc.ReadSection(rdc.SectionIndex(SectionType::FrameCapture)),
+                       Ownership::Stream);
+    ser.SetBufferStore(store, Ownership::Stream);
+    REQUIRE(ser.GetBufferStore());
+
+    for(const bytebuf *b : contents)
+    {
+      CHECK(ser.ReadChunk<uint32_t>() == 1);
+
+      byte *data = NULL;
+      uint64_t size = 0;
+      ser.Serialise("Size"_lit, size);
+      ser.Serialise("Contents"_lit, data, size, SerialiserFlags::AllocateMemory);
+
+      REQUIRE(size == b->size());
+      CHECK(memcmp(data, b->data(), (size_t)size) == 0);
+
+      FreeAlignedBuffer(data);
+
+      ser.EndChunk();
+    }
+
+    CHECK_FALSE(ser.IsErrored());
+
+    {
+      CHECK(ser.ReadChunk<uint32_t>() == 2);
+
+      byte *data = NULL;
+      uint64_t size = 0;
+      ser.Serialise("Size"_lit, size);
+      ser.Serialise("Contents"_lit, data, size, SerialiserFlags::AllocateMemory);
+
+      CHECK(data == NULL);
+      CHECK(ser.IsErrored());
+
+      FreeAlignedBuffer(data);
+    }
+  }
+
+  // without the store the references can't be resolved
+  {
+    RDCFile rdc;
+    rdc.Open(filename.c_str());
+    REQUIRE((rdc.ErrorCode() == ContainerError::NoError));
+
+    ReadSerialiser ser(rdc.ReadSection(rdc.SectionIndex(SectionType::FrameCapture)),
+                       Ownership::Stream);
+
+    ser.ReadChunk<uint32_t>();
+
+    byte *data = NULL;
+    uint64_t size = 0;
+    ser.Serialise("Size"_lit, size);
+    ser.Serialise("Contents"_lit, data, size, SerialiserFlags::AllocateMemory);
+    FreeAlignedBuffer(data);
+
+    CHECK(ser.IsErrored());
+  }
+
+  FileIO::Delete(filename.c_str());
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
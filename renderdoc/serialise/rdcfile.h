@@ -38,6 +38,8 @@ enum class ContainerError
 
 extern const char *SectionTypeNames[];
 
+class BufferStore;
+
 struct RDCThumb
 {
   bytebuf pixels;
@@ -98,6 +100,29 @@ public:
   StreamReader *ReadSection(int index) const;
   StreamWriter *WriteSection(const SectionProperties &props);
 
+  const rdcstr &GetFilename() const { return m_Filename; }
+  // When deferred, sections written to a file on disk are instead buffered uncompressed in memory
+  // until FlushDeferredSections() is called. This allows the compression and file IO to be done
+  // later, potentially on another thread, as long as nothing else uses the RDCFile meanwhile.
+  // If more than maxBufferedBytes would be buffered, everything so far is written out and the file
+  // goes back to writing sections directly.
+  void SetDeferredWriting(bool deferred, uint64_t maxBufferedBytes = ~0ULL)
+  {
+    m_DeferWrites = deferred;
+    m_DeferLimit = maxBufferedBytes;
+  }
+  uint64_t GetDeferredSize() const;
+  void FlushDeferredSections(RENDERDOC_ProgressCallback progress);
+
+  // When writing a capture, the store that the frame capture's buffers are deduplicated into. It
+  // is NULL if deduplication is disabled. WriteBufferStore() writes it out as its own section once
+  // the frame capture section is complete.
+  BufferStore *GetBufferStore();
+  void WriteBufferStore();
+  // When reading, the buffer store needed to read the frame capture section, or NULL if the capture
+  // has none. The caller owns the returned store.
+  BufferStore *ReadBufferStore() const;
+
   // Only valid if GetDriver returns RDCDriver::Image, passes over the underlying FILE * for use
   // loading the image directly, since the RDC container isn't there to read from a section.
   FILE *StealImageFileHandle(rdcstr &filename);
@@ -133,4 +158,21 @@ private:
   rdcarray<SectionProperties> m_Sections;
   rdcarray<SectionLocation> m_SectionLocations;
   rdcarray<bytebuf> m_MemorySections;
+
+  struct DeferredSection
+  {
+    SectionProperties props;
+    rdcarray<byte *> blocks;
+    uint64_t size = 0;
+  };
+
+  bool m_DeferWrites = false;
+  uint64_t m_DeferLimit = ~0ULL;
+  rdcarray<DeferredSection *> m_DeferredSections;
+
+  StreamWriter *StopDeferring(DeferredSection *current);
+
+  BufferStore *m_BufferStore = NULL;
+
+  friend class DeferredSectionWriter;
 };
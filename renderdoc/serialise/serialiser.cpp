@@ -27,7 +27,9 @@
 
 #include "serialiser.h"
 #include "core/core.h"
+#include "lz4/lz4.h"
 #include "strings/string_utils.h"
+#include "zstd/xxhash.h"
 
 #if ENABLED(RDOC_DEVEL)
 
@@ -36,6 +38,228 @@ int64_t Chunk::m_TotalMem = 0;
 
 #endif
 
+BufferStore::~BufferStore()
+{
+  // compression tasks read from the buffers, so they must finish first
+  m_Compression.Wait();
+
+  if(m_Storage)
+  {
+    FreeAlignedBuffer(m_Storage);
+  }
+  else
+  {
+    CollectCompressed(true);
+
+    for(Buffer &b : m_Buffers)
+      FreeAlignedBuffer(b.data);
+  }
+}
+
+bool BufferStore::Matches(const Buffer &b, const byte *data)
+{
+  if(b.compSize == b.size)
+    return memcmp(b.data, data, (size_t)b.size) == 0;
+
+  m_Scratch.resize((size_t)b.size);
+  int decompSize = LZ4_decompress_safe((const char *)b.data, (char *)m_Scratch.data(),
+                                       (int)b.compSize, (int)b.size);
+
+  return decompSize == (int)b.size && memcmp(m_Scratch.data(), data, (size_t)b.size) == 0;
+}
+
+void BufferStore::CollectCompressed(bool wait)
+{
+  if(wait)
+    m_Compression.Wait();
+
+  for(Buffer &b : m_Buffers)
+  {
+    if(b.job == NULL || Atomic::CmpExch32(&b.job->done, 0, 0) == 0)
+      continue;
+
+    // only the capturing thread reads the uncompressed copy, so it's safe to swap it out here
+    if(b.job->dst)
+    {
+      FreeAlignedBuffer(b.data);
+      b.data = b.job->dst;
+      b.compSize = b.job->dstSize;
+      m_CompressedBytes -= b.size - b.compSize;
+    }
+
+    delete b.job;
+    b.job = NULL;
+  }
+}
+
+uint64_t BufferStore::Add(const byte *data, uint64_t size)
+{
+  CollectCompressed(false);
+
+  rdcarray<uint32_t> &candidates = m_Lookup[XXH64(data, (size_t)size, 0)];
+
+  for(uint32_t idx : candidates)
+  {
+    const Buffer &b = m_Buffers[idx];
+    if(b.size == size && Matches(b, data))
+    {
+      m_DeduplicatedBytes += size;
+      return idx;
+    }
+  }
+
+  Buffer b;
+  b.size = size;
+  b.compSize = size;
+  b.data = AllocAlignedBuffer(size);
+  b.job = NULL;
+  memcpy(b.data, data, (size_t)size);
+
+  // unique buffers are held until the capture is written, so compress them on the task pool as
+  // they come in rather than stalling the application here. Anything that doesn't compress is kept
+  // as-is.
+  if(size <= LZ4_MAX_INPUT_SIZE)
+  {
+    CompressJob *job = b.job = new CompressJob;
+    job->src = b.data;
+    job->size = size;
+
+    m_Compression.Run([job]() {
+      int bound = LZ4_compressBound((int)job->size);
+      byte *dst = AllocAlignedBuffer((uint64_t)bound);
+
+      int compSize =
+          LZ4_compress_default((const char *)job->src, (char *)dst, (int)job->size, bound);
+
+      if(compSize > 0 && uint64_t(compSize) < job->size)
+      {
+        job->dst = dst;
+        job->dstSize = (uint64_t)compSize;
+      }
+      else
+      {
+        FreeAlignedBuffer(dst);
+      }
+
+      Atomic::Inc32(&job->done);
+    });
+  }
+
+  candidates.push_back((uint32_t)m_Buffers.size());
+  m_Buffers.push_back(b);
+  m_StoredBytes += size;
+  m_CompressedBytes += size;
+
+  return m_Buffers.size() - 1;
+}
+
+bool BufferStore::GetBufferSize(uint64_t index, uint64_t &size) const
+{
+  if(index >= m_Buffers.size() || !m_Storage)
+    return false;
+
+  size = m_Buffers[(size_t)index].size;
+  return true;
+}
+
+bool BufferStore::ReadBuffer(uint64_t index, byte *dst) const
+{
+  if(index >= m_Buffers.size() || !m_Storage)
+    return false;
+
+  const Buffer &b = m_Buffers[(size_t)index];
+
+  if(b.compSize == b.size)
+  {
+    memcpy(dst, b.data, (size_t)b.size);
+    return true;
+  }
+
+  int decompSize =
+      LZ4_decompress_safe((const char *)b.data, (char *)dst, (int)b.compSize, (int)b.size);
+
+  return decompSize == (int)b.size;
+}
+
+// the store is written as the number of buffers, then each buffer's size and compressed size, then
+// the data for each buffer. On read the compressed data is kept in one allocation and each buffer
+// is only decompressed when it's serialised.
+bool BufferStore::Write(StreamWriter &writer)
+{
+  CollectCompressed(true);
+
+  writer.Write((uint64_t)m_Buffers.size());
+
+  for(const Buffer &b : m_Buffers)
+  {
+    writer.Write(b.size);
+    writer.Write(b.compSize);
+  }
+
+  for(const Buffer &b : m_Buffers)
+    writer.Write(b.data, b.compSize);
+
+  return !writer.IsErrored();
+}
+
+bool BufferStore::Read(StreamReader &reader)
+{
+  uint64_t numBuffers = 0;
+  reader.Read(numBuffers);
+
+  if(numBuffers > reader.GetSize() / (sizeof(uint64_t) * 2))
+  {
+    RDCERR("Invalid buffer store with %llu buffers in %llu bytes", numBuffers, reader.GetSize());
+    return false;
+  }
+
+  m_Buffers.resize((size_t)numBuffers);
+
+  uint64_t totalSize = 0, totalCompSize = 0;
+  for(size_t i = 0; i < m_Buffers.size(); i++)
+  {
+    Buffer &b = m_Buffers[i];
+
+    reader.Read(b.size);
+    reader.Read(b.compSize);
+    b.job = NULL;
+
+    if(b.compSize > b.size || (b.compSize < b.size && b.size > LZ4_MAX_INPUT_SIZE))
+    {
+      RDCERR("Invalid buffer store entry %zu, %llu bytes compressed to %llu", i, b.size,
+             b.compSize);
+      m_Buffers.clear();
+      return false;
+    }
+
+    totalSize += b.size;
+    totalCompSize += b.compSize;
+  }
+
+  if(reader.IsErrored() || totalCompSize > reader.GetSize() - reader.GetOffset())
+  {
+    RDCERR("Invalid buffer store with %llu bytes of data in %llu bytes", totalCompSize,
+           reader.GetSize());
+    m_Buffers.clear();
+    return false;
+  }
+
+  m_Storage = AllocAlignedBuffer(RDCMAX(totalCompSize, (uint64_t)1));
+  reader.Read(m_Storage, totalCompSize);
+
+  uint64_t offset = 0;
+  for(Buffer &b : m_Buffers)
+  {
+    b.data = m_Storage + offset;
+    offset += b.compSize;
+  }
+
+  m_StoredBytes = totalSize;
+  m_CompressedBytes = totalCompSize;
+
+  return !reader.IsErrored();
+}
+
 void DumpObject(FileIO::LogFileHandle *log, const rdcstr &indent, SDObject *obj)
 {
   if(obj->NumChildren() > 0)
@@ -104,6 +328,9 @@ Serialiser<SerialiserMode::Reading>::~Serialiser()
 {
   if(m_Ownership == Ownership::Stream && m_Read)
     delete m_Read;
+
+  if(m_BufferStoreOwnership == Ownership::Stream)
+    delete m_BufferStore;
 }
 
 template <>
@@ -327,6 +554,9 @@ Serialiser<SerialiserMode::Writing>::~Serialiser()
     m_Write->Finish();
     delete m_Write;
   }
+
+  if(m_BufferStoreOwnership == Ownership::Stream)
+    delete m_BufferStore;
 }
 
 template <>
@@ -992,8 +1222,10 @@ Chunk *Chunk::Create(Serialiser<SerialiserMode::Writing> &ser, uint16_t chunkTyp
 {
   RDCCOMPILE_ASSERT(sizeof(Chunk) <= 16, "Chunk should be no more than 16 bytes");
 
-  RDCASSERT(ser.GetWriter()->GetOffset() < 0xffffffff);
-  uint32_t length = (uint32_t)ser.GetWriter()->GetOffset();
+  StreamWriter *writer = ser.GetWriter();
+
+  RDCASSERT(writer->GetOffset() < 0xffffffff);
+  uint32_t length = (uint32_t)writer->GetOffset();
 
   byte *data = NULL;
   if(allocator)
@@ -1011,9 +1243,13 @@ Chunk *Chunk::Create(Serialiser<SerialiserMode::Writing> &ser, uint16_t chunkTyp
   if(!allocator)
     data = AllocAlignedBuffer(length);
 
-  memcpy(data, ser.GetWriter()->GetData(), (size_t)length);
+  // if the chunk was serialised in place, the allocation is exactly where it was written and
+  // there's nothing to copy
+  if(data != writer->GetData())
+    memcpy(data, writer->GetData(), (size_t)length);
 
-  ser.GetWriter()->Rewind();
+  writer->Rewind();
+  writer->ClearExternalBuffer();
 
   Chunk *ret = NULL;
 
@@ -1168,6 +1404,21 @@ byte *ChunkAllocator::AllocChunk()
   return AllocateFromPages(true, sizeof(Chunk));
 }
 
+void ChunkAllocator::SerialiseInPlace(Serialiser<SerialiserMode::Writing> &ser)
+{
+  // if there isn't a reasonable amount of space left in the current page, start a new one rather
+  // than forcing most chunks to spill back out of it
+  if(pages.empty() || GetRemainingBufferBytes(pages.back()) < m_Pool.GetBufferPageSize() / 16)
+    pages.push_back(m_Pool.AllocPage());
+
+  ChunkPage &p = pages.back();
+
+  // round down so that any chunk that fits will also fit once AllocAlignedBuffer() aligns its size
+  uint64_t available = GetRemainingBufferBytes(p) & ~63ULL;
+
+  ser.GetWriter()->SetExternalBuffer(p.bufferHead, available);
+}
+
 void ChunkAllocator::Reset()
 {
   m_Pool.ResetPageSet(pages);
@@ -25,8 +25,10 @@
 #pragma once
 
 #include <set>
+#include <unordered_map>
 #include "api/replay/structured_data.h"
 #include "common/formatting.h"
+#include "common/threading.h"
 #include "streamio.h"
 
 // function to deallocate anything from a serialise. Default impl
@@ -80,6 +82,78 @@ enum class SerialiserMode
 
 struct CompressedFileIO;
 
+// Holds large buffers keyed by their contents, so that identical data serialised in many places
+// (e.g. cleared textures or zero-filled buffers in initial contents) is only stored once. When one
+// is attached to a writing serialiser, byte buffers of at least MinimumSize are added here and only
+// a reference is written inline. A reading serialiser needs the same store attached to resolve
+// those references again.
+class BufferStore
+{
+public:
+  // smaller buffers aren't worth the hashing and lookup
+  static const uint64_t MinimumSize = 4096;
+
+  BufferStore() = default;
+  BufferStore(const BufferStore &) = delete;
+  BufferStore &operator=(const BufferStore &) = delete;
+  ~BufferStore();
+
+  // returns the index of the stored buffer with these contents, storing a copy if it's new. The
+  // copy is compressed on the task pool rather than on the calling thread.
+  uint64_t Add(const byte *data, uint64_t size);
+  // only valid on a store that has been read. Buffers are kept compressed and only decompressed
+  // into the caller's memory when they're needed.
+  bool GetBufferSize(uint64_t index, uint64_t &size) const;
+  bool ReadBuffer(uint64_t index, byte *dst) const;
+
+  uint64_t NumBuffers() const { return m_Buffers.size(); }
+  uint64_t GetStoredBytes() const { return m_StoredBytes; }
+  uint64_t GetCompressedBytes() const { return m_CompressedBytes; }
+  uint64_t GetDeduplicatedBytes() const { return m_DeduplicatedBytes; }
+  // waits for any outstanding compression before writing
+  bool Write(StreamWriter &writer);
+  bool Read(StreamReader &reader);
+
+private:
+  // a buffer being compressed on the task pool. Only the task writes to it until done is set.
+  struct CompressJob
+  {
+    const byte *src;
+    uint64_t size;
+    byte *dst = NULL;
+    uint64_t dstSize = 0;
+    int32_t done = 0;
+  };
+
+  struct Buffer
+  {
+    // when written, this is uncompressed until compression has finished. When read it points into
+    // m_Storage.
+    byte *data;
+    uint64_t size;
+    // the size of data. If this is the same as size, data is uncompressed
+    uint64_t compSize;
+    CompressJob *job;
+  };
+
+  bool Matches(const Buffer &b, const byte *data);
+  // pick up the results of any finished compression, or wait for all of them
+  void CollectCompressed(bool wait);
+
+  rdcarray<Buffer> m_Buffers;
+  std::unordered_map<uint64_t, rdcarray<uint32_t>> m_Lookup;
+  Threading::TaskGroup m_Compression;
+
+  // when read, all the compressed buffers are kept in one allocation
+  byte *m_Storage = NULL;
+
+  bytebuf m_Scratch;
+
+  uint64_t m_StoredBytes = 0;
+  uint64_t m_CompressedBytes = 0;
+  uint64_t m_DeduplicatedBytes = 0;
+};
+
 template <SerialiserMode sertype>
 class Serialiser
 {
@@ -137,6 +211,14 @@ public:
   void *GetUserData() { return m_pUserData; }
   void SetUserData(void *userData) { m_pUserData = userData; }
   void SetStringDatabase(std::set<rdcstr> *db) { m_ExtStringDB = db; }
+  BufferStore *GetBufferStore() { return m_BufferStore; }
+  void SetBufferStore(BufferStore *store, Ownership own)
+  {
+    if(m_BufferStoreOwnership == Ownership::Stream)
+      delete m_BufferStore;
+    m_BufferStore = store;
+    m_BufferStoreOwnership = own;
+  }
   // jumps to the byte after the current chunk, can be called any time after BeginChunk
   void SkipCurrentChunk();
 
@@ -250,15 +332,40 @@ public:
     if(IsWriting() && el == NULL)
       byteSize = 0;
 
+    // if this buffer is in the buffer store, the index of it there. The top bit of the serialised
+    // size indicates that the index follows instead of the data.
+    uint64_t storeIndex = ~0ULL;
+
+    if(IsWriting() && m_BufferStore && byteSize >= BufferStore::MinimumSize)
+      storeIndex = m_BufferStore->Add(el, byteSize);
+
     {
       m_InternalElement++;
-      DoSerialise(*this, byteSize);
+      if(storeIndex != ~0ULL)
+      {
+        uint64_t storedSize = byteSize | StoredBufferBit;
+        DoSerialise(*this, storedSize);
+        DoSerialise(*this, storeIndex);
+      }
+      else
+      {
+        DoSerialise(*this, byteSize);
+
+        if(IsReading() && (byteSize & StoredBufferBit))
+        {
+          byteSize &= ~StoredBufferBit;
+          DoSerialise(*this, storeIndex);
+        }
+      }
       m_InternalElement--;
     }
 
     if(IsReading())
     {
-      VerifyArraySize(byteSize);
+      if(storeIndex == ~0ULL)
+        VerifyArraySize(byteSize);
+      else
+        VerifyStoredBuffer(byteSize, storeIndex);
     }
 
     if(ExportStructure())
@@ -283,18 +390,23 @@ public:
     {
       if(IsWriting())
       {
-        // ensure byte alignment
-        m_Write->AlignTo<ChunkAlignment>();
+        // stored buffers have no inline data
+        if(storeIndex == ~0ULL)
+        {
+          // ensure byte alignment
+          m_Write->AlignTo<ChunkAlignment>();
 
-        if(el)
-          m_Write->Write(el, byteSize);
-        else
-          RDCASSERT(byteSize == 0);
+          if(el)
+            m_Write->Write(el, byteSize);
+          else
+            RDCASSERT(byteSize == 0);
+        }
       }
       else if(IsReading())
       {
         // ensure byte alignment
-        m_Read->AlignTo<ChunkAlignment>();
+        if(storeIndex == ~0ULL)
+          m_Read->AlignTo<ChunkAlignment>();
 
 // Coverity is unable to tie this allocation together with the automatic scoped deallocation in the
 // ScopedDeseralise* classes. We can verify with e.g. valgrind that there are no leaks, so to keep
@@ -320,7 +432,10 @@ public:
         }
 #endif
 
-        m_Read->Read(el, byteSize);
+        if(storeIndex != ~0ULL)
+          ReadStoredBuffer(el, byteSize, storeIndex);
+        else
+          m_Read->Read(el, byteSize);
       }
     }
 
@@ -1046,6 +1161,54 @@ public:
     return *this;
   }
 
+  // as SerialiseStream but the contents are sent as compressed blocks with checksums, see
+  // StreamTransferCompressed. The contents aren't exported to structured data.
+  Serialiser &SerialiseCompressedStream(const rdcstr &name, StreamReader &stream,
+                                        RENDERDOC_ProgressCallback progress)
+  {
+    RDCCOMPILE_ASSERT(IsWriting(), "Can't read into a StreamReader");
+
+    uint64_t totalSize = stream.GetSize();
+
+    {
+      m_InternalElement++;
+      DoSerialise(*this, totalSize);
+      m_InternalElement--;
+    }
+
+    StreamTransferCompressed(m_Write, &stream, progress);
+
+    return *this;
+  }
+
+  Serialiser &SerialiseCompressedStream(const rdcstr &name, StreamWriter &stream,
+                                        RENDERDOC_ProgressCallback progress)
+  {
+    RDCCOMPILE_ASSERT(IsReading(), "Can't write from a StreamWriter");
+
+    uint64_t totalSize = 0;
+
+    {
+      m_InternalElement++;
+      DoSerialise(*this, totalSize);
+      m_InternalElement--;
+    }
+
+    if(ExportStructure() && !m_StructureStack.empty())
+    {
+      SDObject &current = *m_StructureStack.back();
+
+      SDObject &obj = *current.AddAndOwnChild(new SDObject(name, "Byte Buffer"_lit));
+      obj.type.basetype = SDBasic::Buffer;
+      obj.type.byteSize = totalSize;
+    }
+
+    if(!StreamReceiveCompressed(&stream, m_Read, totalSize, progress))
+      stream.SetErrored();
+
+    return *this;
+  }
+
   // these functions can be chained onto the end of a Serialise() call or macro to
   // set additional properties or change things
   Serialiser &Hidden()
@@ -1276,6 +1439,7 @@ protected:
   void SetStructuriser(bool s) { m_Structuriser = s; }
 private:
   static const uint64_t ChunkAlignment = 64;
+  static const uint64_t StoredBufferBit = 1ULL << 63;
   template <class SerialiserMode, typename T, bool isEnum = std::is_enum<T>::value>
   struct SerialiseDispatch
   {
@@ -1298,6 +1462,34 @@ private:
     }
   };
 
+  // check a stored buffer reference before anything is allocated for it. Invalid references are
+  // treated as empty buffers
+  void VerifyStoredBuffer(uint64_t &byteSize, uint64_t storeIndex)
+  {
+    uint64_t size = 0;
+
+    if(m_BufferStore && m_BufferStore->GetBufferSize(storeIndex, size) && size == byteSize)
+      return;
+
+    RDCERR("Invalid reference to stored buffer %llu of %llu bytes", storeIndex, byteSize);
+
+    byteSize = 0;
+    m_Read->SetErrored();
+  }
+
+  void ReadStoredBuffer(byte *el, uint64_t byteSize, uint64_t storeIndex)
+  {
+    if(el == NULL || byteSize == 0)
+      return;
+
+    if(!m_BufferStore->ReadBuffer(storeIndex, el))
+    {
+      RDCERR("Couldn't decompress stored buffer %llu", storeIndex);
+      memset(el, 0, (size_t)byteSize);
+      m_Read->SetErrored();
+    }
+  }
+
   void VerifyArraySize(uint64_t &count)
   {
     uint64_t size = m_Read->GetSize();
@@ -1365,6 +1557,9 @@ private:
 
   Ownership m_Ownership;
 
+  BufferStore *m_BufferStore = NULL;
+  Ownership m_BufferStoreOwnership = Ownership::Nothing;
+
   // See SetStreamingMode
   bool m_DataStreaming = false;
   bool m_DrawChunk = false;
@@ -1601,6 +1796,12 @@ public:
   byte *AllocAlignedBuffer(uint64_t size);
   byte *AllocChunk();
 
+  // point the serialiser's writer at the free space in our current page, so that the next chunk is
+  // serialised directly in place and Chunk::Create() with this allocator doesn't need to copy it.
+  // The writer goes back to its own buffer once the chunk is created, so nothing keeps pointing
+  // into our pages past that.
+  void SerialiseInPlace(Serialiser<SerialiserMode::Writing> &ser);
+
   void Reset();
 
 private:
@@ -840,6 +840,143 @@ TEST_CASE("Verify multiple chunks can be merged", "[serialiser][chunks]")
   delete buf;
 };
 
+TEST_CASE("Verify chunks can be serialised in place", "[serialiser][chunks]")
+{
+  enum ChunkType
+  {
+    SMALL = 5,
+    LARGE,
+  };
+
+  ChunkPagePool pool(64 * 1024);
+  ChunkAllocator alloc(pool);
+
+  WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+
+  rdcarray<Chunk *> chunks;
+
+  bytebuf largeData;
+  largeData.resize(48 * 1024);
+  for(size_t i = 0; i < largeData.size(); i++)
+    largeData[i] = byte(i * 13);
+
+  // enough small chunks to need several pages, with large chunks in between which won't fit in
+  // whatever space is left and have to be moved out of the page while serialising
+  for(int i = 0; i < 400; i++)
+  {
+    alloc.SerialiseInPlace(ser);
+    CHECK(ser.GetWriter()->IsExternalBuffer());
+
+    if((i % 50) == 25)
+    {
+      SCOPED_SERIALISE_CHUNK(LARGE);
+      SERIALISE_ELEMENT(i);
+      SERIALISE_ELEMENT(largeData);
+      chunks.push_back(scope.Get(&alloc));
+    }
+    else if((i % 10) == 3)
+    {
+      // chunks created without the allocator are copied out of the page as normal
+      SCOPED_SERIALISE_CHUNK(SMALL);
+      SERIALISE_ELEMENT(i);
+      chunks.push_back(scope.Get());
+      CHECK_FALSE(chunks.back()->IsFromAllocator());
+    }
+    else
+    {
+      SCOPED_SERIALISE_CHUNK(SMALL);
+      SERIALISE_ELEMENT(i);
+      chunks.push_back(scope.Get(&alloc));
+      CHECK(chunks.back()->IsFromAllocator());
+    }
+
+    CHECK_FALSE(ser.GetWriter()->IsExternalBuffer());
+  }
+
+  REQUIRE_FALSE(ser.IsErrored());
+
+  StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+  {
+    WriteSerialiser merged(buf, Ownership::Nothing);
+    for(Chunk *c : chunks)
+      c->Write(merged);
+  }
+
+  for(Chunk *c : chunks)
+    c->Delete();
+
+  {
+    ReadSerialiser rser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+    int expected = 0;
+    while(!rser.GetReader()->AtEnd())
+    {
+      uint32_t chunkID = rser.ReadChunk<uint32_t>();
+
+      int i = -1;
+      rser.Serialise("i"_lit, i);
+      CHECK(i == expected);
+
+      if(chunkID == LARGE)
+      {
+        bytebuf readData;
+        rser.Serialise("largeData"_lit, readData);
+        CHECK((readData == largeData));
+      }
+      else
+      {
+        CHECK(chunkID == (uint32_t)SMALL);
+      }
+
+      rser.EndChunk();
+      expected++;
+    }
+
+    CHECK(expected == 400);
+  }
+
+  delete buf;
+}
+
+TEST_CASE("Benchmark chunk creation", "[.][benchmark]")
+{
+  const int numChunks = 200000;
+
+  ChunkPagePool pool(1024 * 1024);
+  ChunkAllocator alloc(pool);
+
+  WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+
+  rdcarray<Chunk *> chunks;
+  chunks.reserve(numChunks);
+
+  auto serialiseChunks = [&](ChunkAllocator *allocator, bool inPlace) {
+    for(int i = 0; i < numChunks; i++)
+    {
+      if(inPlace)
+        allocator->SerialiseInPlace(ser);
+
+      // roughly the size and shape of a typical draw or state-setting call
+      SCOPED_SERIALISE_CHUNK(1);
+      uint32_t params[12] = {};
+      params[0] = i;
+      SERIALISE_ELEMENT(params);
+      chunks.push_back(scope.Get(allocator));
+    }
+
+    for(Chunk *c : chunks)
+      c->Delete();
+    chunks.clear();
+
+    if(allocator)
+      allocator->Reset();
+  };
+
+  BENCHMARK("Heap allocated chunks") { serialiseChunks(NULL, false); }
+  BENCHMARK("Chunk allocator, copied") { serialiseChunks(&alloc, false); }
+  BENCHMARK("Chunk allocator, in place") { serialiseChunks(&alloc, true); }
+}
+
 TEST_CASE("Read/write container types", "[serialiser][structured]")
 {
   StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
@@ -25,7 +25,15 @@
 #include "streamio.h"
 #include <errno.h>
 #include "api/replay/stringise.h"
+#include "common/threading.h"
 #include "common/timing.h"
+#include "core/settings.h"
+#include "zstd/xxhash.h"
+#include "zstdio.h"
+
+RDOC_CONFIG(uint32_t, Serialise_CompressWriteBlockKB, 256,
+            "The size in kilobytes of the block that small writes are coalesced into before being "
+            "passed on to a compressor. If set to 0, writes are passed through directly.");
 
 Compressor::~Compressor()
 {
@@ -39,6 +47,157 @@ Decompressor::~Decompressor()
     delete m_Read;
 }
 
+ReadAheadDecompressor::ReadAheadDecompressor(Decompressor *decompressor, uint64_t uncompressedSize,
+                                             uint32_t numBlocks, Ownership own)
+    : Decompressor(NULL, Ownership::Nothing),
+      m_Decompressor(decompressor),
+      m_DecompressorOwnership(own),
+      m_UncompressedSize(uncompressedSize)
+{
+  // we need at least two blocks so that one can be decompressed while the other is read
+  m_Blocks.resize(RDCMAX(numBlocks, 2U));
+  for(Block &b : m_Blocks)
+    b.data = AllocAlignedBuffer(BlockSize);
+
+  m_Free.Wake((uint32_t)m_Blocks.size());
+
+  m_Thread = Threading::CreateThread([this]() { ThreadEntry(); });
+}
+
+ReadAheadDecompressor::~ReadAheadDecompressor()
+{
+  // wake the thread if it's waiting for a free block, it will see the stop flag and exit
+  Atomic::Inc32(&m_Stop);
+  m_Free.Wake((uint32_t)m_Blocks.size());
+
+  Threading::JoinThread(m_Thread);
+  Threading::CloseThread(m_Thread);
+
+  for(Block &b : m_Blocks)
+    FreeAlignedBuffer(b.data);
+
+  if(m_DecompressorOwnership == Ownership::Stream)
+    delete m_Decompressor;
+}
+
+void ReadAheadDecompressor::ThreadEntry()
+{
+  Threading::SetCurrentThreadName("ReadAheadDecompressor");
+
+  uint64_t remaining = m_UncompressedSize;
+  uint32_t index = 0;
+
+  while(remaining > 0)
+  {
+    m_Free.WaitForWake();
+
+    if(Atomic::CmpExch32(&m_Stop, 0, 0) != 0)
+      return;
+
+    Block &b = m_Blocks[index];
+    b.size = RDCMIN(remaining, uint64_t(BlockSize));
+    b.success = m_Decompressor->Read(b.data, b.size);
+
+    remaining -= b.size;
+
+    m_Filled.Wake(1);
+
+    // the reader will see the failure when it gets to this block, nothing more can be read
+    if(!b.success)
+      return;
+
+    index = (index + 1) % m_Blocks.size();
+  }
+}
+
+const byte *ReadAheadDecompressor::AcquireBlock(uint64_t &available)
+{
+  // if we've consumed the current block, hand it back to be decompressed into again
+  if(m_Current && m_CurrentOffset == m_Current->size)
+  {
+    m_Current = NULL;
+    m_Free.Wake(1);
+    m_CurrentIndex = (m_CurrentIndex + 1) % m_Blocks.size();
+  }
+
+  if(!m_Current)
+  {
+    m_Filled.WaitForWake();
+
+    m_Current = &m_Blocks[m_CurrentIndex];
+    m_CurrentOffset = 0;
+
+    if(!m_Current->success)
+    {
+      m_Errored = true;
+      return NULL;
+    }
+  }
+
+  available = m_Current->size - m_CurrentOffset;
+  return m_Current->data + m_CurrentOffset;
+}
+
+bool ReadAheadDecompressor::Recompress(Compressor *comp)
+{
+  bool success = !m_Errored;
+
+  while(success && m_ConsumedSize < m_UncompressedSize)
+  {
+    uint64_t available = 0;
+    const byte *data = AcquireBlock(available);
+
+    success &= (data != NULL);
+    if(success)
+      success &= comp->Write(data, available);
+
+    m_CurrentOffset += available;
+    m_ConsumedSize += available;
+  }
+  success &= comp->Finish();
+
+  return success;
+}
+
+bool ReadAheadDecompressor::Read(void *data, uint64_t numBytes)
+{
+  if(m_Errored)
+    return false;
+
+  if(numBytes == 0)
+    return true;
+
+  // the thread stops once everything is decompressed, so we can't wait for more than that
+  if(m_ConsumedSize + numBytes > m_UncompressedSize)
+  {
+    RDCERR("Reading %llu bytes at %llu, past the end of %llu uncompressed bytes", numBytes,
+           m_ConsumedSize, m_UncompressedSize);
+    m_Errored = true;
+    return false;
+  }
+
+  byte *dst = (byte *)data;
+
+  while(numBytes > 0)
+  {
+    uint64_t available = 0;
+    const byte *src = AcquireBlock(available);
+
+    if(!src)
+      return false;
+
+    uint64_t chunkSize = RDCMIN(numBytes, available);
+    memcpy(dst, src, (size_t)chunkSize);
+
+    dst += chunkSize;
+    numBytes -= chunkSize;
+    m_CurrentOffset += chunkSize;
+    m_ConsumedSize += chunkSize;
+  }
+
+  return true;
+}
+
 static const uint64_t initialBufferSize = 64 * 1024;
 const byte StreamWriter::empty[128] = {};
 
@@ -487,7 +646,18 @@ StreamWriter::StreamWriter(FILE *file, Ownership own)
 
 StreamWriter::StreamWriter(Compressor *compressor, Ownership own)
 {
-  m_BufferBase = m_BufferHead = m_BufferEnd = NULL;
+  const uint64_t blockSize = Serialise_CompressWriteBlockKB() * 1024ULL;
+
+  if(blockSize > 0)
+  {
+    m_BufferBase = m_BufferHead = AllocAlignedBuffer(blockSize);
+    m_BufferEnd = m_BufferBase + blockSize;
+  }
+  else
+  {
+    // with no block every write fails the space check and goes straight to the compressor
+    m_BufferBase = m_BufferHead = m_BufferEnd = NULL;
+  }
 
   m_Compressor = compressor;
 
@@ -497,9 +667,15 @@ StreamWriter::StreamWriter(Compressor *compressor, Ownership own)
 
 StreamWriter::~StreamWriter()
 {
+  // anything still coalesced must reach the compressor before close callbacks look at its output
+  if(m_Compressor)
+    FlushCompressed();
+
   for(StreamCloseCallback cb : m_Callbacks)
     cb();
 
+  ClearExternalBuffer();
+
   FreeAlignedBuffer(m_BufferBase);
 
   if(m_Ownership == Ownership::Stream)
@@ -512,6 +688,64 @@ StreamWriter::~StreamWriter()
   }
 }
 
+void StreamWriter::SetExternalBuffer(byte *buf, uint64_t size)
+{
+  if(!m_InMemory)
+  {
+    RDCERR("Can't write a file/socket/compressor stream writer to an external buffer");
+    return;
+  }
+
+  if(!m_OwnedBase)
+  {
+    m_OwnedBase = m_BufferBase;
+    m_OwnedEnd = m_BufferEnd;
+  }
+
+  m_BufferBase = m_BufferHead = buf;
+  m_BufferEnd = buf + size;
+  m_WriteSize = 0;
+}
+
+void StreamWriter::ClearExternalBuffer()
+{
+  if(!m_OwnedBase)
+    return;
+
+  m_BufferBase = m_BufferHead = m_OwnedBase;
+  m_BufferEnd = m_OwnedEnd;
+  m_WriteSize = 0;
+
+  m_OwnedBase = m_OwnedEnd = NULL;
+}
+
+void StreamWriter::MoveFromExternalBuffer(uint64_t numBytes)
+{
+  byte *external = m_BufferBase;
+  uint64_t curUsed = m_BufferHead - m_BufferBase;
+
+  m_BufferBase = m_OwnedBase;
+  m_BufferEnd = m_OwnedEnd;
+  m_OwnedBase = m_OwnedEnd = NULL;
+
+  uint64_t bufferSize = m_BufferEnd - m_BufferBase;
+  const uint64_t newSize = curUsed + numBytes;
+
+  if(bufferSize < newSize)
+  {
+    while(bufferSize < newSize)
+      bufferSize += 128 * 1024;
+
+    FreeAlignedBuffer(m_BufferBase);
+
+    m_BufferBase = AllocAlignedBuffer(bufferSize);
+    m_BufferEnd = m_BufferBase + bufferSize;
+  }
+
+  memcpy(m_BufferBase, external, (size_t)curUsed);
+  m_BufferHead = m_BufferBase + curUsed;
+}
+
 bool StreamWriter::SendSocketData(const void *data, uint64_t numBytes)
 {
   // try to coalesce small writes without doing blocking sends, at least until we're flushed.
@@ -562,6 +796,36 @@ bool StreamWriter::FlushSocketData()
   return true;
 }
 
+bool StreamWriter::WriteCompressed(const void *data, uint64_t numBytes)
+{
+  // the write doesn't fit in what's left of the block, so pass on what we have
+  if(!FlushCompressed())
+    return false;
+
+  // small writes start a new block, anything that would fill most of it goes straight through
+  // rather than being copied twice
+  if(numBytes < uint64_t(m_BufferEnd - m_BufferBase) / 2)
+  {
+    memcpy(m_BufferHead, data, (size_t)numBytes);
+    m_BufferHead += numBytes;
+    return true;
+  }
+
+  return m_Compressor->Write(data, numBytes);
+}
+
+bool StreamWriter::FlushCompressed()
+{
+  if(m_BufferHead == m_BufferBase)
+    return true;
+
+  bool success = m_Compressor->Write(m_BufferBase, uint64_t(m_BufferHead - m_BufferBase));
+
+  m_BufferHead = m_BufferBase;
+
+  return success;
+}
+
 void StreamWriter::HandleError()
 {
   if(m_File)
@@ -638,3 +902,188 @@ void StreamTransfer(StreamWriter *writer, StreamReader *reader, RENDERDOC_Progre
 
   delete[] buf;
 }
+
+// each block is this header followed by storedSize bytes, which are either zstd compressed or the
+// raw data if it didn't compress.
+struct CompressedTransferHeader
+{
+  uint32_t uncompressedSize;
+  uint32_t storedSize;
+  uint64_t checksum;
+};
+
+struct CompressedTransferBlock
+{
+  CompressedTransferHeader header = {};
+  bytebuf data;
+};
+
+static const uint64_t CompressedTransferBlockSize = 1024 * 1024;
+
+// how many blocks to have in flight, enough to keep every worker busy
+static uint32_t CompressedTransferDepth()
+{
+  return RDCMAX(2U, Threading::TaskPoolThreadCount() + 1);
+}
+
+static CompressedTransferBlock CompressTransferBlock(const bytebuf &input)
+{
+  CompressedTransferBlock ret;
+  ret.header.uncompressedSize = (uint32_t)input.size();
+  ret.header.checksum = XXH64(input.data(), input.size(), 0);
+
+  StreamWriter compressed(StreamWriter::DefaultScratchSize);
+  bool success;
+  {
+    ZSTDCompressor comp(&compressed, Ownership::Nothing);
+    success = comp.Write(input.data(), input.size()) && comp.Finish();
+  }
+
+  if(success && compressed.GetOffset() < input.size())
+    ret.data.assign(compressed.GetData(), (size_t)compressed.GetOffset());
+  else
+    ret.data = input;
+
+  ret.header.storedSize = (uint32_t)ret.data.size();
+
+  return ret;
+}
+
+static bool DecompressTransferBlock(const CompressedTransferBlock &block, bytebuf &output)
+{
+  output.resize(block.header.uncompressedSize);
+
+  if(block.header.storedSize == block.header.uncompressedSize)
+  {
+    memcpy(output.data(), block.data.data(), output.size());
+  }
+  else
+  {
+    StreamReader compressed(block.data);
+    ZSTDDecompressor decomp(&compressed, Ownership::Nothing);
+    if(!decomp.Read(output.data(), output.size()))
+      return false;
+  }
+
+  return XXH64(output.data(), output.size(), 0) == block.header.checksum;
+}
+
+void StreamTransferCompressed(StreamWriter *writer, StreamReader *reader,
+                              RENDERDOC_ProgressCallback progress)
+{
+  uint64_t totalSize = reader->GetSize();
+  uint64_t numBlocks = (totalSize + CompressedTransferBlockSize - 1) / CompressedTransferBlockSize;
+
+  const uint32_t depth = CompressedTransferDepth();
+
+  // blocks are read in order on this thread, then a slot is reused once its block is written
+  rdcarray<bytebuf> input;
+  input.resize(depth);
+  Threading::Future<CompressedTransferBlock> *compressed =
+      new Threading::Future<CompressedTransferBlock>[depth];
+
+  if(progress)
+    progress(0.0001f);
+
+  uint64_t queued = 0;
+  for(uint64_t i = 0; i < numBlocks; i++)
+  {
+    while(queued < numBlocks && queued - i < depth)
+    {
+      bytebuf *block = &input[queued % depth];
+      block->resize((size_t)RDCMIN(CompressedTransferBlockSize,
+                                   totalSize - queued * CompressedTransferBlockSize));
+      reader->Read(block->data(), block->size());
+
+      compressed[queued % depth] =
+          Threading::Async([block]() { return CompressTransferBlock(*block); });
+      queued++;
+    }
+
+    const CompressedTransferBlock &block = compressed[i % depth].Get();
+
+    writer->Write(block.header);
+    writer->Write(block.data.data(), block.data.size());
+
+    if(progress)
+      progress(float(i + 1) / float(numBlocks));
+  }
+
+  delete[] compressed;
+
+  if(progress)
+    progress(1.0f);
+}
+
+bool StreamReceiveCompressed(StreamWriter *writer, StreamReader *reader, uint64_t totalSize,
+                             RENDERDOC_ProgressCallback progress)
+{
+  uint64_t numBlocks = (totalSize + CompressedTransferBlockSize - 1) / CompressedTransferBlockSize;
+
+  const uint32_t depth = CompressedTransferDepth();
+
+  rdcarray<CompressedTransferBlock> stored;
+  stored.resize(depth);
+  rdcarray<bytebuf> output;
+  output.resize(depth);
+  Threading::Future<bool> *decompressed = new Threading::Future<bool>[depth];
+
+  if(progress)
+    progress(0.0001f);
+
+  bool success = true;
+
+  // a bad checksum only affects that block, so we keep reading to stay in sync with the stream. A
+  // bad header means we can't tell where the next block starts, so we stop there.
+  uint64_t queued = 0, remaining = totalSize;
+  for(uint64_t i = 0; i < numBlocks; i++)
+  {
+    while(queued < numBlocks && queued - i < depth && !reader->IsErrored())
+    {
+      CompressedTransferBlock *block = &stored[queued % depth];
+      bytebuf *dst = &output[queued % depth];
+
+      reader->Read(block->header);
+
+      uint32_t expectedSize = (uint32_t)RDCMIN(CompressedTransferBlockSize, remaining);
+      if(block->header.uncompressedSize != expectedSize ||
+         block->header.storedSize > block->header.uncompressedSize)
+      {
+        RDCERR("Invalid compressed block header in stream");
+        reader->SetErrored();
+        break;
+      }
+
+      block->data.resize(block->header.storedSize);
+      reader->Read(block->data.data(), block->data.size());
+
+      decompressed[queued % depth] =
+          Threading::Async([block, dst]() { return DecompressTransferBlock(*block, *dst); });
+
+      remaining -= expectedSize;
+      queued++;
+    }
+
+    if(i >= queued)
+      break;
+
+    if(!decompressed[i % depth].Get())
+    {
+      RDCERR("Corrupted block %llu in compressed stream", i);
+      success = false;
+    }
+
+    const bytebuf &block = output[i % depth];
+    writer->Write(block.data(), block.size());
+
+    if(progress)
+      progress(float(i + 1) / float(numBlocks));
+  }
+
+  delete[] decompressed;
+
+  if(progress)
+    progress(1.0f);
+
+  return success && !reader->IsErrored() && !writer->IsErrored();
+}
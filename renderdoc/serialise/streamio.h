@@ -66,6 +66,53 @@ protected:
   Ownership m_Ownership;
 };
 
+// wraps another decompressor and runs it on a helper thread, decompressing fixed-size blocks into a
+// bounded ring ahead of the reader so that decompression overlaps with processing the data.
+class ReadAheadDecompressor : public Decompressor
+{
+public:
+  ReadAheadDecompressor(Decompressor *decompressor, uint64_t uncompressedSize, uint32_t numBlocks,
+                        Ownership own);
+  ~ReadAheadDecompressor();
+
+  bool Recompress(Compressor *comp);
+  bool Read(void *data, uint64_t numBytes);
+
+  static const uint64_t BlockSize = 1024 * 1024;
+
+private:
+  void ThreadEntry();
+  const byte *AcquireBlock(uint64_t &available);
+
+  struct Block
+  {
+    byte *data = NULL;
+    uint64_t size = 0;
+    bool success = false;
+  };
+
+  Decompressor *m_Decompressor;
+  Ownership m_DecompressorOwnership;
+
+  uint64_t m_UncompressedSize;
+  uint64_t m_ConsumedSize = 0;
+
+  rdcarray<Block> m_Blocks;
+
+  // the block the reader is currently consuming, and its read offset. NULL before the first read
+  Block *m_Current = NULL;
+  uint32_t m_CurrentIndex = 0;
+  uint64_t m_CurrentOffset = 0;
+
+  bool m_Errored = false;
+
+  // counts blocks that have been decompressed and blocks that are free to decompress into
+  Threading::Semaphore m_Filled, m_Free;
+  int32_t m_Stop = 0;
+
+  Threading::ThreadHandle m_Thread = 0;
+};
+
 class StreamReader
 {
 public:
@@ -316,6 +363,12 @@ public:
 
   uint64_t GetOffset() { return m_WriteSize; }
   const byte *GetData() { return m_BufferBase; }
+  // for in-memory writers, write into an externally owned buffer instead of our own. Any current
+  // contents are discarded. If the external buffer fills up, the data is moved back into our own
+  // buffer and writing continues there as normal.
+  void SetExternalBuffer(byte *buf, uint64_t size);
+  void ClearExternalBuffer();
+  bool IsExternalBuffer() const { return m_OwnedBase != NULL; }
   template <uint64_t alignment>
   bool AlignTo()
   {
@@ -363,7 +416,15 @@ public:
     }
     else if(m_Compressor)
     {
-      return m_Compressor->Write(data, numBytes);
+      // coalesce small writes into our buffer, the compressor only sees whole blocks
+      if(uint64_t(m_BufferEnd - m_BufferHead) > numBytes)
+      {
+        memcpy(m_BufferHead, data, (size_t)numBytes);
+        m_BufferHead += numBytes;
+        return true;
+      }
+
+      return WriteCompressed(data, numBytes);
     }
     else if(m_File)
     {
@@ -393,16 +454,15 @@ public:
   {
     const uint64_t numBytes = sizeof(T);
 
-    if(m_InMemory)
+    // in-memory, compressor and socket writers all append into [m_BufferHead, m_BufferEnd) until
+    // it's full, so as long as there's space we can copy without caring which kind of stream this
+    // is. File and invalid writers have no buffer and always fall through.
+    // We duplicate the implementation here instead of calling the Write(void *, size_t) overload
+    // above since then the compiler may not be able to optimise out the memcpy
+    if(uint64_t(m_BufferEnd - m_BufferHead) > numBytes)
     {
-      // we duplicate the implementation here instead of calling the Write(void *, size_t)
-      // overload above since then the compiler may not be able to optimise out the memcpy
       m_WriteSize += numBytes;
 
-      // are we about to write outside the buffer? Resize it larger
-      if(m_BufferHead + numBytes >= m_BufferEnd)
-        EnsureSized(numBytes);
-
       // perform the actual copy
       memcpy(m_BufferHead, &data, (size_t)numBytes);
 
@@ -411,10 +471,8 @@ public:
 
       return true;
     }
-    else
-    {
-      return Write(&data, numBytes);
-    }
+
+    return Write(&data, numBytes);
   }
 
   // write a particular value at an offset (not necessarily just append).
@@ -443,7 +501,7 @@ public:
   bool Flush()
   {
     if(m_Compressor)
-      return true;
+      return FlushCompressed();
     else if(m_File)
       return FileIO::fflush(m_File);
     else if(m_Sock)
@@ -455,7 +513,7 @@ public:
   bool Finish()
   {
     if(m_Compressor)
-      return m_Compressor->Finish();
+      return FlushCompressed() && m_Compressor->Finish();
     else if(m_File)
       return FileIO::fflush(m_File);
     else if(m_Sock)
@@ -468,6 +526,12 @@ public:
 private:
   inline void EnsureSized(const uint64_t numBytes)
   {
+    if(m_OwnedBase)
+    {
+      MoveFromExternalBuffer(numBytes);
+      return;
+    }
+
     uint64_t bufferSize = m_BufferEnd - m_BufferBase;
     const uint64_t newSize = (m_BufferHead - m_BufferBase) + numBytes;
 
@@ -491,15 +555,21 @@ private:
     }
   }
 
+  void MoveFromExternalBuffer(uint64_t numBytes);
+
   void HandleError();
 
   bool SendSocketData(const void *data, uint64_t numBytes);
   bool FlushSocketData();
 
+  bool WriteCompressed(const void *data, uint64_t numBytes);
+  bool FlushCompressed();
+
   // used for aligned writes
   static const byte empty[128];
 
-  // base of the buffer allocation if we're writing to a buffer
+  // base of the buffer allocation if we're writing to a buffer, or coalescing writes to a
+  // compressor or socket
   byte *m_BufferBase;
 
   // where we are currently writing to in the buffer
@@ -508,6 +578,10 @@ private:
   // the end of the buffer
   byte *m_BufferEnd;
 
+  // if we're writing to an external buffer, our own buffer is saved here
+  byte *m_OwnedBase = NULL;
+  byte *m_OwnedEnd = NULL;
+
   // the total size of the file/compressor (ie. how much data flushed through it)
   uint64_t m_WriteSize = 0;
 
@@ -535,3 +609,13 @@ private:
 };
 
 void StreamTransfer(StreamWriter *writer, StreamReader *reader, RENDERDOC_ProgressCallback progress);
+
+// transfers a stream as a series of independently compressed blocks, each with a checksum of its
+// contents, for copying large files over slow links. Blocks are compressed on the task pool so
+// later blocks are compressed while earlier ones are being written out.
+void StreamTransferCompressed(StreamWriter *writer, StreamReader *reader,
+                              RENDERDOC_ProgressCallback progress);
+// the receiving end of StreamTransferCompressed, writing totalSize bytes out. Returns false if the
+// data was corrupted or the stream failed.
+bool StreamReceiveCompressed(StreamWriter *writer, StreamReader *reader, uint64_t totalSize,
+                             RENDERDOC_ProgressCallback progress);
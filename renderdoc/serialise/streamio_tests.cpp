@@ -307,4 +307,81 @@ TEST_CASE("Test stream I/O operations over the network", "[streamio][network]")
   delete server;
 };
 
+TEST_CASE("Test compressed stream transfer", "[streamio]")
+{
+  // a few blocks and a partial one, half easily compressible and half not
+  bytebuf contents;
+  contents.resize(3 * 1024 * 1024 + 1234);
+  uint32_t seed = 1234;
+  for(size_t i = 0; i < contents.size(); i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    contents[i] = i < contents.size() / 2 ? byte(i / 4096) : byte(seed >> 16);
+  }
+
+  StreamWriter sent(StreamWriter::DefaultScratchSize);
+  {
+    StreamReader source(contents);
+    StreamTransferCompressed(&sent, &source, RENDERDOC_ProgressCallback());
+  }
+
+  REQUIRE_FALSE(sent.IsErrored());
+  CHECK(sent.GetOffset() < contents.size());
+
+  bytebuf wire(sent.GetData(), (size_t)sent.GetOffset());
+
+  SECTION("Round trip")
+  {
+    float lastProgress = 0.0f;
+    StreamReader reader(wire);
+    StreamWriter received(StreamWriter::DefaultScratchSize);
+    CHECK(StreamReceiveCompressed(&received, &reader, contents.size(),
+                                  [&lastProgress](float p) { lastProgress = p; }));
+
+    CHECK(reader.AtEnd());
+    CHECK(lastProgress == 1.0f);
+    REQUIRE(received.GetOffset() == contents.size());
+    CHECK(memcmp(received.GetData(), contents.data(), contents.size()) == 0);
+  };
+
+  SECTION("Corrupted block contents")
+  {
+    // flip a byte in the middle of the last block, past the headers
+    wire[wire.size() - 100] ^= 0x5a;
+
+    StreamReader reader(wire);
+    StreamWriter received(StreamWriter::DefaultScratchSize);
+    CHECK_FALSE(StreamReceiveCompressed(&received, &reader, contents.size(),
+                                        RENDERDOC_ProgressCallback()));
+
+    // the rest of the stream is still consumed
+    CHECK(reader.AtEnd());
+    CHECK_FALSE(reader.IsErrored());
+  };
+
+  SECTION("Corrupted block header")
+  {
+    wire[0] ^= 0x5a;
+
+    StreamReader reader(wire);
+    StreamWriter received(StreamWriter::DefaultScratchSize);
+    CHECK_FALSE(StreamReceiveCompressed(&received, &reader, contents.size(),
+                                        RENDERDOC_ProgressCallback()));
+    CHECK(reader.IsErrored());
+  };
+
+  SECTION("Empty stream")
+  {
+    StreamWriter emptySent(StreamWriter::DefaultScratchSize);
+    StreamReader source(bytebuf{});
+    StreamTransferCompressed(&emptySent, &source, RENDERDOC_ProgressCallback());
+    CHECK(emptySent.GetOffset() == 0);
+
+    StreamReader reader((const byte *)NULL, 0);
+    StreamWriter received(StreamWriter::DefaultScratchSize);
+    CHECK(StreamReceiveCompressed(&received, &reader, 0, RENDERDOC_ProgressCallback()));
+    CHECK(received.GetOffset() == 0);
+  };
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -521,6 +521,7 @@ struct ReplayCommand : public Command
 private:
   std::string filename;
   std::string remote_host;
+  std::string profile;
   uint32_t width = 0;
   uint32_t height = 0;
   uint32_t loops = 0;
@@ -537,6 +538,11 @@ public:
     parser.add<std::string>("remote-host", 0,
                             "Instead of replaying locally, replay on this host over the network.",
                             false);
+    parser.add<std::string>(
+        "profile", 0,
+        "Record RenderDoc's internal profiling regions during a local replay and write them to "
+        "this file as a Chrome trace.",
+        false);
   }
   virtual const char *Description()
   {
@@ -564,6 +570,9 @@ public:
     if(parser.exist("remote-host"))
       remote_host = parser.get<std::string>("remote-host");
 
+    if(parser.exist("profile"))
+      profile = parser.get<std::string>("profile");
+
     width = parser.get<uint32_t>("width");
     height = parser.get<uint32_t>("height");
     loops = parser.get<uint32_t>("loops");
@@ -612,6 +621,9 @@ public:
     {
       std::cout << "Replaying '" << filename << "' locally.." << std::endl;
 
+      if(!profile.empty())
+        RENDERDOC_StartProfiling();
+
       ICaptureFile *file = RENDERDOC_OpenCaptureFile();
 
       if(file->OpenFile(filename.c_str(), "rdc", NULL) != ReplayStatus::Succeeded)
@@ -637,6 +649,14 @@ public:
         std::cerr << "Couldn't load and replay '" << filename << "': " << ToStr(status) << std::endl;
         return 1;
       }
+
+      if(!profile.empty())
+      {
+        if(RENDERDOC_EndProfiling(profile.c_str()))
+          std::cout << "Wrote profile to '" << profile << "'." << std::endl;
+        else
+          std::cerr << "Couldn't write profile to '" << profile << "'." << std::endl;
+      }
     }
     return 0;
   }
@@ -3,6 +3,8 @@ import rdtest
 from typing import List, Tuple
 import time
 import os
+import math
+import struct
 
 # Not a real test, re-used by API-specific tests
 class Draw_Zoo(rdtest.TestCase):
@@ -115,6 +117,8 @@ class Draw_Zoo(rdtest.TestCase):
 
             rdtest.log.success("Checked vertex out data in instance {}".format(inst))
 
+            self.check_mesh_statistics(draw, inst)
+
             if self.props.shaderDebugging and refl.debugInfo.debuggable:
                 for vtx in range(num_verts):
                     if vtx in restarts:
@@ -137,6 +141,107 @@ class Draw_Zoo(rdtest.TestCase):
 
         rdtest.log.success("Checked draw {}".format(draw.eventId))
 
+    def mesh_statistics_reference(self, mesh: rd.MeshFormat):
+        # Calculate the bounds the way the mesh viewer did before GetMeshStatistics, one vertex at a time
+        fmt: rd.ResourceFormat = mesh.format
+
+        flt_max = struct.unpack('=f', struct.pack('=I', 0x7f7fffff))[0]
+        minimum = [flt_max if c < fmt.compCount else 0.0 for c in range(4)]
+        maximum = [-v for v in minimum]
+
+        # instanced elements only read the single element they point at
+        if mesh.instanced:
+            vertices = [0]
+        elif mesh.indexResourceId != rd.ResourceId.Null() and mesh.indexByteStride > 0:
+            ibdata = self.controller.GetBufferData(mesh.indexResourceId, mesh.indexByteOffset,
+                                                   mesh.numIndices * mesh.indexByteStride)
+            index_fmt = {1: 'B', 2: 'H', 4: 'I'}[mesh.indexByteStride]
+            restart = mesh.restartIndex & ((1 << (mesh.indexByteStride*8)) - 1)
+
+            num_indices = int(len(ibdata) / mesh.indexByteStride)
+            indices = struct.unpack_from('=' + str(num_indices) + index_fmt, ibdata)
+
+            vertices = [i + mesh.baseVertex for i in indices if not (mesh.allowRestart and i == restart)]
+        else:
+            vertices = range(mesh.numIndices)
+
+        vbdata = self.controller.GetBufferData(mesh.vertexResourceId, mesh.vertexByteOffset, 0)
+        elem_size = fmt.compCount * fmt.compByteWidth
+
+        for vert in vertices:
+            offs = vert * mesh.vertexByteStride
+            if vert < 0 or offs + elem_size > len(vbdata):
+                continue
+
+            value = rdtest.unpack_data(fmt, vbdata, offs)
+
+            for c, v in enumerate(value):
+                v = float(v)
+                if math.isfinite(v):
+                    minimum[c] = min(minimum[c], v)
+                    maximum[c] = max(maximum[c], v)
+
+        return minimum, maximum
+
+    def check_mesh_statistics(self, draw: rd.DrawcallDescription, inst: int):
+        meshes: List[rd.MeshFormat] = []
+
+        ib: rd.BoundVBuffer = self.pipe.GetIBuffer()
+        vbs: List[rd.BoundVBuffer] = self.pipe.GetVBuffers()
+
+        # Describe the vertex inputs the same way the mesh viewer does
+        for attr in self.pipe.GetVertexInputs():
+            attr: rd.VertexInputAttribute
+            if not attr.used or attr.genericEnabled:
+                continue
+
+            mesh = rd.MeshFormat()
+            mesh.format = attr.format
+            mesh.numIndices = draw.numIndices
+            mesh.instanced = attr.perInstance
+            mesh.instStepRate = attr.instanceRate
+            mesh.allowRestart = self.pipe.IsStripRestartEnabled() and rd.IsStrip(draw.topology)
+            mesh.restartIndex = self.pipe.GetStripRestartIndex()
+
+            if draw.flags & rd.DrawFlags.Indexed:
+                mesh.indexResourceId = ib.resourceId
+                mesh.indexByteStride = draw.indexByteWidth
+                mesh.indexByteOffset = ib.byteOffset + draw.indexOffset * draw.indexByteWidth
+                mesh.baseVertex = draw.baseVertex
+
+            vb = vbs[attr.vertexBuffer]
+
+            element = draw.vertexOffset
+            if attr.perInstance:
+                element = draw.instanceOffset + (int(inst / attr.instanceRate) if attr.instanceRate > 0 else 0)
+
+            mesh.vertexResourceId = vb.resourceId
+            mesh.vertexByteStride = vb.byteStride
+            mesh.vertexByteOffset = vb.byteOffset + attr.byteOffset + element * vb.byteStride
+
+            meshes.append(mesh)
+
+        postvs: rd.MeshFormat = self.controller.GetPostVSData(inst, 0, rd.MeshDataStage.VSOut)
+        meshes += [a.mesh for a in rdtest.get_postvs_attrs(self.controller, postvs, rd.MeshDataStage.VSOut)]
+
+        stats: List[rd.MeshStatistics] = self.controller.GetMeshStatistics(meshes)
+
+        if len(stats) != len(meshes):
+            raise rdtest.TestFailureException("Got {} mesh statistics for {} elements".format(len(stats), len(meshes)))
+
+        for i, mesh in enumerate(meshes):
+            ref_min, ref_max = self.mesh_statistics_reference(mesh)
+
+            stat_min = [stats[i].minimum.x, stats[i].minimum.y, stats[i].minimum.z, stats[i].minimum.w]
+            stat_max = [stats[i].maximum.x, stats[i].maximum.y, stats[i].maximum.z, stats[i].maximum.w]
+
+            if not rdtest.value_compare(ref_min, stat_min) or not rdtest.value_compare(ref_max, stat_max):
+                raise rdtest.TestFailureException(
+                    "Mesh statistics for element {} in instance {} are {} - {}, expected {} - {}".format(
+                        i, inst, stat_min, stat_max, ref_min, ref_max))
+
+        rdtest.log.success("Checked mesh statistics in instance {}".format(inst))
+
     def check_debug(self, vtx, idx, inst, postvs):
         trace: rd.ShaderDebugTrace = self.controller.DebugVertex(vtx, inst, idx, 0)
 
@@ -539,6 +539,65 @@ class TestCase:
 
         return cycles, variables
 
+    def run_trace(self, trace: rd.ShaderDebugTrace, breakpoints=None):
+        if breakpoints is None:
+            breakpoints = []
+
+        state: rd.ShaderDebugState = self.controller.RunDebug(trace.debugger, breakpoints)
+
+        variables = {}
+        for change in state.changes:
+            variables[change.after.name] = change.after
+
+        return state.stepIndex, variables
+
+    def debug_vars_equal(self, a: rd.ShaderVariable, b: rd.ShaderVariable):
+        if a.rows != b.rows or a.columns != b.columns or a.type != b.type or len(a.members) != len(b.members):
+            return False
+
+        if len(a.members) > 0:
+            return all(self.debug_vars_equal(x, y) for x, y in zip(a.members, b.members))
+
+        return list(a.value.u64v) == list(b.value.u64v)
+
+    def check_run_debug(self, trace: rd.ShaderDebugTrace, ref_cycles: int, ref_variables,
+                        output: rd.SourceVariableMapping = None):
+        # Run a second debug of the same invocation to completion with RunDebug, and check the final
+        # snapshot against the result of processing the full trace. The trace is freed afterwards.
+        try:
+            if trace.debugger is None:
+                raise TestFailureException("Couldn't debug invocation a second time")
+
+            cycles, variables = self.run_trace(trace)
+
+            if cycles != ref_cycles:
+                raise TestFailureException("RunDebug finished after {} steps, full trace took {}".format(cycles, ref_cycles))
+
+            compared = 0
+            for name, var in variables.items():
+                var: rd.ShaderVariable
+                # pointers refer to each debugger's own storage so they can't be compared
+                if name not in ref_variables or var.type == rd.VarType.GPUPointer:
+                    continue
+
+                if not self.debug_vars_equal(ref_variables[name], var):
+                    raise TestFailureException("RunDebug final value of {} doesn't match the full trace".format(name))
+
+                compared += 1
+
+            if compared == 0:
+                raise TestFailureException("RunDebug final state has no variables in common with the full trace")
+
+            if output is not None:
+                expect = self.evaluate_source_var(output, ref_variables)
+                debugged = self.evaluate_source_var(output, variables)
+
+                if not util.value_compare(expect.value.fv[0:expect.columns], debugged.value.fv[0:debugged.columns]):
+                    raise TestFailureException("RunDebug output {} is {}, full trace gave {}".format(
+                        output.name, debugged.value.fv[0:debugged.columns], expect.value.fv[0:expect.columns]))
+        finally:
+            self.controller.FreeTrace(trace)
+
     def get_sig_index(self, signature, builtin: rd.ShaderBuiltin, reg_index: int = -1):
         search = (builtin, reg_index)
         signature_mapped = [(sig.systemValue, sig.regIndex) for sig in signature]
@@ -31,6 +31,11 @@ class D3D11_Shader_Debug_Zoo(rdtest.TestCase):
 
             try:
                 self.check_pixel_value(pipe.GetOutputTargets()[0].resourceId, 4 * test, 0, debugged.value.fv[0:4])
+
+                # Check that running to the end without recording states gives the same result
+                self.check_run_debug(self.controller.DebugPixel(4 * test, 0, rd.ReplayController.NoPreference,
+                                                                rd.ReplayController.NoPreference),
+                                     cycles, variables, output)
             except rdtest.TestFailureException as ex:
                 failed = True
                 rdtest.log.error("Test {} did not match. {}".format(test, str(ex)))
@@ -0,0 +1,39 @@
+import rdtest
+import renderdoc as rd
+
+
+class Python_Array_Slices(rdtest.TestCase):
+    def run(self):
+        draw = rd.DrawcallDescription()
+
+        children = []
+        for i in range(10):
+            child = rd.DrawcallDescription()
+            child.eventId = i
+            children.append(child)
+
+        draw.children = children
+
+        # Slicing copies the elements out into a list, as for any python sequence
+        sliced = draw.children[2:8:2]
+        self.check(isinstance(sliced, list))
+        self.check([d.eventId for d in sliced] == [2, 4, 6])
+
+        # view() gives a read-only view onto the same elements without converting them up front
+        view = draw.children.view(2, 8, 2)
+        self.check(len(view) == 3)
+        self.check(view[0].eventId == 2)
+        self.check(view[-1].eventId == 6)
+        self.check([d.eventId for d in view[1:]] == [4, 6])
+        self.check([d.eventId for d in list(view)] == [2, 4, 6])
+
+        self.check(len(draw.children.view()) == 10)
+        self.check([d.eventId for d in draw.children.view(step=-3)] == [9, 6, 3, 0])
+
+        try:
+            view[3]
+            raise rdtest.TestFailureException("Indexing past the end of a view didn't raise")
+        except IndexError:
+            pass
+
+        rdtest.log.success("Array slices and views are as expected")
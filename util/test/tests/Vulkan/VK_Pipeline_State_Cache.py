@@ -0,0 +1,63 @@
+import rdtest
+import renderdoc as rd
+
+
+class VK_Pipeline_State_Cache(rdtest.TestCase):
+    demos_test_name = 'VK_Descriptor_Indexing'
+
+    # converts a pipeline state to plain python values, so it can be compared after the state has changed
+    def snapshot(self, obj):
+        if obj is None or isinstance(obj, (bool, int, float, str, bytes)):
+            return obj
+
+        if isinstance(obj, rd.ResourceId):
+            return str(obj)
+
+        if hasattr(obj, '__len__') and hasattr(obj, '__getitem__'):
+            return [self.snapshot(o) for o in obj]
+
+        ret = {}
+        for name in dir(obj):
+            if name.startswith('_') or name in ['this', 'thisown']:
+                continue
+
+            val = getattr(obj, name)
+            if not callable(val):
+                ret[name] = self.snapshot(val)
+
+        return ret
+
+    def get_states(self, events):
+        states = {}
+        for eid in events:
+            self.controller.SetFrameEvent(eid, True)
+            states[eid] = self.snapshot(self.controller.GetVulkanPipelineState())
+        return states
+
+    def check_capture(self):
+        events = []
+        draw: rd.DrawcallDescription = self.get_first_draw()
+        while draw is not None:
+            events.append(draw.eventId)
+            draw = draw.next
+
+        self.check(len(events) > 1)
+
+        cache_size = rd.SetConfigSetting('Replay_PipelineStateCacheSizeMB')
+        default_size = cache_size.data.basic.u
+
+        # with no budget only the current event is cached, so every state is fetched fresh
+        cache_size.data.basic.u = 0
+        fresh = self.get_states(events)
+
+        # with the default budget, fill the cache then go back through the events in reverse so that
+        # each state comes from the cache
+        cache_size.data.basic.u = default_size
+        self.get_states(events)
+        cached = self.get_states(reversed(events))
+
+        for eid in events:
+            if cached[eid] != fresh[eid]:
+                raise rdtest.TestFailureException("Cached pipeline state at {} doesn't match fresh fetch".format(eid))
+
+        rdtest.log.success("Cached pipeline states match fresh fetches")
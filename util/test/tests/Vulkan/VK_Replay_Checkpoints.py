@@ -0,0 +1,47 @@
+import rdtest
+import renderdoc as rd
+
+
+class VK_Replay_Checkpoints(rdtest.TestCase):
+    demos_test_name = 'VK_Resource_Lifetimes'
+    demos_frame_cap = 200
+
+    # read back the contents of every output target at each event, replaying fully to each one
+    def get_outputs(self, events):
+        ret = {}
+        for eid in events:
+            self.controller.SetFrameEvent(eid, True)
+
+            pipe: rd.PipeState = self.controller.GetPipelineState()
+
+            ret[eid] = [self.controller.GetTextureData(o.resourceId, rd.Subresource())
+                        for o in pipe.GetOutputTargets() if o.resourceId != rd.ResourceId.Null()]
+        return ret
+
+    def check_capture(self):
+        events = []
+        draw: rd.DrawcallDescription = self.get_first_draw()
+        while draw is not None:
+            events.append(draw.eventId)
+            draw = draw.next
+
+        interval = rd.SetConfigSetting('Vulkan_ReplayCheckpointInterval')
+        default_interval = interval.data.basic.u
+
+        # without checkpoints, every replay goes from the start of the frame
+        interval.data.basic.u = 0
+        reference = self.get_outputs(events)
+
+        # create checkpoints at every submit going forward, then replay going backwards so that each
+        # replay resumes from the closest checkpoint
+        interval.data.basic.u = 1
+        self.get_outputs(events)
+        resumed = self.get_outputs(reversed(events))
+
+        interval.data.basic.u = default_interval
+
+        for eid in events:
+            if resumed[eid] != reference[eid]:
+                raise rdtest.TestFailureException("Outputs at {} differ when resuming from a checkpoint".format(eid))
+
+        rdtest.log.success("Replays resuming from checkpoints match full replays")
@@ -47,6 +47,11 @@ class VK_Shader_Debug_Zoo(rdtest.TestCase):
 
                     try:
                         self.check_pixel_value(pipe.GetOutputTargets()[0].resourceId, x, y, debugged.value.fv[0:4])
+
+                        # Check that running to the end without recording states gives the same result
+                        self.check_run_debug(self.controller.DebugPixel(x, y, rd.ReplayController.NoPreference,
+                                                                        rd.ReplayController.NoPreference),
+                                             cycles, variables, output)
                     except rdtest.TestFailureException as ex:
                         failed = True
                         rdtest.log.error("Test {} in sub-section {} did not match. {}".format(test, child, str(ex)))